@@ -0,0 +1,132 @@
+// Measures the Arachne wall generator on detailed outlines, reporting the time of WallToolPaths::generate()
+// and the allocations of the skeletal trapezoidation graph.
+// Usage: arachne_benchmark [STL / OBJ / 3MF files]
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "libslic3r/ClipperUtils.hpp"
+#include "libslic3r/Model.hpp"
+#include "libslic3r/PrintConfig.hpp"
+#include "libslic3r/TriangleMesh.hpp"
+#include "libslic3r/TriangleMeshSlicer.hpp"
+#include "libslic3r/Arachne/SkeletalTrapezoidation.hpp"
+#include "libslic3r/Arachne/WallToolPaths.hpp"
+#include "libslic3r/Arachne/BeadingStrategy/BeadingStrategyFactory.hpp"
+
+#include "SandboxUtils.hpp"
+
+namespace Slic3r {
+
+static constexpr const int    NumRuns     = 3;
+static constexpr const size_t NumWalls    = 3;
+static constexpr const double LineWidth   = 0.45;
+static constexpr const double LayerHeight = 0.2;
+
+static void measure(const std::string &name, const std::vector<ExPolygons> &layers)
+{
+    const coord_t                      line_width = scaled<coord_t>(LineWidth);
+    const Arachne::WallToolPathsParams params     = Arachne::make_paths_params(1, PrintObjectConfig::defaults(), PrintConfig::defaults());
+
+    const double t = sandbox::seconds_per_run(NumRuns, [&layers, line_width, &params]() {
+        for (const ExPolygons &layer : layers) {
+            Arachne::WallToolPaths wall_tool_paths(to_polygons(layer), line_width, line_width, NumWalls, 0, LayerHeight, params);
+            wall_tool_paths.generate();
+        }
+    });
+
+    // The graph is not accessible through WallToolPaths, build it with a beading strategy close to the one of WallToolPaths.
+    size_t num_allocations = 0;
+    size_t num_blocks      = 0;
+    for (const ExPolygons &layer : layers) {
+        const Arachne::BeadingStrategyPtr beading_strategy = Arachne::BeadingStrategyFactory::makeStrategy(
+            line_width, line_width, scaled<coord_t>(params.wall_transition_length), float(params.wall_transition_angle), true,
+            scaled<coord_t>(params.min_bead_width), scaled<coord_t>(params.min_feature_size), 0.5, 0.5, coord_t(2 * NumWalls));
+        Arachne::SkeletalTrapezoidation wall_maker(to_polygons(layer), *beading_strategy, beading_strategy->getTransitioningAngle(),
+            scaled<coord_t>(0.8), scaled<coord_t>(100.), scaled<coord_t>(params.wall_transition_filter_deviation), scaled<coord_t>(params.wall_transition_length));
+        std::vector<Arachne::VariableWidthLines> toolpaths;
+        wall_maker.generateToolpaths(toolpaths);
+        num_allocations += wall_maker.graph.arena().num_allocations();
+        num_blocks      += wall_maker.graph.arena().num_blocks();
+    }
+
+    sandbox::report(name)
+              << std::setw(6) << layers.size() << " layers "
+              << "generate " << std::setw(10) << std::fixed << std::setprecision(4) << t << " s, "
+              << "graph nodes and edges " << std::setw(10) << num_allocations << ", "
+              << "heap blocks " << std::setw(6) << num_blocks << std::endl;
+}
+
+static std::vector<ExPolygons> slice(const TriangleMesh &mesh)
+{
+    std::vector<ExPolygons> layers = slice_mesh_ex(mesh.its, sandbox::slicing_zs(mesh.bounding_box(), LayerHeight));
+    layers.erase(std::remove_if(layers.begin(), layers.end(), [](const ExPolygons &l) { return l.empty(); }), layers.end());
+    return layers;
+}
+
+static Polygon make_circle(const Point &center, double r, size_t num_points)
+{
+    Polygon out;
+    out.points.reserve(num_points);
+    for (size_t i = 0; i < num_points; ++ i) {
+        const double a = 2. * PI * double(i) / double(num_points);
+        out.points.emplace_back(center + Point(scaled<coord_t>(r * cos(a)), scaled<coord_t>(r * sin(a))));
+    }
+    return out;
+}
+
+// A toothed wheel with a ring of holes surrounded by lettering-like strokes 0.5 mm to 1.2 mm wide,
+// producing the thin features and width transitions typical of embossed text and logos.
+static ExPolygons make_logo()
+{
+    Polygons outer;
+    Polygons holes;
+
+    // Wheel with 60 teeth.
+    Polygon wheel;
+    for (size_t i = 0; i < 240; ++ i) {
+        const double a = 2. * PI * double(i) / 240.;
+        const double r = (i / 2) % 2 == 0 ? 30. : 28.;
+        wheel.points.emplace_back(scaled<coord_t>(r * cos(a)), scaled<coord_t>(r * sin(a)));
+    }
+    outer.emplace_back(std::move(wheel));
+    for (size_t i = 0; i < 24; ++ i) {
+        const double a = 2. * PI * double(i) / 24.;
+        holes.emplace_back(make_circle(Point(scaled<coord_t>(22. * cos(a)), scaled<coord_t>(22. * sin(a))), 1.5 + 0.2 * double(i % 4), 32));
+    }
+    holes.emplace_back(make_circle(Point(0, 0), 8., 128));
+
+    // Rings and bars of varying stroke width, four lines of twelve letters.
+    for (size_t row = 0; row < 4; ++ row)
+        for (size_t col = 0; col < 12; ++ col) {
+            const Point  center(scaled<coord_t>(-33. + 6. * double(col)), scaled<coord_t>(-50. - 8. * double(row)));
+            const double stroke = 0.5 + 0.1 * double((row * 12 + col) % 8);
+            if (col % 3 == 2) {
+                outer.emplace_back(Polygon{ center + Point(scaled<coord_t>(-0.5 * stroke), scaled<coord_t>(-2.5)),
+                                            center + Point(scaled<coord_t>( 0.5 * stroke), scaled<coord_t>(-2.5)),
+                                            center + Point(scaled<coord_t>( 0.5 * stroke), scaled<coord_t>( 2.5)),
+                                            center + Point(scaled<coord_t>(-0.5 * stroke), scaled<coord_t>( 2.5)) });
+            } else {
+                outer.emplace_back(make_circle(center, 2.5, 48));
+                holes.emplace_back(make_circle(center, 2.5 - stroke, 48));
+            }
+        }
+
+    return diff_ex(outer, holes);
+}
+
+} // namespace Slic3r
+
+int main(int argc, const char *argv[])
+{
+    using namespace Slic3r;
+
+    sandbox::for_each_input_mesh(argc, argv, [](const std::string &name, const TriangleMesh &mesh) { measure(name, slice(mesh)); });
+
+    measure("logo, wheel with 60 teeth and 48 letters", std::vector<ExPolygons>(10, make_logo()));
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,97 @@
+// Measures the heap allocations and the time of the Clipper boolean operations and offsets on the shapes of
+// tests/libslic3r/test_clipper_utils.cpp, comparing a Clipper engine constructed for each operation with the engine
+// of the thread reused by the consecutive operations (ClipperUtils::ThreadLocalEngine).
+// Usage: clipper_benchmark
+
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+#include "libslic3r/ClipperUtils.hpp"
+#include "libslic3r/ExPolygon.hpp"
+
+#include "AllocationCounter.hpp"
+#include "SandboxUtils.hpp"
+
+namespace Slic3r {
+
+static constexpr const size_t NumRuns = 20000;
+
+static void measure(const std::string &name, const std::function<void()> &fn)
+{
+    // Warm up, so that the engine of the thread has its memory allocated.
+    fn();
+    const size_t num_allocations = sandbox::num_allocations();
+    const double t               = sandbox::seconds_per_run(NumRuns, fn);
+    sandbox::report(name, 56)
+              << std::setw(10) << std::fixed << std::setprecision(2) << double(sandbox::num_allocations() - num_allocations) / NumRuns << " allocations, "
+              << std::setw(10) << std::setprecision(3) << t * 1e6 << " us" << std::endl;
+}
+
+template<class Clipper>
+static void clipper_diff(Clipper &clipper, const Polygons &subject, const Polygons &clip, ClipperLib::Paths &out)
+{
+    clipper.AddPaths(ClipperUtils::PolygonsProvider(subject), ClipperLib::ptSubject, true);
+    clipper.AddPaths(ClipperUtils::PolygonsProvider(clip), ClipperLib::ptClip, true);
+    clipper.Execute(ClipperLib::ctDifference, out, ClipperLib::pftNonZero, ClipperLib::pftNonZero);
+}
+
+template<class ClipperOffset>
+static void clipper_offset(ClipperOffset &co, const Polygons &polygons, float delta, ClipperLib::Paths &out)
+{
+    co.MiterLimit = 3.;
+    co.AddPaths(ClipperUtils::PolygonsProvider(polygons), ClipperLib::jtMiter, ClipperLib::etClosedPolygon);
+    co.Execute(out, delta);
+}
+
+static void measure_shapes(const std::string &name, const Polygons &subject, const Polygons &clip, float delta)
+{
+    ClipperLib::Paths out;
+    measure(name + ": diff, engine per operation", [&]() { ClipperLib::Clipper clipper; clipper_diff(clipper, subject, clip, out); });
+    measure(name + ": diff, thread engine",        [&]() { ClipperUtils::ThreadLocalClipper clipper; clipper_diff(*clipper, subject, clip, out); });
+    measure(name + ": offset, engine per operation", [&]() { ClipperLib::ClipperOffset co; clipper_offset(co, subject, delta, out); });
+    measure(name + ": offset, thread engine",        [&]() { ClipperUtils::ThreadLocalClipperOffset co; clipper_offset(*co, subject, delta, out); });
+    measure(name + ": diff_ex()",                  [&]() { diff_ex(subject, clip); });
+    measure(name + ": offset_ex()",                [&]() { offset_ex(subject, delta); });
+    measure(name + ": union_ex(offset())",         [&]() { union_ex(offset(subject, delta)); });
+}
+
+} // namespace Slic3r
+
+int main()
+{
+    using namespace Slic3r;
+
+    // Shapes of tests/libslic3r/test_clipper_utils.cpp
+    const Polygon square { { 200, 100 }, { 200, 200 }, { 100, 200 }, { 100, 100 } };
+    const Polygon hole_in_square { { 160, 140 }, { 140, 140 }, { 140, 160 }, { 160, 160 } };
+    measure_shapes("square with hole", Polygons{ square, hole_in_square }, Polygons{ hole_in_square }, 5.f);
+
+    const Polygon square2 { { 20000000, 20000000 }, { 0, 20000000 }, { 0, 0 }, { 20000000, 0 } };
+    const Polygon hole2 { { 5000000, 15000000 }, { 15000000, 15000000 }, { 15000000, 5000000 }, { 5000000, 5000000 } };
+    measure_shapes("square with hole 2", Polygons{ square2, hole2 }, Polygons{ hole2 }, 1000000.f);
+
+    // Clipper bug #96: a cross with notches clipped by a square.
+    const Polygon cross {
+        { 44735000, 31936670 }, { 55270000, 31936670 }, { 55270000, 25270000 }, { 74730000, 25270000 }, { 74730000, 44730000 }, { 68063296, 44730000 }, { 68063296, 55270000 }, { 74730000, 55270000 },
+        { 74730000, 74730000 }, { 55270000, 74730000 }, { 55270000, 68063296 }, { 44730000, 68063296 }, { 44730000, 74730000 }, { 25270000, 74730000 }, { 25270000, 55270000 }, { 31936670, 55270000 },
+        { 31936670, 44730000 }, { 25270000, 44730000 }, { 25270000, 25270000 }, { 44730000, 25270000 }, { 44730000, 31936670 } };
+    const Polygon clip96 { { 75200000, 45200000 }, { 54800000, 45200000 }, { 54800000, 24800000 }, { 75200000, 24800000 } };
+    measure_shapes("Clipper bug #96", Polygons{ cross }, Polygons{ clip96 }, -500000.f);
+
+    // A layer sized input: 20 x 20 copies of the cross with notches clipped by a circle.
+    Polygons crosses;
+    for (int i = 0; i < 20; ++ i)
+        for (int j = 0; j < 20; ++ j) {
+            crosses.emplace_back(cross);
+            crosses.back().translate(Point(coord_t(i) * 60000000, coord_t(j) * 60000000));
+        }
+    Polygon circle;
+    for (int i = 0; i < 360; ++ i)
+        circle.points.emplace_back(Point(coord_t(600000000. + 500000000. * cos(i * PI / 180.)), coord_t(600000000. + 500000000. * sin(i * PI / 180.))));
+    measure_shapes("20 x 20 crosses", crosses, Polygons{ circle }, -500000.f);
+
+    return EXIT_SUCCESS;
+}
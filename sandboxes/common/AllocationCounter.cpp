@@ -0,0 +1,24 @@
+#include "AllocationCounter.hpp"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+// Count the heap allocations of the whole program.
+static std::atomic<size_t> g_num_allocations { 0 };
+
+void* operator new(size_t size)
+{
+    ++ g_num_allocations;
+    if (void *p = std::malloc(size == 0 ? 1 : size))
+        return p;
+    throw std::bad_alloc();
+}
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete(void *p, size_t) noexcept { std::free(p); }
+
+namespace Slic3r { namespace sandbox {
+
+size_t num_allocations() { return g_num_allocations; }
+
+} } // namespace Slic3r::sandbox
@@ -0,0 +1,15 @@
+#ifndef slic3r_sandboxes_AllocationCounter_hpp_
+#define slic3r_sandboxes_AllocationCounter_hpp_
+
+#include <cstddef>
+
+namespace Slic3r { namespace sandbox {
+
+// Number of the heap allocations made by the program so far.
+// Counted by the global operator new of AllocationCounter.cpp, which is linked into the sandboxes
+// linking the sandbox_allocation_counter library only.
+size_t num_allocations();
+
+} } // namespace Slic3r::sandbox
+
+#endif // slic3r_sandboxes_AllocationCounter_hpp_
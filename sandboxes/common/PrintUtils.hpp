@@ -0,0 +1,34 @@
+#ifndef slic3r_sandboxes_PrintUtils_hpp_
+#define slic3r_sandboxes_PrintUtils_hpp_
+
+#include <initializer_list>
+#include <string>
+
+#include "libslic3r/Model.hpp"
+#include "libslic3r/Print.hpp"
+#include "libslic3r/TriangleMesh.hpp"
+
+namespace Slic3r { namespace sandbox {
+
+// Place the mesh in the middle of the bed and slice it with the full print config modified by config_overrides,
+// running all the steps of the print.
+inline void process_print(Print &print, Model &model, const std::string &name, const TriangleMesh &mesh,
+                          std::initializer_list<DynamicPrintConfig::SetDeserializeItem> config_overrides)
+{
+    DynamicPrintConfig config = DynamicPrintConfig::full_print_config();
+    config.set_deserialize_strict(config_overrides);
+
+    ModelObject *object = model.add_object();
+    object->name = name;
+    object->add_volume(mesh);
+    object->add_instance()->set_offset(Vec3d(128., 128., 0.));
+    object->ensure_on_bed();
+
+    print.apply(model, config);
+    print.set_status_silent();
+    print.process();
+}
+
+} } // namespace Slic3r::sandbox
+
+#endif // slic3r_sandboxes_PrintUtils_hpp_
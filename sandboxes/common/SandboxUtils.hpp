@@ -0,0 +1,61 @@
+#ifndef slic3r_sandboxes_SandboxUtils_hpp_
+#define slic3r_sandboxes_SandboxUtils_hpp_
+
+// Helpers shared by the benchmark sandboxes: timing of repeated runs, the report lines
+// and the inputs given on the command line.
+
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "libslic3r/BoundingBox.hpp"
+#include "libslic3r/Model.hpp"
+
+#include "libnest2d/tools/benchmark.h"
+
+namespace Slic3r { namespace sandbox {
+
+// Run fn num_runs times, return the average time of a run in seconds.
+template<class Fn>
+double seconds_per_run(size_t num_runs, Fn &&fn)
+{
+    Benchmark b;
+    b.start();
+    for (size_t i = 0; i < num_runs; ++ i)
+        fn();
+    b.stop();
+    return b.getElapsedSec() / double(num_runs);
+}
+
+// Start a line of the report with the name of the measured case, left aligned to width.
+inline std::ostream& report(const std::string &name, int width = 48)
+{
+    return std::cout << std::left << std::setw(width) << name << std::right;
+}
+
+// Call fn(name, mesh) for the first object of each model file given on the command line.
+template<class Fn>
+void for_each_input_mesh(int argc, const char *argv[], Fn &&fn)
+{
+    for (int i = 1; i < argc; ++ i) {
+        Model model = Model::read_from_file(argv[i]);
+        if (model.objects.empty())
+            std::cerr << "No object found in " << argv[i] << std::endl;
+        else
+            fn(std::string(argv[i]), model.objects.front()->mesh());
+    }
+}
+
+// Heights of the layers of the given height slicing the bounding box, taken in the middle of the layers.
+inline std::vector<float> slicing_zs(const BoundingBoxf3 &bbox, double layer_height)
+{
+    std::vector<float> zs;
+    for (double z = bbox.min.z() + 0.5 * layer_height; z < bbox.max.z(); z += layer_height)
+        zs.emplace_back(float(z));
+    return zs;
+}
+
+} } // namespace Slic3r::sandbox
+
+#endif // slic3r_sandboxes_SandboxUtils_hpp_
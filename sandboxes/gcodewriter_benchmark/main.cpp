@@ -0,0 +1,82 @@
+// Measures the heap allocations and the time of formatting the G-code lines of an extrusion path with GCodeWriter,
+// comparing the lines returned as strings and concatenated to the output with the lines appended to the output in place.
+// Usage: gcodewriter_benchmark
+
+#include <cmath>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "libslic3r/GCodeWriter.hpp"
+
+#include "AllocationCounter.hpp"
+#include "SandboxUtils.hpp"
+
+namespace Slic3r {
+
+static constexpr const size_t NumRuns   = 200;
+static constexpr const size_t NumPoints = 10000;
+
+// Measure the allocations per G-code line of fn(gcode), which emits one line for each point.
+static void measure(const std::string &name, const std::function<void(std::string&)> &fn)
+{
+    // Warm up, so that the output has its memory allocated.
+    std::string gcode;
+    fn(gcode);
+    const size_t num_allocations = sandbox::num_allocations();
+    const double t               = sandbox::seconds_per_run(NumRuns, [&fn, &gcode]() {
+        gcode.clear();
+        fn(gcode);
+    });
+    sandbox::report(name)
+              << std::setw(10) << std::fixed << std::setprecision(3) << double(sandbox::num_allocations() - num_allocations) / (NumRuns * NumPoints) << " allocations per line, "
+              << std::setw(10) << std::setprecision(3) << t * 1e9 / NumPoints << " ns per line, "
+              << gcode.size() << " bytes" << std::endl;
+}
+
+} // namespace Slic3r
+
+int main()
+{
+    using namespace Slic3r;
+
+    // A circle of 100 mm diameter, as extruded by a perimeter.
+    std::vector<Vec2d> points;
+    points.reserve(NumPoints);
+    for (size_t i = 0; i < NumPoints; ++ i) {
+        const double a = 2. * PI * double(i) / double(NumPoints);
+        points.emplace_back(Vec2d(125. + 50. * cos(a), 125. + 50. * sin(a)));
+    }
+    const double      dE      = 0.0011;
+    const std::string comment = "outer wall";
+
+    GCodeWriter writer;
+    writer.set_extruders({ 0 });
+    writer.set_extruder(0);
+
+    for (bool with_comments : { false, true }) {
+        GCodeWriter::full_gcode_comment = with_comments;
+        const std::string suffix = with_comments ? ", with comments" : "";
+        measure("G1 returned and concatenated" + suffix, [&](std::string &gcode) {
+            for (const Vec2d &pt : points)
+                gcode += writer.extrude_to_xy(pt, dE, comment);
+        });
+        measure("G1 appended" + suffix, [&](std::string &gcode) {
+            for (const Vec2d &pt : points)
+                writer.extrude_to_xy(gcode, pt, dE, comment);
+        });
+        measure("G1 F returned and concatenated" + suffix, [&](std::string &gcode) {
+            for (size_t i = 0; i < NumPoints; ++ i)
+                gcode += writer.set_speed(1800. + double(i % 600), comment, ";_EXTRUDE_SET_SPEED");
+        });
+        measure("G1 F appended" + suffix, [&](std::string &gcode) {
+            for (size_t i = 0; i < NumPoints; ++ i)
+                writer.set_speed(gcode, 1800. + double(i % 600), comment, ";_EXTRUDE_SET_SPEED");
+        });
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,66 @@
+// Measures the generation of the Lightning infill trees of tall objects printed with 15% lightning infill.
+// Usage: lightning_benchmark [STL / OBJ / 3MF files]
+
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "libslic3r/Model.hpp"
+#include "libslic3r/Print.hpp"
+#include "libslic3r/TriangleMesh.hpp"
+#include "libslic3r/Fill/FillLightning.hpp"
+
+#include "PrintUtils.hpp"
+#include "SandboxUtils.hpp"
+
+namespace Slic3r {
+
+static constexpr const int NumRuns = 3;
+
+static void measure(const std::string &name, const TriangleMesh &mesh)
+{
+    Model model;
+    Print print;
+    // Generates the infill areas the trees are built for, the trees are generated for the first time as well.
+    sandbox::process_print(print, model, name, mesh, {
+        { "sparse_infill_pattern", "lightning" },
+        { "sparse_infill_density", "15%" },
+        { "layer_height",          0.2 },
+        { "initial_layer_print_height", 0.2 },
+        { "enable_support",        false },
+    });
+
+    const PrintObject &print_object = *print.objects().front();
+    const double       t = sandbox::seconds_per_run(NumRuns, [&print_object]() { FillLightning::build_generator(print_object, []() {}); });
+    sandbox::report(name)
+              << std::setw(6) << print_object.layer_count() << " layers "
+              << "build_generator " << std::setw(10) << std::fixed << std::setprecision(4) << t << " s" << std::endl;
+}
+
+// Cubes of decreasing size stacked on each other, so that there are top surfaces to be supported at several heights.
+static TriangleMesh make_stepped_tower(unsigned num_steps, double step_height)
+{
+    indexed_triangle_set out;
+    for (unsigned i = 0; i < num_steps; ++ i) {
+        const double size = 20. * (num_steps - i);
+        indexed_triangle_set its = its_make_cube(size, size, step_height);
+        its_transform(its, identity3f().translate(Vec3f(float(-0.5 * size), float(-0.5 * size), float(step_height * i))));
+        its_merge(out, its);
+    }
+    return TriangleMesh(out);
+}
+
+} // namespace Slic3r
+
+int main(int argc, const char *argv[])
+{
+    using namespace Slic3r;
+
+    sandbox::for_each_input_mesh(argc, argv, measure);
+
+    measure("cylinder 80 x 150 mm",          make_cylinder(40., 150.));
+    measure("stepped tower 6 x 25 mm steps", make_stepped_tower(6, 25.));
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,101 @@
+// Measures SeamPlacer::init() with aligned seams on tall objects, reporting the time, the memory of the seam candidates
+// and the size of their KD trees.
+// Usage: seam_benchmark [STL / OBJ / 3MF files]
+
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "libslic3r/Model.hpp"
+#include "libslic3r/Print.hpp"
+#include "libslic3r/TriangleMesh.hpp"
+#include "libslic3r/GCode/SeamPlacer.hpp"
+
+#include "PrintUtils.hpp"
+#include "SandboxUtils.hpp"
+
+namespace Slic3r {
+
+static constexpr const int NumRuns = 3;
+
+static void measure(const std::string &name, const TriangleMesh &mesh)
+{
+    Model model;
+    Print print;
+    sandbox::process_print(print, model, name, mesh, {
+        { "seam_position",         "aligned" },
+        { "layer_height",          0.2 },
+        { "initial_layer_print_height", 0.2 },
+        { "enable_support",        false },
+    });
+
+    SeamPlacer   seam_placer;
+    const double t = sandbox::seconds_per_run(NumRuns, [&seam_placer, &print]() { seam_placer.init(print, []() {}); });
+
+    size_t num_candidates = 0;
+    size_t num_tree_nodes = 0;
+    size_t memory         = 0;
+    size_t tree_memory    = 0;
+    for (const auto &[print_object, seam_data] : seam_placer.m_seam_per_object)
+        for (const PrintObjectSeamData::LayerSeams &layer : seam_data.layers) {
+            num_candidates += layer.points.size();
+            memory         += layer.points.capacity() * sizeof(SeamPlacerImpl::SeamCandidate) + layer.positions.capacity() * sizeof(Vec3f);
+            if (layer.points_tree) {
+                num_tree_nodes += layer.points_tree->num_nodes();
+                tree_memory    += layer.points_tree->num_nodes() * sizeof(PrintObjectSeamData::SeamCandidatesTree::IndexType);
+            }
+        }
+
+    sandbox::report(name)
+              << std::setw(6) << print.objects().front()->layer_count() << " layers "
+              << "init " << std::setw(10) << std::fixed << std::setprecision(4) << t << " s, "
+              << "candidates " << std::setw(10) << num_candidates << ", "
+              << std::setw(8) << (memory >> 10) << " kB, "
+              << "tree nodes " << std::setw(10) << num_tree_nodes << ", "
+              << std::setw(8) << (tree_memory >> 10) << " kB" << std::endl;
+}
+
+// Surface of revolution with a wavy profile, radius between 22 and 38 mm.
+static TriangleMesh make_vase(double height, size_t num_segments)
+{
+    const size_t num_rings = size_t(height) + 1;
+    indexed_triangle_set its;
+    for (size_t i = 0; i < num_rings; ++ i) {
+        const double z = height * double(i) / double(num_rings - 1);
+        const double r = 30. + 8. * sin(z / 40.);
+        for (size_t j = 0; j < num_segments; ++ j) {
+            const double a = 2. * PI * double(j) / double(num_segments);
+            its.vertices.emplace_back(float(r * cos(a)), float(r * sin(a)), float(z));
+        }
+    }
+    auto vertex = [num_segments](size_t ring, size_t segment) { return int(ring * num_segments + segment % num_segments); };
+    for (size_t i = 0; i + 1 < num_rings; ++ i)
+        for (size_t j = 0; j < num_segments; ++ j) {
+            its.indices.emplace_back(vertex(i, j), vertex(i, j + 1), vertex(i + 1, j + 1));
+            its.indices.emplace_back(vertex(i, j), vertex(i + 1, j + 1), vertex(i + 1, j));
+        }
+    const int bottom = int(its.vertices.size());
+    its.vertices.emplace_back(0.f, 0.f, 0.f);
+    const int top = int(its.vertices.size());
+    its.vertices.emplace_back(0.f, 0.f, float(height));
+    for (size_t j = 0; j < num_segments; ++ j) {
+        its.indices.emplace_back(bottom, vertex(0, j + 1), vertex(0, j));
+        its.indices.emplace_back(top, vertex(num_rings - 1, j), vertex(num_rings - 1, j + 1));
+    }
+    return TriangleMesh(its);
+}
+
+} // namespace Slic3r
+
+int main(int argc, const char *argv[])
+{
+    using namespace Slic3r;
+
+    sandbox::for_each_input_mesh(argc, argv, measure);
+
+    measure("vase 400 mm, 360 segments", make_vase(400., 360));
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,80 @@
+// Measures slice_mesh() / slice_mesh_ex() over the OBJ meshes of tests/data and over large synthetic meshes.
+// Usage: slice_benchmark [directory with OBJ files] [layer height]
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+
+#include "libslic3r/TriangleMesh.hpp"
+#include "libslic3r/TriangleMeshSlicer.hpp"
+#include "libslic3r/Format/OBJ.hpp"
+
+#include "SandboxUtils.hpp"
+
+namespace Slic3r {
+
+static constexpr const int NumRuns = 5;
+
+static void measure(const std::string &name, const indexed_triangle_set &its, float layer_height)
+{
+    std::vector<float> zs = sandbox::slicing_zs(bounding_box(its), layer_height);
+    MeshSlicingParamsEx params;
+    const double t_polygons   = sandbox::seconds_per_run(NumRuns, [&its, &zs, &params]() { slice_mesh(its, zs, params); });
+    const double t_expolygons = sandbox::seconds_per_run(NumRuns, [&its, &zs, &params]() { slice_mesh_ex(its, zs, params); });
+    size_t num_polygons = 0;
+    for (const Polygons &layer : slice_mesh(its, zs, params))
+        num_polygons += layer.size();
+    sandbox::report(name)
+              << std::setw(10) << its.indices.size() << " facets "
+              << std::setw(6) << zs.size() << " layers "
+              << std::setw(8) << num_polygons << " polygons "
+              << "slice_mesh " << std::setw(10) << std::fixed << std::setprecision(4) << t_polygons << " s "
+              << "slice_mesh_ex " << std::setw(10) << t_expolygons << " s" << std::endl;
+}
+
+// Finely tesselated spheres stacked along Z, to get a scan like number of facets crossing each slicing plane.
+static indexed_triangle_set make_sphere_stack(unsigned num_spheres, double detail)
+{
+    indexed_triangle_set out, sphere = its_make_sphere(10., 2. * PI / detail);
+    for (unsigned i = 0; i < num_spheres; ++ i) {
+        indexed_triangle_set its = sphere;
+        its_transform(its, identity3f().translate(Vec3f(0.f, 0.f, 15.f * float(i))));
+        its_merge(out, its);
+    }
+    return out;
+}
+
+} // namespace Slic3r
+
+int main(int argc, const char *argv[])
+{
+    using namespace Slic3r;
+
+    const std::string data_dir     = argc > 1 ? argv[1] : TEST_DATA_DIR;
+    const float       layer_height = argc > 2 ? std::stof(argv[2]) : 0.2f;
+
+    std::vector<boost::filesystem::path> paths;
+    for (const boost::filesystem::directory_entry &entry : boost::filesystem::directory_iterator(data_dir))
+        if (boost::filesystem::is_regular_file(entry.status()) && entry.path().extension() == ".obj")
+            paths.emplace_back(entry.path());
+    std::sort(paths.begin(), paths.end());
+
+    for (const boost::filesystem::path &path : paths) {
+        TriangleMesh mesh;
+        ObjInfo      obj_info;
+        std::string  message;
+        if (load_obj(path.string().c_str(), &mesh, obj_info, message))
+            measure(path.filename().string(), mesh.its, layer_height);
+        else
+            std::cerr << "Failed loading " << path.string() << ": " << message << std::endl;
+    }
+
+    measure("sphere stack 4x 1M facets",  make_sphere_stack(4, 1000.), layer_height);
+    measure("sphere stack 16x 1M facets", make_sphere_stack(16, 1000.), layer_height);
+
+    return EXIT_SUCCESS;
+}
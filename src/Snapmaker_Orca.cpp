@@ -51,9 +51,11 @@ using namespace nlohmann;
 #include "libslic3r/GCode/PostProcessor.hpp"
 #include "libslic3r/Model.hpp"
 #include "libslic3r/ModelArrange.hpp"
+#include "libslic3r/PersistentSliceCache.hpp"
 #include "libslic3r/Platform.hpp"
 #include "libslic3r/Print.hpp"
 #include "libslic3r/SLAPrint.hpp"
+#include "libslic3r/Support/TreeSupport.hpp"
 #include "libslic3r/TriangleMesh.hpp"
 #include "libslic3r/Format/AMF.hpp"
 #include "libslic3r/Format/3mf.hpp"
@@ -1258,6 +1260,20 @@ int CLI::run(int argc, char **argv)
     if (avoid_extrusion_cali_region_option)
         avoid_extrusion_cali_region = avoid_extrusion_cali_region_option->value;
 
+    ConfigOptionString* slice_cache_dir_option = m_config.option<ConfigOptionString>("slice_cache_dir");
+    if (slice_cache_dir_option && !slice_cache_dir_option->value.empty()) {
+        ConfigOptionInt* slice_cache_size_option = m_config.option<ConfigOptionInt>("slice_cache_size");
+        uint64_t slice_cache_size = slice_cache_size_option ? uint64_t(std::max(0, slice_cache_size_option->value)) : 4096;
+        PrintObject::persistent_slice_cache = std::make_shared<PersistentSliceCache>(slice_cache_dir_option->value, slice_cache_size << 20);
+        BOOST_LOG_TRIVIAL(info) << boost::format("use slice cache directory %1%, size limit %2% MB")%slice_cache_dir_option->value %slice_cache_size;
+    }
+
+    ConfigOptionInt* tree_support_cache_size_option = m_config.option<ConfigOptionInt>("tree_support_cache_size");
+    if (tree_support_cache_size_option && tree_support_cache_size_option->value > 0) {
+        TreeSupportData::cache_size_limit = size_t(tree_support_cache_size_option->value) << 20;
+        BOOST_LOG_TRIVIAL(info) << boost::format("tree support cache size limit %1% MB")%tree_support_cache_size_option->value;
+    }
+
     ConfigOptionString* pipe_option = m_config.option<ConfigOptionString>("pipe");
     if (pipe_option) {
         pipe_name = pipe_option->value;
@@ -5140,6 +5156,8 @@ int CLI::run(int argc, char **argv)
                     else
                         finished = true;
                 }//end for partplate
+                if (PrintObject::persistent_slice_cache)
+                    BOOST_LOG_TRIVIAL(info) << PrintObject::persistent_slice_cache->stats_string();
 
 #if defined(__linux__) || defined(__LINUX__)
                 if (g_cli_callback_mgr.is_started()) {
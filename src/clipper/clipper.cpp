@@ -788,7 +788,7 @@ bool ClipperBase::AddPath(const Path &pg, PolyType PolyTyp, bool Closed)
     return false;
 
   // Allocate a new edge array.
-  std::vector<TEdge> edges(highI + 1);
+  std::vector<TEdge> edges = AllocateEdges(highI + 1);
   // Fill in the edge array.
   bool result = AddPathInternal(pg, highI, PolyTyp, Closed, edges.data());
   if (result)
@@ -975,10 +975,64 @@ bool ClipperBase::AddPathInternal(const Path &pg, int highI, PolyType PolyTyp, b
 }
 //------------------------------------------------------------------------------
 
+// Maximum number of edges kept by ClipperBase::Clear() for reuse, about 650kB. Matches the largest edge size class.
+// The Clipper objects reused by ClipperUtils are kept per thread for the life time of the thread, thus the limits
+// cover the small operations, which are the most frequent ones, while the large operations allocate their own memory.
+static constexpr const size_t MaxRetainedEdges = 4 * 1024;
+// Maximum number of output point chunks kept by Clipper::DisposeAllOutRecs() for reuse, 4096 points or about 160kB.
+static constexpr const size_t MaxRetainedOutPtsChunks = 128;
+
+// Size class of an edge array of the given capacity: The highest i, for which 2^i <= capacity.
+static inline size_t edges_size_class_floor(size_t capacity)
+{
+  size_t i = 0;
+  while ((capacity >>= 1) != 0)
+    ++ i;
+  return i;
+}
+
+// Size class of a request for num_edges: The lowest i, for which 2^i >= num_edges.
+static inline size_t edges_size_class_ceil(size_t num_edges)
+{
+  size_t i = 0;
+  while ((size_t(1) << i) < num_edges)
+    ++ i;
+  return i;
+}
+
+std::vector<TEdge> ClipperBase::AllocateEdges(size_t num_edges)
+{
+  static_assert(MaxRetainedEdges == (size_t(1) << (NumEdgeSizeClasses - 1)), "The largest edge size class has to hold MaxRetainedEdges");
+  std::vector<TEdge> edges;
+  size_t size_class = edges_size_class_ceil(num_edges);
+  if (size_class < NumEdgeSizeClasses) {
+    // Take an array of the smallest size class large enough.
+    for (size_t i = size_class; i < NumEdgeSizeClasses; ++ i)
+      if (! m_edges_free[i].empty()) {
+        edges = std::move(m_edges_free[i].back());
+        m_edges_free[i].pop_back();
+        m_edges_free_capacity -= edges.capacity();
+        edges.clear();
+        break;
+      }
+    if (edges.capacity() == 0)
+      // Round the capacity up to the size class, so that the array is reusable by any request of its size class.
+      edges.reserve(size_t(1) << size_class);
+  }
+  edges.resize(num_edges);
+  return edges;
+}
+
 void ClipperBase::Clear()
 {
   CLIPPERLIB_PROFILE_FUNC();
   m_MinimaList.clear();
+  // Keep the edge arrays for the next operation of a reused Clipper object, but do not hold the memory of a large operation.
+  for (std::vector<TEdge> &edges : m_edges)
+    if (edges.capacity() > 0 && m_edges_free_capacity + edges.capacity() <= MaxRetainedEdges) {
+      m_edges_free_capacity += edges.capacity();
+      m_edges_free[edges_size_class_floor(edges.capacity())].emplace_back(std::move(edges));
+    }
   m_edges.clear();
 #ifndef CLIPPERLIB_INT32
   m_UseFullRange = false;
@@ -1063,6 +1117,7 @@ IntRect ClipperBase::GetBounds()
 
 Clipper::Clipper(int initOptions) : 
   ClipperBase(),
+  m_OutPtsChunksUsed(0),
   m_OutPtsFree(nullptr),
   m_OutPtsChunkSize(32),
   m_OutPtsChunkLast(32),
@@ -1079,6 +1134,14 @@ Clipper::Clipper(int initOptions) :
 }
 //------------------------------------------------------------------------------
 
+Clipper::~Clipper()
+{
+  Clear();
+  for (OutPt *pts : m_OutPts)
+    delete[] pts;
+}
+//------------------------------------------------------------------------------
+
 void Clipper::Reset()
 {
   CLIPPERLIB_PROFILE_FUNC();
@@ -1205,23 +1268,27 @@ OutPt* Clipper::AllocateOutPt()
     m_OutPtsFree = pt->Next;
   } else if (m_OutPtsChunkLast < m_OutPtsChunkSize) {
     // Get a point from the last chunk.
-    pt = m_OutPts.back() + (m_OutPtsChunkLast ++);
+    pt = m_OutPts[m_OutPtsChunksUsed - 1] + (m_OutPtsChunkLast ++);
   } else {
-    // The last chunk is full. Allocate a new one.
-    m_OutPts.push_back(new OutPt[m_OutPtsChunkSize]);
+    // The last chunk is full. Take the next chunk kept from the previous operation or allocate a new one.
+    if (m_OutPtsChunksUsed == m_OutPts.size())
+      m_OutPts.push_back(new OutPt[m_OutPtsChunkSize]);
     m_OutPtsChunkLast = 1;
-    pt = m_OutPts.back();
+    pt = m_OutPts[m_OutPtsChunksUsed ++];
   }
   return pt;
 }
 
 void Clipper::DisposeAllOutRecs()
 {
-  for (OutPt *pts : m_OutPts)
-    delete[] pts;
+  // Keep the chunks of output points for the next operation of a reused Clipper object, up to a limit.
+  for (size_t i = MaxRetainedOutPtsChunks; i < m_OutPts.size(); ++ i)
+    delete[] m_OutPts[i];
+  if (m_OutPts.size() > MaxRetainedOutPtsChunks)
+    m_OutPts.resize(MaxRetainedOutPtsChunks);
   for (OutRec *rec : m_PolyOuts)
     delete rec;
-  m_OutPts.clear();
+  m_OutPtsChunksUsed = 0;
   m_OutPtsFree = nullptr;
   m_OutPtsChunkLast = m_OutPtsChunkSize;
   m_PolyOuts.clear();
@@ -3462,7 +3529,9 @@ void ClipperOffset::Execute(Paths& solution, double delta)
   DoOffset(delta);
   
   //now clean up 'corners' ...
-  Clipper clpr;
+  Clipper &clpr = m_clipper;
+  clpr.Clear();
+  clpr.ReverseSolution(false);
   clpr.AddPaths(m_destPolys, ptSubject, true);
   if (delta > 0)
   {
@@ -3493,7 +3562,9 @@ void ClipperOffset::Execute(PolyTree& solution, double delta)
   DoOffset(delta);
 
   //now clean up 'corners' ...
-  Clipper clpr;
+  Clipper &clpr = m_clipper;
+  clpr.Clear();
+  clpr.ReverseSolution(false);
   clpr.AddPaths(m_destPolys, ptSubject, true);
   if (delta > 0)
   {
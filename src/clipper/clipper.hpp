@@ -50,6 +50,7 @@
 //use_deprecated: Enables temporary support for the obsolete functions
 //#define use_deprecated  
 
+#include <array>
 #include <vector>
 #include <deque>
 #include <stdexcept>
@@ -331,7 +332,7 @@ public:
       return false;
 
     // Allocate a new edge array.
-    std::vector<TEdge> edges(num_edges_total);
+    std::vector<TEdge> edges = AllocateEdges(num_edges_total);
     // Fill in the edge array.
     bool result = false;
     TEdge *p_edge = edges.data();
@@ -359,6 +360,8 @@ public:
   bool PreserveCollinear() const {return m_PreserveCollinear;};
   void PreserveCollinear(bool value) {m_PreserveCollinear = value;};
 protected:
+  // Edge array for a new path, reusing the memory of the edge arrays released by Clear().
+  std::vector<TEdge> AllocateEdges(size_t num_edges);
   bool AddPathInternal(const Path &pg, int highI, PolyType PolyTyp, bool Closed, TEdge* edges);
   TEdge* AddBoundsToLML(TEdge *e, bool IsClosed);
   void Reset();
@@ -379,6 +382,12 @@ protected:
 
   // A vector of edges per each input path.
   std::vector<std::vector<TEdge>> m_edges;
+  // Edge arrays released by Clear(), kept for the paths added to a Clipper object reused for another operation.
+  // Bucketed by size class, the arrays of bucket i have a capacity of at least 2^i edges.
+  static constexpr const size_t   NumEdgeSizeClasses = 13;
+  std::array<std::vector<std::vector<TEdge>>, NumEdgeSizeClasses> m_edges_free;
+  // Sum of capacities of the edge arrays in m_edges_free.
+  size_t                          m_edges_free_capacity { 0 };
   // Don't remove intermediate vertices of a collinear sequence of points.
   bool             m_PreserveCollinear;
   // Is any of the paths inserted by AddPath() or AddPaths() open?
@@ -390,7 +399,7 @@ class Clipper : public ClipperBase
 {
 public:
   Clipper(int initOptions = 0);
-  ~Clipper() { Clear(); }
+  ~Clipper();
   void Clear() { ClipperBase::Clear(); DisposeAllOutRecs(); }
   bool Execute(ClipType clipType,
       Paths &solution,
@@ -424,7 +433,9 @@ private:
   // Output polygons.
   std::vector<OutRec*>  m_PolyOuts;
   // Output points, allocated by a continuous sets of m_OutPtsChunkSize.
+  // The chunks are kept by DisposeAllOutRecs() for the next Execute(), only the first m_OutPtsChunksUsed chunks are in use.
   std::vector<OutPt*>   m_OutPts;
+  size_t                m_OutPtsChunksUsed;
   // List of free output points, to be used before taking a point from m_OutPts or allocating a new chunk.
   OutPt                *m_OutPtsFree;
   size_t                m_OutPtsChunkSize;
@@ -508,7 +519,11 @@ private:
 class ClipperOffset 
 {
 public:
-  ClipperOffset(double miterLimit = 2.0, double roundPrecision = 0.25, double shortestEdgeLength = 0.) :
+  static constexpr const double DefaultMiterLimit         = 2.0;
+  static constexpr const double DefaultArcTolerance       = 0.25;
+  static constexpr const double DefaultShortestEdgeLength = 0.;
+
+  ClipperOffset(double miterLimit = DefaultMiterLimit, double roundPrecision = DefaultArcTolerance, double shortestEdgeLength = DefaultShortestEdgeLength) :
     MiterLimit(miterLimit), ArcTolerance(roundPrecision), ShortestEdgeLength(shortestEdgeLength), m_lowest(-1, 0) {}
   ~ClipperOffset() { Clear(); }
   void AddPath(const Path& path, JoinType joinType, EndType endType);
@@ -535,6 +550,8 @@ private:
   // y: index of the lowest point in the lowest contour
   IntPoint m_lowest;
   PolyNode m_polyNodes;
+  // Cleans up the offset polygons, kept to reuse its memory by the next Execute() of a reused ClipperOffset object.
+  Clipper m_clipper;
 
   void FixOrientations();
   void DoOffset(double delta);
@@ -311,17 +311,20 @@ namespace detail {
 	// code from journals of graphics tools (JGT)
 	// http://www.acm.org/jgt/
 	// by Tomas Moller, May 2000
+	// The intersection is calculated with the accuracy of the ray and of the vertices if they are the same, so that
+	// a float ray query of a float AABB tree does not convert every visited triangle to double.
 	template<typename V, typename W>
-	std::enable_if_t<std::is_same<typename V::Scalar, double>::value&& std::is_same<typename W::Scalar, double>::value, bool>
+	std::enable_if_t<std::is_same<typename V::Scalar, typename W::Scalar>::value, bool>
 	intersect_triangle(const V &orig, const V &dir, const W &vert0, const W &vert1, const W &vert2, double &t, double &u, double &v, double eps)
 	{
+	   using Scalar = typename V::Scalar;
 	   // find vectors for two edges sharing vert0
 	   const V      edge1 = vert1 - vert0;
 	   const V      edge2 = vert2 - vert0;
 	   // begin calculating determinant - also used to calculate U parameter
 	   const V      pvec  = dir.cross(edge2);
 	   // if determinant is near zero, ray lies in plane of triangle
-	   const double det   = edge1.dot(pvec);
+	   const Scalar det   = edge1.dot(pvec);
 	   V      	 	qvec;
 
 	   if (det > eps) {
@@ -354,7 +357,7 @@ namespace detail {
 	     	// ray is parallel to the plane of the triangle
 		   	return false;
 
-	   double inv_det = 1.0 / det;
+	   Scalar inv_det = Scalar(1.) / det;
 	   // calculate t, ray intersects triangle
 	   t = edge2.dot(qvec) * inv_det;
 	   u *= inv_det;
@@ -362,22 +365,18 @@ namespace detail {
 	   return true;
 	}
 
+	// Mixed accuracy of the ray and of the vertices, the intersection is calculated in double.
+	// The casts are evaluated into vectors, intersect_triangle() above does not accept Eigen expressions.
 	template<typename V, typename W>
     std::enable_if_t<std::is_same<typename V::Scalar, double>::value && !std::is_same<typename W::Scalar, double>::value, bool>
 	intersect_triangle(const V &origin, const V &dir, const W &v0, const W &v1, const W &v2, double &t, double &u, double &v, double eps) {
-        return intersect_triangle(origin, dir, v0.template cast<double>(), v1.template cast<double>(), v2.template cast<double>(), t, u, v, eps);
+        return intersect_triangle(origin, dir, V(v0.template cast<double>()), V(v1.template cast<double>()), V(v2.template cast<double>()), t, u, v, eps);
 	}
 
 	template<typename V, typename W>
     std::enable_if_t<! std::is_same<typename V::Scalar, double>::value && std::is_same<typename W::Scalar, double>::value, bool>
 	intersect_triangle(const V &origin, const V &dir, const W &v0, const W &v1, const W &v2, double &t, double &u, double &v, double eps) {
-        return intersect_triangle(origin.template cast<double>(), dir.template cast<double>(), v0, v1, v2, t, u, v, eps);
-	}
-
-	template<typename V, typename W>
-    std::enable_if_t<! std::is_same<typename V::Scalar, double>::value && ! std::is_same<typename W::Scalar, double>::value, bool>
-	intersect_triangle(const V &origin, const V &dir, const W &v0, const W &v1, const W &v2, double &t, double &u, double &v, double eps) {
-	    return intersect_triangle(origin.template cast<double>(), dir.template cast<double>(), v0.template cast<double>(), v1.template cast<double>(), v2.template cast<double>(), t, u, v, eps);
+        return intersect_triangle(W(origin.template cast<double>()), W(dir.template cast<double>()), v0, v1, v2, t, u, v, eps);
 	}
 
 	template<typename Tree>
@@ -373,7 +373,8 @@ bool SkeletalTrapezoidation::computePointCellRange(const VD::cell_type &cell, Po
 SkeletalTrapezoidation::SkeletalTrapezoidation(const Polygons& polys, const BeadingStrategy& beading_strategy,
                                                double transitioning_angle, coord_t discretization_step_size,
                                                coord_t transition_filter_dist, coord_t allowed_filter_deviation,
-                                               coord_t beading_propagation_transition_dist
+                                               coord_t beading_propagation_transition_dist,
+                                               Geometry::VoronoiDiagramCache *voronoi_cache
     ): transitioning_angle(transitioning_angle),
     discretization_step_size(discretization_step_size),
     transition_filter_dist(transition_filter_dist),
@@ -381,10 +382,10 @@ SkeletalTrapezoidation::SkeletalTrapezoidation(const Polygons& polys, const Bead
     beading_propagation_transition_dist(beading_propagation_transition_dist),
     beading_strategy(beading_strategy)
 {
-    constructFromPolygons(polys);
+    constructFromPolygons(polys, voronoi_cache);
 }
 
-void SkeletalTrapezoidation::constructFromPolygons(const Polygons& polys)
+void SkeletalTrapezoidation::constructFromPolygons(const Polygons& polys, Geometry::VoronoiDiagramCache *voronoi_cache)
 {
 #ifdef ARACHNE_DEBUG
     this->outline = polys;
@@ -415,8 +416,16 @@ void SkeletalTrapezoidation::constructFromPolygons(const Polygons& polys)
     }
 #endif
 
-    VD voronoi_diagram;
-    voronoi_diagram.construct_voronoi(segments.cbegin(), segments.cend());
+    // The Voronoi diagram of the segments of polys, shared through the cache with the other layers having the same outline.
+    std::shared_ptr<const VD> voronoi_diagram_ptr;
+    if (voronoi_cache) {
+        voronoi_diagram_ptr = voronoi_cache->get(polys);
+    } else {
+        auto vd = std::make_shared<VD>();
+        vd->construct_voronoi(segments.cbegin(), segments.cend());
+        voronoi_diagram_ptr = std::move(vd);
+    }
+    const VD &voronoi_diagram = *voronoi_diagram_ptr;
 
 #ifdef ARACHNE_DEBUG_VORONOI
     {
@@ -110,7 +110,8 @@ public:
     , coord_t discretization_step_size
     , coord_t transition_filter_dist
     , coord_t allowed_filter_deviation
-    , coord_t beading_propagation_transition_dist);
+    , coord_t beading_propagation_transition_dist
+    , Geometry::VoronoiDiagramCache *voronoi_cache = nullptr);
 
     /*!
      * A skeletal graph through the polygons that we need to fill with beads.
@@ -163,7 +164,7 @@ protected:
      * Another complication arises because the VD uses floating logic, which can result in zero-length segments after rounding to integers.
      * We therefore collapse edges and their whole cells afterwards.
      */
-    void constructFromPolygons(const Polygons& polys);
+    void constructFromPolygons(const Polygons& polys, Geometry::VoronoiDiagramCache *voronoi_cache);
 
     /*!
      * mapping each voronoi VD edge to the corresponding halfedge HE edge
@@ -537,7 +537,8 @@ const std::vector<VariableWidthLines> &WallToolPaths::generate()
         discretization_step_size,
         transition_filter_dist,
         allowed_filter_deviation,
-        wall_transition_length
+        wall_transition_length,
+        m_params.voronoi_cache
     );
     wall_maker.generateToolpaths(toolpaths);
 
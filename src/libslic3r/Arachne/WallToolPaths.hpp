@@ -12,6 +12,8 @@
 #include "../Polygon.hpp"
 #include "../PrintConfig.hpp"
 
+namespace Slic3r::Geometry { class VoronoiDiagramCache; }
+
 namespace Slic3r::Arachne
 {
 
@@ -31,6 +33,8 @@ public:
     float   wall_transition_filter_deviation;
     int     wall_distribution_count;
     bool    is_top_or_bottom_layer;
+    // Optional cache of the Voronoi diagrams of the outlines, shared with the other layers and consumers.
+    Geometry::VoronoiDiagramCache *voronoi_cache = nullptr;
 };
 
 WallToolPathsParams make_paths_params(const int layer_id, const PrintObjectConfig &print_object_config, const PrintConfig &print_config);
@@ -0,0 +1,125 @@
+#ifndef UTILS_ARENA_ALLOCATOR_H
+#define UTILS_ARENA_ALLOCATOR_H
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <vector>
+
+namespace Slic3r::Arachne
+{
+/*!
+ * Memory of a short lived, node based container such as the std::list of the half-edge graph.
+ *
+ * The memory is requested from the heap in large blocks and the single objects are cut from them,
+ * so that the objects allocated one after the other lie next to each other in memory. The released objects
+ * are kept for reuse by objects of the same size, the blocks are only returned to the heap with the arena.
+ *
+ * Not thread safe, an arena is owned by a single container (or a single group of containers) used by a single thread.
+ */
+class Arena
+{
+public:
+    explicit Arena(size_t block_size = 64 * 1024) : m_block_size(block_size) { m_free_lists.reserve(MaxFreeLists); }
+    Arena(const Arena &) = delete;
+    Arena &operator=(const Arena &) = delete;
+
+    void *allocate(size_t size, size_t alignment)
+    {
+        ++ m_num_allocations;
+        for (FreeList &free_list : m_free_lists)
+            if (free_list.size == size && free_list.head != nullptr) {
+                FreeObject *out = free_list.head;
+                free_list.head  = out->next;
+                return out;
+            }
+        size = std::max(size, sizeof(FreeObject));
+        void *out = std::align(alignment, size, m_free_begin, m_free_size);
+        if (out == nullptr) {
+            // Allocations larger than a block get a block of their own.
+            m_free_size = std::max(m_block_size, size + alignment);
+            m_blocks.emplace_back(new char[m_free_size]);
+            m_free_begin = m_blocks.back().get();
+            out          = std::align(alignment, size, m_free_begin, m_free_size);
+            assert(out != nullptr);
+        }
+        m_free_begin = static_cast<char*>(m_free_begin) + size;
+        m_free_size -= size;
+        return out;
+    }
+
+    void deallocate(void *p, size_t size) noexcept
+    {
+        if (size < sizeof(FreeObject))
+            return;
+        auto it = std::find_if(m_free_lists.begin(), m_free_lists.end(), [size](const FreeList &l) { return l.size == size; });
+        if (it == m_free_lists.end()) {
+            if (m_free_lists.size() == m_free_lists.capacity())
+                // Growing the free lists could throw. The object is not reused, its memory is released with the arena.
+                return;
+            m_free_lists.push_back({ size, nullptr });
+            it = std::prev(m_free_lists.end());
+        }
+        it->head = new (p) FreeObject{ it->head };
+    }
+
+    // Number of objects allocated from the arena.
+    size_t num_allocations() const { return m_num_allocations; }
+    // Number of blocks allocated from the heap.
+    size_t num_blocks() const { return m_blocks.size(); }
+
+private:
+    struct FreeObject
+    {
+        FreeObject *next;
+    };
+    struct FreeList
+    {
+        size_t      size;
+        FreeObject *head;
+    };
+
+    size_t                              m_block_size;
+    std::vector<std::unique_ptr<char[]>> m_blocks;
+    void                               *m_free_begin { nullptr };
+    size_t                              m_free_size { 0 };
+    // A container allocates objects of one or two sizes only.
+    static constexpr const size_t       MaxFreeLists = 8;
+    // Reserved to MaxFreeLists, so that deallocate() never allocates.
+    std::vector<FreeList>               m_free_lists;
+    size_t                              m_num_allocations { 0 };
+};
+
+/*!
+ * Standard allocator handing out the memory of an Arena. The copies of the allocator, including the rebound ones, share the arena,
+ * which is released with the last of them.
+ */
+template<class T>
+class ArenaAllocator
+{
+public:
+    using value_type = T;
+
+    explicit ArenaAllocator(std::shared_ptr<Arena> arena) : m_arena(std::move(arena)) {}
+    template<class U>
+    ArenaAllocator(const ArenaAllocator<U> &other) noexcept : m_arena(other.arena()) {}
+
+    T   *allocate(size_t n) { return static_cast<T*>(m_arena->allocate(n * sizeof(T), alignof(T))); }
+    void deallocate(T *p, size_t n) noexcept { m_arena->deallocate(p, n * sizeof(T)); }
+
+    const std::shared_ptr<Arena> &arena() const { return m_arena; }
+
+    template<class U>
+    bool operator==(const ArenaAllocator<U> &rhs) const { return m_arena == rhs.arena(); }
+    template<class U>
+    bool operator!=(const ArenaAllocator<U> &rhs) const { return m_arena != rhs.arena(); }
+
+private:
+    std::shared_ptr<Arena> m_arena;
+};
+
+} // namespace Slic3r::Arachne
+#endif // UTILS_ARENA_ALLOCATOR_H
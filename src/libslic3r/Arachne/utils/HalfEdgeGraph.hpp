@@ -6,10 +6,12 @@
 
 
 #include <list>
+#include <memory>
 #include <cassert>
 
 
 
+#include "ArenaAllocator.hpp"
 #include "HalfEdge.hpp"
 #include "HalfEdgeNode.hpp"
 
@@ -21,8 +23,19 @@ class HalfEdgeGraph
 public:
     using edge_t = derived_edge_t;
     using node_t = derived_node_t;
-    std::list<edge_t> edges;
-    std::list<node_t> nodes;
+    // The edges and nodes are allocated from a common arena, which is released with the graph.
+    using Edges = std::list<edge_t, ArenaAllocator<edge_t>>;
+    using Nodes = std::list<node_t, ArenaAllocator<node_t>>;
+
+    HalfEdgeGraph() : HalfEdgeGraph(std::make_shared<Arena>()) {}
+
+    Edges edges;
+    Nodes nodes;
+
+    const Arena& arena() const { return *edges.get_allocator().arena(); }
+
+private:
+    explicit HalfEdgeGraph(const std::shared_ptr<Arena> &arena) : edges(ArenaAllocator<edge_t>(arena)), nodes(ArenaAllocator<node_t>(arena)) {}
 };
 
 } // namespace Slic3r::Arachne
@@ -320,8 +320,16 @@ BuildVolume::ObjectState BuildVolume::volume_state_bbox(const BoundingBoxf3& vol
 
 bool BuildVolume::all_paths_inside(const GCodeProcessorResult& paths, const BoundingBoxf3& paths_bbox, bool ignore_bottom) const
 {
-    auto move_valid = [](const GCodeProcessorResult::MoveVertex &move) {
-        return move.type == EMoveType::Extrude && move.extrusion_role != erCustom && move.width != 0.f && move.height != 0.f;
+    // Read only the columns of the moves needed for the test.
+    const GCodeProcessorResult::MoveVertices &moves = paths.moves;
+    auto move_valid = [&moves](size_t id) {
+        return moves.type(id) == EMoveType::Extrude && moves.extrusion_role(id) != erCustom && moves.width(id) != 0.f && moves.height(id) != 0.f;
+    };
+    auto all_valid_moves = [&moves, move_valid](auto &&inside) {
+        for (size_t id = 0; id < moves.size(); ++ id)
+            if (move_valid(id) && ! inside(moves.position(id)))
+                return false;
+        return true;
     };
     static constexpr const double epsilon = BedEpsilon;
 
@@ -341,19 +349,19 @@ bool BuildVolume::all_paths_inside(const GCodeProcessorResult& paths, const Boun
         const float r = unscaled<double>(m_circle.radius) + epsilon;
         const float r2 = sqr(r);
         return m_max_print_height == 0.0 ? 
-            std::all_of(paths.moves.begin(), paths.moves.end(), [move_valid, c, r2](const GCodeProcessorResult::MoveVertex &move)
-                { return ! move_valid(move) || (to_2d(move.position) - c).squaredNorm() <= r2; }) :
-            std::all_of(paths.moves.begin(), paths.moves.end(), [move_valid, c, r2, z = m_max_print_height + epsilon](const GCodeProcessorResult::MoveVertex& move)
-                { return ! move_valid(move) || ((to_2d(move.position) - c).squaredNorm() <= r2 && move.position.z() <= z); });
+            all_valid_moves([c, r2](const Vec3f &position)
+                { return (to_2d(position) - c).squaredNorm() <= r2; }) :
+            all_valid_moves([c, r2, z = m_max_print_height + epsilon](const Vec3f &position)
+                { return (to_2d(position) - c).squaredNorm() <= r2 && position.z() <= z; });
     }
     case BuildVolume_Type::Convex:
     //FIXME doing test on convex hull until we learn to do test on non-convex polygons efficiently.
     case BuildVolume_Type::Custom:
         return m_max_print_height == 0.0 ?
-            std::all_of(paths.moves.begin(), paths.moves.end(), [move_valid, this](const GCodeProcessorResult::MoveVertex &move) 
-                { return ! move_valid(move) || Geometry::inside_convex_polygon(m_top_bottom_convex_hull_decomposition_bed, to_2d(move.position).cast<double>()); }) :
-            std::all_of(paths.moves.begin(), paths.moves.end(), [move_valid, this, z = m_max_print_height + epsilon](const GCodeProcessorResult::MoveVertex &move)
-                { return ! move_valid(move) || (Geometry::inside_convex_polygon(m_top_bottom_convex_hull_decomposition_bed, to_2d(move.position).cast<double>()) && move.position.z() <= z); });
+            all_valid_moves([this](const Vec3f &position)
+                { return Geometry::inside_convex_polygon(m_top_bottom_convex_hull_decomposition_bed, to_2d(position).cast<double>()); }) :
+            all_valid_moves([this, z = m_max_print_height + epsilon](const Vec3f &position)
+                { return Geometry::inside_convex_polygon(m_top_bottom_convex_hull_decomposition_bed, to_2d(position).cast<double>()) && position.z() <= z; });
     default:
         return true;
     }
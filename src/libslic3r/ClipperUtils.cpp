@@ -58,6 +58,63 @@ namespace ClipperUtils {
 Points EmptyPathsProvider::s_empty_points;
 Points SinglePathProvider::s_end;
 
+static void reset_engine(ClipperLib::Clipper &clipper)
+{
+    clipper.Clear();
+    clipper.ReverseSolution(false);
+    clipper.StrictlySimple(false);
+    clipper.PreserveCollinear(false);
+}
+
+static void reset_engine(ClipperLib::ClipperOffset &co)
+{
+    co.Clear();
+    co.MiterLimit         = ClipperLib::ClipperOffset::DefaultMiterLimit;
+    co.ArcTolerance       = ClipperLib::ClipperOffset::DefaultArcTolerance;
+    co.ShortestEdgeLength = ClipperLib::ClipperOffset::DefaultShortestEdgeLength;
+}
+
+template<class Engine>
+struct ThreadEngineSlot
+{
+    Engine engine;
+    bool   taken { false };
+};
+
+template<class Engine>
+static ThreadEngineSlot<Engine>& thread_engine_slot()
+{
+    static thread_local ThreadEngineSlot<Engine> slot;
+    return slot;
+}
+
+template<class Engine>
+ThreadLocalEngine<Engine>::ThreadLocalEngine()
+{
+    ThreadEngineSlot<Engine> &slot = thread_engine_slot<Engine>();
+    if (slot.taken) {
+        m_nested = std::make_unique<Engine>();
+        m_engine = m_nested.get();
+    } else {
+        slot.taken = true;
+        m_engine   = &slot.engine;
+        reset_engine(*m_engine);
+    }
+}
+
+template<class Engine>
+ThreadLocalEngine<Engine>::~ThreadLocalEngine()
+{
+    if (! m_nested) {
+        // Release the input paths now, the memory is kept by the engine for the next operation.
+        m_engine->Clear();
+        thread_engine_slot<Engine>().taken = false;
+    }
+}
+
+template class ThreadLocalEngine<ClipperLib::Clipper>;
+template class ThreadLocalEngine<ClipperLib::ClipperOffset>;
+
 // Clip source polygon to be used as a clipping polygon with a bouding box around the source (to be clipped) polygon.
 // Useful as an optimization for expensive ClipperLib operations, for example when clipping source polygons one by one
 // with a set of polygons covering the whole layer below.
@@ -264,23 +321,23 @@ bool has_duplicate_points(const ClipperLib::PolyTree &polytree)
 template<typename PathsProvider>
 static ClipperLib::Paths raw_offset(PathsProvider &&paths, float offset, ClipperLib::JoinType joinType, double miterLimit, ClipperLib::EndType endType = ClipperLib::etClosedPolygon)
 {
-    ClipperLib::ClipperOffset co;
+    ClipperUtils::ThreadLocalClipperOffset co;
     ClipperLib::Paths out;
     out.reserve(paths.size());
     ClipperLib::Paths out_this;
     if (joinType == jtRound)
-        co.ArcTolerance = miterLimit;
+        co->ArcTolerance = miterLimit;
     else
-        co.MiterLimit = miterLimit;
-    co.ShortestEdgeLength = std::abs(offset * ClipperOffsetShortestEdgeFactor);
+        co->MiterLimit = miterLimit;
+    co->ShortestEdgeLength = std::abs(offset * ClipperOffsetShortestEdgeFactor);
     for (const ClipperLib::Path &path : paths) {
-        co.Clear();
+        co->Clear();
         // Execute reorients the contours so that the outer most contour has a positive area. Thus the output
         // contours will be CCW oriented even though the input paths are CW oriented.
         // Offset is applied after contour reorientation, thus the signum of the offset value is reversed.
-        co.AddPath(path, joinType, endType);
+        co->AddPath(path, joinType, endType);
         bool ccw = endType == ClipperLib::etClosedPolygon ? ClipperLib::Orientation(path) : true;
-        co.Execute(out_this, ccw ? offset : - offset);
+        co->Execute(out_this, ccw ? offset : - offset);
         if (! ccw) {
             // Reverse the resulting contours.
             for (ClipperLib::Path &path : out_this)
@@ -305,11 +362,11 @@ TResult clipper_do(
     TClip &&                       clip,
     const ClipperLib::PolyFillType fillType)
 {
-    ClipperLib::Clipper clipper;
-    clipper.AddPaths(std::forward<TSubj>(subject), ClipperLib::ptSubject, true);
-    clipper.AddPaths(std::forward<TClip>(clip),    ClipperLib::ptClip,    true);
+    ClipperUtils::ThreadLocalClipper clipper;
+    clipper->AddPaths(std::forward<TSubj>(subject), ClipperLib::ptSubject, true);
+    clipper->AddPaths(std::forward<TClip>(clip),    ClipperLib::ptClip,    true);
     TResult retval;
-    clipper.Execute(clipType, retval, fillType, fillType);
+    clipper->Execute(clipType, retval, fillType, fillType);
     return retval;
 }
 
@@ -334,10 +391,10 @@ TResult clipper_union(
     // fillType pftNonZero and pftPositive "should" produce the same result for "normalized with implicit union" set of polygons
     const ClipperLib::PolyFillType fillType = ClipperLib::pftNonZero)
 {
-    ClipperLib::Clipper clipper;
-    clipper.AddPaths(std::forward<TSubj>(subject), ClipperLib::ptSubject, true);
+    ClipperUtils::ThreadLocalClipper clipper;
+    clipper->AddPaths(std::forward<TSubj>(subject), ClipperLib::ptSubject, true);
     TResult retval;
-    clipper.Execute(ClipperLib::ctUnion, retval, fillType, fillType);
+    clipper->Execute(ClipperLib::ctUnion, retval, fillType, fillType);
     return retval;
 }
 
@@ -377,12 +434,12 @@ static TResult shrink_paths(PathsProvider &&paths, float offset, ClipperLib::Joi
     //assert(offset > 0);
     TResult out;
     if (auto raw = raw_offset(std::forward<PathsProvider>(paths), - offset, joinType, miterLimit); ! raw.empty()) {
-        ClipperLib::Clipper clipper;
-        clipper.AddPaths(raw, ClipperLib::ptSubject, true);
-        ClipperLib::IntRect r = clipper.GetBounds();
-        clipper.AddPath({ { r.left - 10, r.bottom + 10 }, { r.right + 10, r.bottom + 10 }, { r.right + 10, r.top - 10 }, { r.left - 10, r.top - 10 } }, ClipperLib::ptSubject, true);
-        clipper.ReverseSolution(true);
-        clipper.Execute(ClipperLib::ctUnion, out, ClipperLib::pftNegative, ClipperLib::pftNegative);
+        ClipperUtils::ThreadLocalClipper clipper;
+        clipper->AddPaths(raw, ClipperLib::ptSubject, true);
+        ClipperLib::IntRect r = clipper->GetBounds();
+        clipper->AddPath({ { r.left - 10, r.bottom + 10 }, { r.right + 10, r.bottom + 10 }, { r.right + 10, r.top - 10 }, { r.left - 10, r.top - 10 } }, ClipperLib::ptSubject, true);
+        clipper->ReverseSolution(true);
+        clipper->Execute(ClipperLib::ctUnion, out, ClipperLib::pftNegative, ClipperLib::pftNegative);
         remove_outermost_polygon(out);
     }
     return out;
@@ -425,14 +482,14 @@ static int offset_expolygon_inner(const Slic3r::ExPolygon &expoly, const float d
     // 1) Offset the outer contour.
     ClipperLib::Paths contours;
     {
-        ClipperLib::ClipperOffset co;
+        ClipperUtils::ThreadLocalClipperOffset co;
         if (joinType == jtRound)
-            co.ArcTolerance = miterLimit;
+            co->ArcTolerance = miterLimit;
         else
-            co.MiterLimit = miterLimit;
-        co.ShortestEdgeLength = std::abs(delta * ClipperOffsetShortestEdgeFactor);
-        co.AddPath(expoly.contour.points, joinType, ClipperLib::etClosedPolygon);
-        co.Execute(contours, delta);
+            co->MiterLimit = miterLimit;
+        co->ShortestEdgeLength = std::abs(delta * ClipperOffsetShortestEdgeFactor);
+        co->AddPath(expoly.contour.points, joinType, ClipperLib::etClosedPolygon);
+        co->Execute(contours, delta);
     }
     if (contours.empty())
         // No need to try to offset the holes.
@@ -445,19 +502,20 @@ static int offset_expolygon_inner(const Slic3r::ExPolygon &expoly, const float d
         // 2) Offset the holes one by one, collect the offsetted holes.
         ClipperLib::Paths holes;
         {
+            ClipperUtils::ThreadLocalClipperOffset co;
+            if (joinType == jtRound)
+                co->ArcTolerance = miterLimit;
+            else
+                co->MiterLimit = miterLimit;
+            co->ShortestEdgeLength = std::abs(delta * ClipperOffsetShortestEdgeFactor);
+            ClipperLib::Paths out2;
             for (const Polygon &hole : expoly.holes) {
-                ClipperLib::ClipperOffset co;
-                if (joinType == jtRound)
-                    co.ArcTolerance = miterLimit;
-                else
-                    co.MiterLimit = miterLimit;
-                co.ShortestEdgeLength = std::abs(delta * ClipperOffsetShortestEdgeFactor);
-                co.AddPath(hole.points, joinType, ClipperLib::etClosedPolygon);
-                ClipperLib::Paths out2;
+                co->Clear();
+                co->AddPath(hole.points, joinType, ClipperLib::etClosedPolygon);
                 // Execute reorients the contours so that the outer most contour has a positive area. Thus the output
                 // contours will be CCW oriented even though the input paths are CW oriented.
                 // Offset is applied after contour reorientation, thus the signum of the offset value is reversed.
-                co.Execute(out2, - delta);
+                co->Execute(out2, - delta);
                 append(holes, std::move(out2));
             }
         }
@@ -816,11 +874,11 @@ Slic3r::ExPolygons xor_ex(const Slic3r::ExPolygons &subject, const Slic3r::ExPol
 template<typename PathsProvider1, typename PathsProvider2>
 Polylines _clipper_pl_open(ClipperLib::ClipType clipType, PathsProvider1 &&subject, PathsProvider2 &&clip)
 {
-    ClipperLib::Clipper clipper;
-    clipper.AddPaths(std::forward<PathsProvider1>(subject), ClipperLib::ptSubject, false);
-    clipper.AddPaths(std::forward<PathsProvider2>(clip), ClipperLib::ptClip, true);
+    ClipperUtils::ThreadLocalClipper clipper;
+    clipper->AddPaths(std::forward<PathsProvider1>(subject), ClipperLib::ptSubject, false);
+    clipper->AddPaths(std::forward<PathsProvider2>(clip), ClipperLib::ptClip, true);
     ClipperLib::PolyTree retval;
-    clipper.Execute(clipType, retval, ClipperLib::pftNonZero, ClipperLib::pftNonZero);
+    clipper->Execute(clipType, retval, ClipperLib::pftNonZero, ClipperLib::pftNonZero);
     return PolyTreeToPolylines(std::move(retval));
 }
 
@@ -321,6 +321,29 @@ namespace ClipperUtils {
     [[nodiscard]] Polygons clip_clipper_polygons_with_subject_bbox(const ExPolygon &src, const BoundingBox &bbox, const bool get_entire_polygons = false);
     [[nodiscard]] Polygons clip_clipper_polygons_with_subject_bbox(const ExPolygons &src, const BoundingBox &bbox, const bool get_entire_polygons = false);
 
+    // ClipperLib::Clipper or ClipperLib::ClipperOffset engine of the current thread, reused by the consecutive operations of the thread,
+    // for example by the per layer operations of a TBB worker. The engine keeps its working memory between the operations
+    // instead of allocating and releasing it with each one. The engine is cleared and its options are reset to the defaults
+    // when taken. An operation nested into another one running on the same thread gets a new engine.
+    template<class Engine>
+    class ThreadLocalEngine
+    {
+    public:
+        ThreadLocalEngine();
+        ~ThreadLocalEngine();
+        ThreadLocalEngine(const ThreadLocalEngine &) = delete;
+        ThreadLocalEngine& operator=(const ThreadLocalEngine &) = delete;
+
+        Engine& operator*()  { return *m_engine; }
+        Engine* operator->() { return m_engine; }
+
+    private:
+        Engine                 *m_engine;
+        // Engine of a nested operation.
+        std::unique_ptr<Engine> m_nested;
+    };
+    using ThreadLocalClipper       = ThreadLocalEngine<ClipperLib::Clipper>;
+    using ThreadLocalClipperOffset = ThreadLocalEngine<ClipperLib::ClipperOffset>;
     }
 
 // Perform union of input polygons using the non-zero rule, convert to ExPolygons.
@@ -242,10 +242,10 @@ void ExPolygon::simplify(double tolerance, ExPolygons* expolygons) const
     append(*expolygons, this->simplify(tolerance));
 }
 
-void ExPolygon::medial_axis(double min_width, double max_width, ThickPolylines* polylines) const
+void ExPolygon::medial_axis(double min_width, double max_width, ThickPolylines* polylines, Geometry::VoronoiDiagramCache *voronoi_cache) const
 {
     // init helper object
-    Slic3r::Geometry::MedialAxis ma(min_width, max_width, *this);
+    Slic3r::Geometry::MedialAxis ma(min_width, max_width, *this, voronoi_cache);
     
     // compute the Voronoi diagram and extract medial axis polylines
     ThickPolylines pp;
@@ -352,10 +352,10 @@ void ExPolygon::medial_axis(double min_width, double max_width, ThickPolylines*
     polylines->insert(polylines->end(), pp.begin(), pp.end());
 }
 
-void ExPolygon::medial_axis(double min_width, double max_width, Polylines* polylines) const
+void ExPolygon::medial_axis(double min_width, double max_width, Polylines* polylines, Geometry::VoronoiDiagramCache *voronoi_cache) const
 {
     ThickPolylines tp;
-    this->medial_axis(min_width, max_width, &tp);
+    this->medial_axis(min_width, max_width, &tp, voronoi_cache);
     polylines->reserve(polylines->size() + tp.size());
     for (auto &pl : tp)
         polylines->emplace_back(pl.points);
@@ -12,6 +12,8 @@ namespace Slic3r {
 class ExPolygon;
 using ExPolygons = std::vector<ExPolygon>;
 
+namespace Geometry { class VoronoiDiagramCache; }
+
 class ExPolygon
 {
 public:
@@ -70,8 +72,9 @@ public:
     Polygons simplify_p(double tolerance) const;
     ExPolygons simplify(double tolerance) const;
     void simplify(double tolerance, ExPolygons* expolygons) const;
-    void medial_axis(double min_width, double max_width, ThickPolylines* polylines) const;
-    void medial_axis(double min_width, double max_width, Polylines* polylines) const;
+    // If voronoi_cache is set, the Voronoi diagram of this ExPolygon may be shared with the other users of the cache.
+    void medial_axis(double min_width, double max_width, ThickPolylines* polylines, Geometry::VoronoiDiagramCache *voronoi_cache = nullptr) const;
+    void medial_axis(double min_width, double max_width, Polylines* polylines, Geometry::VoronoiDiagramCache *voronoi_cache = nullptr) const;
     Polylines medial_axis(double min_width, double max_width) const 
         { Polylines out; this->medial_axis(min_width, max_width, &out); return out; }
     Lines lines() const;
@@ -14,11 +14,13 @@
 #include <cstdlib>
 #include <cmath>
 #include <algorithm>
+#include <chrono>
+#include <mutex>
 #include <numeric>
+#include <unordered_map>
 
-// Boost pool: Don't use mutexes to synchronize memory allocation.
-#define BOOST_POOL_NO_MT
-#include <boost/pool/object_pool.hpp>
+#include <boost/functional/hash.hpp>
+#include <boost/log/trivial.hpp>
 
 #include <boost/geometry.hpp>
 #include <boost/geometry/geometries/point.hpp>
@@ -254,11 +256,31 @@ struct CubeProperties
     double line_xy_distance;// Defines maximal distance from a center of a cube on X and Y axis on which lines will be created
 };
 
+// Allocates the Cubes in blocks, which are only released all together, perfect for building up our octree.
+class CubeArena
+{
+public:
+    Cube* construct(const Vec3d &center) {
+        if (m_blocks.empty() || m_blocks.back().size() == BlockSize) {
+            m_blocks.emplace_back();
+            // The block never grows beyond its capacity, thus the pointers to its Cubes stay valid.
+            m_blocks.back().reserve(BlockSize);
+        }
+        return &m_blocks.back().emplace_back(center);
+    }
+
+    size_t size() const { return m_blocks.empty() ? 0 : (m_blocks.size() - 1) * BlockSize + m_blocks.back().size(); }
+    size_t memory_used() const { return m_blocks.size() * BlockSize * sizeof(Cube); }
+
+private:
+    static constexpr const size_t BlockSize = 4096;
+    std::vector<std::vector<Cube>> m_blocks;
+};
+
 struct Octree
 {
-    // Octree will allocate its Cubes from the pool. The pool only supports deletion of the complete pool,
-    // perfect for building up our octree.
-    boost::object_pool<Cube>    pool;
+    // Octree will allocate its Cubes from the arena. The arena only supports deletion of all the cubes at once.
+    CubeArena                   pool;
     Cube*                       root_cube { nullptr };
     Vec3d                       origin;
     std::vector<CubeProperties> cubes_properties;
@@ -1462,6 +1484,51 @@ static void transform_center(Cube *current_cube, const Eigen::Matrix3d &rot)
             transform_center(child, rot);
 }
 
+// Inputs of build_octree(), stored with the octree built from them. A cached octree is only reused if all its inputs
+// compare equal, the hash only selects the candidates.
+struct OctreeCacheEntry
+{
+    indexed_triangle_set  triangle_mesh;
+    std::vector<Vec3d>    overhang_triangles;
+    coordf_t              line_spacing;
+    bool                  support_overhangs_only;
+    std::weak_ptr<Octree> octree;
+
+    bool matches(const indexed_triangle_set &triangle_mesh, const std::vector<Vec3d> &overhang_triangles, coordf_t line_spacing, bool support_overhangs_only) const {
+        return this->line_spacing == line_spacing && this->support_overhangs_only == support_overhangs_only &&
+               this->triangle_mesh.vertices == triangle_mesh.vertices && this->triangle_mesh.indices == triangle_mesh.indices &&
+               this->overhang_triangles == overhang_triangles;
+    }
+};
+
+static size_t octree_inputs_hash(const indexed_triangle_set &triangle_mesh, const std::vector<Vec3d> &overhang_triangles, coordf_t line_spacing, bool support_overhangs_only)
+{
+    size_t seed = 0;
+    for (const stl_vertex &v : triangle_mesh.vertices)
+        for (int i = 0; i < 3; ++ i)
+            boost::hash_combine(seed, v[i]);
+    for (const stl_triangle_vertex_indices &tri : triangle_mesh.indices)
+        for (int i = 0; i < 3; ++ i)
+            boost::hash_combine(seed, tri[i]);
+    for (const Vec3d &p : overhang_triangles)
+        for (int i = 0; i < 3; ++ i)
+            boost::hash_combine(seed, p[i]);
+    boost::hash_combine(seed, line_spacing);
+    boost::hash_combine(seed, support_overhangs_only);
+    return seed;
+}
+
+// Process wide store of the octrees built by build_octree(), indexed by the hash of their inputs. The store does not own
+// the octrees, an octree is released as soon as the last PrintObject using it releases it.
+static std::mutex                                                s_octree_cache_mutex;
+static std::unordered_multimap<size_t, OctreeCacheEntry>         s_octree_cache;
+
+static OctreePtr build_octree_uncached(
+    const indexed_triangle_set  &triangle_mesh,
+    const std::vector<Vec3d>    &overhang_triangles,
+    coordf_t                     line_spacing,
+    bool                         support_overhangs_only);
+
 OctreePtr build_octree(
     // Mesh is rotated to the coordinate system of the octree.
     const indexed_triangle_set  &triangle_mesh,
@@ -1474,10 +1541,45 @@ OctreePtr build_octree(
     assert(line_spacing > 0);
     assert(! std::isnan(line_spacing));
 
+    const size_t hash = octree_inputs_hash(triangle_mesh, overhang_triangles, line_spacing, support_overhangs_only);
+    {
+        std::lock_guard<std::mutex> lock(s_octree_cache_mutex);
+        for (auto [it, it_end] = s_octree_cache.equal_range(hash); it != it_end; ++ it)
+            if (it->second.matches(triangle_mesh, overhang_triangles, line_spacing, support_overhangs_only))
+                if (OctreePtr octree = it->second.octree.lock()) {
+                    BOOST_LOG_TRIVIAL(info) << "Adaptive infill octree reused, " << octree->pool.size() << " cubes";
+                    return octree;
+                }
+    }
+
+    // Two PrintObjects may build the same octree at the same time, then the one built later is stored.
+    auto      start_time = std::chrono::steady_clock::now();
+    OctreePtr octree     = build_octree_uncached(triangle_mesh, overhang_triangles, line_spacing, support_overhangs_only);
+    BOOST_LOG_TRIVIAL(info) << "Adaptive infill octree built in "
+        << std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count() << " s, "
+        << octree->pool.size() << " cubes, " << (octree->pool.memory_used() >> 10) << " kB";
+
+    std::lock_guard<std::mutex> lock(s_octree_cache_mutex);
+    // Drop the entries of the released octrees, including the one with the same inputs built by another PrintObject in the meantime.
+    for (auto it = s_octree_cache.begin(); it != s_octree_cache.end();)
+        if (it->second.octree.expired() || (it->first == hash && it->second.matches(triangle_mesh, overhang_triangles, line_spacing, support_overhangs_only)))
+            it = s_octree_cache.erase(it);
+        else
+            ++ it;
+    s_octree_cache.emplace(hash, OctreeCacheEntry{ triangle_mesh, overhang_triangles, line_spacing, support_overhangs_only, octree });
+    return octree;
+}
+
+static OctreePtr build_octree_uncached(
+    const indexed_triangle_set  &triangle_mesh,
+    const std::vector<Vec3d>    &overhang_triangles,
+    coordf_t                     line_spacing,
+    bool                         support_overhangs_only)
+{
     BoundingBox3Base<Vec3f>     bbox(triangle_mesh.vertices);
     Vec3d                       cube_center      = bbox.center().cast<double>();
     std::vector<CubeProperties> cubes_properties = make_cubes_properties(double(bbox.size().maxCoeff()), line_spacing);
-    auto                        octree           = OctreePtr(new Octree(cube_center, cubes_properties));
+    auto                        octree           = OctreePtr(new Octree(cube_center, cubes_properties), OctreeDeleter());
 
     if (cubes_properties.size() > 1) {
         Octree *octree_ptr = octree.get();
@@ -25,7 +25,8 @@ namespace FillAdaptive
 struct Octree;
 // To keep the definition of Octree opaque, we have to define a custom deleter.
 struct OctreeDeleter { void operator()(Octree *p); };
-using  OctreePtr = std::unique_ptr<Octree, OctreeDeleter>;
+// Octrees are shared by the PrintObjects they were built for, see build_octree().
+using  OctreePtr = std::shared_ptr<Octree>;
 
 // Calculate line spacing for
 // 1) adaptive cubic infill
@@ -38,6 +39,8 @@ Eigen::Quaterniond              transform_to_world();
 // Inverse roation of the above.
 Eigen::Quaterniond              transform_to_octree();
 
+// Build an octree, or return the one already built for the same mesh, overhangs and line spacing by another PrintObject
+// or by the previous run of this PrintObject, if it is still referenced.
 FillAdaptive::OctreePtr         build_octree(
     // Mesh is rotated to the coordinate system of the octree.
     const indexed_triangle_set  &triangle_mesh,
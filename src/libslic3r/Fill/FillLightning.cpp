@@ -4,6 +4,8 @@
 #include "FillLightning.hpp"
 #include "Lightning/Generator.hpp"
 
+#include <boost/log/trivial.hpp>
+
 namespace Slic3r::FillLightning {
 
 void Filler::_fill_surface_single(
@@ -26,9 +28,16 @@ void GeneratorDeleter::operator()(Generator *p) {
     delete p;
 }
 
-GeneratorPtr build_generator(const PrintObject &print_object, const std::function<void()> &throw_on_cancel_callback)
+GeneratorPtr build_generator(const PrintObject &print_object, const std::function<void()> &throw_on_cancel_callback, GeneratorPtr previous)
 {
-    return GeneratorPtr(new Generator(print_object, throw_on_cancel_callback));
+    Generator::Inputs inputs(print_object);
+    if (previous && previous->inputs() == inputs) {
+        BOOST_LOG_TRIVIAL(debug) << "Lightning infill trees reused";
+        return previous;
+    }
+    // Release the previous trees before generating the new ones.
+    previous.reset();
+    return GeneratorPtr(new Generator(std::move(inputs), throw_on_cancel_callback));
 }
 
 } // namespace Slic3r::FillAdaptive
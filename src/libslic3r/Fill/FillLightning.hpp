@@ -14,7 +14,8 @@ class Generator;
 struct GeneratorDeleter { void operator()(Generator *p); };
 using  GeneratorPtr = std::unique_ptr<Generator, GeneratorDeleter>;
 
-GeneratorPtr build_generator(const PrintObject &print_object, const std::function<void()> &throw_on_cancel_callback);
+// Returns the previous generator if it was built from the same inputs (see Generator::Inputs) as the new one would be.
+GeneratorPtr build_generator(const PrintObject &print_object, const std::function<void()> &throw_on_cancel_callback, GeneratorPtr previous = GeneratorPtr());
 
 class Filler : public Slic3r::Fill
 {
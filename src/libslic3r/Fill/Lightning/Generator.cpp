@@ -2,6 +2,7 @@
 //CuraEngine is released under the terms of the AGPLv3 or higher.
 
 #include "Generator.hpp"
+#include "DistanceField.hpp"
 #include "TreeNode.hpp"
 
 #include "../../ClipperUtils.hpp"
@@ -10,6 +11,11 @@
 
 #include "ExPolygon.hpp"
 
+#include <boost/functional/hash.hpp>
+
+#include <tbb/parallel_for.h>
+#include <tbb/task_group.h>
+
 /* Possible future tasks/optimizations,etc.:
  * - Improve connecting heuristic to favor connecting to shorter trees
  * - Change which node of a tree is the root when that would be better in reconnectRoots.
@@ -63,109 +69,143 @@ Slic3r::SVG draw_two_overhangs_to_svg(size_t ts_layer, const ExPolygons& overhan
 
 namespace Slic3r::FillLightning {
 
-Generator::Generator(const PrintObject &print_object, const std::function<void()> &throw_on_cancel_callback)
+// Number of layers, which distance fields are constructed in parallel ahead of the layers the trees are generated for.
+static constexpr const int LIGHTNING_BAND_SIZE = 16;
+
+// The angles are not configurable, they are part of the inputs nevertheless so that the inputs describe the generated trees completely.
+static constexpr const double LIGHTNING_INFILL_OVERHANG_ANGLE      = M_PI / 4; // 45 degrees
+static constexpr const double LIGHTNING_INFILL_PRUNE_ANGLE         = M_PI / 4; // 45 degrees
+static constexpr const double LIGHTNING_INFILL_STRAIGHTENING_ANGLE = M_PI / 4; // 45 degrees
+
+static std::vector<Polygons> collect_infill_outlines(const PrintObject &print_object)
 {
-    const PrintConfig         &print_config         = print_object.print()->config();
-    const PrintObjectConfig   &object_config        = print_object.config();
-    const PrintRegionConfig   &region_config        = print_object.shared_regions()->all_regions.front()->config();
-    const std::vector<double> &nozzle_diameters     = print_config.nozzle_diameter.values;
-    double                     max_nozzle_diameter  = *std::max_element(nozzle_diameters.begin(), nozzle_diameters.end());
-//    const int                  infill_extruder      = region_config.infill_extruder.value;
-    const double               default_infill_extrusion_width = Flow::auto_extrusion_width(FlowRole::frInfill, float(max_nozzle_diameter));
-    // Note: There's not going to be a layer below the first one, so the 'initial layer height' doesn't have to be taken into account.
-    const double               layer_thickness      = scaled<double>(object_config.layer_height.value);
+    std::vector<Polygons> infill_outlines(print_object.layers().size(), Polygons());
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, print_object.layers().size()), [&print_object, &infill_outlines](const tbb::blocked_range<size_t> &range) {
+        for (size_t layer_id = range.begin(); layer_id < range.end(); ++ layer_id)
+            for (const LayerRegion *layerm : print_object.get_layer(layer_id)->regions())
+                for (const Surface &surface : layerm->fill_surfaces.surfaces)
+                    if (surface.surface_type == stInternal || surface.surface_type == stInternalVoid)
+                        append(infill_outlines[layer_id], to_polygons(surface.expolygon));
+    });
+    return infill_outlines;
+}
 
-    m_infill_extrusion_width = scaled<float>(region_config.sparse_infill_line_width.get_abs_value(max_nozzle_diameter));
-    // Orca: fix lightning infill divide by zero when infill line width is set to 0.
-    // firstly attempt to set it to the default line width. If that is not provided either, set it to a sane default
-    // based on the nozzle diameter.
-    if (m_infill_extrusion_width < EPSILON)
-        m_infill_extrusion_width = scaled<float>(
-            object_config.line_width.get_abs_value(max_nozzle_diameter) < EPSILON ?
-            default_infill_extrusion_width :
-            object_config.line_width.get_abs_value(max_nozzle_diameter)
-        );
-    
-    m_supporting_radius = coord_t(m_infill_extrusion_width) * 100 / region_config.sparse_infill_density;
-
-    const double lightning_infill_overhang_angle      = M_PI / 4; // 45 degrees
-    const double lightning_infill_prune_angle         = M_PI / 4; // 45 degrees
-    const double lightning_infill_straightening_angle = M_PI / 4; // 45 degrees
-    m_wall_supporting_radius                          = coord_t(layer_thickness * std::tan(lightning_infill_overhang_angle));
-    m_prune_length                                    = coord_t(layer_thickness * std::tan(lightning_infill_prune_angle));
-    m_straightening_max_distance                      = coord_t(layer_thickness * std::tan(lightning_infill_straightening_angle));
-
-    generateInitialInternalOverhangs(print_object, throw_on_cancel_callback);
-    generateTrees(print_object, throw_on_cancel_callback);
+static void hash_polygons(size_t &seed, const std::vector<Polygons> &layers)
+{
+    boost::hash_combine(seed, layers.size());
+    for (const Polygons &polygons : layers) {
+        boost::hash_combine(seed, polygons.size());
+        for (const Polygon &polygon : polygons) {
+            boost::hash_combine(seed, polygon.points.size());
+            for (const Point &pt : polygon.points) {
+                boost::hash_combine(seed, pt.x());
+                boost::hash_combine(seed, pt.y());
+            }
+        }
+    }
+}
+
+Generator::Inputs::Inputs(const PrintObject &print_object) :
+    outlines(collect_infill_outlines(print_object))
+{
+    this->init(print_object);
+}
+
+Generator::Inputs::Inputs(const PrintObject &print_object, std::vector<Polygons> contours, std::vector<Polygons> overhangs, float density) :
+    support(true), density(density), outlines(std::move(contours)), overhangs(std::move(overhangs))
+{
+    this->init(print_object);
+}
+
+void Generator::Inputs::init(const PrintObject &print_object)
+{
+    const PrintObjectConfig   &object_config    = print_object.config();
+    const PrintRegionConfig   &region_config    = print_object.shared_regions()->all_regions.front()->config();
+    const std::vector<double> &nozzle_diameters = print_object.print()->config().nozzle_diameter.values;
+    max_nozzle_diameter      = *std::max_element(nozzle_diameters.begin(), nozzle_diameters.end());
+    layer_height             = object_config.layer_height.value;
+    line_width               = object_config.line_width.get_abs_value(max_nozzle_diameter);
+    sparse_infill_line_width = region_config.sparse_infill_line_width.get_abs_value(max_nozzle_diameter);
+    sparse_infill_density    = region_config.sparse_infill_density.value;
+    overhang_angle           = LIGHTNING_INFILL_OVERHANG_ANGLE;
+    prune_angle              = LIGHTNING_INFILL_PRUNE_ANGLE;
+    straightening_angle      = LIGHTNING_INFILL_STRAIGHTENING_ANGLE;
+
+    hash = 0;
+    boost::hash_combine(hash, support);
+    for (double value : { max_nozzle_diameter, layer_height, line_width, sparse_infill_line_width, sparse_infill_density,
+                          double(density), overhang_angle, prune_angle, straightening_angle })
+        boost::hash_combine(hash, value);
+    hash_polygons(hash, outlines);
+    hash_polygons(hash, overhangs);
 }
 
-Generator::Generator(PrintObject* m_object, std::vector<Polygons>& contours, std::vector<Polygons>& overhangs, const std::function<void()> &throw_on_cancel_callback, float density)
+bool Generator::Inputs::operator==(const Inputs &rhs) const
 {
-    const PrintConfig         &print_config         = m_object->print()->config();
-    const PrintObjectConfig   &object_config        = m_object->config();
-    const PrintRegionConfig   &region_config        = m_object->shared_regions()->all_regions.front()->config();
-    const std::vector<double> &nozzle_diameters     = print_config.nozzle_diameter.values;
-    double                     max_nozzle_diameter  = *std::max_element(nozzle_diameters.begin(), nozzle_diameters.end());
-//    const int                  infill_extruder      = region_config.infill_extruder.value;
-    const double               default_infill_extrusion_width = Flow::auto_extrusion_width(FlowRole::frInfill, float(max_nozzle_diameter));
+    return hash                     == rhs.hash &&
+           support                  == rhs.support &&
+           max_nozzle_diameter      == rhs.max_nozzle_diameter &&
+           layer_height             == rhs.layer_height &&
+           line_width               == rhs.line_width &&
+           sparse_infill_line_width == rhs.sparse_infill_line_width &&
+           sparse_infill_density    == rhs.sparse_infill_density &&
+           density                  == rhs.density &&
+           overhang_angle           == rhs.overhang_angle &&
+           prune_angle              == rhs.prune_angle &&
+           straightening_angle      == rhs.straightening_angle &&
+           outlines                 == rhs.outlines &&
+           overhangs                == rhs.overhangs;
+}
+
+Generator::Generator(const PrintObject &print_object, const std::function<void()> &throw_on_cancel_callback) :
+    Generator(Inputs(print_object), throw_on_cancel_callback)
+{}
+
+Generator::Generator(Inputs &&inputs, const std::function<void()> &throw_on_cancel_callback) :
+    m_inputs(std::move(inputs))
+{
+    const double default_infill_extrusion_width = Flow::auto_extrusion_width(FlowRole::frInfill, float(m_inputs.max_nozzle_diameter));
     // Note: There's not going to be a layer below the first one, so the 'initial layer height' doesn't have to be taken into account.
-    const double               layer_thickness      = scaled<double>(object_config.layer_height.value);
+    const double layer_thickness                = scaled<double>(m_inputs.layer_height);
 
-    m_infill_extrusion_width = scaled<float>(region_config.sparse_infill_line_width.get_abs_value(max_nozzle_diameter));
+    m_infill_extrusion_width = scaled<float>(m_inputs.sparse_infill_line_width);
     // Orca: fix lightning infill divide by zero when infill line width is set to 0.
     // firstly attempt to set it to the default line width. If that is not provided either, set it to a sane default
     // based on the nozzle diameter.
     if (m_infill_extrusion_width < EPSILON)
-        m_infill_extrusion_width = scaled<float>(
-            object_config.line_width.get_abs_value(max_nozzle_diameter) < EPSILON ?
-            default_infill_extrusion_width :
-            object_config.line_width.get_abs_value(max_nozzle_diameter)
-        );
-    //m_supporting_radius: against to the density of lightning, failures may happen if set to high density
-    //higher density lightning makes support harder, more time-consuming on computing and printing, but more reliable on supporting overhangs
-    //lower density lightning performs opposite
-    //TODO: decide whether enable density controller in advanced options or not
-    density = std::max(0.15f, density);
-    m_supporting_radius = coord_t(m_infill_extrusion_width) / density;
-
-    const double lightning_infill_overhang_angle = M_PI / 4; // 45 degrees
-    const double lightning_infill_prune_angle = M_PI / 4; // 45 degrees
-    const double lightning_infill_straightening_angle = M_PI / 4; // 45 degrees
-    m_wall_supporting_radius = layer_thickness * std::tan(lightning_infill_overhang_angle);
-    m_prune_length = layer_thickness * std::tan(lightning_infill_prune_angle);
-    m_straightening_max_distance = layer_thickness * std::tan(lightning_infill_straightening_angle);
-
-    m_overhang_per_layer = overhangs;
-
-    generateTreesforSupport(contours, throw_on_cancel_callback);
-
-    //for (size_t i = 0; i < overhangs.size(); i++)
-    //{
-    //    auto svg = draw_two_overhangs_to_svg(i, to_expolygons(contours[i]), to_expolygons(overhangs[i]));
-    //    for (auto& root : m_lightning_layers[i].tree_roots)
-    //        root->draw_tree(svg);
-    //}
+        m_infill_extrusion_width = scaled<float>(m_inputs.line_width < EPSILON ? default_infill_extrusion_width : m_inputs.line_width);
+
+    m_wall_supporting_radius     = coord_t(layer_thickness * std::tan(m_inputs.overhang_angle));
+    m_prune_length               = coord_t(layer_thickness * std::tan(m_inputs.prune_angle));
+    m_straightening_max_distance = coord_t(layer_thickness * std::tan(m_inputs.straightening_angle));
+
+    if (m_inputs.support) {
+        //m_supporting_radius: against to the density of lightning, failures may happen if set to high density
+        //higher density lightning makes support harder, more time-consuming on computing and printing, but more reliable on supporting overhangs
+        //lower density lightning performs opposite
+        //TODO: decide whether enable density controller in advanced options or not
+        m_supporting_radius  = coord_t(m_infill_extrusion_width) / std::max(0.15f, m_inputs.density);
+        m_overhang_per_layer = m_inputs.overhangs;
+    } else {
+        m_supporting_radius  = coord_t(m_infill_extrusion_width) * 100 / m_inputs.sparse_infill_density;
+        generateInitialInternalOverhangs(throw_on_cancel_callback);
+    }
+    generateTrees(throw_on_cancel_callback);
 }
 
-void Generator::generateInitialInternalOverhangs(const PrintObject &print_object, const std::function<void()> &throw_on_cancel_callback)
+void Generator::generateInitialInternalOverhangs(const std::function<void()> &throw_on_cancel_callback)
 {
-    m_overhang_per_layer.resize(print_object.layers().size());
+    m_overhang_per_layer.resize(m_inputs.outlines.size());
 
-    Polygons infill_area_above;
+    const Polygons no_infill_area;
     //Iterate from top to bottom, to subtract the overhang areas above from the overhang areas on the layer below, to get only overhang in the top layer where it is overhanging.
-    for (int layer_nr = int(print_object.layers().size()) - 1; layer_nr >= 0; --layer_nr) {
+    for (int layer_nr = int(m_inputs.outlines.size()) - 1; layer_nr >= 0; --layer_nr) {
         throw_on_cancel_callback();
-        Polygons infill_area_here;
-        for (const LayerRegion* layerm : print_object.get_layer(layer_nr)->regions())
-            for (const Surface& surface : layerm->fill_surfaces.surfaces)
-                if (surface.surface_type == stInternal || surface.surface_type == stInternalVoid)
-                    append(infill_area_here, to_polygons(surface.expolygon));
+        const Polygons &infill_area_here  = m_inputs.outlines[layer_nr];
+        const Polygons &infill_area_above = layer_nr + 1 < int(m_inputs.outlines.size()) ? m_inputs.outlines[layer_nr + 1] : no_infill_area;
 
         //Remove the part of the infill area that is already supported by the walls.
-        Polygons overhang = diff(offset(infill_area_here, -float(m_wall_supporting_radius)), infill_area_above);
-
-        m_overhang_per_layer[layer_nr] = overhang;
-        infill_area_above = std::move(infill_area_here);
+        m_overhang_per_layer[layer_nr] = diff(offset(infill_area_here, -float(m_wall_supporting_radius)), infill_area_above);
     }
 }
 
@@ -175,109 +215,84 @@ const Layer& Generator::getTreesForLayer(const size_t& layer_id) const
     return m_lightning_layers[layer_id];
 }
 
-void Generator::generateTrees(const PrintObject &print_object, const std::function<void()> &throw_on_cancel_callback)
+void Generator::generateTrees(const std::function<void()> &throw_on_cancel_callback)
 {
-    const auto _locator_cell_size = locator_cell_size();
-    m_lightning_layers.resize(print_object.layers().size());
-    bboxs.resize(print_object.layers().size());
-    std::vector<Polygons> infill_outlines(print_object.layers().size(), Polygons());
-
-    // For-each layer from top to bottom:
-    for (int layer_id = int(print_object.layers().size()) - 1; layer_id >= 0; layer_id--) {
-        throw_on_cancel_callback();
-        for (const LayerRegion *layerm : print_object.get_layer(layer_id)->regions())
-            for (const Surface &surface : layerm->fill_surfaces.surfaces)
-                if (surface.surface_type == stInternal || surface.surface_type == stInternalVoid)
-                    append(infill_outlines[layer_id], to_polygons(surface.expolygon));
-    }
-
-    // For various operations its beneficial to quickly locate nearby features on the polygon:
-    const size_t top_layer_id = print_object.layers().size() - 1;
-    EdgeGrid::Grid outlines_locator(get_extents(infill_outlines[top_layer_id]).inflated(SCALED_EPSILON));
-    outlines_locator.create(infill_outlines[top_layer_id], _locator_cell_size);
-
-    // For-each layer from top to bottom:
-    for (int layer_id = int(top_layer_id); layer_id >= 0; layer_id--) {
-        throw_on_cancel_callback();
-        Layer             &current_lightning_layer = m_lightning_layers[layer_id];
-        const Polygons    &current_outlines        = infill_outlines[layer_id];
-        const BoundingBox &current_outlines_bbox   = get_extents(current_outlines);
-
-        bboxs[layer_id] = get_extents(current_outlines);
-
-        // register all trees propagated from the previous layer as to-be-reconnected
-        std::vector<NodeSPtr> to_be_reconnected_tree_roots = current_lightning_layer.tree_roots;
-
-        current_lightning_layer.generateNewTrees(m_overhang_per_layer[layer_id], current_outlines, current_outlines_bbox, outlines_locator, m_supporting_radius, m_wall_supporting_radius, throw_on_cancel_callback);
-        current_lightning_layer.reconnectRoots(to_be_reconnected_tree_roots, current_outlines, current_outlines_bbox, outlines_locator, m_supporting_radius, m_wall_supporting_radius);
-
-        // Initialize trees for next lower layer from the current one.
-        if (layer_id == 0)
-            return;
-
-        const Polygons &below_outlines      = infill_outlines[layer_id - 1];
-        BoundingBox     below_outlines_bbox = get_extents(below_outlines).inflated(SCALED_EPSILON);
-        if (const BoundingBox &outlines_locator_bbox = outlines_locator.bbox(); outlines_locator_bbox.defined)
-            below_outlines_bbox.merge(outlines_locator_bbox);
-
-        if (!current_lightning_layer.tree_roots.empty())
-            below_outlines_bbox.merge(get_extents(current_lightning_layer.tree_roots).inflated(SCALED_EPSILON));
-
-        outlines_locator.set_bbox(below_outlines_bbox);
-        outlines_locator.create(below_outlines, _locator_cell_size);
-
-        std::vector<NodeSPtr>& lower_trees = m_lightning_layers[layer_id - 1].tree_roots;
-        for (auto& tree : current_lightning_layer.tree_roots)
-            tree->propagateToNextLayer(lower_trees, below_outlines, outlines_locator, m_prune_length, m_straightening_max_distance, _locator_cell_size / 2);
-    }
+    propagateTrees(m_inputs.outlines, throw_on_cancel_callback);
 }
 
-void Generator::generateTreesforSupport(std::vector<Polygons>& contours, const std::function<void()> &throw_on_cancel_callback)
+void Generator::propagateTrees(const std::vector<Polygons>& outlines, const std::function<void()> &throw_on_cancel_callback)
 {
-    if (contours.empty()) return;
-
-    m_lightning_layers.resize(contours.size());
-    bboxs.resize(contours.size());
+    if (outlines.empty()) return;
+
+    m_lightning_layers.resize(outlines.size());
+    bboxs.resize(outlines.size());
+
+    // Distance fields of the layers [band_top - LIGHTNING_BAND_SIZE + 1, band_top], constructed in parallel.
+    std::vector<std::unique_ptr<DistanceField>> distance_fields(outlines.size());
+    auto precompute_band = [this, &outlines, &distance_fields, &throw_on_cancel_callback](int band_top) {
+        tbb::parallel_for(tbb::blocked_range<int>(std::max(0, band_top - LIGHTNING_BAND_SIZE + 1), band_top + 1), [&](const tbb::blocked_range<int> &range) {
+            for (int layer_id = range.begin(); layer_id < range.end(); ++ layer_id) {
+                throw_on_cancel_callback();
+                bboxs[layer_id] = get_extents(outlines[layer_id]);
+                distance_fields[layer_id] = std::make_unique<DistanceField>(m_supporting_radius, outlines[layer_id], bboxs[layer_id], m_overhang_per_layer[layer_id]);
+            }
+        });
+    };
 
     const auto _locator_cell_size = locator_cell_size();
     // For various operations its beneficial to quickly locate nearby features on the polygon:
-    const size_t top_layer_id = contours.size() - 1;
-    EdgeGrid::Grid outlines_locator(get_extents(contours[top_layer_id]).inflated(SCALED_EPSILON));
-    outlines_locator.create(contours[top_layer_id], _locator_cell_size);
-
-    // For-each layer from top to bottom:
-    for (int layer_id = int(top_layer_id); layer_id >= 0; layer_id--) {
-		throw_on_cancel_callback();
-        Layer& current_lightning_layer = m_lightning_layers[layer_id];
-        const Polygons& current_outlines = contours[layer_id];
-        const BoundingBox& current_outlines_bbox = get_extents(current_outlines);
-
-        bboxs[layer_id] = get_extents(current_outlines);
-
-        // register all trees propagated from the previous layer as to-be-reconnected
-        std::vector<NodeSPtr> to_be_reconnected_tree_roots = current_lightning_layer.tree_roots;
-
-        current_lightning_layer.generateNewTrees(m_overhang_per_layer[layer_id], current_outlines, current_outlines_bbox, outlines_locator, m_supporting_radius, m_wall_supporting_radius, throw_on_cancel_callback);
-        current_lightning_layer.reconnectRoots(to_be_reconnected_tree_roots, current_outlines, current_outlines_bbox, outlines_locator, m_supporting_radius, m_wall_supporting_radius);
-
-        // Initialize trees for next lower layer from the current one.
-        if (layer_id == 0)
-            return;
-
-        const Polygons& below_outlines = contours[layer_id - 1];
-        BoundingBox     below_outlines_bbox = get_extents(below_outlines).inflated(SCALED_EPSILON);
-        if (const BoundingBox& outlines_locator_bbox = outlines_locator.bbox(); outlines_locator_bbox.defined)
-            below_outlines_bbox.merge(outlines_locator_bbox);
-
-        if (!current_lightning_layer.tree_roots.empty())
-            below_outlines_bbox.merge(get_extents(current_lightning_layer.tree_roots).inflated(SCALED_EPSILON));
-
-        outlines_locator.set_bbox(below_outlines_bbox);
-        outlines_locator.create(below_outlines, _locator_cell_size);
-
-        std::vector<NodeSPtr>& lower_trees = m_lightning_layers[layer_id - 1].tree_roots;
-        for (auto& tree : current_lightning_layer.tree_roots)
-            tree->propagateToNextLayer(lower_trees, below_outlines, outlines_locator, m_prune_length, m_straightening_max_distance, _locator_cell_size / 2);
+    const int top_layer_id = int(outlines.size()) - 1;
+    EdgeGrid::Grid outlines_locator(get_extents(outlines[top_layer_id]).inflated(SCALED_EPSILON));
+    outlines_locator.create(outlines[top_layer_id], _locator_cell_size);
+
+    precompute_band(top_layer_id);
+    tbb::task_group precompute;
+    try {
+        for (int band_top = top_layer_id; band_top >= 0; band_top -= LIGHTNING_BAND_SIZE) {
+            // Construct the distance fields of the next band while the trees of this band are being generated.
+            if (band_top >= LIGHTNING_BAND_SIZE)
+                precompute.run([&precompute_band, band_top]() { precompute_band(band_top - LIGHTNING_BAND_SIZE); });
+
+            // For-each layer of the band from top to bottom:
+            for (int layer_id = band_top; layer_id > band_top - LIGHTNING_BAND_SIZE && layer_id >= 0; layer_id--) {
+                throw_on_cancel_callback();
+                Layer             &current_lightning_layer = m_lightning_layers[layer_id];
+                const Polygons    &current_outlines        = outlines[layer_id];
+                const BoundingBox &current_outlines_bbox   = bboxs[layer_id];
+
+                // register all trees propagated from the previous layer as to-be-reconnected
+                std::vector<NodeSPtr> to_be_reconnected_tree_roots = current_lightning_layer.tree_roots;
+
+                current_lightning_layer.generateNewTrees(*distance_fields[layer_id], current_outlines, current_outlines_bbox, outlines_locator, m_supporting_radius, m_wall_supporting_radius, throw_on_cancel_callback);
+                distance_fields[layer_id].reset();
+                current_lightning_layer.reconnectRoots(to_be_reconnected_tree_roots, current_outlines, current_outlines_bbox, outlines_locator, m_supporting_radius, m_wall_supporting_radius);
+
+                // Initialize trees for next lower layer from the current one.
+                if (layer_id == 0)
+                    break;
+
+                const Polygons &below_outlines      = outlines[layer_id - 1];
+                BoundingBox     below_outlines_bbox = get_extents(below_outlines).inflated(SCALED_EPSILON);
+                if (const BoundingBox &outlines_locator_bbox = outlines_locator.bbox(); outlines_locator_bbox.defined)
+                    below_outlines_bbox.merge(outlines_locator_bbox);
+
+                if (!current_lightning_layer.tree_roots.empty())
+                    below_outlines_bbox.merge(get_extents(current_lightning_layer.tree_roots).inflated(SCALED_EPSILON));
+
+                outlines_locator.set_bbox(below_outlines_bbox);
+                outlines_locator.create(below_outlines, _locator_cell_size);
+
+                std::vector<NodeSPtr>& lower_trees = m_lightning_layers[layer_id - 1].tree_roots;
+                for (auto& tree : current_lightning_layer.tree_roots)
+                    tree->propagateToNextLayer(lower_trees, below_outlines, outlines_locator, m_prune_length, m_straightening_max_distance, _locator_cell_size / 2);
+            }
+            precompute.wait();
+        }
+    } catch (...) {
+        // Don't leave the construction of the next band running on the local variables.
+        precompute.cancel();
+        precompute.wait();
+        throw;
     }
 }
 
@@ -37,6 +37,54 @@ namespace FillLightning
 class Generator  // "Just like Nicola used to make!"
 {
 public:
+    /*!
+     * Everything the generated trees depend on: the areas to be filled, the
+     * settings read from the print object and the angles of the generator.
+     *
+     * Generators created from equal inputs generate the same trees, thus a
+     * generator may be reused as long as its inputs did not change. The hash
+     * is only used to reject different inputs quickly, equal hashes are
+     * verified by comparing the inputs.
+     */
+    struct Inputs
+    {
+        /*!
+         * Inputs of the infill trees of a mesh, the infill areas are collected
+         * from the stInternal and stInternalVoid fill surfaces of its layers.
+         */
+        explicit Inputs(const PrintObject &print_object);
+
+        /*!
+         * Inputs of the trees of the tree support base, filling the contours
+         * of the support layers and supporting the given overhangs.
+         */
+        Inputs(const PrintObject &print_object, std::vector<Polygons> contours, std::vector<Polygons> overhangs, float density);
+
+        bool operator==(const Inputs &rhs) const;
+        bool operator!=(const Inputs &rhs) const { return ! (*this == rhs); }
+
+        bool   support                  { false };
+        double max_nozzle_diameter      { 0. };
+        double layer_height             { 0. };
+        double line_width               { 0. };
+        double sparse_infill_line_width { 0. };
+        double sparse_infill_density    { 0. };
+        // Density of the support trees, not used by the infill trees.
+        float  density                  { 0.f };
+        double overhang_angle           { 0. };
+        double prune_angle              { 0. };
+        double straightening_angle      { 0. };
+        // For each layer, the area to be filled.
+        std::vector<Polygons> outlines;
+        // For each layer, the overhangs to be supported by the support trees.
+        std::vector<Polygons> overhangs;
+        size_t hash                     { 0 };
+
+    private:
+        // Read the settings and the angles, hash everything.
+        void init(const PrintObject &print_object);
+    };
+
     /*!
      * Create a generator to fill a certain mesh with infill.
      *
@@ -46,6 +94,12 @@ public:
      */
     explicit Generator(const PrintObject &print_object, const std::function<void()> &throw_on_cancel_callback);
 
+    /*!
+     * Create a generator from inputs collected beforehand, for example to
+     * check whether a previously created generator could be reused.
+     */
+    Generator(Inputs &&inputs, const std::function<void()> &throw_on_cancel_callback);
+
     /*!
      * Get a tree of paths generated for a certain layer of the mesh.
      *
@@ -61,7 +115,7 @@ public:
 
     float infilll_extrusion_width() const { return m_infill_extrusion_width; }
 
-    Generator(PrintObject* m_object, std::vector<Polygons>& contours, std::vector<Polygons>& overhangs, const std::function<void()> &throw_on_cancel_callback, float density = 0.15);
+    const Inputs& inputs() const { return m_inputs; }
 
 protected:
     /*!
@@ -72,13 +126,24 @@ protected:
      * only when support is generated. For this pattern, we also need to
      * generate overhang areas for the inside of the model.
      */
-    void generateInitialInternalOverhangs(const PrintObject &print_object, const std::function<void()> &throw_on_cancel_callback);
+    void generateInitialInternalOverhangs(const std::function<void()> &throw_on_cancel_callback);
 
     /*!
      * Calculate the tree structure of all layers.
      */
-    void generateTrees(const PrintObject &print_object, const std::function<void()> &throw_on_cancel_callback);
-    void generateTreesforSupport(std::vector<Polygons>& contours, const std::function<void()> &throw_on_cancel_callback);
+    void generateTrees(const std::function<void()> &throw_on_cancel_callback);
+
+    /*!
+     * Generate the trees of all layers top to bottom, propagating the trees of
+     * each layer to the layer below, for the given areas to be filled.
+     *
+     * The distance fields of the layers do not depend on the trees propagated
+     * from above, thus they are constructed in parallel one band of layers
+     * ahead of the layers the trees are generated for.
+     */
+    void propagateTrees(const std::vector<Polygons>& outlines, const std::function<void()> &throw_on_cancel_callback);
+
+    Inputs m_inputs;
 
     float m_infill_extrusion_width;
 
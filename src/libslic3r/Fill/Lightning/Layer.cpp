@@ -53,6 +53,20 @@ void Layer::generateNewTrees
 )
 {
     DistanceField distance_field(supporting_radius, current_outlines, current_outlines_bbox, current_overhang);
+    this->generateNewTrees(distance_field, current_outlines, current_outlines_bbox, outlines_locator, supporting_radius, wall_supporting_radius, throw_on_cancel_callback);
+}
+
+void Layer::generateNewTrees
+(
+    DistanceField& distance_field,
+    const Polygons& current_outlines,
+    const BoundingBox& current_outlines_bbox,
+    const EdgeGrid::Grid& outlines_locator,
+    const coord_t supporting_radius,
+    const coord_t wall_supporting_radius,
+    const std::function<void()> &throw_on_cancel_callback
+)
+{
     throw_on_cancel_callback();
 
     SparseNodeGrid tree_node_locator;
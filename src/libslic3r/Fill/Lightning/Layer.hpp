@@ -17,6 +17,7 @@ namespace Slic3r::FillLightning
 {
 
 class Node;
+class DistanceField;
 using NodeSPtr = std::shared_ptr<Node>;
 using SparseNodeGrid = std::unordered_multimap<Point, std::weak_ptr<Node>, PointHash>;
 
@@ -48,6 +49,21 @@ public:
         const std::function<void()> &throw_on_cancel_callback
     );
 
+    /*!
+     * Same as above, with the distance field of current_overhang already
+     * constructed, so that it may be constructed ahead of time in parallel.
+     */
+    void generateNewTrees
+    (
+        DistanceField& distance_field,
+        const Polygons& current_outlines,
+        const BoundingBox& current_outlines_bbox,
+        const EdgeGrid::Grid& outline_locator,
+        coord_t supporting_radius,
+        coord_t wall_supporting_radius,
+        const std::function<void()> &throw_on_cancel_callback
+    );
+
     /*! Determine & connect to connection point in tree/outline.
      * \param min_dist_from_boundary_for_tree If the unsupported point is closer to the boundary than this then don't consider connecting it to a tree
      */
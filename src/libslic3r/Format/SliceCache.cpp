@@ -0,0 +1,274 @@
+#include "../libslic3r.h"
+
+#include "SliceCache.hpp"
+
+#include <cstring>
+
+#include <boost/filesystem/operations.hpp>
+#include <boost/log/trivial.hpp>
+#include <boost/nowide/fstream.hpp>
+
+namespace Slic3r {
+
+static constexpr const char   SLICE_CACHE_MAGIC[4]   = { 'O', 'S', 'L', 'C' };
+static constexpr const size_t SLICE_CACHE_HEADER_SIZE = 16;
+
+namespace {
+
+class Encoder
+{
+public:
+    explicit Encoder(std::string &out) : m_out(out) {}
+
+    void put_varint(uint64_t v) {
+        while (v >= 0x80) {
+            m_out.push_back(char((v & 0x7f) | 0x80));
+            v >>= 7;
+        }
+        m_out.push_back(char(v));
+    }
+    void put_signed(int64_t v) { this->put_varint((uint64_t(v) << 1) ^ uint64_t(v >> 63)); }
+    void put_point(const Point &pt) {
+        this->put_signed(int64_t(pt.x()) - int64_t(m_last.x()));
+        this->put_signed(int64_t(pt.y()) - int64_t(m_last.y()));
+        m_last = pt;
+    }
+    void put_polygon(const Polygon &polygon) {
+        this->put_varint(polygon.points.size());
+        for (const Point &pt : polygon.points)
+            this->put_point(pt);
+    }
+    void put_expolygons(const ExPolygons &expolygons) {
+        this->put_varint(expolygons.size());
+        for (const ExPolygon &expoly : expolygons) {
+            this->put_varint(expoly.holes.size());
+            this->put_polygon(expoly.contour);
+            for (const Polygon &hole : expoly.holes)
+                this->put_polygon(hole);
+        }
+    }
+    void put_bboxes(const std::vector<BoundingBox> &bboxes) {
+        this->put_varint(bboxes.size());
+        for (const BoundingBox &bbox : bboxes) {
+            m_out.push_back(char(bbox.defined));
+            this->put_point(bbox.min);
+            this->put_signed(int64_t(bbox.max.x()) - int64_t(bbox.min.x()));
+            this->put_signed(int64_t(bbox.max.y()) - int64_t(bbox.min.y()));
+        }
+    }
+
+private:
+    std::string &m_out;
+    Point        m_last { Point::Zero() };
+};
+
+class Decoder
+{
+public:
+    Decoder(const unsigned char *begin, const unsigned char *end) : m_ptr(begin), m_end(end) {}
+
+    bool ok() const { return m_ok; }
+
+    uint64_t get_varint() {
+        uint64_t v = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            if (m_ptr == m_end) {
+                m_ok = false;
+                return 0;
+            }
+            unsigned char c = *m_ptr ++;
+            v |= uint64_t(c & 0x7f) << shift;
+            if ((c & 0x80) == 0)
+                return v;
+        }
+        m_ok = false;
+        return 0;
+    }
+    int64_t get_signed() { uint64_t v = this->get_varint(); return int64_t(v >> 1) ^ -int64_t(v & 1); }
+    // Number of elements, each element occupies at least one byte. Guards against corrupted counts.
+    size_t get_count() {
+        uint64_t n = this->get_varint();
+        if (n > uint64_t(m_end - m_ptr)) {
+            m_ok = false;
+            return 0;
+        }
+        return size_t(n);
+    }
+    Point get_point() {
+        coord_t x = coord_t(int64_t(m_last.x()) + this->get_signed());
+        coord_t y = coord_t(int64_t(m_last.y()) + this->get_signed());
+        m_last = Point(x, y);
+        return m_last;
+    }
+    void get_polygon(Polygon &polygon) {
+        size_t n = this->get_count();
+        polygon.points.reserve(n);
+        for (size_t i = 0; i < n && m_ok; ++ i)
+            polygon.points.emplace_back(this->get_point());
+    }
+    void get_expolygons(ExPolygons &expolygons) {
+        size_t n = this->get_count();
+        expolygons.reserve(n);
+        for (size_t i = 0; i < n && m_ok; ++ i) {
+            expolygons.emplace_back();
+            ExPolygon &expoly = expolygons.back();
+            expoly.holes.assign(this->get_count(), Polygon());
+            this->get_polygon(expoly.contour);
+            for (Polygon &hole : expoly.holes)
+                this->get_polygon(hole);
+        }
+    }
+    void get_bboxes(std::vector<BoundingBox> &bboxes) {
+        size_t n = this->get_count();
+        bboxes.reserve(n);
+        for (size_t i = 0; i < n && m_ok; ++ i) {
+            if (m_ptr == m_end) {
+                m_ok = false;
+                break;
+            }
+            bool defined = *m_ptr ++ != 0;
+            BoundingBox bbox;
+            bbox.min     = this->get_point();
+            // The width has to be read before the height, the order of evaluation of function arguments is unspecified.
+            coord_t dx   = coord_t(this->get_signed());
+            coord_t dy   = coord_t(this->get_signed());
+            bbox.max     = bbox.min + Point(dx, dy);
+            bbox.defined = defined;
+            bboxes.emplace_back(bbox);
+        }
+    }
+
+private:
+    const unsigned char *m_ptr;
+    const unsigned char *m_end;
+    Point                m_last { Point::Zero() };
+    bool                 m_ok { true };
+};
+
+void put_uint32(std::string &out, uint32_t v)
+{
+    for (int i = 0; i < 4; ++ i)
+        out.push_back(char((v >> (8 * i)) & 0xff));
+}
+
+void put_uint64(std::string &out, uint64_t v)
+{
+    for (int i = 0; i < 8; ++ i)
+        out.push_back(char((v >> (8 * i)) & 0xff));
+}
+
+uint32_t get_uint32(const unsigned char *p)
+{
+    return uint32_t(p[0]) | (uint32_t(p[1]) << 8) | (uint32_t(p[2]) << 16) | (uint32_t(p[3]) << 24);
+}
+
+uint64_t get_uint64(const unsigned char *p)
+{
+    return uint64_t(get_uint32(p)) | (uint64_t(get_uint32(p + 4)) << 32);
+}
+
+} // namespace
+
+void SliceCacheWriter::set_layer(size_t layer_idx, const ExPolygons &lslices, const std::vector<BoundingBox> &lslices_bboxes, const ExPolygons &loverhangs)
+{
+    assert(layer_idx < m_layers.size());
+    std::string &out = m_layers[layer_idx];
+    out.clear();
+    Encoder encoder(out);
+    encoder.put_expolygons(lslices);
+    encoder.put_bboxes(lslices_bboxes);
+    encoder.put_expolygons(loverhangs);
+}
+
+bool SliceCacheWriter::save(const std::string &path) const
+{
+    std::string header;
+    header.reserve(SLICE_CACHE_HEADER_SIZE + (m_layers.size() + 1) * 8);
+    header.append(SLICE_CACHE_MAGIC, sizeof(SLICE_CACHE_MAGIC));
+    put_uint32(header, VERSION);
+    put_uint32(header, uint32_t(m_layers.size()));
+    put_uint32(header, 0);
+    uint64_t offset = SLICE_CACHE_HEADER_SIZE + (m_layers.size() + 1) * 8;
+    for (const std::string &layer : m_layers) {
+        put_uint64(header, offset);
+        offset += layer.size();
+    }
+    put_uint64(header, offset);
+
+    boost::nowide::ofstream out(path, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (! out.good()) {
+        BOOST_LOG_TRIVIAL(error) << "SliceCacheWriter: can not open " << path << " for writing";
+        return false;
+    }
+    out.write(header.data(), header.size());
+    for (const std::string &layer : m_layers)
+        out.write(layer.data(), layer.size());
+    out.close();
+    if (out.fail()) {
+        BOOST_LOG_TRIVIAL(error) << "SliceCacheWriter: failed writing " << path;
+        return false;
+    }
+    return true;
+}
+
+bool SliceCacheReader::open(const std::string &path)
+{
+    this->close();
+    boost::system::error_code ec;
+    if (! boost::filesystem::exists(path, ec) || boost::filesystem::file_size(path, ec) < SLICE_CACHE_HEADER_SIZE + 8)
+        return false;
+    try {
+        m_file.open(path);
+    } catch (const std::exception &err) {
+        BOOST_LOG_TRIVIAL(error) << "SliceCacheReader: can not map " << path << ", reason = " << err.what();
+        return false;
+    }
+    const unsigned char *data = reinterpret_cast<const unsigned char*>(m_file.data());
+    const size_t         size = m_file.size();
+    if (memcmp(data, SLICE_CACHE_MAGIC, sizeof(SLICE_CACHE_MAGIC)) != 0 || get_uint32(data + 4) != SliceCacheWriter::VERSION) {
+        BOOST_LOG_TRIVIAL(warning) << "SliceCacheReader: " << path << " is not a slice cache of version " << SliceCacheWriter::VERSION;
+        this->close();
+        return false;
+    }
+    size_t layer_count = get_uint32(data + 8);
+    size_t index_end   = SLICE_CACHE_HEADER_SIZE + (layer_count + 1) * 8;
+    bool   valid       = index_end <= size;
+    // The offsets have to be monotonous and point inside the file.
+    for (size_t i = 0, last = index_end; valid && i <= layer_count; ++ i) {
+        uint64_t offset = get_uint64(data + SLICE_CACHE_HEADER_SIZE + i * 8);
+        valid = offset >= last && offset <= size;
+        last  = size_t(offset);
+    }
+    if (! valid) {
+        BOOST_LOG_TRIVIAL(error) << "SliceCacheReader: corrupted index table in " << path;
+        this->close();
+        return false;
+    }
+    m_layer_count = layer_count;
+    return true;
+}
+
+void SliceCacheReader::close()
+{
+    if (m_file.is_open())
+        m_file.close();
+    m_layer_count = 0;
+}
+
+bool SliceCacheReader::load_layer(size_t layer_idx, ExPolygons &lslices, std::vector<BoundingBox> &lslices_bboxes, ExPolygons &loverhangs) const
+{
+    lslices.clear();
+    lslices_bboxes.clear();
+    loverhangs.clear();
+    if (layer_idx >= m_layer_count)
+        return false;
+    const unsigned char *data  = reinterpret_cast<const unsigned char*>(m_file.data());
+    const unsigned char *index = data + SLICE_CACHE_HEADER_SIZE + layer_idx * 8;
+    Decoder decoder(data + get_uint64(index), data + get_uint64(index + 8));
+    decoder.get_expolygons(lslices);
+    decoder.get_bboxes(lslices_bboxes);
+    decoder.get_expolygons(loverhangs);
+    return decoder.ok();
+}
+
+} // namespace Slic3r
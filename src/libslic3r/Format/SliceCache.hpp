@@ -0,0 +1,63 @@
+#ifndef slic3r_Format_SliceCache_hpp_
+#define slic3r_Format_SliceCache_hpp_
+
+#include "../ExPolygon.hpp"
+#include "../BoundingBox.hpp"
+
+#include <string>
+#include <vector>
+
+#include <boost/iostreams/device/mapped_file.hpp>
+
+namespace Slic3r {
+
+// Binary container for the per layer slice geometry (Layer::lslices, Layer::lslices_bboxes and Layer::loverhangs)
+// of a single PrintObject, used by Print::export_cached_data() / Print::load_cached_data().
+//
+// Layout (all integers little endian):
+//      header: "OSLC", uint32 version, uint32 layer count, uint32 reserved
+//      index:  (layer count + 1) x uint64 file offsets, layer i occupies [offset[i], offset[i + 1])
+//      layers: per layer record, see SliceCacheWriter::set_layer()
+// Points are stored as zig-zag varint deltas from the previously stored point of the same layer,
+// so that the layers may be decoded independently and lazily from a memory mapped file.
+class SliceCacheWriter
+{
+public:
+    static constexpr uint32_t VERSION = 1;
+
+    explicit SliceCacheWriter(size_t layer_count) : m_layers(layer_count) {}
+
+    // Encode a single layer. Thread safe for distinct layer indices.
+    void set_layer(size_t layer_idx, const ExPolygons &lslices, const std::vector<BoundingBox> &lslices_bboxes, const ExPolygons &loverhangs);
+    // Write header, index table and all the layer records. Returns false on an I/O error.
+    bool save(const std::string &path) const;
+
+private:
+    std::vector<std::string> m_layers;
+};
+
+class SliceCacheReader
+{
+public:
+    SliceCacheReader() = default;
+    ~SliceCacheReader() { this->close(); }
+
+    // Memory map the file and validate its header and index table.
+    // Returns false if the file does not exist, is truncated or has an unsupported version.
+    bool   open(const std::string &path);
+    void   close();
+    bool   is_open() const { return m_file.is_open(); }
+    size_t layer_count() const { return m_layer_count; }
+
+    // Decode a single layer. Thread safe, the output containers are cleared first.
+    // Returns false if the layer record is corrupted.
+    bool   load_layer(size_t layer_idx, ExPolygons &lslices, std::vector<BoundingBox> &lslices_bboxes, ExPolygons &loverhangs) const;
+
+private:
+    boost::iostreams::mapped_file_source m_file;
+    size_t                               m_layer_count { 0 };
+};
+
+} // namespace Slic3r
+
+#endif /* slic3r_Format_SliceCache_hpp_ */
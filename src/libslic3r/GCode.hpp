@@ -27,6 +27,7 @@
 // ORCA: post processor below used for Dynamic Pressure advance
 #include "GCode/AdaptivePAProcessor.hpp"
 
+#include <atomic>
 #include <memory>
 #include <map>
 #include <set>
@@ -155,6 +156,8 @@ struct LayerResult {
 	// Is indicating if this LayerResult should be processed, or it is just inserted artificial LayerResult.
     // It is used for the pressure equalizer because it needs to buffer one layer back.
     bool        nop_layer_result { false };
+    // Lines of gcode parsed for the CoolingBuffer by the preceding filter, or empty if the CoolingBuffer shall parse gcode.
+    std::vector<LayerGCodeLine> lines;
 
     static LayerResult make_nop_layer_result() { return {"", std::numeric_limits<coord_t>::max(), false, false, true}; }
 };
@@ -315,11 +318,16 @@ private:
         const Layer& layer,
         unsigned int extruder_id);
 
+    struct ObjectByExtruder;
+    using ExtrusionsByExtruder = std::map<unsigned int, std::vector<ObjectByExtruder>>;
+
     LayerResult process_layer(
         const Print                     &print,
         // Set of object & print layers of the same PrintObject and with the same print_z.
         const std::vector<LayerToPrint> &layers,
         const LayerTools  				&layer_tools,
+        // Extrusions of this print_z grouped by group_extrusions_by_extruder().
+        ExtrusionsByExtruder            &by_extruder,
         const bool                       last_layer,
 		// Pairs of PrintObject index and its instance index.
 		const std::vector<const PrintInstance*> *ordering,
@@ -445,6 +453,25 @@ private:
 		// For sequential print, the instance of the object to be printing has to be defined.
 		const size_t                     				 single_object_instance_idx);
 
+    // Group extrusions of a single print_z by an extruder, then by an object, an island and a region.
+    // Does not depend on the state of the G-code generator, thus it is executed for several layers in parallel.
+    static ExtrusionsByExtruder group_extrusions_by_extruder(const Print &print, const std::vector<LayerToPrint> &layers, const LayerTools &layer_tools);
+    static std::vector<AvoidCrossingPerimeters::LayerBoundariesPtr> make_travel_boundaries(const std::vector<LayerToPrint> &layers, std::atomic<int64_t> &time_ns);
+
+    // A single print_z passed from the parallel grouping stage to the serial G-code generating stage of process_layers().
+    struct LayerToProcess
+    {
+        std::vector<LayerToPrint>   layers;
+        const LayerTools           *layer_tools { nullptr };
+        bool                        last_layer  { false };
+        ExtrusionsByExtruder        by_extruder;
+        // Travel boundaries of the layers, calculated by the grouping stage if reduce_crossing_wall is enabled.
+        // Only the few layers in flight through the pipeline hold them, which limits the memory of tall prints.
+        std::vector<AvoidCrossingPerimeters::LayerBoundariesPtr> travel_boundaries;
+        // Empty layer inserted at the end for the pressure equalizer, which returns one layer back.
+        bool                        nop_layer   { false };
+    };
+
     std::string     extrude_perimeters(const Print& print, const std::vector<ObjectByExtruder::Island::Region>& by_region);
     std::string     extrude_infill(const Print& print, const std::vector<ObjectByExtruder::Island::Region>& by_region, bool ironing);
     std::string     extrude_support(const ExtrusionEntityCollection& support_fills);
@@ -602,7 +629,8 @@ private:
     // BBS
     int get_bed_temperature(const int extruder_id, const bool is_first_layer, const BedType bed_type) const;
 
-    std::string _extrude(const ExtrusionPath &path, std::string description = "", double speed = -1);
+    // Append the G-code of the path to gcode.
+    void _extrude(std::string &gcode, const ExtrusionPath &path, std::string description = "", double speed = -1);
     double get_overhang_degree_corr_speed(float speed, double path_degree);
     void print_machine_envelope(GCodeOutputStream &file, Print &print);
     void _print_first_layer_bed_temperature(GCodeOutputStream &file, Print &print, const std::string &gcode, unsigned int first_printing_extruder_id, bool wait);
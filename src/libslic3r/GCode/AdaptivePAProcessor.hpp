@@ -54,6 +54,15 @@ public:
      */
     void resetPreviousPA(double PA){ m_last_predicted_pa = PA; };
     
+    /**
+     * @brief Checks whether adaptive pressure advance is enabled for any of the tools used.
+     *
+     * If it is not, no PA change tags are emitted and processing the layers would return them unchanged.
+     *
+     * @return True if an adaptive PA model was set up for at least one tool.
+     */
+    bool is_enabled() const { return ! m_AdaptivePAInterpolators.empty(); }
+    
 private:
     GCode &m_gcodegen; ///< Reference to the GCode object.
     std::unordered_map<unsigned int, std::unique_ptr<AdaptivePAInterpolator>> m_AdaptivePAInterpolators; ///< Map between Interpolator objects and tool ID's
@@ -9,6 +9,7 @@
 #include "../SVG.hpp"
 #include "AvoidCrossingPerimeters.hpp"
 
+#include <algorithm>
 #include <numeric>
 #include <unordered_set>
 #include <boost/range/adaptor/reversed.hpp>
@@ -1182,15 +1183,20 @@ Polyline AvoidCrossingPerimeters::travel_to(const GCode &gcodegen, const Point &
     Vec2d startf = start.cast<double>();
     Vec2d endf   = end  .cast<double>();
 
+    if (! m_layer_boundaries)
+        m_layer_boundaries = std::make_shared<LayerBoundaries>();
+    const LayerBoundaries &layer_boundaries = *m_layer_boundaries;
+    Boundary              &internal         = m_layer_boundaries->internal;
+
     bool is_support_layer = dynamic_cast<const SupportLayer *>(gcodegen.layer()) != nullptr;
-    if (!use_external && (is_support_layer || (!m_lslices_offset.empty() && !any_expolygon_contains(m_lslices_offset, m_lslices_offset_bboxes, m_grid_lslices_offset, travel)))) {
-        // Initialize m_internal only when it is necessary.
-        if (m_internal.boundaries.empty())
-            init_boundary(&m_internal, to_polygons(get_boundary(*gcodegen.layer())));
+    if (!use_external && (is_support_layer || (!layer_boundaries.lslices_offset.empty() && !any_expolygon_contains(layer_boundaries.lslices_offset, layer_boundaries.lslices_offset_bboxes, layer_boundaries.grid_lslices_offset, travel)))) {
+        // Initialize internal only when it is necessary, if it was not calculated ahead by make_layer_boundaries().
+        if (internal.boundaries.empty())
+            init_boundary(&internal, to_polygons(get_boundary(*gcodegen.layer())));
 
         // Trim the travel line by the bounding box.
-        if (!m_internal.boundaries.empty() && Geometry::liang_barsky_line_clipping(startf, endf, m_internal.bbox)) {
-            travel_intersection_count = avoid_perimeters(m_internal, startf.cast<coord_t>(), endf.cast<coord_t>(), *gcodegen.layer(), result_pl);
+        if (!internal.boundaries.empty() && Geometry::liang_barsky_line_clipping(startf, endf, internal.bbox)) {
+            travel_intersection_count = avoid_perimeters(internal, startf.cast<coord_t>(), endf.cast<coord_t>(), *gcodegen.layer(), result_pl);
             result_pl.points.front()  = start;
             result_pl.points.back()   = end;
         }
@@ -1233,32 +1239,56 @@ Polyline AvoidCrossingPerimeters::travel_to(const GCode &gcodegen, const Point &
     } else if (max_detour_length_exceeded) {
         *could_be_wipe_disabled = false;
     } else
-        *could_be_wipe_disabled = !need_wipe(gcodegen, m_lslices_offset, m_lslices_offset_bboxes, m_grid_lslices_offset, travel, result_pl, travel_intersection_count);
+        *could_be_wipe_disabled = !need_wipe(gcodegen, layer_boundaries.lslices_offset, layer_boundaries.lslices_offset_bboxes, layer_boundaries.grid_lslices_offset, travel, result_pl, travel_intersection_count);
 
     return result_pl;
 }
 
 // ************************************* AvoidCrossingPerimeters::init_layer() *****************************************
 
-void AvoidCrossingPerimeters::init_layer(const Layer &layer)
+static void init_lslices_offset(AvoidCrossingPerimeters::LayerBoundaries *layer_boundaries, const Layer &layer)
 {
-    m_internal.clear();
-    m_external.clear();
-    m_lslices_offset.clear();
-    m_lslices_offset_bboxes.clear();
-
-    float perimeter_offset = -get_external_perimeter_width(layer) / float(2.);
-    m_lslices_offset        = offset_ex(layer.lslices, perimeter_offset);
+    float perimeter_offset           = -get_external_perimeter_width(layer) / float(2.);
+    layer_boundaries->lslices_offset = offset_ex(layer.lslices, perimeter_offset);
 
-    m_lslices_offset_bboxes.reserve(m_lslices_offset.size());
-    for (const ExPolygon &ex_poly : m_lslices_offset)
-        m_lslices_offset_bboxes.emplace_back(get_extents(ex_poly));
+    layer_boundaries->lslices_offset_bboxes.reserve(layer_boundaries->lslices_offset.size());
+    for (const ExPolygon &ex_poly : layer_boundaries->lslices_offset)
+        layer_boundaries->lslices_offset_bboxes.emplace_back(get_extents(ex_poly));
 
     BoundingBox bbox_slice(get_extents(layer.lslices));
     bbox_slice.offset(SCALED_EPSILON);
 
-    m_grid_lslices_offset.set_bbox(bbox_slice);
-    m_grid_lslices_offset.create(m_lslices_offset, coord_t(scale_(1.)));
+    layer_boundaries->grid_lslices_offset.set_bbox(bbox_slice);
+    layer_boundaries->grid_lslices_offset.create(layer_boundaries->lslices_offset, coord_t(scale_(1.)));
+}
+
+// Called from a parallel stage of GCode::process_layers(), therefore it must only read the layer.
+// In addition to what init_layer() calculates in place, the boundary of the travels inside of the object
+// is calculated, as it is needed by most layers and it is the most expensive part.
+AvoidCrossingPerimeters::LayerBoundariesPtr AvoidCrossingPerimeters::make_layer_boundaries(const Layer &layer)
+{
+    auto out   = std::make_shared<LayerBoundaries>();
+    out->layer = &layer;
+    init_lslices_offset(out.get(), layer);
+    init_boundary(&out->internal, to_polygons(get_boundary(layer)));
+    return out;
+}
+
+void AvoidCrossingPerimeters::init_layer(const Layer &layer)
+{
+    m_external.clear();
+
+    auto it = std::find_if(m_layer_boundaries_precalculated.begin(), m_layer_boundaries_precalculated.end(),
+        [&layer](const LayerBoundariesPtr &layer_boundaries) { return layer_boundaries->layer == &layer; });
+    if (it != m_layer_boundaries_precalculated.end()) {
+        m_layer_boundaries = *it;
+        ++ m_num_layers_precalculated;
+    } else {
+        m_layer_boundaries        = std::make_shared<LayerBoundaries>();
+        m_layer_boundaries->layer = &layer;
+        init_lslices_offset(m_layer_boundaries.get(), layer);
+        ++ m_num_layers_calculated;
+    }
 }
 
 #if 0
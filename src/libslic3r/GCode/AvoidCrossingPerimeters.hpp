@@ -5,6 +5,9 @@
 #include "../ExPolygon.hpp"
 #include "../EdgeGrid.hpp"
 
+#include <memory>
+#include <vector>
+
 namespace Slic3r {
 
 // Forward declarations.
@@ -23,7 +26,19 @@ public:
     bool        disabled_once() const   { return m_disabled_once; }
     void        reset_once_modifiers()  { m_use_external_mp_once = false; m_disabled_once = false; }
 
+    // Geometry of a single layer used for planning the travels inside of an object.
+    struct LayerBoundaries;
+    using LayerBoundariesPtr = std::shared_ptr<LayerBoundaries>;
+
+    // Calculate the geometry of the layer independently of the G-code generator, thus it may be called
+    // from a parallel stage of GCode::process_layers() ahead of the G-code generation.
+    static LayerBoundariesPtr make_layer_boundaries(const Layer &layer);
+    // Boundaries calculated by make_layer_boundaries() for the layers of the next call of GCode::process_layer().
+    void        set_layer_boundaries(std::vector<LayerBoundariesPtr> &&layer_boundaries) { m_layer_boundaries_precalculated = std::move(layer_boundaries); }
     void        init_layer(const Layer &layer);
+    // Number of layers initialized with the boundaries calculated ahead and in place, respectively.
+    size_t      num_layers_precalculated() const { return m_num_layers_precalculated; }
+    size_t      num_layers_calculated() const { return m_num_layers_calculated; }
 
     Polyline    travel_to(const GCode& gcodegen, const Point& point)
     {
@@ -50,6 +65,17 @@ public:
         }
     };
 
+    struct LayerBoundaries {
+        const Layer             *layer { nullptr };
+        // Lslices offseted by half an external perimeter width. Used for detection if line or polyline is inside of any polygon.
+        ExPolygons               lslices_offset;
+        std::vector<BoundingBox> lslices_offset_bboxes;
+        // Used for detection of line or polyline is inside of any polygon.
+        EdgeGrid::Grid           grid_lslices_offset;
+        // Store all needed data for travels inside object
+        Boundary                 internal;
+    };
+
 private:
     bool           m_use_external_mp { false };
     // just for the next travel move
@@ -58,13 +84,11 @@ private:
     // we enable it by default for the first travel move in print
     bool           m_disabled_once { true };
 
-    // Lslices offseted by half an external perimeter width. Used for detection if line or polyline is inside of any polygon.
-    ExPolygons               m_lslices_offset;
-    std::vector<BoundingBox> m_lslices_offset_bboxes;
-    // Used for detection of line or polyline is inside of any polygon.
-    EdgeGrid::Grid           m_grid_lslices_offset;
-    // Store all needed data for travels inside object
-    Boundary m_internal;
+    // Geometry of the current layer. Shared by the instances of an object, referenced by m_layer_boundaries_precalculated.
+    LayerBoundariesPtr               m_layer_boundaries;
+    std::vector<LayerBoundariesPtr>  m_layer_boundaries_precalculated;
+    size_t                           m_num_layers_precalculated { 0 };
+    size_t                           m_num_layers_calculated { 0 };
     // Store all needed data for travels outside object
     Boundary m_external;
 };
@@ -1,9 +1,12 @@
 #include "../GCode.hpp"
 #include "CoolingBuffer.hpp"
+#include <fast_float/fast_float.h>
 #include <boost/algorithm/string/predicate.hpp>
 #include <boost/algorithm/string/replace.hpp>
 #include <boost/log/trivial.hpp>
 #include <iostream>
+#include <charconv>
+#include <string_view>
 #include <float.h>
 #include <system_error>
 #include <unordered_map>
@@ -302,7 +305,36 @@ finished:
 
 std::string CoolingBuffer::process_layer(std::string &&gcode, size_t layer_id, bool flush)
 {
-    // Cache the input G-code.
+    return this->process_layer(std::move(gcode), std::vector<LayerGCodeLine>(), layer_id, flush);
+}
+
+std::string CoolingBuffer::process_layer(std::string &&gcode, std::vector<LayerGCodeLine> &&lines, size_t layer_id, bool flush)
+{
+    // Parse the input G-code, unless the preceding filter passed its lines, and cache both.
+    const size_t offset = m_gcode.size();
+    if (lines.empty()) {
+        const char *gcode_begin = gcode.c_str();
+        for (const char *line_start = gcode_begin; *line_start != 0;) {
+            const char *line_end = line_start;
+            while (*line_end != '\n' && *line_end != 0)
+                ++ line_end;
+            LayerGCodeLine &line = m_lines.emplace_back(parse_line(line_start, line_end, m_toolchange_prefix));
+            if (*line_end == '\n')
+                ++ line_end;
+            line.line_start = offset + (line_start - gcode_begin);
+            line.line_end   = offset + (line_end - gcode_begin);
+            line_start      = line_end;
+        }
+    } else {
+        for (LayerGCodeLine &line : lines) {
+            line.line_start += offset;
+            line.line_end   += offset;
+        }
+        if (m_lines.empty())
+            m_lines = std::move(lines);
+        else
+            append(m_lines, std::move(lines));
+    }
     if (m_gcode.empty())
         m_gcode = std::move(gcode);
     else
@@ -312,17 +344,102 @@ std::string CoolingBuffer::process_layer(std::string &&gcode, size_t layer_id, b
     if (flush) {
         // This is either an object layer or the very last print layer. Calculate cool down over the collected support layers
         // and one object layer.
-        std::vector<PerExtruderAdjustments> per_extruder_adjustments = this->parse_layer_gcode(m_gcode, m_current_pos);
+        std::vector<PerExtruderAdjustments> per_extruder_adjustments = this->parse_layer_gcode(m_gcode, m_lines, m_current_pos);
         float layer_time_stretched = this->calculate_layer_slowdown(per_extruder_adjustments);
         out = this->apply_layer_cooldown(m_gcode, layer_id, layer_time_stretched, per_extruder_adjustments);
         m_gcode.clear();
+        m_lines.clear();
     }
     return out;
 }
 
-// Parse the layer G-code for the moves, which could be adjusted.
-// Return the list of parsed lines, bucketed by an extruder.
-std::vector<PerExtruderAdjustments> CoolingBuffer::parse_layer_gcode(const std::string &gcode, std::vector<float> &current_pos) const
+static inline bool line_starts_with(const std::string_view &line, const std::string_view &prefix)
+{
+    return line.size() >= prefix.size() && line.compare(0, prefix.size(), prefix) == 0;
+}
+
+static inline bool line_contains(const std::string_view &line, const std::string_view &tag)
+{
+    return line.find(tag) != std::string_view::npos;
+}
+
+LayerGCodeLine CoolingBuffer::parse_line(const char *line_start, const char *line_end, const std::string &toolchange_prefix)
+{
+    LayerGCodeLine       line;
+    const std::string_view sline(line_start, line_end - line_start);
+    if (line_starts_with(sline, "G0 "))
+        line.type = LayerGCodeLine::TYPE_G0;
+    else if (line_starts_with(sline, "G1 "))
+        line.type = LayerGCodeLine::TYPE_G1;
+    else if (line_starts_with(sline, "G92 "))
+        line.type = LayerGCodeLine::TYPE_G92;
+    else if (line_starts_with(sline, "G2 "))
+        line.type = LayerGCodeLine::TYPE_G2;
+    else if (line_starts_with(sline, "G3 "))
+        line.type = LayerGCodeLine::TYPE_G3;
+    if (line.type != LayerGCodeLine::TYPE_OTHER) {
+        // G0, G1, G2, G3 or G92. Parse the axes.
+        const char *c = line_start + 3;
+        for (;;) {
+            // Skip whitespaces.
+            for (; c != line_end && (*c == ' ' || *c == '\t'); ++ c);
+            if (c == line_end || *c == ';')
+                break;
+            //BBS: Parse the axis.
+            size_t axis = (*c >= 'X' && *c <= 'Z') ? (*c - 'X') :
+                          (*c == 'E') ? 3 : (*c == 'F') ? 4 :
+                          (*c == 'I') ? 5 : (*c == 'J') ? 6 : size_t(-1);
+            if (axis != size_t(-1)) {
+                ++ c;
+                float value;
+                if (fast_float::from_chars(c, line_end, value).ec != std::errc()) {
+                    assert(is_decimal_separator_point()); // for atof
+                    value = float(atof(c));
+                }
+                line.values[axis] = value;
+                line.axes |= uint8_t(1 << axis);
+            }
+            // Skip this word.
+            for (; c != line_end && *c != ' ' && *c != '\t'; ++ c);
+        }
+        if (line_contains(sline, ";_EXTERNAL_PERIMETER"))
+            line.tags |= LayerGCodeLine::TAG_EXTERNAL_PERIMETER;
+        if (line_contains(sline, ";_WIPE"))
+            line.tags |= LayerGCodeLine::TAG_WIPE;
+        if (line_contains(sline, ";_EXTRUDE_SET_SPEED"))
+            line.tags |= LayerGCodeLine::TAG_EXTRUDE_SET_SPEED;
+    } else if (line_starts_with(sline, ";_EXTRUDE_END")) {
+        line.type = LayerGCodeLine::TYPE_EXTRUDE_END;
+    } else if (line_starts_with(sline, toolchange_prefix)) {
+        unsigned int new_extruder = 0;
+        auto ret = std::from_chars(sline.data() + toolchange_prefix.size(), sline.data() + sline.size(), new_extruder);
+        if (std::errc::invalid_argument != ret.ec) {
+            line.type        = LayerGCodeLine::TYPE_SET_TOOL;
+            line.extruder_id = new_extruder;
+        }
+    } else if (line_starts_with(sline, ";_OVERHANG_FAN_START")) {
+        line.type = LayerGCodeLine::TYPE_OVERHANG_FAN_START;
+    } else if (line_starts_with(sline, ";_OVERHANG_FAN_END")) {
+        line.type = LayerGCodeLine::TYPE_OVERHANG_FAN_END;
+    } else if (line_starts_with(sline, ";_SUPP_INTERFACE_FAN_START")) {
+        line.type = LayerGCodeLine::TYPE_SUPPORT_INTERFACE_FAN_START;
+    } else if (line_starts_with(sline, ";_SUPP_INTERFACE_FAN_END")) {
+        line.type = LayerGCodeLine::TYPE_SUPPORT_INTERFACE_FAN_END;
+    } else if (line_starts_with(sline, "G4 ")) {
+        // Parse the wait time, only the S parameter is taken into account.
+        line.type = LayerGCodeLine::TYPE_G4;
+        size_t pos_S = sline.find('S', 3);
+        assert(is_decimal_separator_point()); // for atof
+        line.values[0] = pos_S == std::string_view::npos ? 0.f : float(atof(line_start + pos_S + 1));
+    } else if (line_starts_with(sline, ";_FORCE_RESUME_FAN_SPEED")) {
+        line.type = LayerGCodeLine::TYPE_FORCE_RESUME_FAN;
+    }
+    return line;
+}
+
+// Collect the moves, which could be adjusted, from the parsed lines of the layer G-code.
+// Return the list of the moves, bucketed by an extruder.
+std::vector<PerExtruderAdjustments> CoolingBuffer::parse_layer_gcode(const std::string &gcode, const std::vector<LayerGCodeLine> &lines, std::vector<float> &current_pos) const
 {
     std::vector<PerExtruderAdjustments> per_extruder_adjustments(m_extruder_ids.size());
     std::vector<size_t>                 map_extruder_to_per_extruder_adjustment(m_num_extruders, 0);
@@ -340,50 +457,28 @@ std::vector<PerExtruderAdjustments> CoolingBuffer::parse_layer_gcode(const std::
 
     unsigned int      current_extruder  = m_current_extruder;
     PerExtruderAdjustments *adjustment  = &per_extruder_adjustments[map_extruder_to_per_extruder_adjustment[current_extruder]];
-    const char       *line_start = gcode.c_str();
-    const char       *line_end   = line_start;
     // Index of an existing CoolingLine of the current adjustment, which holds the feedrate setting command
     // for a sequence of extrusion moves.
     size_t            active_speed_modifier = size_t(-1);
 
-    for (; *line_start != 0; line_start = line_end) 
+    for (const LayerGCodeLine &parsed : lines)
     {
-        while (*line_end != '\n' && *line_end != 0)
-            ++ line_end;
-        // sline will not contain the trailing '\n'.
-        std::string sline(line_start, line_end);
         // CoolingLine will contain the trailing '\n'.
-        if (*line_end == '\n')
-            ++ line_end;
-        CoolingLine line(0, line_start - gcode.c_str(), line_end - gcode.c_str());
-        if (boost::starts_with(sline, "G0 "))
-            line.type = CoolingLine::TYPE_G0;
-        else if (boost::starts_with(sline, "G1 "))
-            line.type = CoolingLine::TYPE_G1;
-        else if (boost::starts_with(sline, "G92 "))
-            line.type = CoolingLine::TYPE_G92;
-        else if (boost::starts_with(sline, "G2 "))
-            line.type = CoolingLine::TYPE_G2;
-        else if (boost::starts_with(sline, "G3 "))
-            line.type = CoolingLine::TYPE_G3;
+        CoolingLine line(0, parsed.line_start, parsed.line_end);
+        switch (parsed.type) {
+        case LayerGCodeLine::TYPE_G0:  line.type = CoolingLine::TYPE_G0;  break;
+        case LayerGCodeLine::TYPE_G1:  line.type = CoolingLine::TYPE_G1;  break;
+        case LayerGCodeLine::TYPE_G92: line.type = CoolingLine::TYPE_G92; break;
+        case LayerGCodeLine::TYPE_G2:  line.type = CoolingLine::TYPE_G2;  break;
+        case LayerGCodeLine::TYPE_G3:  line.type = CoolingLine::TYPE_G3;  break;
+        default: break;
+        }
         if (line.type) {
             // G0, G1 or G92
-            // Parse the G-code line.
             std::vector<float> new_pos(current_pos);
-            const char *c = sline.data() + 3;
-            for (;;) {
-                // Skip whitespaces.
-                for (; *c == ' ' || *c == '\t'; ++ c);
-                if (*c == 0 || *c == ';')
-                    break;
-
-                assert(is_decimal_separator_point()); // for atof
-                //BBS: Parse the axis.
-                size_t axis = (*c >= 'X' && *c <= 'Z') ? (*c - 'X') :
-                              (*c == 'E') ? 3 : (*c == 'F') ? 4 :
-                              (*c == 'I') ? 5 : (*c == 'J') ? 6 : size_t(-1);
-                if (axis != size_t(-1)) {
-                    new_pos[axis] = float(atof(++c));
+            for (size_t axis = 0; axis < LayerGCodeLine::NUM_AXES; ++ axis)
+                if (parsed.has_axis(axis)) {
+                    new_pos[axis] = parsed.values[axis];
                     if (axis == 4) {
                         // Convert mm/min to mm/sec.
                         new_pos[4] /= 60.f;
@@ -395,11 +490,8 @@ std::vector<PerExtruderAdjustments> CoolingBuffer::parse_layer_gcode(const std::
                         new_pos[axis] += current_pos[axis - 5];
                     }
                 }
-                // Skip this word.
-                for (; *c != ' ' && *c != '\t' && *c != 0; ++ c);
-            }
-            bool external_perimeter = boost::contains(sline, ";_EXTERNAL_PERIMETER");
-            bool wipe               = boost::contains(sline, ";_WIPE");
+            bool external_perimeter = (parsed.tags & LayerGCodeLine::TAG_EXTERNAL_PERIMETER) != 0;
+            bool wipe               = (parsed.tags & LayerGCodeLine::TAG_WIPE) != 0;
             if (external_perimeter)
                 line.type |= CoolingLine::TYPE_EXTERNAL_PERIMETER;
             if (wipe)
@@ -412,7 +504,7 @@ std::vector<PerExtruderAdjustments> CoolingBuffer::parse_layer_gcode(const std::
             
             // ORCA: Dont slowdown external perimeters for layer time works by not marking the external perimeter as adjustable, 
             // hence the slowdown algorithm ignores it.
-            if (boost::contains(sline, ";_EXTRUDE_SET_SPEED") && ! wipe && adjust_external) {
+            if ((parsed.tags & LayerGCodeLine::TAG_EXTRUDE_SET_SPEED) && ! wipe && adjust_external) {
                 line.type |= CoolingLine::TYPE_ADJUSTABLE;
                 active_speed_modifier = adjustment->lines.size();
             }
@@ -472,46 +564,38 @@ std::vector<PerExtruderAdjustments> CoolingBuffer::parse_layer_gcode(const std::
                 }
             }
             current_pos = std::move(new_pos);
-        } else if (boost::starts_with(sline, ";_EXTRUDE_END")) {
+        } else if (parsed.type == LayerGCodeLine::TYPE_EXTRUDE_END) {
             line.type = CoolingLine::TYPE_EXTRUDE_END;
             active_speed_modifier = size_t(-1);
-        } else if (boost::starts_with(sline, m_toolchange_prefix)) {
-            unsigned int new_extruder = 0;
-            auto ret = std::from_chars(sline.data() + m_toolchange_prefix.size(), sline.data() + sline.size(), new_extruder);
-            if (std::errc::invalid_argument != ret.ec) {
-                // Only change extruder in case the number is meaningful. User could provide an out-of-range index through custom gcodes -
-                // those shall be ignored.
-                if (new_extruder < map_extruder_to_per_extruder_adjustment.size()) {
-                    if (new_extruder != current_extruder) {
-                        // Switch the tool.
-                        line.type        = CoolingLine::TYPE_SET_TOOL;
-                        current_extruder = new_extruder;
-                        adjustment       = &per_extruder_adjustments[map_extruder_to_per_extruder_adjustment[current_extruder]];
-                    }
-                } else {
-                    // Only log the error in case of MM printer. Single extruder printers likely ignore any T anyway.
-                    if (map_extruder_to_per_extruder_adjustment.size() > 1)
-                        BOOST_LOG_TRIVIAL(error) << "CoolingBuffer encountered an invalid toolchange, maybe from a custom gcode: " << sline;
+        } else if (parsed.type == LayerGCodeLine::TYPE_SET_TOOL) {
+            // Only change extruder in case the number is meaningful. User could provide an out-of-range index through custom gcodes -
+            // those shall be ignored.
+            unsigned int new_extruder = parsed.extruder_id;
+            if (new_extruder < map_extruder_to_per_extruder_adjustment.size()) {
+                if (new_extruder != current_extruder) {
+                    // Switch the tool.
+                    line.type        = CoolingLine::TYPE_SET_TOOL;
+                    current_extruder = new_extruder;
+                    adjustment       = &per_extruder_adjustments[map_extruder_to_per_extruder_adjustment[current_extruder]];
                 }
+            } else {
+                // Only log the error in case of MM printer. Single extruder printers likely ignore any T anyway.
+                if (map_extruder_to_per_extruder_adjustment.size() > 1)
+                    BOOST_LOG_TRIVIAL(error) << "CoolingBuffer encountered an invalid toolchange, maybe from a custom gcode: "
+                                             << std::string_view(gcode).substr(parsed.line_start, parsed.line_end - parsed.line_start);
             }
-        } else if (boost::starts_with(sline, ";_OVERHANG_FAN_START")) {
+        } else if (parsed.type == LayerGCodeLine::TYPE_OVERHANG_FAN_START) {
             line.type = CoolingLine::TYPE_OVERHANG_FAN_START;
-        } else if (boost::starts_with(sline, ";_OVERHANG_FAN_END")) {
+        } else if (parsed.type == LayerGCodeLine::TYPE_OVERHANG_FAN_END) {
             line.type = CoolingLine::TYPE_OVERHANG_FAN_END;
-        } else if (boost::starts_with(sline, ";_SUPP_INTERFACE_FAN_START")) {
+        } else if (parsed.type == LayerGCodeLine::TYPE_SUPPORT_INTERFACE_FAN_START) {
             line.type = CoolingLine::TYPE_SUPPORT_INTERFACE_FAN_START;
-        } else if (boost::starts_with(sline, ";_SUPP_INTERFACE_FAN_END")) {
+        } else if (parsed.type == LayerGCodeLine::TYPE_SUPPORT_INTERFACE_FAN_END) {
             line.type = CoolingLine::TYPE_SUPPORT_INTERFACE_FAN_END;
-        } else if (boost::starts_with(sline, "G4 ")) {
-            // Parse the wait time.
+        } else if (parsed.type == LayerGCodeLine::TYPE_G4) {
             line.type = CoolingLine::TYPE_G4;
-            size_t pos_S = sline.find('S', 3);
-            size_t pos_P = sline.find('P', 3);
-            assert(is_decimal_separator_point()); // for atof
-            line.time = line.time_max = float(
-                (pos_S > 0) ? atof(sline.c_str() + pos_S + 1) :
-                (pos_P > 0) ? atof(sline.c_str() + pos_P + 1) * 0.001 : 0.);
-        } else if (boost::starts_with(sline, ";_FORCE_RESUME_FAN_SPEED")) {
+            line.time = line.time_max = parsed.values[0];
+        } else if (parsed.type == LayerGCodeLine::TYPE_FORCE_RESUME_FAN) {
             line.type = CoolingLine::TYPE_FORCE_RESUME_FAN;
         }
         if (line.type != 0)
@@ -2,8 +2,10 @@
 #define slic3r_CoolingBuffer_hpp_
 
 #include "../libslic3r.h"
+#include <cstdint>
 #include <map>
 #include <string>
+#include <vector>
 
 namespace Slic3r {
 
@@ -11,6 +13,53 @@ class GCode;
 class Layer;
 struct PerExtruderAdjustments;
 
+// A line of the G-code of a layer, parsed into the values the CoolingBuffer works with.
+// A filter of GCode::process_layers() preceding the CoolingBuffer may pass the parsed lines of its output
+// together with the text, so that the CoolingBuffer does not parse the text again.
+struct LayerGCodeLine
+{
+    enum Type : uint8_t {
+        TYPE_OTHER,
+        TYPE_G0,
+        TYPE_G1,
+        TYPE_G2,
+        TYPE_G3,
+        TYPE_G4,
+        TYPE_G92,
+        TYPE_SET_TOOL,
+        TYPE_EXTRUDE_END,
+        TYPE_OVERHANG_FAN_START,
+        TYPE_OVERHANG_FAN_END,
+        TYPE_SUPPORT_INTERFACE_FAN_START,
+        TYPE_SUPPORT_INTERFACE_FAN_END,
+        TYPE_FORCE_RESUME_FAN,
+    };
+    // Tags found on a G0, G1, G2, G3 or G92 line.
+    enum Tag : uint8_t {
+        TAG_EXTERNAL_PERIMETER = 1 << 0,
+        TAG_WIPE               = 1 << 1,
+        TAG_EXTRUDE_SET_SPEED  = 1 << 2,
+    };
+    // X, Y, Z, E, F, I, J
+    static constexpr const size_t NUM_AXES = 7;
+
+    bool has_axis(size_t axis) const { return (this->axes & (1 << axis)) != 0; }
+
+    // Start of this line in the G-code of the layer.
+    size_t       line_start { 0 };
+    // End of this line in the G-code of the layer, including the trailing '\n'.
+    size_t       line_end { 0 };
+    Type         type { TYPE_OTHER };
+    // Combination of Tag.
+    uint8_t      tags { 0 };
+    // Axes found on a G0, G1, G2, G3 or G92 line, bit i is set if values[i] was provided.
+    uint8_t      axes { 0 };
+    // New extruder of TYPE_SET_TOOL.
+    unsigned int extruder_id { 0 };
+    // Values of the axes, F in mm/min. The wait time of G4 in seconds.
+    float        values[NUM_AXES] { 0.f };
+};
+
 // A standalone G-code filter, to control cooling of the print.
 // The G-code is processed per layer. Once a layer is collected, fan start / stop commands are edited
 // and the print is modified to stretch over a minimum layer time.
@@ -26,10 +75,16 @@ public:
     void        reset(const Vec3d &position);
     void        set_current_extruder(unsigned int extruder_id) { m_current_extruder = extruder_id; }
     std::string process_layer(std::string &&gcode, size_t layer_id, bool flush);
+    // Process G-code together with its lines parsed by parse_line(). If lines is empty, the G-code is parsed here.
+    std::string process_layer(std::string &&gcode, std::vector<LayerGCodeLine> &&lines, size_t layer_id, bool flush);
+
+    // Parse a single line of G-code, line_end points to the '\n' or to the end of the G-code.
+    // The line_start and line_end offsets of the returned line are to be filled in by the caller.
+    static LayerGCodeLine parse_line(const char *line_start, const char *line_end, const std::string &toolchange_prefix);
 
 private:
 	CoolingBuffer& operator=(const CoolingBuffer&) = delete;
-    std::vector<PerExtruderAdjustments> parse_layer_gcode(const std::string &gcode, std::vector<float> &current_pos) const;
+    std::vector<PerExtruderAdjustments> parse_layer_gcode(const std::string &gcode, const std::vector<LayerGCodeLine> &lines, std::vector<float> &current_pos) const;
     float       calculate_layer_slowdown(std::vector<PerExtruderAdjustments> &per_extruder_adjustments);
     // Apply slow down over G-code lines stored in per_extruder_adjustments, enable fan if needed.
     // Returns the adjusted G-code.
@@ -37,6 +92,8 @@ private:
 
     // G-code snippet cached for the support layers preceding an object layer.
     std::string                 m_gcode;
+    // Parsed lines of m_gcode.
+    std::vector<LayerGCodeLine> m_lines;
     // Internal data.
     // BBS: X,Y,Z,E,F,I,J
     std::vector<char>           m_axis;
@@ -14,12 +14,16 @@
 #include <boost/nowide/fstream.hpp>
 #include <boost/nowide/cstdio.hpp>
 #include <boost/filesystem/path.hpp>
+#include <boost/filesystem/operations.hpp>
+#include <boost/iostreams/device/mapped_file.hpp>
 
 #include <fast_float/fast_float.h>
 
 #include <float.h>
 #include <assert.h>
 #include <regex>
+#include <cmath>
+#include <cstring>
 #include <charconv>
 #include <string>
 #include <system_error>
@@ -101,6 +105,8 @@ const std::string GCodeProcessor::Flush_End_Tag = " FLUSH_END";
 
 const float GCodeProcessor::Wipe_Width = 0.05f;
 const float GCodeProcessor::Wipe_Height = 0.05f;
+// Fits the estimated printing time of both the normal and the stealth modes.
+const size_t GCodeProcessor::Post_Process_Slot_Width = 160;
 
 bool GCodeProcessor::s_IsBBLPrinter = true;
 
@@ -231,6 +237,8 @@ void GCodeProcessor::TimeMachine::CustomGCodeTime::reset()
 
 void GCodeProcessor::TimeMachine::reset()
 {
+    // Let the planner finish before its data is released.
+    synchronize();
     enabled = false;
     acceleration = 0.0f;
     max_acceleration = 0.0f;
@@ -245,6 +253,8 @@ void GCodeProcessor::TimeMachine::reset()
     prev.reset();
     gcode_time.reset();
     blocks = std::vector<TimeBlock>();
+    planner_blocks = std::vector<TimeBlock>();
+    planner_blocks_count = 0;
     g1_times_cache = std::vector<G1LinesCacheItem>();
     std::fill(moves_time.begin(), moves_time.end(), 0.0f);
     std::fill(roles_time.begin(), roles_time.end(), 0.0f);
@@ -260,6 +270,15 @@ void GCodeProcessor::TimeMachine::simulate_st_synchronize(float additional_time)
     calculate_time(0, additional_time);
 }
 
+void GCodeProcessor::TimeMachine::enable_parallel_planning(bool enable)
+{
+    synchronize();
+    if (enable && ! planner)
+        planner = std::make_unique<tbb::task_group>();
+    else if (! enable)
+        planner.reset();
+}
+
 static void planner_forward_pass_kernel(GCodeProcessor::TimeBlock& prev, GCodeProcessor::TimeBlock& curr)
 {
     // If the previous block is an acceleration block, but it is not long enough to complete the
@@ -332,10 +351,30 @@ static void recalculate_trapezoids(std::vector<GCodeProcessor::TimeBlock>& block
 
 void GCodeProcessor::TimeMachine::calculate_time(size_t keep_last_n_blocks, float additional_time)
 {
-    if (!enabled || blocks.size() < 2)
+    if (!enabled || queued_blocks() < 2)
         return;
 
-    assert(keep_last_n_blocks <= blocks.size());
+    assert(keep_last_n_blocks <= queued_blocks());
+    planner_blocks_count = keep_last_n_blocks;
+
+    if (planner) {
+        // Wait for the previous request, the windows of blocks have to be planned in order.
+        planner->wait();
+        planner->run([this, new_blocks = std::move(blocks), keep_last_n_blocks, additional_time]() {
+            planner_blocks.insert(planner_blocks.end(), new_blocks.begin(), new_blocks.end());
+            this->plan(keep_last_n_blocks, additional_time);
+        });
+        blocks.clear();
+    } else {
+        planner_blocks.insert(planner_blocks.end(), blocks.begin(), blocks.end());
+        blocks.clear();
+        this->plan(keep_last_n_blocks, additional_time);
+    }
+}
+
+void GCodeProcessor::TimeMachine::plan(size_t keep_last_n_blocks, float additional_time)
+{
+    std::vector<TimeBlock> &blocks = planner_blocks;
 
     // forward_pass
     for (size_t i = 0; i + 1 < blocks.size(); ++i) {
@@ -402,7 +441,43 @@ void GCodeProcessor::TimeProcessor::reset()
     machines[static_cast<size_t>(PrintEstimatedStatistics::ETimeMode::Normal)].enabled = true;
 }
 
-void GCodeProcessor::TimeProcessor::post_process(const std::string& filename, std::vector<GCodeProcessorResult::MoveVertex>& moves, std::vector<size_t>& lines_ends, size_t total_layer_num)
+std::string GCodeProcessor::TimeProcessor::estimated_printing_time_lines() const
+{
+    std::string out;
+    for (size_t i = 0; i < static_cast<size_t>(PrintEstimatedStatistics::ETimeMode::Count); ++i) {
+        const TimeMachine& machine = machines[i];
+        PrintEstimatedStatistics::ETimeMode mode = static_cast<PrintEstimatedStatistics::ETimeMode>(i);
+        if (mode == PrintEstimatedStatistics::ETimeMode::Normal || machine.enabled) {
+            char buf[128];
+            if (!s_IsBBLPrinter)
+                // SoftFever: compatibility with klipper_estimator
+                sprintf(buf, "; estimated printing time (normal mode) = %s\n", get_time_dhms(machine.time).c_str());
+            else
+                sprintf(buf, "; model printing time: %s; total estimated time: %s\n",
+                        get_time_dhms(machine.time - machine.prepare_time).c_str(),
+                        get_time_dhms(machine.time).c_str());
+            out += buf;
+        }
+    }
+    return out;
+}
+
+static std::string total_layer_number_line(size_t total_layer_num)
+{
+    char buf[128];
+    sprintf(buf, "; total layer number: %zd\n", total_layer_num);
+    return buf;
+}
+
+// Strips the padding of a slot reserved by GCodeProcessor::reserve_post_process_slot().
+static std::string_view rtrim_post_process_slot(std::string_view line)
+{
+    while (! line.empty() && line.back() == ' ')
+        line.remove_suffix(1);
+    return line;
+}
+
+void GCodeProcessor::TimeProcessor::post_process(const std::string& filename, GCodeProcessorResult::MoveVertices& moves, std::vector<size_t>& lines_ends, size_t total_layer_num)
 {
     FilePtr in{ boost::nowide::fopen(filename.c_str(), "rb") };
     if (in.f == nullptr)
@@ -482,8 +557,8 @@ void GCodeProcessor::TimeProcessor::post_process(const std::string& filename, st
     auto process_placeholders = [&](std::string& gcode_line) {
         int extra_lines_count = 0;
 
-        // remove trailing '\n'
-        auto line = std::string_view(gcode_line).substr(0, gcode_line.length() - 1);
+        // remove trailing '\n' and the padding of the slots reserved by reserve_post_process_slot()
+        auto line = rtrim_post_process_slot(std::string_view(gcode_line).substr(0, gcode_line.length() - 1));
 
         std::string ret;
         if (line.length() > 1) {
@@ -515,31 +590,11 @@ void GCodeProcessor::TimeProcessor::post_process(const std::string& filename, st
                 }
             }
             else if (line == reserved_tag(ETags::Estimated_Printing_Time_Placeholder)) {
-                for (size_t i = 0; i < static_cast<size_t>(PrintEstimatedStatistics::ETimeMode::Count); ++i) {
-                    const TimeMachine& machine = machines[i];
-                    PrintEstimatedStatistics::ETimeMode mode = static_cast<PrintEstimatedStatistics::ETimeMode>(i);
-                    if (mode == PrintEstimatedStatistics::ETimeMode::Normal || machine.enabled) {
-                        char buf[128];
-						if(!s_IsBBLPrinter)
-                            // SoftFever: compatibility with klipper_estimator
-                            sprintf(buf, "; estimated printing time (normal mode) = %s\n", get_time_dhms(machine.time).c_str());
-						else {
-                        //sprintf(buf, "; estimated printing time (%s mode) = %s\n",
-                        //    (mode == PrintEstimatedStatistics::ETimeMode::Normal) ? "normal" : "silent",
-                        //    get_time_dhms(machine.time).c_str());
-                        sprintf(buf, "; model printing time: %s; total estimated time: %s\n",
-                                get_time_dhms(machine.time - machine.prepare_time).c_str(),
-                                get_time_dhms(machine.time).c_str());
-                        }
-                        ret += buf;
-                    }
-                }
+                ret = this->estimated_printing_time_lines();
             }
             //BBS: write total layer number
             else if (line == reserved_tag(ETags::Total_Layer_Number_Placeholder)) {
-                char buf[128];
-                sprintf(buf, "; total layer number: %zd\n", total_layer_num);
-                ret += buf;
+                ret = total_layer_number_line(total_layer_num);
             }
         }
 
@@ -740,12 +795,13 @@ void GCodeProcessor::TimeProcessor::post_process(const std::string& filename, st
     // updates moves' gcode ids which have been modified by the insertion of the M73 lines
     unsigned int curr_offset_id = 0;
     unsigned int total_offset = 0;
-    for (GCodeProcessorResult::MoveVertex& move : moves) {
-        while (curr_offset_id < static_cast<unsigned int>(offsets.size()) && offsets[curr_offset_id].first <= move.gcode_id) {
+    for (size_t i = 0; i < moves.size(); ++i) {
+        unsigned int& gcode_id = moves.gcode_id(i);
+        while (curr_offset_id < static_cast<unsigned int>(offsets.size()) && offsets[curr_offset_id].first <= gcode_id) {
             total_offset += offsets[curr_offset_id].second;
             ++curr_offset_id;
         }
-        move.gcode_id += total_offset;
+        gcode_id += total_offset;
     }
 
     if (rename_file(out_path, filename)) {
@@ -902,12 +958,251 @@ void GCodeProcessor::UsedFilaments::process_caches(GCodeProcessor* processor)
     process_total_volume_cache(processor);
 }
 
+void GCodeProcessorResult::MoveVertices::clear()
+{
+    m_gcode_ids.clear();
+    m_types.clear();
+    m_extrusion_roles.clear();
+    m_extruder_ids.clear();
+    m_cp_color_ids.clear();
+    m_positions.clear();
+    m_delta_extruders.clear();
+    m_feedrates.clear();
+    m_widths.clear();
+    m_heights.clear();
+    m_mm3_per_mms.clear();
+    m_times.clear();
+    m_move_path_types.clear();
+    m_fan_speeds.clear();
+    m_temperatures.clear();
+    m_layer_durations.clear();
+    m_arcs.clear();
+}
+
+void GCodeProcessorResult::MoveVertices::reserve(size_t n)
+{
+    m_gcode_ids.reserve(n);
+    m_types.reserve(n);
+    m_extrusion_roles.reserve(n);
+    m_extruder_ids.reserve(n);
+    m_cp_color_ids.reserve(n);
+    m_positions.reserve(n);
+    m_delta_extruders.reserve(n);
+    m_feedrates.reserve(n);
+    m_widths.reserve(n);
+    m_heights.reserve(n);
+    m_mm3_per_mms.reserve(n);
+    m_times.reserve(n);
+    m_move_path_types.reserve(n);
+}
+
+void GCodeProcessorResult::MoveVertices::shrink_to_fit()
+{
+    m_gcode_ids.shrink_to_fit();
+    m_types.shrink_to_fit();
+    m_extrusion_roles.shrink_to_fit();
+    m_extruder_ids.shrink_to_fit();
+    m_cp_color_ids.shrink_to_fit();
+    m_positions.shrink_to_fit();
+    m_delta_extruders.shrink_to_fit();
+    m_feedrates.shrink_to_fit();
+    m_widths.shrink_to_fit();
+    m_heights.shrink_to_fit();
+    m_mm3_per_mms.shrink_to_fit();
+    m_times.shrink_to_fit();
+    m_move_path_types.shrink_to_fit();
+    m_fan_speeds.shrink_to_fit();
+    m_temperatures.shrink_to_fit();
+    m_layer_durations.shrink_to_fit();
+    m_arcs.shrink_to_fit();
+}
+
+size_t GCodeProcessorResult::MoveVertices::memsize() const
+{
+    size_t out = SLIC3R_STDVEC_MEMSIZE(m_gcode_ids, unsigned int) +
+        SLIC3R_STDVEC_MEMSIZE(m_types, EMoveType) +
+        SLIC3R_STDVEC_MEMSIZE(m_extrusion_roles, ExtrusionRole) +
+        SLIC3R_STDVEC_MEMSIZE(m_extruder_ids, unsigned char) +
+        SLIC3R_STDVEC_MEMSIZE(m_cp_color_ids, unsigned char) +
+        SLIC3R_STDVEC_MEMSIZE(m_positions, Vec3f) +
+        SLIC3R_STDVEC_MEMSIZE(m_delta_extruders, float) +
+        SLIC3R_STDVEC_MEMSIZE(m_feedrates, float) +
+        SLIC3R_STDVEC_MEMSIZE(m_widths, uint16_t) +
+        SLIC3R_STDVEC_MEMSIZE(m_heights, uint16_t) +
+        SLIC3R_STDVEC_MEMSIZE(m_mm3_per_mms, float) +
+        SLIC3R_STDVEC_MEMSIZE(m_times, float) +
+        SLIC3R_STDVEC_MEMSIZE(m_move_path_types, EMovePathType) +
+        m_fan_speeds.memsize() + m_temperatures.memsize() + m_layer_durations.memsize() +
+        SLIC3R_STDVEC_MEMSIZE(m_arcs, ArcData);
+    for (const ArcData &arc : m_arcs)
+        out += SLIC3R_STDVEC_MEMSIZE(arc.interpolation_points, Vec3f);
+    return out;
+}
+
+void GCodeProcessorResult::MoveVertices::push_back(const MoveVertex &move)
+{
+    m_gcode_ids.emplace_back(move.gcode_id);
+    m_types.emplace_back(move.type);
+    m_extrusion_roles.emplace_back(move.extrusion_role);
+    m_extruder_ids.emplace_back(move.extruder_id);
+    m_cp_color_ids.emplace_back(move.cp_color_id);
+    m_positions.emplace_back(move.position);
+    m_delta_extruders.emplace_back(move.delta_extruder);
+    m_feedrates.emplace_back(move.feedrate);
+    m_widths.emplace_back(float_to_half(move.width));
+    m_heights.emplace_back(float_to_half(move.height));
+    m_mm3_per_mms.emplace_back(move.mm3_per_mm);
+    m_times.emplace_back(move.time);
+    m_move_path_types.emplace_back(move.move_path_type);
+    m_fan_speeds.push_back(move.fan_speed);
+    m_temperatures.push_back(move.temperature);
+    m_layer_durations.push_back(move.layer_duration);
+    // The arc center and the interpolation points are meaningless for the other moves, don't store them.
+    if (move.is_arc_move())
+        m_arcs.push_back({ uint32_t(m_gcode_ids.size() - 1), move.arc_center_position, move.interpolation_points });
+}
+
+void GCodeProcessorResult::MoveVertices::set(size_t id, const MoveVertex &move)
+{
+    m_gcode_ids[id]       = move.gcode_id;
+    m_types[id]           = move.type;
+    m_extrusion_roles[id] = move.extrusion_role;
+    m_extruder_ids[id]    = move.extruder_id;
+    m_cp_color_ids[id]    = move.cp_color_id;
+    m_positions[id]       = move.position;
+    m_delta_extruders[id] = move.delta_extruder;
+    m_feedrates[id]       = move.feedrate;
+    m_widths[id]          = float_to_half(move.width);
+    m_heights[id]         = float_to_half(move.height);
+    m_mm3_per_mms[id]     = move.mm3_per_mm;
+    m_times[id]           = move.time;
+    m_move_path_types[id] = move.move_path_type;
+    m_fan_speeds.set(id, move.fan_speed);
+    m_temperatures.set(id, move.temperature);
+    m_layer_durations.set(id, move.layer_duration);
+    auto it = std::lower_bound(m_arcs.begin(), m_arcs.end(), id, [](const ArcData &arc, size_t id) { return arc.move_id < id; });
+    const bool has_arc = it != m_arcs.end() && it->move_id == id;
+    if (move.is_arc_move()) {
+        if (has_arc) {
+            it->center               = move.arc_center_position;
+            it->interpolation_points = move.interpolation_points;
+        } else
+            m_arcs.insert(it, { uint32_t(id), move.arc_center_position, move.interpolation_points });
+    } else if (has_arc)
+        m_arcs.erase(it);
+}
+
+void GCodeProcessorResult::MoveVertices::erase(size_t id)
+{
+    m_gcode_ids.erase(m_gcode_ids.begin() + id);
+    m_types.erase(m_types.begin() + id);
+    m_extrusion_roles.erase(m_extrusion_roles.begin() + id);
+    m_extruder_ids.erase(m_extruder_ids.begin() + id);
+    m_cp_color_ids.erase(m_cp_color_ids.begin() + id);
+    m_positions.erase(m_positions.begin() + id);
+    m_delta_extruders.erase(m_delta_extruders.begin() + id);
+    m_feedrates.erase(m_feedrates.begin() + id);
+    m_widths.erase(m_widths.begin() + id);
+    m_heights.erase(m_heights.begin() + id);
+    m_mm3_per_mms.erase(m_mm3_per_mms.begin() + id);
+    m_times.erase(m_times.begin() + id);
+    m_move_path_types.erase(m_move_path_types.begin() + id);
+    m_fan_speeds.erase(id);
+    m_temperatures.erase(id);
+    m_layer_durations.erase(id);
+    auto it = std::lower_bound(m_arcs.begin(), m_arcs.end(), id, [](const ArcData &arc, size_t id) { return arc.move_id < id; });
+    if (it != m_arcs.end() && it->move_id == id)
+        it = m_arcs.erase(it);
+    for (; it != m_arcs.end(); ++ it)
+        -- it->move_id;
+}
+
+GCodeProcessorResult::MoveVertex GCodeProcessorResult::MoveVertices::operator[](size_t id) const
+{
+    MoveVertex out;
+    out.gcode_id       = m_gcode_ids[id];
+    out.type           = m_types[id];
+    out.extrusion_role = m_extrusion_roles[id];
+    out.extruder_id    = m_extruder_ids[id];
+    out.cp_color_id    = m_cp_color_ids[id];
+    out.position       = m_positions[id];
+    out.delta_extruder = m_delta_extruders[id];
+    out.feedrate       = m_feedrates[id];
+    out.width          = half_to_float(m_widths[id]);
+    out.height         = half_to_float(m_heights[id]);
+    out.mm3_per_mm     = m_mm3_per_mms[id];
+    out.fan_speed      = m_fan_speeds[id];
+    out.temperature    = m_temperatures[id];
+    out.time           = m_times[id];
+    out.layer_duration = m_layer_durations[id];
+    out.move_path_type = m_move_path_types[id];
+    if (auto it = this->arc(id); it != m_arcs.end()) {
+        out.arc_center_position  = it->center;
+        out.interpolation_points = it->interpolation_points;
+    }
+    return out;
+}
+
+std::vector<GCodeProcessorResult::MoveVertices::ArcData>::const_iterator GCodeProcessorResult::MoveVertices::arc(size_t id) const
+{
+    if (! this->is_arc_move(id))
+        return m_arcs.end();
+    auto it = std::lower_bound(m_arcs.begin(), m_arcs.end(), id, [](const ArcData &arc, size_t id) { return arc.move_id < id; });
+    assert(it != m_arcs.end() && it->move_id == id);
+    return it;
+}
+
+const std::vector<Vec3f>& GCodeProcessorResult::MoveVertices::interpolation_points(size_t id) const
+{
+    static const std::vector<Vec3f> empty;
+    auto it = this->arc(id);
+    return it == m_arcs.end() ? empty : it->interpolation_points;
+}
+
+// IEEE 754 half precision conversion, rounding to the nearest even.
+uint16_t GCodeProcessorResult::MoveVertices::float_to_half(float value)
+{
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    const uint16_t sign = uint16_t((bits >> 16) & 0x8000);
+    uint32_t       abs  = bits & 0x7fffffff;
+    if (abs >= 0x7f800000)
+        // Infinity or NaN.
+        return sign | 0x7c00 | (abs > 0x7f800000 ? 0x200 : 0);
+    if (abs >= 0x477ff000)
+        // Rounds to infinity.
+        return sign | 0x7c00;
+    if (abs < 0x38800000) {
+        // Subnormal or zero.
+        float a;
+        memcpy(&a, &abs, sizeof(a));
+        return sign | uint16_t(std::nearbyint(a * 16777216.f));
+    }
+    abs += 0xc8000fff + ((abs >> 13) & 1);
+    return sign | uint16_t(abs >> 13);
+}
+
+float GCodeProcessorResult::MoveVertices::half_to_float(uint16_t value)
+{
+    const uint32_t sign     = uint32_t(value & 0x8000) << 16;
+    const uint32_t exponent = (value >> 10) & 0x1f;
+    const uint32_t mantissa = value & 0x3ff;
+    if (exponent == 0) {
+        const float out = float(mantissa) * (1.f / 16777216.f);
+        return sign ? - out : out;
+    }
+    const uint32_t bits = sign | ((exponent == 31 ? 0xff : exponent + 112) << 23) | (mantissa << 13);
+    float out;
+    memcpy(&out, &bits, sizeof(out));
+    return out;
+}
+
 #if ENABLE_GCODE_VIEWER_STATISTICS
 void GCodeProcessorResult::reset() {
     //BBS: add mutex for protection of gcode result
     lock();
 
-    moves = std::vector<GCodeProcessorResult::MoveVertex>();
+    moves = MoveVertices();
     printable_area = Pointfs();
     //BBS: add bed exclude area
     bed_exclude_area = Pointfs();
@@ -1039,10 +1334,21 @@ bool GCodeProcessor::contains_reserved_tags(const std::string& gcode, unsigned i
     return ret;
 }
 
+std::string GCodeProcessor::reserve_post_process_slot(const std::string& line) const
+{
+    std::string out = line;
+    if (this->can_post_process_in_place())
+        // Leave enough space for the used filament values, which may grow with the values recalculated by the post-processing.
+        out.append(std::max(Post_Process_Slot_Width, 2 * line.size()) - line.size() - 1, ' ');
+    out += '\n';
+    return out;
+}
+
 GCodeProcessor::GCodeProcessor()
 : m_options_z_corrector(m_result)
 {
     reset();
+    enable_parallel_time_estimation(true);
     m_time_processor.machines[static_cast<size_t>(PrintEstimatedStatistics::ETimeMode::Normal)].line_m73_main_mask = "M73 P%s R%s\n";
     m_time_processor.machines[static_cast<size_t>(PrintEstimatedStatistics::ETimeMode::Normal)].line_m73_stop_mask = "M73 C%s\n";
     m_time_processor.machines[static_cast<size_t>(PrintEstimatedStatistics::ETimeMode::Stealth)].line_m73_main_mask = "M73 Q%s S%s\n";
@@ -1468,6 +1774,12 @@ void GCodeProcessor::enable_stealth_time_estimator(bool enabled)
     m_time_processor.machines[static_cast<size_t>(PrintEstimatedStatistics::ETimeMode::Stealth)].enabled = enabled;
 }
 
+void GCodeProcessor::enable_parallel_time_estimation(bool enabled)
+{
+    for (TimeMachine &machine : m_time_processor.machines)
+        machine.enable_parallel_planning(enabled);
+}
+
 void GCodeProcessor::reset()
 {
     m_units = EUnits::Millimeters;
@@ -1536,6 +1848,8 @@ void GCodeProcessor::reset()
     m_detect_layer_based_on_tag = false;
 
     m_seams_count = 0;
+    m_post_process_lines.clear();
+    m_processed_buffer_size = 0;
     m_preheat_time = 0.f;
     m_preheat_steps = 1;
 
@@ -1609,7 +1923,7 @@ void GCodeProcessor::process_file(const std::string& filename, std::function<voi
     m_result.filename = filename;
     m_result.id = ++s_result_id;
     // 1st move must be a dummy move
-    m_result.moves.emplace_back(GCodeProcessorResult::MoveVertex());
+    m_result.moves.push_back(GCodeProcessorResult::MoveVertex());
     size_t parse_line_callback_cntr = 10000;
     m_parser.parse_file(filename, [this, cancel_callback, &parse_line_callback_cntr](GCodeReader& reader, const GCodeReader::GCodeLine& line) {
         if (-- parse_line_callback_cntr == 0) {
@@ -1637,11 +1951,15 @@ void GCodeProcessor::initialize(const std::string& filename)
     m_result.filename = filename;
     m_result.id = ++s_result_id;
     // 1st move must be a dummy move
-    m_result.moves.emplace_back(GCodeProcessorResult::MoveVertex());
+    m_result.moves.push_back(GCodeProcessorResult::MoveVertex());
 }
 
 void GCodeProcessor::process_buffer(const std::string &buffer)
 {
+    // The buffers are written into the exported G-code file one after another, keep the line ends for post_process_in_place().
+    for (const char *it = buffer.data(), *end = it + buffer.size(); (it = static_cast<const char*>(memchr(it, '\n', end - it))) != nullptr; ++ it)
+        m_result.lines_ends.emplace_back(m_processed_buffer_size + (it - buffer.data()) + 1);
+    m_processed_buffer_size += buffer.size();
     //FIXME maybe cache GCodeLine gline to be over multiple parse_buffer() invocations.
     m_parser.parse_buffer(buffer, [this](GCodeReader&, const GCodeReader::GCodeLine& line) { 
         this->process_gcode_line(line, false);
@@ -1651,10 +1969,10 @@ void GCodeProcessor::process_buffer(const std::string &buffer)
 void GCodeProcessor::finalize(bool post_process)
 {
     // update width/height of wipe moves
-    for (GCodeProcessorResult::MoveVertex& move : m_result.moves) {
-        if (move.type == EMoveType::Wipe) {
-            move.width = Wipe_Width;
-            move.height = Wipe_Height;
+    for (size_t i = 0; i < m_result.moves.size(); ++i) {
+        if (m_result.moves.type(i) == EMoveType::Wipe) {
+            m_result.moves.set_width(i, Wipe_Width);
+            m_result.moves.set_height(i, Wipe_Height);
         }
     }
 
@@ -1663,6 +1981,7 @@ void GCodeProcessor::finalize(bool post_process)
         TimeMachine& machine = m_time_processor.machines[i];
         TimeMachine::CustomGCodeTime& gcode_time = machine.gcode_time;
         machine.calculate_time();
+        machine.synchronize();
         if (gcode_time.needed && gcode_time.cache != 0.0f)
             gcode_time.times.push_back({ CustomGCode::ColorChange, gcode_time.cache });
     }
@@ -1676,15 +1995,17 @@ void GCodeProcessor::finalize(bool post_process)
     auto prepare_time = (it != time_mode.roles_times.end()) ? it->second : 0.0f;
 
     //update times for results
-    for (size_t i = 0; i < m_result.moves.size(); i++) {
+    const std::vector<float>& layer_times = m_result.print_statistics.modes[static_cast<size_t>(PrintEstimatedStatistics::ETimeMode::Normal)].layers_times;
+    m_result.moves.transform_layer_durations([&layer_times, prepare_time](float layer_duration) {
         //field layer_duration contains the layer id for the move in which the layer_duration has to be set.
-        size_t layer_id = size_t(m_result.moves[i].layer_duration);
-        std::vector<float>& layer_times = m_result.print_statistics.modes[static_cast<size_t>(PrintEstimatedStatistics::ETimeMode::Normal)].layers_times;
+        size_t layer_id = size_t(layer_duration);
         if (layer_times.size() > layer_id - 1 && layer_id > 0)
-            m_result.moves[i].layer_duration = layer_id == 1 ? std::max(0.f,layer_times[layer_id - 1] - prepare_time) : layer_times[layer_id - 1];
+            return layer_id == 1 ? std::max(0.f,layer_times[layer_id - 1] - prepare_time) : layer_times[layer_id - 1];
         else
-            m_result.moves[i].layer_duration = 0;
-    }
+            return 0.f;
+    });
+    // no more moves will be added, release the spare capacity of the columns
+    m_result.moves.shrink_to_fit();
     
 #if ENABLE_GCODE_VIEWER_DATA_CHECKING
     std::cout << "\n";
@@ -1692,7 +2013,8 @@ void GCodeProcessor::finalize(bool post_process)
     m_height_compare.output();
     m_width_compare.output();
 #endif // ENABLE_GCODE_VIEWER_DATA_CHECKING
-    if (post_process){
+    const bool post_processed_in_place = post_process && this->post_process_in_place();
+    if (post_process && ! post_processed_in_place){
         m_time_processor.post_process(m_result.filename, m_result.moves, m_result.lines_ends, m_layer_id);
     }
 #if ENABLE_GCODE_VIEWER_STATISTICS
@@ -1701,7 +2023,7 @@ void GCodeProcessor::finalize(bool post_process)
     //BBS: update slice warning
     update_slice_warnings();
 
-    if (post_process)
+    if (post_process && ! post_processed_in_place)
         run_post_process();
 }
 
@@ -1892,6 +2214,22 @@ void GCodeProcessor::apply_config_simplify3d(const std::string& filename)
     }
 }
 
+// Returns true for the comment lines replaced by the post-processing: the placeholder tags and the used filament statistics.
+static bool is_post_process_slot(const std::string_view comment)
+{
+    if (comment.size() < 4)
+        return false;
+    if (comment[1] == '_')
+        return boost::starts_with(comment, ";_GP_");
+    if (comment[1] != ' ' || (comment[2] != 'f' && comment[2] != 't'))
+        return false;
+    for (const std::string *mask : { &PrintStatistics::FilamentUsedMmMask, &PrintStatistics::FilamentUsedGMask, &PrintStatistics::TotalFilamentUsedGMask,
+                                     &PrintStatistics::FilamentUsedCm3Mask, &PrintStatistics::FilamentCostMask, &PrintStatistics::TotalFilamentCostMask })
+        if (boost::starts_with(comment, *mask))
+            return true;
+    return false;
+}
+
 void GCodeProcessor::process_gcode_line(const GCodeReader::GCodeLine& line, bool producers_enabled)
 {
 /* std::cout << line.raw() << std::endl; */
@@ -1974,6 +2312,12 @@ void GCodeProcessor::process_gcode_line(const GCodeReader::GCodeLine& line, bool
                 break;
             case 3:
                 switch (cmd[1]) {
+                case '7':
+                    switch (cmd[2]) {
+                    case '3': { m_post_process_lines.emplace_back(m_line_id); break; } // Set print progress, removed by the post-processing if disable_m73
+                    default: break;
+                    }
+                    break;
                 case '8':
                     switch (cmd[2]) {
                     case '2': { process_M82(line); break; }  // Set extruder to absolute mode
@@ -2098,11 +2442,14 @@ void GCodeProcessor::process_gcode_line(const GCodeReader::GCodeLine& line, bool
         }
     }
     else {
-        const std::string &comment = line.raw();
-        if (comment.length() > 2 && comment.front() == ';')
+        const std::string_view comment = line.raw_view();
+        if (comment.length() > 2 && comment.front() == ';') {
+            if (is_post_process_slot(comment))
+                m_post_process_lines.emplace_back(m_line_id);
             // Process tags embedded into comments. Tag comments always start at the start of a line
             // with a comment and continue with a tag without any whitespace separator.
             process_tags(comment.substr(1), producers_enabled);
+        }
     }
 }
 
@@ -3180,7 +3527,7 @@ void GCodeProcessor::process_G1(const GCodeReader::GCodeLine& line, const std::o
 
         // calculates block entry feedrate
         float vmax_junction = curr.safe_feedrate;
-        if (!blocks.empty() && prev.feedrate > PREVIOUS_FEEDRATE_THRESHOLD) {
+        if (machine.queued_blocks() > 0 && prev.feedrate > PREVIOUS_FEEDRATE_THRESHOLD) {
             bool prev_speed_larger = prev.feedrate > block.feedrate_profile.cruise;
             float smaller_speed_factor = prev_speed_larger ? (block.feedrate_profile.cruise / prev.feedrate) : (prev.feedrate / block.feedrate_profile.cruise);
             // Pick the smaller of the nominal speeds. Higher speed shall not be achieved at the junction during coasting.
@@ -3276,7 +3623,7 @@ void GCodeProcessor::process_G1(const GCodeReader::GCodeLine& line, const std::o
 
         blocks.push_back(block);
 
-        if (blocks.size() > TimeProcessor::Planner::refresh_threshold)
+        if (machine.queued_blocks() > TimeProcessor::Planner::refresh_threshold)
             machine.calculate_time(TimeProcessor::Planner::queue_size);
     }
 
@@ -3286,7 +3633,7 @@ void GCodeProcessor::process_G1(const GCodeReader::GCodeLine& line, const std::o
         // check for seam starting vertex
         if (type == EMoveType::Extrude && m_extrusion_role == erExternalPerimeter) {
             //BBS: m_result.moves.back().position has plate offset, must minus plate offset before calculate the real seam position
-            const Vec3f new_pos = m_result.moves.back().position - m_extruder_offsets[m_extruder_id] - plate_offset;
+            const Vec3f new_pos = m_result.moves.position(m_result.moves.size() - 1) - m_extruder_offsets[m_extruder_id] - plate_offset;
             if (!m_seams_detector.has_first_vertex()) {
                 m_seams_detector.set_first_vertex(new_pos);
             } else if (m_detect_layer_based_on_tag) {
@@ -3305,7 +3652,7 @@ void GCodeProcessor::process_G1(const GCodeReader::GCodeLine& line, const std::o
 
             const Vec3f curr_pos(m_end_position[X], m_end_position[Y], m_end_position[Z]);
             //BBS: m_result.moves.back().position has plate offset, must minus plate offset before calculate the real seam position
-            const Vec3f new_pos = m_result.moves.back().position - m_extruder_offsets[m_extruder_id] - plate_offset;
+            const Vec3f new_pos = m_result.moves.position(m_result.moves.size() - 1) - m_extruder_offsets[m_extruder_id] - plate_offset;
             const std::optional<Vec3f> first_vertex = m_seams_detector.get_first_vertex();
             // the threshold value = 0.0625f == 0.25 * 0.25 is arbitrary, we may find some smarter condition later
 
@@ -3320,7 +3667,7 @@ void GCodeProcessor::process_G1(const GCodeReader::GCodeLine& line, const std::o
     }
     else if (type == EMoveType::Extrude && m_extrusion_role == erExternalPerimeter) {
         m_seams_detector.activate(true);
-        m_seams_detector.set_first_vertex(m_result.moves.back().position - m_extruder_offsets[m_extruder_id] - plate_offset);
+        m_seams_detector.set_first_vertex(m_result.moves.position(m_result.moves.size() - 1) - m_extruder_offsets[m_extruder_id] - plate_offset);
     }
 
     if (m_detect_layer_based_on_tag && !m_result.spiral_vase_layers.empty()) {
@@ -3615,7 +3962,7 @@ void  GCodeProcessor::process_G2_G3(const GCodeReader::GCodeLine& line)
         //BBS: calculates block entry feedrate
         static const float PREVIOUS_FEEDRATE_THRESHOLD = 0.0001f;
         float vmax_junction = curr.safe_feedrate;
-        if (!blocks.empty() && prev.feedrate > PREVIOUS_FEEDRATE_THRESHOLD) {
+        if (machine.queued_blocks() > 0 && prev.feedrate > PREVIOUS_FEEDRATE_THRESHOLD) {
             bool prev_speed_larger = prev.feedrate > block.feedrate_profile.cruise;
             float smaller_speed_factor = prev_speed_larger ? (block.feedrate_profile.cruise / prev.feedrate) : (prev.feedrate / block.feedrate_profile.cruise);
             //BBS: Pick the smaller of the nominal speeds. Higher speed shall not be achieved at the junction during coasting.
@@ -3710,7 +4057,7 @@ void  GCodeProcessor::process_G2_G3(const GCodeReader::GCodeLine& line)
 
         blocks.push_back(block);
 
-        if (blocks.size() > TimeProcessor::Planner::refresh_threshold)
+        if (machine.queued_blocks() > TimeProcessor::Planner::refresh_threshold)
             machine.calculate_time(TimeProcessor::Planner::queue_size);
     }
 
@@ -3720,7 +4067,7 @@ void  GCodeProcessor::process_G2_G3(const GCodeReader::GCodeLine& line)
     if (m_seams_detector.is_active()) {
         //BBS: check for seam starting vertex
         if (type == EMoveType::Extrude && m_extrusion_role == erExternalPerimeter) {
-            const Vec3f new_pos = m_result.moves.back().position - m_extruder_offsets[m_extruder_id] - plate_offset;
+            const Vec3f new_pos = m_result.moves.position(m_result.moves.size() - 1) - m_extruder_offsets[m_extruder_id] - plate_offset;
             if (!m_seams_detector.has_first_vertex()) {
                 m_seams_detector.set_first_vertex(new_pos);
             } else if (m_detect_layer_based_on_tag) {
@@ -3737,7 +4084,7 @@ void  GCodeProcessor::process_G2_G3(const GCodeReader::GCodeLine& line)
                 m_end_position[X] = pos.x(); m_end_position[Y] = pos.y(); m_end_position[Z] = pos.z();
             };
             const Vec3f curr_pos(m_end_position[X], m_end_position[Y], m_end_position[Z]);
-            const Vec3f new_pos = m_result.moves.back().position - m_extruder_offsets[m_extruder_id] - plate_offset;
+            const Vec3f new_pos = m_result.moves.position(m_result.moves.size() - 1) - m_extruder_offsets[m_extruder_id] - plate_offset;
             const std::optional<Vec3f> first_vertex = m_seams_detector.get_first_vertex();
             //BBS: the threshold value = 0.0625f == 0.25 * 0.25 is arbitrary, we may find some smarter condition later
 
@@ -3752,7 +4099,7 @@ void  GCodeProcessor::process_G2_G3(const GCodeReader::GCodeLine& line)
     }
     else if (type == EMoveType::Extrude && m_extrusion_role == erExternalPerimeter) {
         m_seams_detector.activate(true);
-        m_seams_detector.set_first_vertex(m_result.moves.back().position - m_extruder_offsets[m_extruder_id] - plate_offset);
+        m_seams_detector.set_first_vertex(m_result.moves.position(m_result.moves.size() - 1) - m_extruder_offsets[m_extruder_id] - plate_offset);
     }
 
     // Orca: we now use spiral_vase_layers for proper layer detect when scarf joint is enabled,
@@ -4349,6 +4696,55 @@ static void update_lines_ends_and_out_file_pos(const std::string& out_string, st
         *out_file_pos += out_string.size();
 }
 
+// Used filament statistics lines exported by GCode (see PrintStatistics::FilamentUsedMmMask etc.) paired with the values
+// calculated from the processed G-code.
+using UsedFilamentLines = std::vector<std::pair<std::string, std::vector<double>>>;
+
+static UsedFilamentLines used_filament_stats(const GCodeProcessorResult& result)
+{
+    std::vector<double> filament_mm(result.extruders_count, 0.0);
+    std::vector<double> filament_cm3(result.extruders_count, 0.0);
+    std::vector<double> filament_g(result.extruders_count, 0.0);
+    std::vector<double> filament_cost(result.extruders_count, 0.0);
+
+    double filament_total_g = 0.0;
+    double filament_total_cost = 0.0;
+
+    for (const auto& [id, volume] : result.print_statistics.total_volumes_per_extruder) {
+        filament_mm[id] = volume / (static_cast<double>(M_PI) * sqr(0.5 * result.filament_diameters[id]));
+        filament_cm3[id] = volume * 0.001;
+        filament_g[id] = filament_cm3[id] * double(result.filament_densities[id]);
+        filament_cost[id] = filament_g[id] * double(result.filament_costs[id]) * 0.001;
+        filament_total_g += filament_g[id];
+        filament_total_cost += filament_cost[id];
+    }
+
+    return {
+        { PrintStatistics::FilamentUsedMmMask,     std::move(filament_mm) },
+        { PrintStatistics::FilamentUsedGMask,      std::move(filament_g) },
+        { PrintStatistics::TotalFilamentUsedGMask, { filament_total_g } },
+        { PrintStatistics::FilamentUsedCm3Mask,    std::move(filament_cm3) },
+        { PrintStatistics::FilamentCostMask,       std::move(filament_cost) },
+        { PrintStatistics::TotalFilamentCostMask,  { filament_total_cost } }
+    };
+}
+
+// Replaces a used filament statistics line with the recalculated values. Returns false if gcode_line is not such a line.
+static bool replace_used_filament_line(std::string& gcode_line, const UsedFilamentLines& used_filament_lines)
+{
+    for (const auto& [tag, values] : used_filament_lines)
+        if (boost::algorithm::starts_with(gcode_line, tag)) {
+            gcode_line = tag;
+            char buf[1024];
+            for (size_t i = 0; i < values.size(); ++i) {
+                sprintf(buf, i == values.size() - 1 ? " %.2lf\n" : " %.2lf,", values[i]);
+                gcode_line += buf;
+            }
+            return true;
+        }
+    return false;
+}
+
 void GCodeProcessor::run_post_process()
 {
     FilePtr in{ boost::nowide::fopen(m_result.filename.c_str(), "rb") };
@@ -4361,22 +4757,7 @@ void GCodeProcessor::run_post_process()
     if (out.f == nullptr)
         throw Slic3r::RuntimeError(std::string("GCode processor post process export failed.\nCannot open file for writing.\n"));
 
-    std::vector<double> filament_mm(m_result.extruders_count, 0.0);
-    std::vector<double> filament_cm3(m_result.extruders_count, 0.0);
-    std::vector<double> filament_g(m_result.extruders_count, 0.0);
-    std::vector<double> filament_cost(m_result.extruders_count, 0.0);
-
-    double filament_total_g = 0.0;
-    double filament_total_cost = 0.0;
-
-    for (const auto& [id, volume] : m_result.print_statistics.total_volumes_per_extruder) {
-        filament_mm[id] = volume / (static_cast<double>(M_PI) * sqr(0.5 * m_result.filament_diameters[id]));
-        filament_cm3[id] = volume * 0.001;
-        filament_g[id] = filament_cm3[id] * double(m_result.filament_densities[id]);
-        filament_cost[id] = filament_g[id] * double(m_result.filament_costs[id]) * 0.001;
-        filament_total_g += filament_g[id];
-        filament_total_cost += filament_cost[id];
-    }
+    const UsedFilamentLines used_filament_lines = used_filament_stats(m_result);
 
     double total_g_wipe_tower = m_print->print_statistics().total_wipe_tower_filament;
 
@@ -4688,12 +5069,13 @@ void GCodeProcessor::run_post_process()
 
         void synchronize_moves(GCodeProcessorResult& result) const {
             auto it = m_gcode_lines_map.begin();
-            for (GCodeProcessorResult::MoveVertex& move : result.moves) {
-                while (it != m_gcode_lines_map.end() && it->first < move.gcode_id) {
+            for (size_t i = 0; i < result.moves.size(); ++i) {
+                unsigned int& gcode_id = result.moves.gcode_id(i);
+                while (it != m_gcode_lines_map.end() && it->first < gcode_id) {
                     ++it;
                 }
-                if (it != m_gcode_lines_map.end() && it->first == move.gcode_id)
-                    move.gcode_id = it->second;
+                if (it != m_gcode_lines_map.end() && it->first == gcode_id)
+                    gcode_id = it->second;
             }
         }
 
@@ -4722,12 +5104,12 @@ void GCodeProcessor::run_post_process()
     auto process_placeholders = [&](std::string& gcode_line) {
         bool processed = false;
 
-        // remove trailing '\n'
-        auto line = std::string_view(gcode_line).substr(0, gcode_line.length() - 1);
+        // remove trailing '\n' and the padding of the slots reserved by reserve_post_process_slot()
+        auto line = rtrim_post_process_slot(std::string_view(gcode_line).substr(0, gcode_line.length() - 1));
 
         if (line.length() > 1) {
             line = line.substr(1);
-            if (true &&
+            if (!m_time_processor.disable_m73 &&
                 (line == reserved_tag(ETags::First_Line_M73_Placeholder) || line == reserved_tag(ETags::Last_Line_M73_Placeholder))) {
                 for (size_t i = 0; i < static_cast<size_t>(PrintEstimatedStatistics::ETimeMode::Count); ++i) {
                     const TimeMachine& machine = m_time_processor.machines[i];
@@ -4784,27 +5166,7 @@ void GCodeProcessor::run_post_process()
             return false;
         if (const char c = gcode_line[2]; c != 'f' && c != 't')
             return false;
-        auto process_tag = [](std::string& gcode_line, const std::string_view tag, const std::vector<double>& values) {
-            if (boost::algorithm::starts_with(gcode_line, tag)) {
-                gcode_line = tag;
-                char buf[1024];
-                for (size_t i = 0; i < values.size(); ++i) {
-                    sprintf(buf, i == values.size() - 1 ? " %.2lf\n" : " %.2lf,", values[i]);
-                    gcode_line += buf;
-                }
-                return true;
-            }
-            return false;
-        };
-
-        bool ret = false;
-        ret |= process_tag(gcode_line, PrintStatistics::FilamentUsedMmMask, filament_mm);
-        ret |= process_tag(gcode_line, PrintStatistics::FilamentUsedGMask, filament_g);
-        ret |= process_tag(gcode_line, PrintStatistics::TotalFilamentUsedGMask, { filament_total_g });
-        ret |= process_tag(gcode_line, PrintStatistics::FilamentUsedCm3Mask, filament_cm3);
-        ret |= process_tag(gcode_line, PrintStatistics::FilamentCostMask, filament_cost);
-        ret |= process_tag(gcode_line, PrintStatistics::TotalFilamentCostMask, { filament_total_cost });
-        return ret;
+        return replace_used_filament_line(gcode_line, used_filament_lines);
     };
 
     // check for temporary lines
@@ -4834,7 +5196,7 @@ void GCodeProcessor::run_post_process()
         &g1_times_cache_it, &last_exported_main, &last_exported_stop,
         &export_lines]
         (const size_t g1_lines_counter) {
-        if (true) {
+        if (!m_time_processor.disable_m73) {
             for (size_t i = 0; i < static_cast<size_t>(PrintEstimatedStatistics::ETimeMode::Count); ++i) {
                 const TimeMachine& machine = m_time_processor.machines[i];
                 if (machine.enabled) {
@@ -5063,6 +5425,95 @@ void GCodeProcessor::run_post_process()
             "Is " + out_path + " locked?" + '\n');
 }
 
+bool GCodeProcessor::post_process_in_place()
+{
+    // Lines M73 are inserted after the moves unless disable_m73, lines M104 are inserted before the tool changes if backtrace_enabled.
+    if (! this->can_post_process_in_place() || m_result.lines_ends.size() != m_line_id)
+        return false;
+    if (m_post_process_lines.empty())
+        return true;
+
+    boost::iostreams::mapped_file file;
+    try {
+        file.open(m_result.filename, boost::iostreams::mapped_file::readwrite);
+    } catch (const std::exception &ex) {
+        BOOST_LOG_TRIVIAL(warning) << "GCodeProcessor: can not map " << m_result.filename << " to post-process it in place, reason = " << ex.what();
+        return false;
+    }
+    if (file.size() != m_processed_buffer_size)
+        return false;
+
+    // Format all the replacements first, the file is only modified if all of them fit into their slots.
+    const UsedFilamentLines used_filament_lines = used_filament_stats(m_result);
+    std::vector<std::string> replacements;
+    replacements.reserve(m_post_process_lines.size());
+    for (unsigned int line_id : m_post_process_lines) {
+        const size_t     begin = line_id > 1 ? m_result.lines_ends[line_id - 2] : 0;
+        std::string_view slot(file.const_data() + begin, m_result.lines_ends[line_id - 1] - begin);
+        std::string_view line = rtrim_post_process_slot(slot.substr(0, slot.size() - 1));
+        std::string      replacement;
+        if (line.size() > 1 && line.front() == ';') {
+            if (line.substr(1) == reserved_tag(ETags::Estimated_Printing_Time_Placeholder))
+                replacement = m_time_processor.estimated_printing_time_lines();
+            else if (line.substr(1) == reserved_tag(ETags::Total_Layer_Number_Placeholder))
+                replacement = total_layer_number_line(m_layer_id);
+            else {
+                replacement = std::string(line) + '\n';
+                if (! replace_used_filament_line(replacement, used_filament_lines))
+                    replacement.clear();
+            }
+        }
+        // Lines M73 and the M73 placeholders are removed by the post-processing.
+        if (replacement.empty() || replacement.back() != '\n' || replacement.size() > slot.size())
+            return false;
+        replacements.emplace_back(std::move(replacement));
+    }
+
+    // Write the replacements over their slots, padding them with spaces to the width of the slot, thus the rest of the file
+    // stays in place. A replacement may span more lines than its slot, collect the new line ends
+    // and update the moves' gcode ids accordingly.
+    char                                              *data = file.data();
+    size_t                                             next_line_end = 0;
+    std::vector<size_t>                                lines_ends;
+    std::vector<std::pair<unsigned int, unsigned int>> offsets;
+    lines_ends.reserve(m_result.lines_ends.size() + 2 * replacements.size());
+    for (size_t i = 0; i < replacements.size(); ++ i) {
+        const unsigned int line_id = m_post_process_lines[i];
+        const size_t       begin   = line_id > 1 ? m_result.lines_ends[line_id - 2] : 0;
+        const size_t       end     = m_result.lines_ends[line_id - 1];
+        for (; next_line_end + 1 < line_id; ++ next_line_end)
+            lines_ends.emplace_back(m_result.lines_ends[next_line_end]);
+        // The last line of the replacement is a comment, the padding is appended to it.
+        const std::string &replacement = replacements[i];
+        memcpy(data + begin, replacement.data(), replacement.size() - 1);
+        memset(data + begin + replacement.size() - 1, ' ', end - begin - replacement.size());
+        data[end - 1] = '\n';
+        unsigned int num_lines = 1;
+        for (size_t pos = replacement.find('\n'); pos + 1 < replacement.size(); pos = replacement.find('\n', pos + 1), ++ num_lines)
+            lines_ends.emplace_back(begin + pos + 1);
+        lines_ends.emplace_back(end);
+        if (num_lines > 1)
+            offsets.push_back({ line_id, num_lines - 1 });
+        next_line_end = line_id;
+    }
+    for (; next_line_end < m_result.lines_ends.size(); ++ next_line_end)
+        lines_ends.emplace_back(m_result.lines_ends[next_line_end]);
+    file.close();
+    m_result.lines_ends = std::move(lines_ends);
+
+    if (! offsets.empty()) {
+        size_t       curr_offset_id = 0;
+        unsigned int total_offset   = 0;
+        for (size_t i = 0; i < m_result.moves.size(); ++ i) {
+            unsigned int &gcode_id = m_result.moves.gcode_id(i);
+            while (curr_offset_id < offsets.size() && offsets[curr_offset_id].first < gcode_id)
+                total_offset += offsets[curr_offset_id ++].second;
+            gcode_id += total_offset;
+        }
+    }
+    return true;
+}
+
 void GCodeProcessor::store_move_vertex(EMoveType type, EMovePathType path_type)
 {
     m_last_line_id = (type == EMoveType::Color_change || type == EMoveType::Pause_Print || type == EMoveType::Custom_GCode) ?
@@ -5114,6 +5565,8 @@ void GCodeProcessor::store_move_vertex(EMoveType type, EMovePathType path_type)
             if (!machine.enabled)
                 continue;
 
+            // The planner updates the stop times.
+            machine.synchronize();
             machine.stop_times.push_back({ m_g1_line_id, 0.0f });
         }
     }
@@ -5265,6 +5718,7 @@ void GCodeProcessor::process_custom_gcode_time(CustomGCode::Type code)
         //FIXME this simulates st_synchronize! is it correct?
         // The estimated time may be longer than the real print time.
         machine.simulate_st_synchronize();
+        machine.synchronize();
         if (gcode_time.cache != 0.0f) {
             gcode_time.times.push_back({ code, gcode_time.cache });
             gcode_time.cache = 0.0f;
@@ -8,13 +8,18 @@
 #include "libslic3r/CustomGCode.hpp"
 
 #include <cstdint>
+#include <algorithm>
 #include <array>
+#include <iterator>
 #include <vector>
+#include <memory>
 #include <mutex>
 #include <string>
 #include <string_view>
 #include <optional>
 
+#include <tbb/task_group.h>
+
 namespace Slic3r {
 
 class Print;
@@ -183,6 +188,209 @@ class Print;
             }
         };
 
+        // Moves stored column by column (struct of arrays) to reduce the memory footprint of G-codes with millions of moves
+        // and to let the passes which scan only a few fields touch only their columns.
+        // Widths and heights are stored as half precision floats, the rarely changing fan speed, temperature and layer duration
+        // are run length encoded and the arc data are only stored for the arc moves.
+        // Accessing a whole move returns a decoded copy of it, single fields are read and modified through the column accessors.
+        class MoveVertices
+        {
+        public:
+            class const_iterator
+            {
+            public:
+                using iterator_category = std::random_access_iterator_tag;
+                using value_type        = MoveVertex;
+                using difference_type   = std::ptrdiff_t;
+                using pointer           = void;
+                using reference         = MoveVertex;
+
+                const_iterator() = default;
+                const_iterator(const MoveVertices *vertices, size_t id) : m_vertices(vertices), m_id(id) {}
+
+                MoveVertex      operator*() const { return (*m_vertices)[m_id]; }
+                MoveVertex      operator[](difference_type n) const { return (*m_vertices)[m_id + n]; }
+                const_iterator& operator++() { ++ m_id; return *this; }
+                const_iterator  operator++(int) { const_iterator out = *this; ++ m_id; return out; }
+                const_iterator& operator--() { -- m_id; return *this; }
+                const_iterator  operator--(int) { const_iterator out = *this; -- m_id; return out; }
+                const_iterator& operator+=(difference_type n) { m_id += n; return *this; }
+                const_iterator& operator-=(difference_type n) { m_id -= n; return *this; }
+                const_iterator  operator+(difference_type n) const { return const_iterator(m_vertices, m_id + n); }
+                const_iterator  operator-(difference_type n) const { return const_iterator(m_vertices, m_id - n); }
+                difference_type operator-(const const_iterator &rhs) const { return difference_type(m_id) - difference_type(rhs.m_id); }
+                bool            operator==(const const_iterator &rhs) const { return m_id == rhs.m_id; }
+                bool            operator!=(const const_iterator &rhs) const { return m_id != rhs.m_id; }
+                bool            operator<(const const_iterator &rhs) const { return m_id < rhs.m_id; }
+                size_t          id() const { return m_id; }
+
+            private:
+                const MoveVertices *m_vertices { nullptr };
+                size_t              m_id { 0 };
+            };
+
+            size_t          size() const { return m_gcode_ids.size(); }
+            bool            empty() const { return m_gcode_ids.empty(); }
+            void            clear();
+            void            reserve(size_t n);
+            void            shrink_to_fit();
+            // Memory allocated by all the columns, in bytes.
+            size_t          memsize() const;
+
+            void            push_back(const MoveVertex &move);
+            // Replaces the move with the given id.
+            void            set(size_t id, const MoveVertex &move);
+            void            erase(size_t id);
+
+            MoveVertex      operator[](size_t id) const;
+            MoveVertex      back() const { return (*this)[this->size() - 1]; }
+            const_iterator  begin() const { return const_iterator(this, 0); }
+            const_iterator  end() const { return const_iterator(this, this->size()); }
+
+            unsigned int    gcode_id(size_t id) const { return m_gcode_ids[id]; }
+            unsigned int&   gcode_id(size_t id) { return m_gcode_ids[id]; }
+            EMoveType       type(size_t id) const { return m_types[id]; }
+            ExtrusionRole   extrusion_role(size_t id) const { return m_extrusion_roles[id]; }
+            unsigned char   extruder_id(size_t id) const { return m_extruder_ids[id]; }
+            unsigned char   cp_color_id(size_t id) const { return m_cp_color_ids[id]; }
+            const Vec3f&    position(size_t id) const { return m_positions[id]; }
+            float           delta_extruder(size_t id) const { return m_delta_extruders[id]; }
+            float           feedrate(size_t id) const { return m_feedrates[id]; }
+            float           width(size_t id) const { return half_to_float(m_widths[id]); }
+            void            set_width(size_t id, float width) { m_widths[id] = float_to_half(width); }
+            float           height(size_t id) const { return half_to_float(m_heights[id]); }
+            void            set_height(size_t id, float height) { m_heights[id] = float_to_half(height); }
+            float           mm3_per_mm(size_t id) const { return m_mm3_per_mms[id]; }
+            float           volumetric_rate(size_t id) const { return m_feedrates[id] * m_mm3_per_mms[id]; }
+            float           fan_speed(size_t id) const { return m_fan_speeds[id]; }
+            float           temperature(size_t id) const { return m_temperatures[id]; }
+            float           time(size_t id) const { return m_times[id]; }
+            float           layer_duration(size_t id) const { return m_layer_durations[id]; }
+            EMovePathType   move_path_type(size_t id) const { return m_move_path_types[id]; }
+            bool            is_arc_move(size_t id) const {
+                return m_move_path_types[id] == EMovePathType::Arc_move_ccw || m_move_path_types[id] == EMovePathType::Arc_move_cw;
+            }
+            // Empty for the moves which are not arc moves.
+            const std::vector<Vec3f>& interpolation_points(size_t id) const;
+            bool            is_arc_move_with_interpolation_points(size_t id) const { return this->is_arc_move(id) && ! this->interpolation_points(id).empty(); }
+
+            // Replaces the layer duration of all moves by fn(layer duration).
+            template<typename Fn> void transform_layer_durations(Fn &&fn) { m_layer_durations.transform(std::forward<Fn>(fn)); }
+
+            static uint16_t float_to_half(float value);
+            static float    half_to_float(uint16_t value);
+
+        private:
+            // Column of values stored as runs of equal values, each run starting at the id of its first value.
+            template<typename T>
+            class RunLengthColumn
+            {
+            public:
+                size_t size() const { return m_size; }
+                size_t runs() const { return m_runs.size(); }
+                size_t memsize() const { return m_runs.capacity() * sizeof(Run); }
+                void   clear() { m_runs.clear(); m_size = 0; }
+                void   shrink_to_fit() { m_runs.shrink_to_fit(); }
+
+                T operator[](size_t id) const { return this->run(id)->value; }
+
+                void push_back(T value) {
+                    if (m_runs.empty() || m_runs.back().value != value)
+                        m_runs.push_back({ uint32_t(m_size), value });
+                    ++ m_size;
+                }
+
+                void set(size_t id, T value) {
+                    auto it = this->run(id);
+                    if (it->value == value)
+                        return;
+                    const size_t next = std::next(it) == m_runs.end() ? m_size : size_t(std::next(it)->first);
+                    if (id + 1 < next)
+                        // Keep the rest of the run.
+                        it = std::prev(m_runs.insert(std::next(it), { uint32_t(id + 1), it->value }));
+                    if (it->first == id)
+                        it->value = value;
+                    else
+                        it = m_runs.insert(std::next(it), { uint32_t(id), value });
+                    this->merge_around(it - m_runs.begin());
+                }
+
+                void erase(size_t id) {
+                    auto it = this->run(id);
+                    const size_t next = std::next(it) == m_runs.end() ? m_size : size_t(std::next(it)->first);
+                    for (auto it_next = std::next(it); it_next != m_runs.end(); ++ it_next)
+                        -- it_next->first;
+                    -- m_size;
+                    if (next - it->first == 1)
+                        this->merge_around(m_runs.erase(it) - m_runs.begin());
+                }
+
+                template<typename Fn> void transform(Fn &&fn) {
+                    size_t last = 0;
+                    for (size_t i = 0; i < m_runs.size(); ++ i) {
+                        const T value = fn(m_runs[i].value);
+                        if (i == 0 || value != m_runs[last].value)
+                            m_runs[i == 0 ? 0 : ++ last] = { m_runs[i].first, value };
+                    }
+                    if (! m_runs.empty())
+                        m_runs.erase(m_runs.begin() + last + 1, m_runs.end());
+                }
+
+            private:
+                struct Run {
+                    uint32_t first;
+                    T        value;
+                };
+
+                typename std::vector<Run>::const_iterator run(size_t id) const {
+                    assert(id < m_size);
+                    return std::prev(std::upper_bound(m_runs.begin(), m_runs.end(), id, [](size_t id, const Run &run) { return id < run.first; }));
+                }
+                typename std::vector<Run>::iterator run(size_t id) {
+                    return m_runs.begin() + (static_cast<const RunLengthColumn*>(this)->run(id) - m_runs.cbegin());
+                }
+                // Merges the run at run_id with its neighbors having the same value.
+                void merge_around(size_t run_id) {
+                    if (run_id + 1 < m_runs.size() && m_runs[run_id + 1].value == m_runs[run_id].value)
+                        m_runs.erase(m_runs.begin() + run_id + 1);
+                    if (run_id > 0 && run_id < m_runs.size() && m_runs[run_id - 1].value == m_runs[run_id].value)
+                        m_runs.erase(m_runs.begin() + run_id);
+                }
+
+                std::vector<Run> m_runs;
+                size_t           m_size { 0 };
+            };
+
+            struct ArcData
+            {
+                uint32_t           move_id;
+                Vec3f              center;
+                std::vector<Vec3f> interpolation_points;
+            };
+
+            // Returns the arc data of the given move or m_arcs.end() if the move is not an arc move.
+            std::vector<ArcData>::const_iterator arc(size_t id) const;
+
+            std::vector<unsigned int>       m_gcode_ids;
+            std::vector<EMoveType>          m_types;
+            std::vector<ExtrusionRole>      m_extrusion_roles;
+            std::vector<unsigned char>      m_extruder_ids;
+            std::vector<unsigned char>      m_cp_color_ids;
+            std::vector<Vec3f>              m_positions;
+            std::vector<float>              m_delta_extruders;
+            std::vector<float>              m_feedrates;
+            std::vector<uint16_t>           m_widths;
+            std::vector<uint16_t>           m_heights;
+            std::vector<float>              m_mm3_per_mms;
+            std::vector<float>              m_times;
+            std::vector<EMovePathType>      m_move_path_types;
+            RunLengthColumn<float>          m_fan_speeds;
+            RunLengthColumn<float>          m_temperatures;
+            RunLengthColumn<float>          m_layer_durations;
+            // Sorted by move_id.
+            std::vector<ArcData>            m_arcs;
+        };
+
         struct SliceWarning {
             int         level;                  // 0: normal tips, 1: warning; 2: error
             std::string msg;                    // enum string
@@ -192,7 +400,7 @@ class Print;
 
         std::string filename;
         unsigned int id;
-        std::vector<MoveVertex> moves;
+        MoveVertices moves;
         // Positions of ends of lines of the final G-code this->filename after TimeProcessor::post_process() finalizes the G-code.
         std::vector<size_t> lines_ends;
         Pointfs printable_area;
@@ -301,6 +509,14 @@ class Print;
         // checks the given gcode for reserved tags and returns true when finding any
         // (the first max_count found tags are returned into found_tag)
         static bool contains_reserved_tags(const std::string& gcode, unsigned int max_count, std::vector<std::string>& found_tag);
+        // Appends a newline to a line (without the trailing newline) to be replaced by the post-processing.
+        // If can_post_process_in_place(), the line is padded with spaces first, so that the post-processing patches
+        // such fixed width slots in place instead of rewriting the whole G-code file. The padding is trimmed afterwards.
+        std::string reserve_post_process_slot(const std::string& line) const;
+        static const size_t Post_Process_Slot_Width;
+        // The post-processing of the G-code exported with the applied config will not insert or remove any lines,
+        // thus it patches the slots reserved by reserve_post_process_slot() in place.
+        bool can_post_process_in_place() const { return m_time_processor.disable_m73 && ! m_result.backtrace_enabled; }
 
         static int get_gcode_last_filament(const std::string &gcode_str);
         static bool get_last_z_from_gcode(const std::string& gcode_str, double& z);
@@ -455,7 +671,16 @@ class Print;
             State curr;
             State prev;
             CustomGCodeTime gcode_time;
+            // Blocks added since the last call of calculate_time().
             std::vector<TimeBlock> blocks;
+            // Blocks being planned and the blocks kept for the next calculate_time() call, owned by the planner.
+            std::vector<TimeBlock> planner_blocks;
+            // Size of planner_blocks once the planner finishes the last calculate_time() request.
+            size_t planner_blocks_count;
+            // If set, calculate_time() plans the blocks in a background task, so that the time modes are planned in parallel
+            // to each other and to the G-code processing. The requests are processed one by one in order, therefore
+            // the results are exactly the same as if planned synchronously.
+            std::unique_ptr<tbb::task_group> planner;
             std::vector<G1LinesCacheItem> g1_times_cache;
             std::array<float, static_cast<size_t>(EMoveType::Count)> moves_time;
             std::array<float, static_cast<size_t>(ExtrusionRole::erCount)> roles_time;
@@ -463,11 +688,23 @@ class Print;
             //BBS: prepare stage time before print model, including start gcode time and mostly same with start gcode time
             float prepare_time;
 
+            TimeMachine() = default;
+            ~TimeMachine() { synchronize(); }
+
             void reset();
 
             // Simulates firmware st_synchronize() call
             void simulate_st_synchronize(float additional_time = 0.0f);
             void calculate_time(size_t keep_last_n_blocks = 0, float additional_time = 0.0f);
+            // Number of blocks not yet accounted into the time, including the blocks kept by the planner.
+            size_t queued_blocks() const { return planner_blocks_count + blocks.size(); }
+            // Waits for the planner to finish, to be called before accessing the accumulated times.
+            void synchronize() { if (planner) planner->wait(); }
+            void enable_parallel_planning(bool enable);
+
+        private:
+            // Plans planner_blocks and accumulates the times of all of them but the last keep_last_n_blocks.
+            void plan(size_t keep_last_n_blocks, float additional_time);
         };
 
         struct TimeProcessor
@@ -502,7 +739,9 @@ class Print;
 
             // post process the file with the given filename to add remaining time lines M73
             // and updates moves' gcode ids accordingly
-            void post_process(const std::string& filename, std::vector<GCodeProcessorResult::MoveVertex>& moves, std::vector<size_t>& lines_ends, size_t total_layer_num);
+            void post_process(const std::string& filename, GCodeProcessorResult::MoveVertices& moves, std::vector<size_t>& lines_ends, size_t total_layer_num);
+            // Lines replacing the Estimated_Printing_Time_Placeholder tag.
+            std::string estimated_printing_time_lines() const;
         };
 
         struct UsedFilaments  // filaments per ColorChange
@@ -590,12 +829,13 @@ class Print;
                 if (!m_move_id.has_value() || !m_custom_gcode_per_print_z_id.has_value())
                     return;
 
-                const Vec3f position = m_result.moves.back().position;
+                const Vec3f position = m_result.moves.position(m_result.moves.size() - 1);
 
-                GCodeProcessorResult::MoveVertex& move = m_result.moves.emplace_back(m_result.moves[*m_move_id]);
+                GCodeProcessorResult::MoveVertex move = m_result.moves[*m_move_id];
                 move.position = position;
                 move.height = height;
-                m_result.moves.erase(m_result.moves.begin() + *m_move_id);
+                m_result.moves.push_back(move);
+                m_result.moves.erase(*m_move_id);
                 m_result.custom_gcode_per_print_z[*m_custom_gcode_per_print_z_id].print_z = position.z();
                 reset();
             }
@@ -731,6 +971,10 @@ class Print;
         size_t m_last_default_color_id;
         bool m_detect_layer_based_on_tag {false};
         int m_seams_count;
+        // Ids of the lines which may be replaced or removed by the post-processing, see post_process_in_place().
+        std::vector<unsigned int> m_post_process_lines;
+        // Number of bytes passed to process_buffer(), used to fill in m_result.lines_ends of the exported G-code.
+        size_t m_processed_buffer_size;
         bool m_single_extruder_multi_material;
         float m_preheat_time;
         int m_preheat_steps;
@@ -779,6 +1023,8 @@ class Print;
             return m_time_processor.machines[static_cast<size_t>(PrintEstimatedStatistics::ETimeMode::Stealth)].enabled;
         }
         void enable_machine_envelope_processing(bool enabled) { m_time_processor.machine_envelope_processing_enabled = enabled; }
+        // Plan the time estimate blocks in background tasks (the default). Produces exactly the same times as the synchronous planning.
+        void enable_parallel_time_estimation(bool enabled);
         void reset();
 
         const GCodeProcessorResult& get_result() const { return m_result; }
@@ -949,6 +1195,11 @@ class Print;
         // 1) add remaining time lines M73 and update moves' gcode ids accordingly
         // 2) update used filament data
         void run_post_process();
+        // Replaces the placeholders and the used filament data by patching the fixed width slots reserved by
+        // reserve_post_process_slot() in place, then trims the padding of the slots. Returns false without modifying the file
+        // if the G-code needs to be rewritten, that is if lines M73 or M104 are to be inserted or removed or if a replacement
+        // does not fit into its slot.
+        bool post_process_in_place();
 
         //BBS: different path_type is only used for arc move
         void store_move_vertex(EMoveType type, EMovePathType path_type = EMovePathType::Noop_move);
@@ -31,7 +31,8 @@ static constexpr int max_look_back_limit = 128;
 // lines where some extruder pressure will remain (so we should equalize between these small travels)
 static constexpr long max_ignored_gap_between_extruding_segments = 3;
 
-PressureEqualizer::PressureEqualizer(const Slic3r::GCodeConfig &config) : m_use_relative_e_distances(config.use_relative_e_distances.value)
+PressureEqualizer::PressureEqualizer(const Slic3r::GCodeConfig &config, const std::string &toolchange_prefix) :
+    m_use_relative_e_distances(config.use_relative_e_distances.value), m_toolchange_prefix(toolchange_prefix)
 {
     // Preallocate some data, so that output_buffer.data() will return an empty string.
     output_buffer.assign(32, 0);
@@ -190,15 +191,18 @@ LayerResult PressureEqualizer::process_layer(LayerResult &&input)
 
     output_buffer_length      = 0;
     output_buffer_prev_length = 0;
+    output_lines.clear();
     for (size_t line_idx = 0; line_idx < next_layer_first_idx; ++line_idx)
         output_gcode_line(line_idx);
     m_gcode_lines.erase(m_gcode_lines.begin(), m_gcode_lines.begin() + int(next_layer_first_idx));
 
-    if (output_buffer_length > 0)
-        prev_layer_result->gcode = std::string(output_buffer.data());
+    if (output_buffer_length > 0) {
+        prev_layer_result->gcode = std::string(output_buffer.data(), output_buffer_length);
+        prev_layer_result->lines = std::move(output_lines);
+    }
 
     assert(!input.nop_layer_result || m_layer_results.empty());
-    LayerResult out = *prev_layer_result;
+    LayerResult out = std::move(*prev_layer_result);
     delete prev_layer_result;
     return out;
 }
@@ -283,6 +287,7 @@ bool PressureEqualizer::process_line(const char *line, const char *line_end, GCo
     buf.max_volumetric_extrusion_rate_slope_positive = 0.f;
     buf.max_volumetric_extrusion_rate_slope_negative = 0.f;
 	buf.extrusion_role = m_current_extrusion_role;
+    buf.parsed = CoolingBuffer::parse_line(line, line_end, m_toolchange_prefix);
 
     std::string str_line(line, line_end);
     const bool found_extrude_set_speed_tag = boost::contains(str_line, EXTRUDE_SET_SPEED_TAG);
@@ -319,7 +324,19 @@ bool PressureEqualizer::process_line(const char *line, const char *line_end, GCo
             float new_pos[5];
             memcpy(new_pos, m_current_pos, sizeof(float)*5);
             bool  changed[5] = { false, false, false, false, false };
-            while (!is_eol(*line)) {
+            auto  set_axis = [this, &buf, &new_pos, &changed](int i, float value) {
+                buf.pos_provided[i] = true;
+                new_pos[i] = value;
+                if (i == 3 && m_use_relative_e_distances)
+                    new_pos[i] += m_current_pos[i];
+                changed[i] = new_pos[i] != m_current_pos[i];
+            };
+            if (buf.parsed.type == LayerGCodeLine::TYPE_G0 || buf.parsed.type == LayerGCodeLine::TYPE_G1) {
+                // Reuse the axes parsed for the CoolingBuffer.
+                for (int i = 0; i < 5; ++ i)
+                    if (buf.parsed.has_axis(i))
+                        set_axis(i, buf.parsed.values[i]);
+            } else while (!is_eol(*line)) {
                 const char axis = toupper(*line++);
                 int  i = -1;
                 switch (axis) {
@@ -338,11 +355,7 @@ bool PressureEqualizer::process_line(const char *line, const char *line_end, GCo
                     break;
                 }
                 if (i != -1) {
-                    buf.pos_provided[i] = true;
-                    new_pos[i] = parse_float(line, line_end - line);
-                    if (i == 3 && m_use_relative_e_distances)
-                        new_pos[i] += m_current_pos[i];
-                    changed[i] = new_pos[i] != m_current_pos[i];
+                    set_axis(i, parse_float(line, line_end - line));
                     eatws(line);
                 }
             }
@@ -471,7 +484,7 @@ void PressureEqualizer::output_gcode_line(const size_t line_idx)
 {
     GCodeLine &line = m_gcode_lines[line_idx];
     if (!line.modified) {
-        push_to_output(line.raw.data(), line.raw_length, true);
+        push_to_output(line.raw.data(), line.raw_length, true, &line.parsed);
         return;
     }
 
@@ -712,8 +725,9 @@ inline void PressureEqualizer::push_to_output(const std::string &text, bool add_
     return this->push_to_output(text.data(), text.size(), add_eol);
 }
 
-inline void PressureEqualizer::push_to_output(const char *text, const size_t len, bool add_eol)
+inline void PressureEqualizer::push_to_output(const char *text, const size_t len, bool add_eol, const LayerGCodeLine *parsed)
 {
+    const size_t line_start = output_buffer_length;
     // New length of the output buffer content.
     size_t len_new = output_buffer_length + len + 1;
     if (add_eol)
@@ -743,6 +757,24 @@ inline void PressureEqualizer::push_to_output(const char *text, const size_t len
     if (add_eol)
         output_buffer[output_buffer_length++] = '\n';
     output_buffer[output_buffer_length] = 0;
+
+    // Record the pushed lines for the CoolingBuffer, parse them unless they were parsed already.
+    if (parsed != nullptr) {
+        LayerGCodeLine &out = output_lines.emplace_back(*parsed);
+        out.line_start = line_start;
+        out.line_end   = output_buffer_length;
+    } else {
+        for (size_t i = line_start; i < output_buffer_length;) {
+            size_t j = i;
+            for (; j < output_buffer_length && output_buffer[j] != '\n'; ++ j);
+            LayerGCodeLine &out = output_lines.emplace_back(CoolingBuffer::parse_line(output_buffer.data() + i, output_buffer.data() + j, m_toolchange_prefix));
+            if (j < output_buffer_length)
+                ++ j;
+            out.line_start = i;
+            out.line_end   = j;
+            i = j;
+        }
+    }
 }
 
 inline bool is_just_line_with_extrude_set_speed_tag(const std::string &line)
@@ -774,9 +806,11 @@ void PressureEqualizer::push_line_to_output(const size_t line_idx, float new_fee
     if (line_idx > 0 && output_buffer_length > 0) {
         const std::string prev_line_str = std::string(output_buffer.begin() + int(this->output_buffer_prev_length),
                                                       output_buffer.begin() + int(this->output_buffer_length) + 1);
-        if (is_just_line_with_extrude_set_speed_tag(prev_line_str))
+        if (is_just_line_with_extrude_set_speed_tag(prev_line_str)) {
             this->output_buffer_length = this->output_buffer_prev_length; // Remove the last line because it only sets the speed for an empty block of g-code lines, so it is useless.
-        else
+            while (! output_lines.empty() && output_lines.back().line_start >= this->output_buffer_length)
+                output_lines.pop_back();
+        } else
             push_to_output(EXTRUDE_END_TAG.data(), EXTRUDE_END_TAG.length(), true);
     } else
         push_to_output(EXTRUDE_END_TAG.data(), EXTRUDE_END_TAG.length(), true);
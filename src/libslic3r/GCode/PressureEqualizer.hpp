@@ -3,6 +3,7 @@
 
 #include "../libslic3r.h"
 #include "../PrintConfig.hpp"
+#include "CoolingBuffer.hpp"
 
 #include <queue>
 
@@ -21,12 +22,13 @@ class PressureEqualizer
 {
 public:
     PressureEqualizer() = delete;
-    explicit PressureEqualizer(const Slic3r::GCodeConfig &config);
+    PressureEqualizer(const Slic3r::GCodeConfig &config, const std::string &toolchange_prefix);
     ~PressureEqualizer() = default;
 
     // Process a next batch of G-code lines.
     // The last LayerResult must be LayerResult::make_nop_layer_result() because it always returns GCode for the previous layer.
     // When process_layer is called for the first layer, then LayerResult::make_nop_layer_result() is returned.
+    // The lines of the returned G-code are passed in LayerResult::lines, parsed for the CoolingBuffer.
     LayerResult process_layer(LayerResult &&input);
 private:
 
@@ -79,6 +81,8 @@ private:
     ExtrusionRole     m_current_extrusion_role;
     bool                            m_retracted;
     bool                            m_use_relative_e_distances;
+    // Prefix of the tool change G-code, to parse the output lines for the CoolingBuffer.
+    std::string                     m_toolchange_prefix;
 
 	// Maximum segment length to split a long segment if the initial and the final flow rate differ.
 	// Smaller value means a smoother transition between two different flow rates.
@@ -171,12 +175,17 @@ private:
 
         bool        extrude_set_speed_tag = false;
         bool        extrude_end_tag       = false;
+
+        // The raw line parsed for the CoolingBuffer, reused if the line is not modified.
+        LayerGCodeLine parsed;
     };
 
     // Output buffer will only grow. It will not be reallocated over and over.
     std::vector<char>               output_buffer;
     size_t                          output_buffer_length;
     size_t                          output_buffer_prev_length;
+    // Lines of the output_buffer parsed for the CoolingBuffer.
+    std::vector<LayerGCodeLine>     output_lines;
 
 #ifdef PRESSURE_EQUALIZER_DEBUG
     // For debugging purposes. Index of the G-code line processed.
@@ -194,7 +203,7 @@ private:
     // Push the text to the end of the output_buffer.
     inline void push_to_output(GCodeG1Formatter &formatter);
     inline void push_to_output(const std::string &text, bool add_eol);
-    inline void push_to_output(const char *text, size_t len, bool add_eol = true);
+    inline void push_to_output(const char *text, size_t len, bool add_eol = true, const LayerGCodeLine *parsed = nullptr);
     // Push a G-code line to the output.
     void push_line_to_output(size_t line_idx, float new_feedrate, const char *comment);
 
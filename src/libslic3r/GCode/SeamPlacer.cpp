@@ -5,9 +5,12 @@
 #include "tbb/parallel_for.h"
 #include "tbb/blocked_range.h"
 #include "tbb/parallel_reduce.h"
+#include <boost/functional/hash.hpp>
 #include <boost/log/trivial.hpp>
 #include <random>
 #include <algorithm>
+#include <list>
+#include <mutex>
 #include <queue>
 
 #include "libslic3r/AABBTreeLines.hpp"
@@ -169,12 +172,9 @@ std::vector<float> raycast_visibility(const AABBTreeIndirect::Tree<3, float> &ra
                           Vec3f final_ray_dir = (f.to_world(dir));
                           if (!model_contains_negative_parts) {
                             igl::Hit hitpoint;
-                            // FIXME: This AABBTTreeIndirect query will not compile for float ray origin and
-                            // direction.
-                            Vec3d final_ray_dir_d = final_ray_dir.cast<double>();
-                            Vec3d ray_origin_d = (center + normal * 0.01f).cast<double>(); // start above surface.
+                            Vec3f ray_origin = center + normal * 0.01f; // start above surface.
                             bool hit = AABBTreeIndirect::intersect_ray_first_hit(triangles.vertices,
-                                                                                 triangles.indices, raycasting_tree, ray_origin_d, final_ray_dir_d, hitpoint);
+                                                                                 triangles.indices, raycasting_tree, ray_origin, final_ray_dir, hitpoint);
                             if (hit && its_face_normal(triangles, hitpoint.id).dot(final_ray_dir) <= 0) {
                               result[s_idx] -= decrease_step;
                             }
@@ -182,15 +182,14 @@ std::vector<float> raycast_visibility(const AABBTreeIndirect::Tree<3, float> &ra
                             bool casting_from_negative_volume = samples.triangle_indices[s_idx]
                                                                 >= negative_volumes_start_index;
 
-                            Vec3d ray_origin_d = (center + normal * 0.01f).cast<double>(); // start above surface.
+                            Vec3f ray_origin = center + normal * 0.01f; // start above surface.
                             if (casting_from_negative_volume) { // if casting from negative volume face, invert direction, change start pos
-                              final_ray_dir = -1.0 * final_ray_dir;
-                              ray_origin_d = (center - normal * 0.01f).cast<double>();
+                              final_ray_dir = -1.0f * final_ray_dir;
+                              ray_origin = center - normal * 0.01f;
                             }
-                            Vec3d final_ray_dir_d = final_ray_dir.cast<double>();
                             bool some_hit = AABBTreeIndirect::intersect_ray_all_hits(triangles.vertices,
                                                                                      triangles.indices, raycasting_tree,
-                                                                                     ray_origin_d, final_ray_dir_d, hits);
+                                                                                     ray_origin, final_ray_dir, hits);
                             if (some_hit) {
                               int counter = 0;
                               // NOTE: iterating in reverse, from the last hit for one simple reason: We know the state of the ray at that point;
@@ -517,7 +516,8 @@ void process_perimeter_polygon(const Polygon &orig_polygon, float z_coord, const
       }
     }
 
-    result.points.emplace_back(position, perimeter, local_ccw_angle, type);
+    result.points.emplace_back(perimeter, local_ccw_angle, type);
+    result.positions.emplace_back(position);
   }
 
   perimeter.end_index = result.points.size();
@@ -615,6 +615,78 @@ std::pair<size_t, size_t> find_previous_and_next_perimeter_point(const std::vect
   return {size_t(prev),size_t(next)};
 }
 
+// Result of the raycasting of compute_global_occlusion()
+struct MeshVisibility {
+  TriangleSetSamples mesh_samples;
+  std::vector<float> mesh_samples_visibility;
+  float mesh_samples_radius;
+};
+
+// Inputs of the raycasting - the model parts and the negative volumes of an object and the transformation of the object.
+// Besides the hash, the sizes of the meshes are compared to make a false match even less likely.
+struct MeshVisibilityKey {
+  size_t hash;
+  size_t num_triangles;
+  size_t num_negative_volumes_triangles;
+
+  bool operator==(const MeshVisibilityKey &rhs) const {
+    return hash == rhs.hash && num_triangles == rhs.num_triangles
+        && num_negative_volumes_triangles == rhs.num_negative_volumes_triangles;
+  }
+};
+
+MeshVisibilityKey make_mesh_visibility_key(const indexed_triangle_set &triangle_set,
+                                           const indexed_triangle_set &negative_volumes_set, const Transform3d &obj_transform) {
+  size_t seed = 0;
+  for (const indexed_triangle_set *its : { &triangle_set, &negative_volumes_set }) {
+    for (const stl_vertex &v : its->vertices)
+      for (int i = 0; i < 3; ++i)
+        boost::hash_combine(seed, v[i]);
+    for (const stl_triangle_vertex_indices &tri : its->indices)
+      for (int i = 0; i < 3; ++i)
+        boost::hash_combine(seed, tri[i]);
+  }
+  for (int i = 0; i < 16; ++i)
+    boost::hash_combine(seed, obj_transform.matrix().data()[i]);
+  return { seed, triangle_set.indices.size(), negative_volumes_set.indices.size() };
+}
+
+// Process wide store of the visibility of the recently raycasted objects. The copies of an object and the following G-code exports
+// of an unchanged object, for example after the seam settings were changed, reuse the visibility instead of raycasting again.
+class MeshVisibilityCache {
+public:
+  std::shared_ptr<const MeshVisibility> find(const MeshVisibilityKey &key) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = std::find_if(m_entries.begin(), m_entries.end(), [&key](const auto &entry) { return entry.first == key; });
+    if (it == m_entries.end())
+      return {};
+    // Keep the most recently used entry at the front.
+    m_entries.splice(m_entries.begin(), m_entries, it);
+    return m_entries.front().second;
+  }
+
+  void insert(const MeshVisibilityKey &key, std::shared_ptr<const MeshVisibility> visibility) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_entries.emplace_front(key, std::move(visibility));
+    // Each entry holds about 1MB of samples.
+    if (m_entries.size() > max_entries)
+      m_entries.pop_back();
+  }
+
+private:
+  static constexpr size_t max_entries = 8;
+  std::mutex m_mutex;
+  std::list<std::pair<MeshVisibilityKey, std::shared_ptr<const MeshVisibility>>> m_entries;
+};
+
+static MeshVisibilityCache s_mesh_visibility_cache;
+
+void init_mesh_samples_tree(GlobalModelInfo &result) {
+  result.mesh_samples_coordinate_functor = CoordinateFunctor(&result.mesh_samples.positions);
+  result.mesh_samples_tree = KDTreeIndirect<3, float, CoordinateFunctor>(result.mesh_samples_coordinate_functor,
+                                                                         result.mesh_samples.positions.size());
+}
+
 // Computes all global model info - transforms object, performs raycasting
 void compute_global_occlusion(GlobalModelInfo &result, const PrintObject *po,
                               std::function<void(void)> throw_if_canceled) {
@@ -642,6 +714,17 @@ void compute_global_occlusion(GlobalModelInfo &result, const PrintObject *po,
   BOOST_LOG_TRIVIAL(debug)
       << "SeamPlacer: gather occlusion meshes: end";
 
+  const MeshVisibilityKey visibility_key = make_mesh_visibility_key(triangle_set, negative_volumes_set, obj_transform);
+  if (std::shared_ptr<const MeshVisibility> visibility = s_mesh_visibility_cache.find(visibility_key)) {
+    BOOST_LOG_TRIVIAL(debug)
+        << "SeamPlacer: visibility of " << visibility->mesh_samples.positions.size() << " samples reused";
+    result.mesh_samples = visibility->mesh_samples;
+    result.mesh_samples_visibility = visibility->mesh_samples_visibility;
+    result.mesh_samples_radius = visibility->mesh_samples_radius;
+    init_mesh_samples_tree(result);
+    return;
+  }
+
   BOOST_LOG_TRIVIAL(debug)
       << "SeamPlacer: decimate: start";
   its_short_edge_collpase(triangle_set, SeamPlacer::fast_decimation_triangle_count_target);
@@ -658,9 +741,7 @@ void compute_global_occlusion(GlobalModelInfo &result, const PrintObject *po,
 
   result.mesh_samples = sample_its_uniform_parallel(SeamPlacer::raycasting_visibility_samples_count,
                                                     triangle_set);
-  result.mesh_samples_coordinate_functor = CoordinateFunctor(&result.mesh_samples.positions);
-  result.mesh_samples_tree = KDTreeIndirect<3, float, CoordinateFunctor>(result.mesh_samples_coordinate_functor,
-                                                                         result.mesh_samples.positions.size());
+  init_mesh_samples_tree(result);
 
   // The following code determines search area for random visibility samples on the mesh when calculating visibility of each perimeter point
   // number of random samples in the given radius (area) is approximately poisson distribution
@@ -694,6 +775,8 @@ void compute_global_occlusion(GlobalModelInfo &result, const PrintObject *po,
   result.mesh_samples_visibility = raycast_visibility(raycasting_tree, triangle_set, result.mesh_samples,
                                                       negative_volumes_start_index);
   throw_if_canceled();
+  s_mesh_visibility_cache.insert(visibility_key, std::make_shared<const MeshVisibility>(MeshVisibility {
+      result.mesh_samples, result.mesh_samples_visibility, result.mesh_samples_radius }));
 #ifdef DEBUG_FILES
   result.debug_export(triangle_set);
 #endif
@@ -739,8 +822,8 @@ struct SeamComparator {
 
   // Standard comparator, must respect the requirements of comparators (e.g. give same result on same inputs) for sorting usage
   // should return if a is better seamCandidate than b
-  bool is_first_better(const SeamCandidate &a, const SeamCandidate &b, const Vec2f &preffered_location = Vec2f { 0.0f,
-                                                                                                               0.0f }) const {
+  bool is_first_better(const SeamCandidate &a, const Vec3f &a_position, const SeamCandidate &b, const Vec3f &b_position,
+                       const Vec2f &preffered_location = Vec2f { 0.0f, 0.0f }) const {
     if (setup == SeamPosition::spAligned && a.central_enforcer != b.central_enforcer) {
       return a.central_enforcer;
     }
@@ -763,15 +846,15 @@ struct SeamComparator {
       return false;
     }
 
-    if (setup == SeamPosition::spRear && a.position.y() != b.position.y()) {
-      return a.position.y() > b.position.y();
+    if (setup == SeamPosition::spRear && a_position.y() != b_position.y()) {
+      return a_position.y() > b_position.y();
     }
 
     float distance_penalty_a = 0.0f;
     float distance_penalty_b = 0.0f;
     if (setup == spNearest) {
-      distance_penalty_a = 1.0f - gauss((a.position.head<2>() - preffered_location).norm(), 0.0f, 1.0f, 0.005f);
-      distance_penalty_b = 1.0f - gauss((b.position.head<2>() - preffered_location).norm(), 0.0f, 1.0f, 0.005f);
+      distance_penalty_a = 1.0f - gauss((a_position.head<2>() - preffered_location).norm(), 0.0f, 1.0f, 0.005f);
+      distance_penalty_b = 1.0f - gauss((b_position.head<2>() - preffered_location).norm(), 0.0f, 1.0f, 0.005f);
     }
 
     // the penalites are kept close to range [0-1.x] however, it should not be relied upon
@@ -788,7 +871,7 @@ struct SeamComparator {
   // Comparator used during alignment. If there is close potential aligned point, it is compared to the current
   // seam point of the perimeter, to find out if the aligned point is not much worse than the current seam
   // Also used by the random seam generator.
-  bool is_first_not_much_worse(const SeamCandidate &a, const SeamCandidate &b) const {
+  bool is_first_not_much_worse(const SeamCandidate &a, const Vec3f &a_position, const SeamCandidate &b, const Vec3f &b_position) const {
     // Blockers/Enforcers discrimination, top priority
     if (setup == SeamPosition::spAligned && a.central_enforcer != b.central_enforcer) {
       // Prefer centers of enforcers.
@@ -826,7 +909,7 @@ struct SeamComparator {
     }
 
     if (setup == SeamPosition::spRear) {
-      return a.position.y() + SeamPlacer::seam_align_score_tolerance * 5.0f > b.position.y();
+      return a_position.y() + SeamPlacer::seam_align_score_tolerance * 5.0f > b_position.y();
     }
 
     float penalty_a = a.overhang + a.visibility
@@ -837,8 +920,8 @@ struct SeamComparator {
     return penalty_a <= penalty_b || penalty_a - penalty_b < SeamPlacer::seam_align_score_tolerance;
   }
 
-  bool are_similar(const SeamCandidate &a, const SeamCandidate &b) const {
-    return is_first_not_much_worse(a, b) && is_first_not_much_worse(b, a);
+  bool are_similar(const SeamCandidate &a, const Vec3f &a_position, const SeamCandidate &b, const Vec3f &b_position) const {
+    return is_first_not_much_worse(a, a_position, b, b_position) && is_first_not_much_worse(b, b_position, a, a_position);
   }
 };
 
@@ -855,11 +938,12 @@ void debug_export_points(const std::vector<PrintObjectSeamData::LayerSeams> &lay
     float min_weight = std::numeric_limits<float>::min();
     float max_weight = min_weight;
 
-    for (const SeamCandidate &point : layers[layer_idx].points) {
+    for (size_t point_idx = 0; point_idx < layers[layer_idx].points.size(); ++point_idx) {
+      const SeamCandidate &point = layers[layer_idx].points[point_idx];
       Vec3i32 color = value_to_rgbi(-PI, PI, point.local_ccw_angle);
       std::string fill = "rgb(" + std::to_string(color.x()) + "," + std::to_string(color.y()) + ","
                          + std::to_string(color.z()) + ")";
-      angles_svg.draw(scaled(Vec2f(point.position.head<2>())), fill);
+      angles_svg.draw(scaled(Vec2f(layers[layer_idx].positions[point_idx].head<2>())), fill);
       min_vis = std::min(min_vis, point.visibility);
       max_vis = std::max(max_vis, point.visibility);
 
@@ -878,52 +962,58 @@ void debug_export_points(const std::vector<PrintObjectSeamData::LayerSeams> &lay
         ("overhang_" + std::to_string(layer_idx) + ".svg").c_str());
     SVG overhangs_svg { overhangs_file_name, bounding_box };
 
-    for (const SeamCandidate &point : layers[layer_idx].points) {
+    for (size_t point_idx = 0; point_idx < layers[layer_idx].points.size(); ++point_idx) {
+      const SeamCandidate &point    = layers[layer_idx].points[point_idx];
+      const Vec3f         &position = layers[layer_idx].positions[point_idx];
       Vec3i32 color = value_to_rgbi(min_vis, max_vis, point.visibility);
       std::string visibility_fill = "rgb(" + std::to_string(color.x()) + "," + std::to_string(color.y()) + ","
                                     + std::to_string(color.z()) + ")";
-      visibility_svg.draw(scaled(Vec2f(point.position.head<2>())), visibility_fill);
+      visibility_svg.draw(scaled(Vec2f(position.head<2>())), visibility_fill);
 
       Vec3i32 weight_color = value_to_rgbi(min_weight, max_weight,
                                          -compute_angle_penalty(point.local_ccw_angle));
       std::string weight_fill = "rgb(" + std::to_string(weight_color.x()) + "," + std::to_string(weight_color.y())
                                 + ","
                                 + std::to_string(weight_color.z()) + ")";
-      weight_svg.draw(scaled(Vec2f(point.position.head<2>())), weight_fill);
+      weight_svg.draw(scaled(Vec2f(position.head<2>())), weight_fill);
 
       Vec3i32 overhang_color = value_to_rgbi(-0.5, 0.5, std::clamp(point.overhang, -0.5f, 0.5f));
       std::string overhang_fill = "rgb(" + std::to_string(overhang_color.x()) + ","
                                   + std::to_string(overhang_color.y())
                                   + ","
                                   + std::to_string(overhang_color.z()) + ")";
-      overhangs_svg.draw(scaled(Vec2f(point.position.head<2>())), overhang_fill);
+      overhangs_svg.draw(scaled(Vec2f(position.head<2>())), overhang_fill);
     }
   }
 }
 #endif
 
 // Pick best seam point based on the given comparator
-void pick_seam_point(std::vector<SeamCandidate> &perimeter_points, size_t start_index,
+void pick_seam_point(PrintObjectSeamData::LayerSeams &layer, size_t start_index,
                      const SeamComparator &comparator) {
+  const std::vector<SeamCandidate> &perimeter_points = layer.points;
   size_t end_index = perimeter_points[start_index].perimeter.end_index;
 
   size_t seam_index = start_index;
   for (size_t index = start_index; index < end_index; ++index) {
-    if (comparator.is_first_better(perimeter_points[index], perimeter_points[seam_index])) {
+    if (comparator.is_first_better(perimeter_points[index], layer.positions[index],
+                                   perimeter_points[seam_index], layer.positions[seam_index])) {
       seam_index = index;
     }
   }
-  perimeter_points[start_index].perimeter.seam_index = seam_index;
+  layer.points[start_index].perimeter.seam_index = seam_index;
 }
 
-size_t pick_nearest_seam_point_index(const std::vector<SeamCandidate> &perimeter_points, size_t start_index,
+size_t pick_nearest_seam_point_index(const PrintObjectSeamData::LayerSeams &layer, size_t start_index,
                                      const Vec2f &preffered_location) {
+  const std::vector<SeamCandidate> &perimeter_points = layer.points;
   size_t end_index = perimeter_points[start_index].perimeter.end_index;
   SeamComparator comparator { spNearest };
 
   size_t seam_index = start_index;
   for (size_t index = start_index; index < end_index; ++index) {
-    if (comparator.is_first_better(perimeter_points[index], perimeter_points[seam_index], preffered_location)) {
+    if (comparator.is_first_better(perimeter_points[index], layer.positions[index],
+                                   perimeter_points[seam_index], layer.positions[seam_index], preffered_location)) {
       seam_index = index;
     }
   }
@@ -931,8 +1021,10 @@ size_t pick_nearest_seam_point_index(const std::vector<SeamCandidate> &perimeter
 }
 
 // picks random seam point uniformly, respecting enforcers blockers and overhang avoidance.
-void pick_random_seam_point(const std::vector<SeamCandidate> &perimeter_points, size_t start_index) {
+void pick_random_seam_point(const PrintObjectSeamData::LayerSeams &layer, size_t start_index) {
   SeamComparator comparator { spRandom };
+  const std::vector<SeamCandidate> &perimeter_points = layer.points;
+  const std::vector<Vec3f>         &positions        = layer.positions;
 
   // algorithm keeps a list of viable points and their lengths. If it finds a point
   // that is much better than the viable_example_index (e.g. better type, no overhang; see is_first_not_much_worse)
@@ -949,19 +1041,19 @@ void pick_random_seam_point(const std::vector<SeamCandidate> &perimeter_points,
   };
   std::vector<Viable> viables;
 
-  const Vec3f pseudornd_seed = perimeter_points[viable_example_index].position;
+  const Vec3f pseudornd_seed = positions[viable_example_index];
   float rand = std::abs(sin(pseudornd_seed.dot(Vec3f(12.9898f,78.233f, 133.3333f))) * 43758.5453f);
   rand = rand - (int) rand;
 
   for (size_t index = start_index; index < end_index; ++index) {
-    if (comparator.are_similar(perimeter_points[index], perimeter_points[viable_example_index])) {
+    if (comparator.are_similar(perimeter_points[index], positions[index],
+                               perimeter_points[viable_example_index], positions[viable_example_index])) {
       // index ok, push info into viables
-      Vec3f edge_to_next { perimeter_points[index == end_index - 1 ? start_index : index + 1].position
-                         - perimeter_points[index].position };
+      Vec3f edge_to_next { positions[index == end_index - 1 ? start_index : index + 1] - positions[index] };
       float dist_to_next = edge_to_next.norm();
       viables.push_back( { index, dist_to_next, edge_to_next });
-    } else if (comparator.is_first_not_much_worse(perimeter_points[viable_example_index],
-                                                  perimeter_points[index])) {
+    } else if (comparator.is_first_not_much_worse(perimeter_points[viable_example_index], positions[viable_example_index],
+                                                  perimeter_points[index], positions[index])) {
       // index is worse then viable_example_index, skip this point
     } else {
       // index is better than viable example index, update example, clear gathered info, start again
@@ -969,8 +1061,7 @@ void pick_random_seam_point(const std::vector<SeamCandidate> &perimeter_points,
       viable_example_index = index;
       viables.clear();
 
-      Vec3f edge_to_next = (perimeter_points[index == end_index - 1 ? start_index : index + 1].position
-                            - perimeter_points[index].position);
+      Vec3f edge_to_next = (positions[index == end_index - 1 ? start_index : index + 1] - positions[index]);
       float dist_to_next = edge_to_next.norm();
       viables.push_back( { index, dist_to_next, edge_to_next });
     }
@@ -990,7 +1081,7 @@ void pick_random_seam_point(const std::vector<SeamCandidate> &perimeter_points,
 
   Perimeter &perimeter = perimeter_points[start_index].perimeter;
   perimeter.seam_index = viables[point_idx].index;
-  perimeter.final_seam_position = perimeter_points[perimeter.seam_index].position
+  perimeter.final_seam_position = positions[perimeter.seam_index]
                                   + viables[point_idx].edge.normalized() * picked_len;
   perimeter.finalized = true;
 }
@@ -1019,10 +1110,12 @@ void SeamPlacer::gather_seam_candidates(const PrintObject *po, const SeamPlacerI
                           process_perimeter_polygon(polygons[poly_index], unscaled_z,
                                                     regions[poly_index], global_model_info, layer_seams);
                         }
-                        auto functor = SeamCandidateCoordinateFunctor { layer_seams.points };
+                        layer_seams.points.shrink_to_fit();
+                        layer_seams.positions.shrink_to_fit();
+                        auto functor = SeamCandidateCoordinateFunctor { layer_seams.positions };
                         seam_data.layers[layer_idx].points_tree =
                             std::make_unique<PrintObjectSeamData::SeamCandidatesTree>(functor,
-                                                                                      layer_seams.points.size());
+                                                                                      layer_seams.positions.size());
                       }
                     }
   );
@@ -1036,9 +1129,10 @@ void SeamPlacer::calculate_candidates_visibility(const PrintObject *po,
   tbb::parallel_for(tbb::blocked_range<size_t>(0, layers.size()),
                     [&layers, &global_model_info](tbb::blocked_range<size_t> r) {
                       for (size_t layer_idx = r.begin(); layer_idx < r.end(); ++layer_idx) {
-                        for (auto &perimeter_point : layers[layer_idx].points) {
-                          perimeter_point.visibility = global_model_info.calculate_point_visibility(
-                              perimeter_point.position);
+                        PrintObjectSeamData::LayerSeams &layer_seams = layers[layer_idx];
+                        for (size_t point_idx = 0; point_idx < layer_seams.points.size(); ++point_idx) {
+                          layer_seams.points[point_idx].visibility = global_model_info.calculate_point_visibility(
+                              layer_seams.positions[point_idx]);
                         }
                       }
                     });
@@ -1068,8 +1162,9 @@ void SeamPlacer::calculate_overhangs_and_layer_embedding(const PrintObject *po)
                             to_unscaled_linesf(po->layers()[layer_idx]->lslices));
 
                         auto& layer_seams = layers[layer_idx];
-                        for (SeamCandidate &perimeter_point : layer_seams.points) {
-                          Vec2f point = Vec2f { perimeter_point.position.head<2>() };
+                        for (size_t point_idx = 0; point_idx < layer_seams.points.size(); ++point_idx) {
+                          SeamCandidate &perimeter_point = layer_seams.points[point_idx];
+                          Vec2f point = Vec2f { layer_seams.positions[point_idx].head<2>() };
                           if (prev_layer_distancer.get() != nullptr) {
                             const auto _dist = prev_layer_distancer->distance_from_lines<true>(point.cast<double>());
                             perimeter_point.overhang = _dist
@@ -1113,29 +1208,32 @@ std::optional<std::pair<size_t, size_t>> SeamPlacer::find_next_seam_in_layer(
     return {};
   }
 
+  const std::vector<SeamCandidate> &points    = layers[layer_idx].points;
+  const std::vector<Vec3f>         &positions = layers[layer_idx].positions;
   size_t best_nearby_point_index = nearby_points_indices[0];
   size_t nearest_point_index = nearby_points_indices[0];
 
   // Now find best nearby point, nearest point, and corresponding indices
   for (const size_t &nearby_point_index : nearby_points_indices) {
-    const SeamCandidate &point = layers[layer_idx].points[nearby_point_index];
+    const SeamCandidate &point = points[nearby_point_index];
     if (point.perimeter.finalized) {
       continue; // skip over finalized perimeters, try to find some that is not finalized
     }
-    if (comparator.is_first_better(point, layers[layer_idx].points[best_nearby_point_index],
+    if (comparator.is_first_better(point, positions[nearby_point_index],
+                                   points[best_nearby_point_index], positions[best_nearby_point_index],
                                    projected_position.head<2>())
-        || layers[layer_idx].points[best_nearby_point_index].perimeter.finalized) {
+        || points[best_nearby_point_index].perimeter.finalized) {
       best_nearby_point_index = nearby_point_index;
     }
-    if ((point.position - projected_position).squaredNorm()
-            < (layers[layer_idx].points[nearest_point_index].position - projected_position).squaredNorm()
-        || layers[layer_idx].points[nearest_point_index].perimeter.finalized) {
+    if ((positions[nearby_point_index] - projected_position).squaredNorm()
+            < (positions[nearest_point_index] - projected_position).squaredNorm()
+        || points[nearest_point_index].perimeter.finalized) {
       nearest_point_index = nearby_point_index;
     }
   }
 
-  const SeamCandidate &best_nearby_point = layers[layer_idx].points[best_nearby_point_index];
-  const SeamCandidate &nearest_point = layers[layer_idx].points[nearest_point_index];
+  const SeamCandidate &best_nearby_point = points[best_nearby_point_index];
+  const SeamCandidate &nearest_point = points[nearest_point_index];
 
   if (nearest_point.perimeter.finalized) {
     //all points are from already finalized perimeter, skip
@@ -1143,21 +1241,22 @@ std::optional<std::pair<size_t, size_t>> SeamPlacer::find_next_seam_in_layer(
   }
 
   //from the nearest_point, deduce index of seam in the next layer
-  const SeamCandidate &next_layer_seam = layers[layer_idx].points[nearest_point.perimeter.seam_index];
+  const SeamCandidate &next_layer_seam = points[nearest_point.perimeter.seam_index];
+  const Vec3f         &next_layer_seam_position = positions[nearest_point.perimeter.seam_index];
 
   // First try to pick central enforcer if any present
   if (next_layer_seam.central_enforcer
-      && (next_layer_seam.position - projected_position).squaredNorm()
+      && (next_layer_seam_position - projected_position).squaredNorm()
              < sqr(3 * max_distance)) {
     return {std::pair<size_t, size_t> {layer_idx, nearest_point.perimeter.seam_index}};
   }
 
   // First try to align the nearest, then try the best nearby
-  if (comparator.is_first_not_much_worse(nearest_point, next_layer_seam)) {
+  if (comparator.is_first_not_much_worse(nearest_point, positions[nearest_point_index], next_layer_seam, next_layer_seam_position)) {
     return {std::pair<size_t, size_t> {layer_idx, nearest_point_index}};
   }
   // If nearest point is not good enough, try it with the best nearby point.
-  if (comparator.is_first_not_much_worse(best_nearby_point, next_layer_seam)) {
+  if (comparator.is_first_not_much_worse(best_nearby_point, positions[best_nearby_point_index], next_layer_seam, next_layer_seam_position)) {
     return {std::pair<size_t, size_t> {layer_idx, best_nearby_point_index}};
   }
 
@@ -1190,7 +1289,7 @@ std::vector<std::pair<size_t, size_t>> SeamPlacer::find_seam_string(const PrintO
     }
     float max_distance = SeamPlacer::seam_align_tolerable_dist_factor *
                          layers[start_seam.first].points[start_seam.second].perimeter.flow_width;
-    Vec3f prev_position = layers[prev_point_index.first].points[prev_point_index.second].position;
+    Vec3f prev_position = layers[prev_point_index.first].positions[prev_point_index.second];
     Vec3f projected_position = prev_position;
     projected_position.z() = float(po->get_layer(next_layer)->slice_z);
 
@@ -1261,8 +1360,8 @@ void SeamPlacer::align_seam_points(const PrintObject *po, const SeamPlacerImpl::
   std::stable_sort(seams.begin(), seams.end(),
                    [&comparator, &layers](const std::pair<size_t, size_t> &left,
                                           const std::pair<size_t, size_t> &right) {
-                     return comparator.is_first_better(layers[left.first].points[left.second],
-                                                       layers[right.first].points[right.second]);
+                     return comparator.is_first_better(layers[left.first].points[left.second], layers[left.first].positions[left.second],
+                                                       layers[right.first].points[right.second], layers[right.first].positions[right.second]);
                    }
   );
 
@@ -1326,28 +1425,29 @@ void SeamPlacer::align_seam_points(const PrintObject *po, const SeamPlacerImpl::
 
       //gather points positions and weights
       float total_length = 0.0f;
-      Vec3f last_point_pos = layers[seam_string[0].first].points[seam_string[0].second].position;
+      Vec3f last_point_pos = layers[seam_string[0].first].positions[seam_string[0].second];
       for (size_t index = 0; index < seam_string.size(); ++index) {
         const SeamCandidate &current = layers[seam_string[index].first].points[seam_string[index].second];
+        const Vec3f &current_position = layers[seam_string[index].first].positions[seam_string[index].second];
         float layer_angle = 0.0f;
         if (index > 0 && index < seam_string.size() - 1) {
           layer_angle = angle_3d(
-              current.position
-                  - layers[seam_string[index - 1].first].points[seam_string[index - 1].second].position,
-              layers[seam_string[index + 1].first].points[seam_string[index + 1].second].position
-                  - current.position
+              current_position
+                  - layers[seam_string[index - 1].first].positions[seam_string[index - 1].second],
+              layers[seam_string[index + 1].first].positions[seam_string[index + 1].second]
+                  - current_position
           );
         }
-        observations[index] = current.position.head<2>();
-        observation_points[index] = current.position.z();
+        observations[index] = current_position.head<2>();
+        observation_points[index] = current_position.z();
         weights[index] = angle_weight(current.local_ccw_angle);
         float curling_influence = layer_angle > 2.0 * std::abs(current.local_ccw_angle) ? -0.8f : 1.0f;
         if (current.type == EnforcedBlockedSeamPoint::Enforced) {
           curling_influence = 1.0f;
           weights[index] += 3.0f;
         }
-        total_length += curling_influence * (last_point_pos - current.position).norm();
-        last_point_pos = current.position;
+        total_length += curling_influence * (last_point_pos - current_position).norm();
+        last_point_pos = current_position;
       }
 
       if (comparator.setup == spRear) {
@@ -1369,7 +1469,7 @@ void SeamPlacer::align_seam_points(const PrintObject *po, const SeamPlacerImpl::
           t = std::max(0.4f, t);
         }
 
-        Vec3f current_pos = layers[pair.first].points[pair.second].position;
+        Vec3f current_pos = layers[pair.first].positions[pair.second];
         Vec2f fitted_pos = curve.get_fitted_value(current_pos.z());
 
         //interpolate between current and fitted position, prefer current pos for large weights.
@@ -1387,10 +1487,10 @@ void SeamPlacer::align_seam_points(const PrintObject *po, const SeamPlacerImpl::
       };
       Vec3f color { randf(), randf(), randf() };
       for (size_t i = 0; i < seam_string.size(); ++i) {
-        auto orig_seam = layers[seam_string[i].first].points[seam_string[i].second];
-        fprintf(clusters, "v %f %f %f %f %f %f \n", orig_seam.position[0],
-                orig_seam.position[1],
-                orig_seam.position[2], color[0], color[1],
+        const Vec3f &orig_seam = layers[seam_string[i].first].positions[seam_string[i].second];
+        fprintf(clusters, "v %f %f %f %f %f %f \n", orig_seam[0],
+                orig_seam[1],
+                orig_seam[2], color[0], color[1],
                 color[2]);
       }
 
@@ -1459,13 +1559,13 @@ void SeamPlacer::init(const Print &print, std::function<void(void)> throw_if_can
       tbb::parallel_for(tbb::blocked_range<size_t>(0, layers.size()),
                         [&layers, configured_seam_preference, comparator](tbb::blocked_range<size_t> r) {
                           for (size_t layer_idx = r.begin(); layer_idx < r.end(); ++layer_idx) {
-                            std::vector<SeamCandidate> &layer_perimeter_points = layers[layer_idx].points;
-                            for (size_t current = 0; current < layer_perimeter_points.size();
-                                 current = layer_perimeter_points[current].perimeter.end_index)
+                            PrintObjectSeamData::LayerSeams &layer_seams = layers[layer_idx];
+                            for (size_t current = 0; current < layer_seams.points.size();
+                                 current = layer_seams.points[current].perimeter.end_index)
                               if (configured_seam_preference == spRandom)
-                                pick_random_seam_point(layer_perimeter_points, current);
+                                pick_random_seam_point(layer_seams, current);
                               else
-                                pick_seam_point(layer_perimeter_points, current, comparator);
+                                pick_seam_point(layer_seams, current, comparator);
                           }
                         });
       BOOST_LOG_TRIVIAL(debug)
@@ -1542,10 +1642,10 @@ void SeamPlacer::place_seam(const Layer *layer, ExtrusionLoop &loop,
   } else {
     seam_index =
         po->config().seam_position == spNearest ?
-                                                pick_nearest_seam_point_index(layer_perimeters.points, perimeter.start_index,
+                                                pick_nearest_seam_point_index(layer_perimeters, perimeter.start_index,
                                                                               unscaled<float>(last_pos)) :
                                                 perimeter.seam_index;
-    seam_position = layer_perimeters.points[seam_index].position;
+    seam_position = layer_perimeters.positions[seam_index];
   }
 
   Point seam_point = Point::new_scale(seam_position.x(), seam_position.y());
@@ -1553,6 +1653,7 @@ void SeamPlacer::place_seam(const Layer *layer, ExtrusionLoop &loop,
 
   if (loop.role() == ExtrusionRole::erPerimeter) { //Hopefully inner perimeter
     const SeamCandidate &perimeter_point = layer_perimeters.points[seam_index];
+    const Vec3f         &perimeter_point_position = layer_perimeters.positions[seam_index];
     ExtrusionLoop::ClosestPathPoint projected_point = loop.get_closest_path_and_point(seam_point, false);
     // determine depth of the seam point.
     float depth = (float) unscale(Point(seam_point - projected_point.foot_pt)).norm();
@@ -1566,18 +1667,18 @@ void SeamPlacer::place_seam(const Layer *layer, ExtrusionLoop &loop,
                                                               perimeter_point.perimeter.start_index :
                                                               seam_index + 1;
 
-    if ((seam_position - perimeter_point.position).squaredNorm() < depth && // seam is on perimeter point
+    if ((seam_position - perimeter_point_position).squaredNorm() < depth && // seam is on perimeter point
         perimeter_point.local_ccw_angle < -EPSILON // In concave angles
     ) { // In this case, we are at internal perimeter, where the external perimeter has seam in concave angle. We want to align
                                                                             // the internal seam into the concave corner, and not on the perpendicular projection on the closest edge (which is what the split_at function does)
       Vec2f dir_to_middle =
-          ((perimeter_point.position - layer_perimeters.points[index_of_prev].position).head<2>().normalized()
-           + (perimeter_point.position - layer_perimeters.points[index_of_next].position).head<2>().normalized())
+          ((perimeter_point_position - layer_perimeters.positions[index_of_prev]).head<2>().normalized()
+           + (perimeter_point_position - layer_perimeters.positions[index_of_next]).head<2>().normalized())
           * 0.5;
       depth = 1.4142 * depth / beta_angle;
       // There are some nice geometric identities in determination of the correct depth of new seam point.
       //overshoot the target depth, in concave angles it will correctly snap to the corner; TODO: find out why such big overshoot is needed.
-      Vec2f final_pos = perimeter_point.position.head<2>() + depth * dir_to_middle;
+      Vec2f final_pos = perimeter_point_position.head<2>() + depth * dir_to_middle;
       projected_point = loop.get_closest_path_and_point(Point::new_scale(final_pos.x(), final_pos.y()), false);
     } else { // not concave angle, in that case the nearest point is the good candidate
       // but for staggering, we also need to recompute depth of the inner perimter, because in convex corners, the distance is larger than layer width
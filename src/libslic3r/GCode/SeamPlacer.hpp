@@ -56,13 +56,15 @@ struct Perimeter {
 // then all the needed attributes are computed and finally, for each perimeter one point is chosen as seam.
 // This seam position can be then further aligned
 struct SeamCandidate {
-  SeamCandidate(const Vec3f &pos, Perimeter &perimeter,
+  SeamCandidate(Perimeter &perimeter,
                 float local_ccw_angle,
                 EnforcedBlockedSeamPoint type) :
-                                                 position(pos), perimeter(perimeter), visibility(0.0f), overhang(0.0f), embedded_distance(0.0f), local_ccw_angle(
+                                                 perimeter(perimeter), visibility(0.0f), overhang(0.0f), embedded_distance(0.0f), local_ccw_angle(
                                                                                                                                                      local_ccw_angle), type(type), central_enforcer(false) {
   }
-  const Vec3f position;
+  // The members are ordered by their alignment to not waste memory on padding, there are millions of candidates in a tall print.
+  // The position of the candidate is stored at the same index of LayerSeams::positions.
+
   // pointer to Perimeter loop of this point. It is shared across all points of the loop
   Perimeter &perimeter;
   float visibility;
@@ -76,25 +78,29 @@ struct SeamCandidate {
   bool central_enforcer; //marks this candidate as central point of enforced segment on the perimeter - important for alignment
 };
 
+// Reads the positions of the candidates from LayerSeams::positions, which are stored next to each other,
+// so that the KD tree queries do not walk over the other attributes of the candidates.
 struct SeamCandidateCoordinateFunctor {
-  SeamCandidateCoordinateFunctor(const std::vector<SeamCandidate> &seam_candidates) :
-                                                                                      seam_candidates(seam_candidates) {
+  SeamCandidateCoordinateFunctor(const std::vector<Vec3f> &positions) :
+                                                                        positions(positions) {
   }
-  const std::vector<SeamCandidate> &seam_candidates;
+  const std::vector<Vec3f> &positions;
   float operator()(size_t index, size_t dim) const {
-    return seam_candidates[index].position[dim];
+    return positions[index][dim];
   }
 };
 } // namespace SeamPlacerImpl
 
 struct PrintObjectSeamData
 {
-  using SeamCandidatesTree = KDTreeIndirect<3, float, SeamPlacerImpl::SeamCandidateCoordinateFunctor>;
+  using SeamCandidatesTree = KDTreeIndirect<3, float, SeamPlacerImpl::SeamCandidateCoordinateFunctor, uint32_t>;
 
   struct LayerSeams
   {
     Slic3r::deque<SeamPlacerImpl::Perimeter> perimeters;
     std::vector<SeamPlacerImpl::SeamCandidate> points;
+    // Positions of points, indexed the same as points and by points_tree.
+    std::vector<Vec3f> positions;
     std::unique_ptr<SeamCandidatesTree> points_tree;
   };
   // Map of PrintObjects (PO) -> vector of layers of PO -> vector of perimeter
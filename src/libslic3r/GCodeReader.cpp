@@ -1,6 +1,8 @@
 #include "GCodeReader.hpp"
 #include <boost/algorithm/string/classification.hpp>
 #include <boost/algorithm/string/split.hpp>
+#include <boost/filesystem/operations.hpp>
+#include <boost/iostreams/device/mapped_file.hpp>
 #include <boost/log/trivial.hpp>
 #include <boost/nowide/fstream.hpp>
 #include <boost/nowide/cstdio.hpp>
@@ -26,6 +28,40 @@ void GCodeReader::apply_config(const DynamicPrintConfig &config)
     m_config.apply(config, true);
 }
 
+// Parse a G-code axis value. The common plain decimal numbers of up to 15 significant digits ("-12.345") are converted exactly
+// with a single division by a power of ten (Clinger's fast path), everything else is left to fast_float,
+// thus the result is always the correctly rounded double, the same as returned by fast_float::from_chars().
+static inline const char* parse_axis_value(const char *begin, const char *end, double &value)
+{
+    static constexpr double pow10[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15 };
+    const char *c        = begin;
+    bool        negative = c != end && *c == '-';
+    if (negative)
+        ++ c;
+    uint64_t    mantissa   = 0;
+    int         num_digits = 0;
+    int         num_frac   = 0;
+    const char *digits     = c;
+    for (; c != end && *c >= '0' && *c <= '9'; ++ c, ++ num_digits)
+        mantissa = mantissa * 10 + uint64_t(*c - '0');
+    bool has_int = c != digits;
+    if (c != end && *c == '.') {
+        const char *frac = ++ c;
+        for (; c != end && *c >= '0' && *c <= '9'; ++ c, ++ num_digits)
+            mantissa = mantissa * 10 + uint64_t(*c - '0');
+        num_frac = int(c - frac);
+    }
+    if ((! has_int && num_frac == 0) || num_digits > 15 || (c != end && (*c == 'e' || *c == 'E'))) {
+        // Not a number, an exponent or too many digits to be converted exactly.
+        auto [pend, ec] = fast_float::from_chars(begin, end, value);
+        return ec == std::errc() ? pend : begin;
+    }
+    value = double(mantissa) / pow10[num_frac];
+    if (negative)
+        value = - value;
+    return c;
+}
+
 const char* GCodeReader::parse_line_internal(const char *ptr, const char *end, GCodeLine &gline, std::pair<const char*, const char*> &command)
 {
     PROFILE_FUNC();
@@ -67,7 +103,7 @@ const char* GCodeReader::parse_line_internal(const char *ptr, const char *end, G
             if (axis != NUM_AXES_WITH_UNKNOWN) {
                 // Try to parse the numeric value.
                 double v;
-                auto [pend, ec] = fast_float::from_chars(++ c, end, v);
+                const char *pend = parse_axis_value(++ c, end, v);
                 if (pend != c && is_end_of_word(*pend)) {
                     // The axis value has been parsed correctly.
                     if (axis != UNKNOWN_AXIS)
@@ -87,22 +123,24 @@ const char* GCodeReader::parse_line_internal(const char *ptr, const char *end, G
         m_position[E] = 0;
 
     // Skip the rest of the line.
-    for (; ! is_end_of_line(*c); ++ c);
+    for (; c != end && ! is_end_of_line(*c); ++ c);
 
-    // Copy the raw string including the comment, without the trailing newlines.
+    // Reference the raw string including the comment, without the trailing newlines.
+    // It is only copied if the callback asks for GCodeLine::raw().
     if (c > ptr) {
-        PROFILE_BLOCK(copy_raw_string);
-        gline.m_raw.assign(ptr, c);
+        gline.m_raw_view  = std::string_view(ptr, c - ptr);
+        gline.m_raw_valid = false;
     }
 
-    // Skip the trailing newlines.
-	if (*c == '\r')
+    // Skip the trailing newlines. The line may end at a CR, which is the last character of a memory mapped file,
+    // thus do not read past the end.
+	if (c != end && *c == '\r')
 		++ c;
-	if (*c == '\n')
+	if (c != end && *c == '\n')
 		++ c;
 
     if (m_verbose)
-        std::cout << gline.m_raw << std::endl;
+        std::cout << gline.m_raw_view << std::endl;
 
     return c;
 }
@@ -124,6 +162,61 @@ void GCodeReader::update_coordinates(GCodeLine &gline, std::pair<const char*, co
 
 template<typename ParseLineCallback, typename LineEndCallback>
 bool GCodeReader::parse_file_raw_internal(const std::string &filename, ParseLineCallback parse_line_callback, LineEndCallback line_end_callback)
+{
+    // Memory map the file, so that the lines are passed to the callback in place, without copying them into a line buffer.
+    boost::iostreams::mapped_file_source file;
+    {
+        boost::system::error_code ec;
+        if (boost::filesystem::file_size(filename, ec) > 0 && ! ec) {
+            try {
+                file.open(filename);
+            } catch (const std::exception &err) {
+                BOOST_LOG_TRIVIAL(warning) << "GCodeReader: can not map " << filename << ", reading it by blocks. Reason: " << err.what();
+            }
+        }
+    }
+    if (! file.is_open())
+        return this->parse_file_raw_buffered(filename, parse_line_callback, line_end_callback);
+
+    const char *begin = file.data();
+    const char *end   = begin + file.size();
+    // Position of the next LF, cached for files with CR line ends.
+    const char *next_lf = nullptr;
+    m_parsing = true;
+    for (const char *it = begin; it != end;) {
+        // Find end of line, a CR terminates a line as well.
+        if (next_lf < it) {
+            next_lf = static_cast<const char*>(memchr(it, '\n', end - it));
+            if (next_lf == nullptr)
+                next_lf = end;
+        }
+        const char *it_end = next_lf;
+        if (const char *cr = static_cast<const char*>(memchr(it, '\r', it_end - it)); cr != nullptr)
+            it_end = cr;
+        if (it_end == end) {
+            // The last line is not terminated by a newline. The parsers need a terminated string, thus copy the line.
+            std::string gcode_line(it, it_end);
+            parse_line_callback(gcode_line.c_str(), gcode_line.c_str() + gcode_line.size());
+            break;
+        }
+        parse_line_callback(it, it_end);
+        if (! m_parsing)
+            // The callback wishes to exit.
+            return true;
+        // Skip EOL.
+        it = it_end;
+        if (*it == '\r')
+            ++ it;
+        if (it != end && *it == '\n') {
+            line_end_callback(size_t(it - begin) + 1);
+            ++ it;
+        }
+    }
+    return true;
+}
+
+template<typename ParseLineCallback, typename LineEndCallback>
+bool GCodeReader::parse_file_raw_buffered(const std::string &filename, ParseLineCallback parse_line_callback, LineEndCallback line_end_callback)
 {
     FilePtr in{ boost::nowide::fopen(filename.c_str(), "rb") };
 
@@ -224,7 +317,7 @@ bool GCodeReader::parse_file_raw(const std::string &filename, raw_line_callback_
 
 bool GCodeReader::GCodeLine::has(char axis) const
 {
-    const char *c = m_raw.c_str();
+    const char *c = m_raw_view.data();
     // Skip the whitespaces.
     c = skip_whitespaces(c);
     // Skip the command.
@@ -247,7 +340,7 @@ bool GCodeReader::GCodeLine::has(char axis) const
 bool GCodeReader::GCodeLine::has_value(char axis, float &value) const
 {
     assert(is_decimal_separator_point());
-    const char *c = m_raw.c_str();
+    const char *c = m_raw_view.data();
     // Skip the whitespaces.
     c = skip_whitespaces(c);
     // Skip the command.
@@ -295,6 +388,8 @@ void GCodeReader::GCodeLine::set(const Axis axis, const float new_value, const i
         match[1] = 'E';
     }
 
+    // Materialize the raw string before modifying it.
+    this->raw();
     if (this->has(axis)) {
         size_t pos = m_raw.find(match)+2;
         size_t end = m_raw.find(' ', pos+1);
@@ -306,6 +401,7 @@ void GCodeReader::GCodeLine::set(const Axis axis, const float new_value, const i
         else
             m_raw = m_raw.replace(pos, 0, std::string(match) + ss.str());
     }
+    m_raw_view = m_raw;
     m_axis[axis] = new_value;
     m_mask |= 1 << int(axis);
 }
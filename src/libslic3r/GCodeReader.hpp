@@ -16,17 +16,41 @@ public:
     class GCodeLine {
     public:
         GCodeLine() { reset(); }
-        void reset() { m_mask = 0; memset(m_axis, 0, sizeof(m_axis)); m_raw.clear(); }
-
-        const std::string&      raw() const { return m_raw; }
+        // Copies always own their raw string, as the source line may reference a parser buffer, which is only valid inside the callback.
+        GCodeLine(const GCodeLine &rhs) : m_raw(rhs.m_raw_view), m_raw_view(m_raw), m_raw_valid(true), m_mask(rhs.m_mask) { memcpy(m_axis, rhs.m_axis, sizeof(m_axis)); }
+        GCodeLine& operator=(const GCodeLine &rhs) {
+            if (this != &rhs) {
+                m_raw.assign(rhs.m_raw_view.data(), rhs.m_raw_view.size());
+                m_raw_view  = m_raw;
+                m_raw_valid = true;
+                m_mask      = rhs.m_mask;
+                memcpy(m_axis, rhs.m_axis, sizeof(m_axis));
+            }
+            return *this;
+        }
+        void reset() { m_mask = 0; memset(m_axis, 0, sizeof(m_axis)); m_raw.clear(); m_raw_view = m_raw; m_raw_valid = true; }
+
+        // The raw line is materialized into a std::string on demand only, lines parsed from a file or a buffer
+        // reference the parser buffer. Prefer raw_view() on hot paths.
+        const std::string&      raw() const {
+            if (! m_raw_valid) {
+                m_raw.assign(m_raw_view.data(), m_raw_view.size());
+                m_raw_view  = m_raw;
+                m_raw_valid = true;
+            }
+            return m_raw;
+        }
+        // Raw line without the trailing newlines. Points either into the parser buffer or to raw(),
+        // in both cases it is followed by a newline or a zero terminator.
+        std::string_view        raw_view() const { return m_raw_view; }
         const std::string_view  cmd() const { 
-            const char *cmd = GCodeReader::skip_whitespaces(m_raw.c_str());
+            const char *cmd = GCodeReader::skip_whitespaces(m_raw_view.data());
             return std::string_view(cmd, GCodeReader::skip_word(cmd) - cmd);
         }
         const std::string_view  comment() const
-            { size_t pos = m_raw.find(';'); return (pos == std::string::npos) ? std::string_view() : std::string_view(m_raw).substr(pos + 1); }
+            { size_t pos = m_raw_view.find(';'); return (pos == std::string_view::npos) ? std::string_view() : m_raw_view.substr(pos + 1); }
 
-        void  clear() { m_raw.clear(); }
+        void  clear() { m_raw.clear(); m_raw_view = m_raw; m_raw_valid = true; }
         bool  has(Axis axis) const { return (m_mask & (1 << int(axis))) != 0; }
         float value(Axis axis) const { return m_axis[axis]; }
         bool  has(char axis) const;
@@ -45,7 +69,7 @@ public:
             float y = this->has(Y) ? (this->y() - reader.y()) : 0;
             return sqrt(x*x + y*y);
         }
-        bool cmd_is(const char *cmd_test)          const { return cmd_is(m_raw, cmd_test); }
+        bool cmd_is(const char *cmd_test)          const { return cmd_is(m_raw_view.data(), cmd_test); }
         //BBS: modify to support G2 and G3
         bool extruding(const GCodeReader &reader)  const { return (this->cmd_is("G1") || this->cmd_is("G2") || this->cmd_is("G3")) && this->dist_E(reader) > 0; }
         bool retracting(const GCodeReader &reader) const { return (this->cmd_is("G1") || this->cmd_is("G2") || this->cmd_is("G3")) && this->dist_E(reader) < 0; }
@@ -73,8 +97,10 @@ public:
         float j() const { return m_axis[J]; }
         float p() const { return m_axis[P]; }
 
-        static bool cmd_is(const std::string &gcode_line, const char *cmd_test) {
-            const char *cmd = GCodeReader::skip_whitespaces(gcode_line.c_str());
+        static bool cmd_is(const std::string &gcode_line, const char *cmd_test) { return cmd_is(gcode_line.c_str(), cmd_test); }
+        // gcode_line has to be terminated by a newline or by a zero.
+        static bool cmd_is(const char *gcode_line, const char *cmd_test) {
+            const char *cmd = GCodeReader::skip_whitespaces(gcode_line);
             size_t len = strlen(cmd_test); 
             return strncmp(cmd, cmd_test, len) == 0 && GCodeReader::is_end_of_word(cmd[len]);
         }
@@ -85,14 +111,18 @@ public:
 
         static std::string extract_cmd(const std::string& gcode_line) {
             GCodeLine temp;
-            temp.m_raw = gcode_line;
+            temp.m_raw      = gcode_line;
+            temp.m_raw_view = temp.m_raw;
             const std::string_view cmd = temp.cmd();
             return { cmd.begin(), cmd.end() };
         }
     private:
-        std::string      m_raw;
-        float            m_axis[NUM_AXES];
-        uint32_t         m_mask;
+        mutable std::string      m_raw;
+        mutable std::string_view m_raw_view;
+        // Is m_raw_view pointing to m_raw?
+        mutable bool             m_raw_valid;
+        float                    m_axis[NUM_AXES];
+        uint32_t                 m_mask;
         friend class GCodeReader;
     };
 
@@ -165,6 +195,9 @@ public:
 private:
     template<typename ParseLineCallback, typename LineEndCallback>
     bool        parse_file_raw_internal(const std::string &filename, ParseLineCallback parse_line_callback, LineEndCallback line_end_callback);
+    // Fallback of parse_file_raw_internal() if the file could not be memory mapped.
+    template<typename ParseLineCallback, typename LineEndCallback>
+    bool        parse_file_raw_buffered(const std::string &filename, ParseLineCallback parse_line_callback, LineEndCallback line_end_callback);
     template<typename ParseLineCallback, typename LineEndCallback>
     bool        parse_file_internal(const std::string &filename, ParseLineCallback parse_line_callback, LineEndCallback line_end_callback);
 
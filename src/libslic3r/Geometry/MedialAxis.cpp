@@ -444,34 +444,45 @@ private:
     const Lines &lines;
 };
 
-MedialAxis::MedialAxis(double min_width, double max_width, const ExPolygon &expolygon) :
-    m_expolygon(expolygon), m_lines(expolygon.lines()), m_min_width(min_width), m_max_width(max_width)
+MedialAxis::MedialAxis(double min_width, double max_width, const ExPolygon &expolygon, VoronoiDiagramCache *voronoi_cache) :
+    m_expolygon(expolygon), m_lines(expolygon.lines()), m_min_width(min_width), m_max_width(max_width), m_voronoi_cache(voronoi_cache)
 {}
 
+// Construct the Voronoi diagram annotated inside / outside of the polygons, which lines are m_lines, or get it from the cache.
+std::shared_ptr<const VoronoiDiagram> MedialAxis::construct_voronoi(const Polygons &polygons)
+{
+    if (m_voronoi_cache)
+        return m_voronoi_cache->get(polygons, true);
+
+    auto vd = std::make_shared<VD>();
+    vd->construct_voronoi(m_lines.begin(), m_lines.end());
+    Slic3r::Voronoi::annotate_inside_outside(*vd, m_lines);
+    return vd;
+}
+
 void MedialAxis::build(ThickPolylines* polylines)
 {
-    m_vd.construct_voronoi(m_lines.begin(), m_lines.end());
+    m_vd = this->construct_voronoi(to_polygons(m_expolygon));
 
     // For several ExPolygons in SPE-1729, an invalid Voronoi diagram was produced that wasn't fixable by rotating input data.
     // Those ExPolygons contain very thin lines and holes formed by very close (1-5nm) vertices that are on the edge of our resolution.
     // Those thin lines and holes are both unprintable and cause the Voronoi diagram to be invalid.
     // So we filter out such thin lines and holes and try to compute the Voronoi diagram again.
-    if (!m_vd.is_valid()) {
-        m_lines = to_lines(closing_ex({m_expolygon}, float(2. * SCALED_EPSILON)));
-        m_vd.construct_voronoi(m_lines.begin(), m_lines.end());
+    if (!m_vd->is_valid()) {
+        ExPolygons closed = closing_ex({m_expolygon}, float(2. * SCALED_EPSILON));
+        m_lines = to_lines(closed);
+        m_vd    = this->construct_voronoi(to_polygons(closed));
 
-        if (!m_vd.is_valid())
+        if (!m_vd->is_valid())
             BOOST_LOG_TRIVIAL(error) << "MedialAxis - Invalid Voronoi diagram even after morphological closing.";
     }
-
-    Slic3r::Voronoi::annotate_inside_outside(m_vd, m_lines);
 //    static constexpr double threshold_alpha = M_PI / 12.; // 30 degrees
 //    std::vector<Vec2d> skeleton_edges = Slic3r::Voronoi::skeleton_edges_rough(vd, lines, threshold_alpha);
     
     /*
     // DEBUG: dump all Voronoi edges
     {
-        for (VD::const_edge_iterator edge = m_vd.edges().begin(); edge != m_vd.edges().end(); ++edge) {
+        for (VD::const_edge_iterator edge = m_vd->edges().begin(); edge != m_vd->edges().end(); ++edge) {
             if (edge->is_infinite()) continue;
             
             ThickPolyline polyline;
@@ -485,8 +496,8 @@ void MedialAxis::build(ThickPolylines* polylines)
     
     // collect valid edges (i.e. prune those not belonging to MAT)
     // note: this keeps twins, so it inserts twice the number of the valid edges
-    m_edge_data.assign(m_vd.edges().size() / 2, EdgeData{});
-    for (VD::const_edge_iterator edge = m_vd.edges().begin(); edge != m_vd.edges().end(); edge += 2)
+    m_edge_data.assign(m_vd->edges().size() / 2, EdgeData{});
+    for (VD::const_edge_iterator edge = m_vd->edges().begin(); edge != m_vd->edges().end(); edge += 2)
         if (edge->is_primary() && edge->is_finite() &&
             (Voronoi::vertex_category(edge->vertex0()) == Voronoi::VertexCategory::Inside ||
              Voronoi::vertex_category(edge->vertex1()) == Voronoi::VertexCategory::Inside) &&
@@ -497,7 +508,7 @@ void MedialAxis::build(ThickPolylines* polylines)
     
     // iterate through the valid edges to build polylines
     ThickPolyline reverse_polyline;
-    for (VD::const_edge_iterator seed_edge = m_vd.edges().begin(); seed_edge != m_vd.edges().end(); seed_edge += 2)
+    for (VD::const_edge_iterator seed_edge = m_vd->edges().begin(); seed_edge != m_vd->edges().end(); seed_edge += 2)
         if (EdgeData &seed_edge_data = this->edge_data(*seed_edge).first; seed_edge_data.active) {
             // Mark this edge as visited.
             seed_edge_data.active = false;
@@ -533,7 +544,7 @@ void MedialAxis::build(ThickPolylines* polylines)
     #ifdef SLIC3R_DEBUG
     {
         static int iRun = 0;
-        dump_voronoi_to_svg(m_lines, m_vd, polylines, debug_out_path("MedialAxis-%d.svg", iRun ++).c_str());
+        dump_voronoi_to_svg(m_lines, *m_vd, polylines, debug_out_path("MedialAxis-%d.svg", iRun ++).c_str());
         printf("Thick lines: ");
         for (ThickPolylines::const_iterator it = polylines->begin(); it != polylines->end(); ++ it) {
             ThickLines lines = it->thicklines();
@@ -8,7 +8,8 @@ namespace Slic3r::Geometry {
 
 class MedialAxis {
 public:
-    MedialAxis(double min_width, double max_width, const ExPolygon &expolygon);
+    // If voronoi_cache is set, the Voronoi diagram is shared with the other users of the cache working on the same polygons.
+    MedialAxis(double min_width, double max_width, const ExPolygon &expolygon, VoronoiDiagramCache *voronoi_cache = nullptr);
     void build(ThickPolylines* polylines);
     void build(Polylines* polylines);
     
@@ -19,10 +20,12 @@ private:
     // for filtering of the skeleton edges
     double               m_min_width;
     double               m_max_width;
+    VoronoiDiagramCache *m_voronoi_cache;
 
-    // Voronoi Diagram.
+    // Voronoi Diagram, annotated inside / outside.
     using VD = VoronoiDiagram;
-    VD                   m_vd;
+    std::shared_ptr<const VD> m_vd;
+    std::shared_ptr<const VD> construct_voronoi(const Polygons &polygons);
 
     // Annotations of the VD skeleton edges.
     struct EdgeData {
@@ -32,7 +35,7 @@ private:
     };
     // Returns a reference to EdgeData and a "reversed" boolean.
     std::pair<EdgeData&, bool> edge_data(const VD::edge_type &edge) {
-        size_t edge_id = &edge - &m_vd.edges().front();
+        size_t edge_id = &edge - &m_vd->edges().front();
         return { m_edge_data[edge_id / 2], (edge_id & 1) != 0 };
     }
     std::vector<EdgeData> m_edge_data;
@@ -1,10 +1,14 @@
 #include "Voronoi.hpp"
 
 #include "libslic3r/Arachne/utils/PolygonsSegmentIndex.hpp"
+#include "libslic3r/Geometry/VoronoiOffset.hpp"
 #include "libslic3r/Geometry/VoronoiUtils.hpp"
 #include "libslic3r/Geometry/VoronoiUtilsCgal.hpp"
 #include "libslic3r/MultiMaterialSegmentation.hpp"
 
+#include <chrono>
+
+#include <boost/functional/hash.hpp>
 #include <boost/log/trivial.hpp>
 
 namespace Slic3r::Geometry {
@@ -353,4 +357,64 @@ VoronoiDiagram::try_to_repair_degenerated_voronoi_diagram_by_rotation(const Segm
     return issue_type;
 }
 
+struct VoronoiDiagramCache::Entry
+{
+    size_t         hash;
+    Polygons       polygons;
+    bool           annotated;
+    VoronoiDiagram voronoi_diagram;
+    std::once_flag constructed;
+};
+
+std::shared_ptr<const VoronoiDiagram> VoronoiDiagramCache::get(const Polygons &polygons, bool annotate_inside_outside)
+{
+    size_t hash = 0;
+    boost::hash_combine(hash, annotate_inside_outside);
+    for (const Polygon &polygon : polygons) {
+        boost::hash_combine(hash, polygon.size());
+        for (const Point &pt : polygon.points) {
+            boost::hash_combine(hash, pt.x());
+            boost::hash_combine(hash, pt.y());
+        }
+    }
+
+    std::shared_ptr<Entry> entry;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = std::find_if(m_entries.begin(), m_entries.end(),
+            [hash, &polygons, annotate_inside_outside](const std::shared_ptr<Entry> &e) {
+                return e->hash == hash && e->annotated == annotate_inside_outside && e->polygons == polygons;
+            });
+        if (it != m_entries.end()) {
+            entry = *it;
+            m_entries.splice(m_entries.begin(), m_entries, it);
+            ++ m_stats.hits;
+        } else {
+            entry = std::make_shared<Entry>();
+            entry->hash     = hash;
+            entry->polygons  = polygons;
+            entry->annotated = annotate_inside_outside;
+            m_entries.emplace_front(entry);
+            if (m_entries.size() > m_capacity)
+                m_entries.pop_back();
+            ++ m_stats.misses;
+        }
+    }
+
+    // The diagram is constructed and annotated outside of the lock, before it is returned to any thread.
+    // Threads asking for the same diagram in the meantime wait for it.
+    std::call_once(entry->constructed, [this, &entry]() {
+        auto  start_time = std::chrono::steady_clock::now();
+        Lines lines      = to_lines(entry->polygons);
+        entry->voronoi_diagram.construct_voronoi(lines.begin(), lines.end());
+        if (entry->annotated)
+            Voronoi::annotate_inside_outside(entry->voronoi_diagram, lines);
+        double construct_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stats.construct_time += construct_time;
+    });
+
+    return std::shared_ptr<const VoronoiDiagram>(entry, &entry->voronoi_diagram);
+}
+
 } // namespace Slic3r::Geometry
@@ -2,8 +2,13 @@
 #define slic3r_Geometry_Voronoi_hpp_
 
 #include "../Line.hpp"
+#include "../Polygon.hpp"
 #include "../Polyline.hpp"
 
+#include <list>
+#include <memory>
+#include <mutex>
+
 #ifdef _MSC_VER
 // Suppress warning C4146 in OpenVDB: unary minus operator applied to unsigned type, result still unsigned
 #pragma warning(push)
@@ -174,6 +179,40 @@ public:
     friend struct boost::polygon::segment_traits<Slic3r::Geometry::VoronoiDiagram::Segment>;
 };
 
+// Thread safe cache of the Voronoi diagrams of closed polygons, to share a diagram between the consumers working
+// on the same polygons, namely the Arachne perimeter generator and the medial axis, and between the layers
+// of a prismatic object with the same outlines.
+// The diagram is constructed from the segments of the polygons in the order of Polygon::lines(), which is also the order
+// of Arachne::PolygonsSegmentIndex. The diagram is immutable once returned. The diagrams annotated with the inside / outside
+// classification of their vertices and edges are cached separately from the plain ones, as the annotation modifies the diagram.
+class VoronoiDiagramCache
+{
+public:
+    struct Stats
+    {
+        size_t hits   { 0 };
+        size_t misses { 0 };
+        // Time spent constructing the diagrams, in seconds.
+        double construct_time { 0. };
+    };
+
+    // Keeps up to capacity least recently used diagrams.
+    explicit VoronoiDiagramCache(size_t capacity = 64) : m_capacity(capacity) {}
+
+    std::shared_ptr<const VoronoiDiagram> get(const Polygons &polygons, bool annotate_inside_outside = false);
+
+    Stats stats() const { std::lock_guard<std::mutex> lock(m_mutex); return m_stats; }
+
+private:
+    struct Entry;
+
+    size_t                            m_capacity;
+    mutable std::mutex                m_mutex;
+    // The most recently used entries first.
+    std::list<std::shared_ptr<Entry>> m_entries;
+    Stats                             m_stats;
+};
+
 } // namespace Slic3r::Geometry
 
 namespace boost::polygon {
@@ -4,6 +4,7 @@
 #define slic3r_KDTreeIndirect_hpp_
 
 #include <algorithm>
+#include <cassert>
 #include <limits>
 #include <vector>
 
@@ -18,13 +19,16 @@ enum class VisitorReturnMask : unsigned int {
 };
 
 // KD tree for N-dimensional closest point search.
-template<size_t ANumDimensions, typename ACoordType, typename ACoordinateFn>
+// The tree is stored as a complete binary tree in a single array of indices. The indices may be stored with a narrower
+// type than size_t (for example uint32_t) to halve the memory of large trees, which also keeps more of the tree in the cache.
+template<size_t ANumDimensions, typename ACoordType, typename ACoordinateFn, typename AIndexType = size_t>
 class KDTreeIndirect
 {
 public:
     static constexpr size_t NumDimensions = ANumDimensions;
     using					CoordinateFn  = ACoordinateFn;
     using					CoordType     = ACoordType;
+    using					IndexType     = AIndexType;
     // Following could be static constexpr size_t, but that would not link in C++11
     enum : size_t {
         npos = size_t(-1)
@@ -36,6 +40,8 @@ public:
     KDTreeIndirect(KDTreeIndirect &&rhs) : m_nodes(std::move(rhs.m_nodes)), coordinate(std::move(rhs.coordinate)) {}
     KDTreeIndirect& operator=(KDTreeIndirect &&rhs) { m_nodes = std::move(rhs.m_nodes); coordinate = std::move(rhs.coordinate); return *this; }
     void clear() { m_nodes.clear(); }
+    // Number of nodes of the tree array, including the empty nodes of the incomplete last level.
+    size_t num_nodes() const { return m_nodes.size(); }
 
     void build(size_t num_indices)
     {
@@ -51,8 +57,9 @@ public:
         if (indices.empty())
             clear();
         else {
+            assert(indices.size() < size_t(std::numeric_limits<IndexType>::max()));
             // Allocate enough memory for a full binary tree.
-            m_nodes.assign(next_highest_power_of_2(indices.size() + 1), npos);
+            m_nodes.assign(next_highest_power_of_2(indices.size() + 1), empty_node);
             build_recursive(indices, 0, 0, 0, indices.size() - 1);
         }
         indices.clear();
@@ -89,7 +96,7 @@ private:
 
         if (left == right) {
             // Insert a node into the balanced tree.
-            m_nodes[node] = input[left];
+            m_nodes[node] = IndexType(input[left]);
             return;
         }
 
@@ -97,7 +104,7 @@ private:
         size_t center = (left + right) / 2;
         partition_input(input, dimension, left, right, center);
         // Insert a node into the tree.
-        m_nodes[node] = input[center];
+        m_nodes[node] = IndexType(input[center]);
         // Build up the left / right subtrees.
         size_t next_dimension = dimension;
         if (++ next_dimension == NumDimensions)
@@ -170,13 +177,13 @@ private:
     void visit_recursive(size_t node, size_t dimension, Visitor &visitor) const
     {
         assert(! m_nodes.empty());
-        if (node >= m_nodes.size() || m_nodes[node] == npos)
+        if (node >= m_nodes.size() || m_nodes[node] == empty_node)
             return;
 
            // Left / right child node index.
         size_t left  = node * 2 + 1;
         size_t right = left + 1;
-        unsigned int mask = visitor(m_nodes[node], dimension);
+        unsigned int mask = visitor(size_t(m_nodes[node]), dimension);
         if ((mask & (unsigned int)VisitorReturnMask::STOP) == 0) {
             size_t next_dimension = (++ dimension == NumDimensions) ? 0 : dimension;
             if (mask & (unsigned int)VisitorReturnMask::CONTINUE_LEFT)
@@ -186,7 +193,8 @@ private:
         }
     }
 
-    std::vector<size_t> m_nodes;
+    static constexpr IndexType empty_node = std::numeric_limits<IndexType>::max();
+    std::vector<IndexType> m_nodes;
 };
 
 // Find a closest point using Euclidian metrics.
@@ -196,13 +204,14 @@ template<size_t K,
          typename FilterFn,
          size_t D,
          typename CoordT,
-         typename CoordFn>
+         typename CoordFn,
+         typename IndexT>
 std::array<size_t, K> find_closest_points(
-    const KDTreeIndirect<D, CoordT, CoordFn> &kdtree,
-    const PointType                          &point,
-    FilterFn                                  filter)
+    const KDTreeIndirect<D, CoordT, CoordFn, IndexT> &kdtree,
+    const PointType                                  &point,
+    FilterFn                                          filter)
 {
-    using Tree = KDTreeIndirect<D, CoordT, CoordFn>;
+    using Tree = KDTreeIndirect<D, CoordT, CoordFn, IndexT>;
 
     struct Visitor
     {
@@ -251,9 +260,9 @@ std::array<size_t, K> find_closest_points(
     return ret;
 }
 
-template<size_t K, typename PointType, size_t D, typename CoordT, typename CoordFn>
+template<size_t K, typename PointType, size_t D, typename CoordT, typename CoordFn, typename IndexT>
 std::array<size_t, K> find_closest_points(
-    const KDTreeIndirect<D, CoordT, CoordFn> &kdtree, const PointType &point)
+    const KDTreeIndirect<D, CoordT, CoordFn, IndexT> &kdtree, const PointType &point)
 {
     return find_closest_points<K>(kdtree, point, [](size_t) { return true; });
 }
@@ -262,10 +271,11 @@ template<typename PointType,
          typename FilterFn,
          size_t D,
          typename CoordT,
-         typename CoordFn>
-size_t find_closest_point(const KDTreeIndirect<D, CoordT, CoordFn> &kdtree,
-                          const PointType                          &point,
-                          FilterFn                                  filter)
+         typename CoordFn,
+         typename IndexT>
+size_t find_closest_point(const KDTreeIndirect<D, CoordT, CoordFn, IndexT> &kdtree,
+                          const PointType                                  &point,
+                          FilterFn                                          filter)
 {
     return find_closest_points<1>(kdtree, point, filter)[0];
 }
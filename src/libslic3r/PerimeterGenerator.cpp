@@ -1998,7 +1998,7 @@ void PerimeterGenerator::process_classic()
                             float(min_width / 2.));
                         // the maximum thickness of our thin wall area is equal to the minimum thickness of a single loop
                         for (ExPolygon &ex : expp)
-                            ex.medial_axis(min_width, ext_perimeter_width + ext_perimeter_spacing2, &thin_walls);
+                            ex.medial_axis(min_width, ext_perimeter_width + ext_perimeter_spacing2, &thin_walls, this->voronoi_cache);
                     } else {
                         coord_t ext_perimeter_smaller_width = this->smaller_ext_perimeter_flow.scaled_width();
                         for (const ExPolygon& expolygon : last) {
@@ -2319,7 +2319,7 @@ void PerimeterGenerator::process_classic()
             for (ExPolygon& ex : gaps_ex) {
                 //BBS: Use DP simplify to avoid duplicated points and accelerate medial-axis calculation as well.
                 ex.douglas_peucker(surface_simplify_resolution);
-                ex.medial_axis(min, max, &polylines);
+                ex.medial_axis(min, max, &polylines, this->voronoi_cache);
             }
 
 #ifdef GAPS_OF_PERIMETER_DEBUG_TO_SVG
@@ -2896,6 +2896,7 @@ void PerimeterGenerator::process_arachne()
         Arachne::WallToolPathsParams input_params = Arachne::make_paths_params(this->layer_id, *object_config, *print_config);
         // Set params is_top_or_bottom_layer for adjusting short-wall removal sensitivity.
         input_params.is_top_or_bottom_layer = (is_bottom_layer || is_topmost_layer) ? true : false;
+        input_params.voronoi_cache = this->voronoi_cache;
 
         coord_t wall_0_inset = 0;
         if (apply_precise_outer_wall)
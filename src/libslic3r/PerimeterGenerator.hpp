@@ -58,6 +58,8 @@ public:
     const PrintRegionConfig     *config;
     const PrintObjectConfig     *object_config;
     const PrintConfig           *print_config;
+    // Voronoi diagrams shared by the layers of the PrintObject, may be null.
+    Geometry::VoronoiDiagramCache *voronoi_cache { nullptr };
     // Outputs:
     ExtrusionEntityCollection   *loops;
     ExtrusionEntityCollection   *gap_fill;
@@ -0,0 +1,163 @@
+#include "PersistentSliceCache.hpp"
+#include "Format/SliceCache.hpp"
+
+#include <algorithm>
+#include <ctime>
+
+#include <boost/filesystem.hpp>
+#include <boost/format.hpp>
+#include <boost/log/trivial.hpp>
+
+namespace Slic3r {
+
+static const char *SLICE_CACHE_ENTRY_EXTENSION = ".slices";
+
+PersistentSliceCache::PersistentSliceCache(const std::string &directory, uint64_t max_bytes) :
+    m_directory(directory), m_max_bytes(max_bytes)
+{
+    boost::system::error_code ec;
+    boost::filesystem::create_directories(m_directory, ec);
+    if (ec)
+        BOOST_LOG_TRIVIAL(error) << "PersistentSliceCache: can not create directory " << m_directory << ", reason = " << ec.message();
+    // Calculate the current size and apply the (possibly changed) size budget.
+    this->shrink_to_fit();
+}
+
+std::string PersistentSliceCache::entry_path(const std::string &key) const
+{
+    return (boost::filesystem::path(m_directory) / (key + SLICE_CACHE_ENTRY_EXTENSION)).string();
+}
+
+bool PersistentSliceCache::load(const std::string &key, size_t num_layers, std::vector<ExPolygons> &layers)
+{
+    const std::string path = this->entry_path(key);
+    SliceCacheReader  reader;
+    bool              valid = reader.open(path);
+    if (valid) {
+        // The slicing heights are part of the key, an entry with a different number of layers does not belong to it.
+        valid = reader.layer_count() == num_layers;
+        layers.assign(valid ? num_layers : 0, ExPolygons());
+        std::vector<BoundingBox> bboxes;
+        ExPolygons               overhangs;
+        for (size_t i = 0; valid && i < layers.size(); ++ i)
+            valid = reader.load_layer(i, layers[i], bboxes, overhangs);
+        reader.close();
+        boost::system::error_code ec;
+        if (valid) {
+            // Refresh the entry for the least recently used eviction policy.
+            boost::filesystem::last_write_time(path, std::time(nullptr), ec);
+            std::lock_guard<std::mutex> lock(m_mutex);
+            auto     it   = m_entries_map.find(key);
+            uint64_t size = it == m_entries_map.end() ? boost::filesystem::file_size(path, ec) : it->second->size;
+            this->touch_locked(key, ec ? 0 : size);
+        } else {
+            BOOST_LOG_TRIVIAL(warning) << "PersistentSliceCache: removing corrupted entry " << path;
+            boost::filesystem::remove(path, ec);
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (auto it = m_entries_map.find(key); it != m_entries_map.end())
+                this->remove_locked(it->second);
+        }
+    }
+    if (! valid)
+        layers.clear();
+    ++ (valid ? m_hits : m_misses);
+    return valid;
+}
+
+void PersistentSliceCache::store(const std::string &key, const std::vector<ExPolygons> &layers)
+{
+    SliceCacheWriter writer(layers.size());
+    for (size_t i = 0; i < layers.size(); ++ i)
+        writer.set_layer(i, layers[i], {}, {});
+    // Write into a temporary file first and rename it, so that the other processes never see a partially written entry.
+    const std::string         path     = this->entry_path(key);
+    const std::string         tmp_path = path + "." + boost::filesystem::unique_path().string() + ".tmp";
+    boost::system::error_code ec;
+    if (! writer.save(tmp_path)) {
+        boost::filesystem::remove(tmp_path, ec);
+        return;
+    }
+    uint64_t size = boost::filesystem::file_size(tmp_path, ec);
+    boost::filesystem::rename(tmp_path, path, ec);
+    if (ec) {
+        BOOST_LOG_TRIVIAL(error) << "PersistentSliceCache: can not store " << path << ", reason = " << ec.message();
+        boost::filesystem::remove(tmp_path, ec);
+        return;
+    }
+    ++ m_stores;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    this->touch_locked(key, size);
+    this->evict_locked();
+}
+
+void PersistentSliceCache::shrink_to_fit()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    // Rescan the directory, as the other processes sharing the cache may have added or removed entries in the meantime.
+    std::vector<Entry>        entries;
+    boost::system::error_code ec;
+    for (boost::filesystem::directory_iterator it(m_directory, ec), end; ! ec && it != end; it.increment(ec))
+        if (it->path().extension() == SLICE_CACHE_ENTRY_EXTENSION) {
+            boost::system::error_code ec2;
+            Entry entry { it->path().stem().string(), boost::filesystem::last_write_time(it->path(), ec2), boost::filesystem::file_size(it->path(), ec2) };
+            if (! ec2)
+                entries.emplace_back(std::move(entry));
+        }
+    std::sort(entries.begin(), entries.end(), [](const Entry &l, const Entry &r) { return l.time < r.time; });
+    m_entries.clear();
+    m_entries_map.clear();
+    m_bytes = 0;
+    for (Entry &entry : entries) {
+        m_bytes += entry.size;
+        m_entries.emplace_back(std::move(entry));
+        m_entries_map[m_entries.back().key] = std::prev(m_entries.end());
+    }
+    this->evict_locked();
+}
+
+void PersistentSliceCache::touch_locked(const std::string &key, uint64_t size)
+{
+    if (auto it = m_entries_map.find(key); it != m_entries_map.end())
+        this->remove_locked(it->second);
+    m_entries.push_back({ key, std::time(nullptr), size });
+    m_entries_map[key] = std::prev(m_entries.end());
+    m_bytes += size;
+}
+
+void PersistentSliceCache::remove_locked(EntryList::iterator it)
+{
+    m_bytes -= it->size;
+    m_entries_map.erase(it->key);
+    m_entries.erase(it);
+}
+
+void PersistentSliceCache::evict_locked()
+{
+    while (m_max_bytes > 0 && m_bytes > m_max_bytes && ! m_entries.empty()) {
+        // Another process may have removed the entry already, count the space as released anyway.
+        boost::system::error_code ec;
+        boost::filesystem::remove(this->entry_path(m_entries.front().key), ec);
+        this->remove_locked(m_entries.begin());
+        ++ m_evictions;
+    }
+}
+
+PersistentSliceCache::Stats PersistentSliceCache::stats() const
+{
+    Stats out;
+    out.hits      = m_hits;
+    out.misses    = m_misses;
+    out.stores    = m_stores;
+    out.evictions = m_evictions;
+    out.bytes     = m_bytes;
+    return out;
+}
+
+std::string PersistentSliceCache::stats_string() const
+{
+    Stats s = this->stats();
+    return (boost::format("slice cache %1%: %2% hits, %3% misses, %4% stored, %5% evicted, %6% of %7% MB used")
+        % m_directory % s.hits % s.misses % s.stores % s.evictions % (s.bytes >> 20) % (m_max_bytes >> 20)).str();
+}
+
+} // namespace Slic3r
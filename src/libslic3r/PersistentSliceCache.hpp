@@ -0,0 +1,83 @@
+#ifndef slic3r_PersistentSliceCache_hpp_
+#define slic3r_PersistentSliceCache_hpp_
+
+#include "ExPolygon.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <ctime>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace Slic3r {
+
+// On disk, content addressed cache of the sliced volumes, shared between processes.
+// An entry is the result of slicing a single ModelVolume at a set of Z heights, stored in the binary slice cache format
+// (see Format/SliceCache.hpp) as "<key>.slices" inside the cache directory. The key is computed by the caller
+// from everything the slicing result depends on (see PrintObjectSlice.cpp), therefore entries never need to be invalidated.
+// The cache directory is kept below a size budget by evicting the least recently used entries, where the file modification
+// time of an entry is refreshed on every hit. The directory is scanned when the cache is opened and by shrink_to_fit(),
+// in between the stores evict from the running total and the index of the entries seen by this process.
+class PersistentSliceCache
+{
+public:
+    struct Stats {
+        size_t   hits      { 0 };
+        size_t   misses    { 0 };
+        size_t   stores    { 0 };
+        size_t   evictions { 0 };
+        // Current size of the cache directory in bytes, as last seen by this process.
+        uint64_t bytes     { 0 };
+    };
+
+    // Creates the directory if it does not exist yet. max_bytes == 0 disables the size limit.
+    PersistentSliceCache(const std::string &directory, uint64_t max_bytes);
+
+    const std::string&  directory() const { return m_directory; }
+    uint64_t            max_bytes() const { return m_max_bytes; }
+
+    // Returns false on a cache miss, if the entry is corrupted or if it does not contain num_layers layers. Thread safe.
+    bool                load(const std::string &key, size_t num_layers, std::vector<ExPolygons> &layers);
+    // Stores the entry and evicts the least recently used entries if the size budget is exceeded. Thread safe.
+    void                store(const std::string &key, const std::vector<ExPolygons> &layers);
+    // Rescan the directory and evict the least recently used entries until it fits into max_bytes. Thread safe.
+    void                shrink_to_fit();
+
+    Stats               stats() const;
+    std::string         stats_string() const;
+
+private:
+    struct Entry {
+        std::string     key;
+        std::time_t     time;
+        uint64_t        size;
+    };
+    using EntryList = std::list<Entry>;
+
+    std::string         entry_path(const std::string &key) const;
+    // Move the entry to the most recently used end of the index, adding it if it is not indexed yet.
+    void                touch_locked(const std::string &key, uint64_t size);
+    void                remove_locked(EntryList::iterator it);
+    void                evict_locked();
+
+    std::string             m_directory;
+    uint64_t                m_max_bytes;
+    std::atomic<size_t>     m_hits      { 0 };
+    std::atomic<size_t>     m_misses    { 0 };
+    std::atomic<size_t>     m_stores    { 0 };
+    std::atomic<size_t>     m_evictions { 0 };
+    // Running total of the sizes of the indexed entries.
+    std::atomic<uint64_t>   m_bytes     { 0 };
+    // Guards the index of the entries.
+    std::mutex              m_mutex;
+    // Entries ordered from the least to the most recently used one.
+    EntryList                                             m_entries;
+    std::unordered_map<std::string, EntryList::iterator> m_entries_map;
+};
+
+} // namespace Slic3r
+
+#endif /* slic3r_PersistentSliceCache_hpp_ */
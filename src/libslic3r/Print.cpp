@@ -18,9 +18,11 @@
 #include "PrintConfig.hpp"
 #include "Model.hpp"
 #include "format.hpp"
+#include "Format/SliceCache.hpp"
 #include <float.h>
 
 #include <algorithm>
+#include <atomic>
 #include <limits>
 #include <unordered_set>
 #include <boost/filesystem/path.hpp>
@@ -1765,6 +1767,7 @@ void  PrintObject::copy_layers_from_shared_object()
 void  PrintObject::copy_layers_overhang_from_shared_object()
 {
     if (m_shared_object) {
+        m_shared_object->load_cached_slices();
         for (size_t index = 0; index <  m_layers.size() && index <  m_shared_object->m_layers.size(); index++)
         {
             Layer* layer_src = m_layers[index];
@@ -1843,9 +1846,14 @@ void Print::process(long long *time_cost_with_cache, bool use_cache)
         obj->clear_shared_object();
 
     //add the print_object share check logic
-    auto is_print_object_the_same = [this](const PrintObject* object1, const PrintObject* object2) -> bool{
-        if (object1->trafo().matrix() != object2->trafo().matrix())
-            return false;
+    // Objects are considered the same if their volumes have the same content and end up at the same place after being centered for slicing,
+    // thus copies placed differently in XY, or whose volume offsets and instance offsets compensate each other, share the slicing.
+    auto is_volume_trafo_the_same = [](const Transform3d &trafo1, const Transform3d &trafo2) -> bool {
+        return trafo1.linear() == trafo2.linear() && (trafo1.translation() - trafo2.translation()).squaredNorm() < sqr(EPSILON);
+    };
+    auto is_print_object_the_same = [this, &is_volume_trafo_the_same](const PrintObject* object1, const PrintObject* object2) -> bool{
+        const Transform3d  trafo1     = object1->trafo_centered();
+        const Transform3d  trafo2     = object2->trafo_centered();
         const ModelObject* model_obj1 = object1->model_object();
         const ModelObject* model_obj2 = object2->model_object();
         if (model_obj1->volumes.size() != model_obj2->volumes.size())
@@ -1860,9 +1868,9 @@ void Print::process(long long *time_cost_with_cache, bool use_cache)
             const ModelVolume &model_volume2 = *model_obj2->volumes[index];
             if (model_volume1.type() != model_volume2.type())
                 return false;
-            if (model_volume1.mesh_ptr() != model_volume2.mesh_ptr())
+            if (!is_volume_trafo_the_same(trafo1 * model_volume1.get_matrix(), trafo2 * model_volume2.get_matrix()))
                 return false;
-            if (!(model_volume1.get_transformation() == model_volume2.get_transformation()))
+            if (!model_volume1.mesh().content_equal(model_volume2.mesh()))
                 return false;
             has_extruder1 = model_volume1.config.has("extruder");
             has_extruder2 = model_volume2.config.has("extruder");
@@ -1882,6 +1890,13 @@ void Print::process(long long *time_cost_with_cache, bool use_cache)
         //    return false;
         if (model_obj1->config.get() != model_obj2->config.get())
             return false;
+        // Objects not sharing the meshes may have been edited independently.
+        if (model_obj1->layer_height_profile.get() != model_obj2->layer_height_profile.get())
+            return false;
+        if (model_obj1->layer_config_ranges.size() != model_obj2->layer_config_ranges.size() ||
+            !std::equal(model_obj1->layer_config_ranges.begin(), model_obj1->layer_config_ranges.end(), model_obj2->layer_config_ranges.begin(),
+                [](const auto &range1, const auto &range2) { return range1.first == range2.first && range1.second.get() == range2.second.get(); }))
+            return false;
         return true;
     };
     int object_count = m_objects.size();
@@ -2236,7 +2251,7 @@ void Print::_make_skirt()
         size_t skirt_layers = this->has_infinite_skirt() ?
             object->layer_count() :
             std::min(size_t(m_config.skirt_height.value), object->layer_count());
-        skirt_height_z = std::max(skirt_height_z, object->m_layers[skirt_layers-1]->print_z);
+        skirt_height_z = std::max(skirt_height_z, object->layers()[skirt_layers-1]->print_z);
     }
 
     // Collect points from all layers contained in skirt height.
@@ -2247,7 +2262,7 @@ void Print::_make_skirt()
     for (PrintObject *object : m_objects) {
         Points object_points;
         // Get object layers up to skirt_height_z.
-        for (const Layer *layer : object->m_layers) {
+        for (const Layer *layer : object->layers()) {
             if (layer->print_z > skirt_height_z)
                 break;
             for (const ExPolygon &expoly : layer->lslices)
@@ -2425,7 +2440,7 @@ Polygons Print::first_layer_islands() const
     Polygons islands;
     for (PrintObject *object : m_objects) {
         Polygons object_islands;
-        for (ExPolygon &expoly : object->m_layers.front()->lslices)
+        for (ExPolygon &expoly : object->layers().front()->lslices)
             object_islands.push_back(expoly.contour);
         if (!object->support_layers().empty()) {
             if (object->support_layers().front()->support_type==stInnerNormal)
@@ -3090,6 +3105,7 @@ const std::string PrintStatistics::TotalFilamentUsedWipeTowerValueMask = "; tota
 #define JSON_ARC_FITTING            "arc_fitting"
 #define JSON_OBJECT_NAME            "name"
 #define JSON_IDENTIFY_ID          "identify_id"
+#define JSON_SLICE_CACHE_VERSION    "slice_cache_version"
 
 
 #define JSON_LAYERS                  "layers"
@@ -3726,34 +3742,38 @@ static void convert_layer_region_from_json(const json& j, LayerRegion& layer_reg
 
 
 void extract_layer(const json& layer_json, Layer& layer) {
-    //slice_polygons
-    int slice_polygons_count = layer_json[JSON_LAYER_SLICED_POLYGONS].size();
-    for (int polygon_index = 0; polygon_index < slice_polygons_count; polygon_index++)
-    {
-        ExPolygon polygon;
+    // lslices, lslices_bboxes and loverhangs of the object layers are stored in the binary slice cache,
+    // only the support layers and caches of the older versions keep them in json.
+    if (layer_json.contains(JSON_LAYER_SLICED_POLYGONS)) {
+        //slice_polygons
+        int slice_polygons_count = layer_json[JSON_LAYER_SLICED_POLYGONS].size();
+        for (int polygon_index = 0; polygon_index < slice_polygons_count; polygon_index++)
+        {
+            ExPolygon polygon;
 
-        polygon = layer_json[JSON_LAYER_SLICED_POLYGONS][polygon_index];
-        layer.lslices.push_back(std::move(polygon));
-    }
+            polygon = layer_json[JSON_LAYER_SLICED_POLYGONS][polygon_index];
+            layer.lslices.push_back(std::move(polygon));
+        }
 
-    //slice_bboxes
-    int sliced_bboxes_count = layer_json[JSON_LAYER_SLLICED_BBOXES].size();
-    for (int bbox_index = 0; bbox_index < sliced_bboxes_count; bbox_index++)
-    {
-        BoundingBox bbox;
+        //slice_bboxes
+        int sliced_bboxes_count = layer_json[JSON_LAYER_SLLICED_BBOXES].size();
+        for (int bbox_index = 0; bbox_index < sliced_bboxes_count; bbox_index++)
+        {
+            BoundingBox bbox;
 
-        bbox = layer_json[JSON_LAYER_SLLICED_BBOXES][bbox_index];
-        layer.lslices_bboxes.push_back(std::move(bbox));
-    }
+            bbox = layer_json[JSON_LAYER_SLLICED_BBOXES][bbox_index];
+            layer.lslices_bboxes.push_back(std::move(bbox));
+        }
 
-    //overhang_polygons
-    int overhang_polygons_count = layer_json[JSON_LAYER_OVERHANG_POLYGONS].size();
-    for (int polygon_index = 0; polygon_index < overhang_polygons_count; polygon_index++)
-    {
-        ExPolygon polygon;
+        //overhang_polygons
+        int overhang_polygons_count = layer_json[JSON_LAYER_OVERHANG_POLYGONS].size();
+        for (int polygon_index = 0; polygon_index < overhang_polygons_count; polygon_index++)
+        {
+            ExPolygon polygon;
 
-        polygon = layer_json[JSON_LAYER_OVERHANG_POLYGONS][polygon_index];
-        layer.loverhangs.push_back(std::move(polygon));
+            polygon = layer_json[JSON_LAYER_OVERHANG_POLYGONS][polygon_index];
+            layer.loverhangs.push_back(std::move(polygon));
+        }
     }
 
     //overhang_box
@@ -3833,7 +3853,7 @@ int Print::export_cached_data(const std::string& directory, bool with_space)
     int ret = 0;
     boost::filesystem::path directory_path(directory);
 
-    auto convert_layer_to_json = [](json& layer_json, const Layer* layer) {
+    auto convert_layer_to_json = [](json& layer_json, const Layer* layer, bool with_slices) {
         json slice_polygons_json = json::array(), slice_bboxs_json = json::array(), overhang_polygons_json = json::array(), layer_regions_json = json::array();
         layer_json[JSON_LAYER_PRINT_Z] = layer->print_z;
         layer_json[JSON_LAYER_HEIGHT] = layer->height;
@@ -3841,28 +3861,30 @@ int Print::export_cached_data(const std::string& directory, bool with_space)
         layer_json[JSON_LAYER_ID] = layer->id();
         //layer_json["slicing_errors"] = layer->slicing_errors;
 
-        //sliced_polygons
-        for (const ExPolygon& slice_polygon : layer->lslices) {
-            json slice_polygon_json = slice_polygon;
-            slice_polygons_json.push_back(std::move(slice_polygon_json));
-        }
-        layer_json[JSON_LAYER_SLICED_POLYGONS] = std::move(slice_polygons_json);
+        if (with_slices) {
+            //sliced_polygons
+            for (const ExPolygon& slice_polygon : layer->lslices) {
+                json slice_polygon_json = slice_polygon;
+                slice_polygons_json.push_back(std::move(slice_polygon_json));
+            }
+            layer_json[JSON_LAYER_SLICED_POLYGONS] = std::move(slice_polygons_json);
 
-        //sliced_bbox
-        for (const BoundingBox& slice_bbox : layer->lslices_bboxes) {
-            json bbox_json = json::array();
+            //sliced_bbox
+            for (const BoundingBox& slice_bbox : layer->lslices_bboxes) {
+                json bbox_json = json::array();
 
-            bbox_json = slice_bbox;
-            slice_bboxs_json.push_back(std::move(bbox_json));
-        }
-        layer_json[JSON_LAYER_SLLICED_BBOXES] = std::move(slice_bboxs_json);
+                bbox_json = slice_bbox;
+                slice_bboxs_json.push_back(std::move(bbox_json));
+            }
+            layer_json[JSON_LAYER_SLLICED_BBOXES] = std::move(slice_bboxs_json);
 
-        //overhang_polygons
-        for (const ExPolygon& overhang_polygon : layer->loverhangs) {
-            json overhang_polygon_json = overhang_polygon;
-            overhang_polygons_json.push_back(std::move(overhang_polygon_json));
+            //overhang_polygons
+            for (const ExPolygon& overhang_polygon : layer->loverhangs) {
+                json overhang_polygon_json = overhang_polygon;
+                overhang_polygons_json.push_back(std::move(overhang_polygon_json));
+            }
+            layer_json[JSON_LAYER_OVERHANG_POLYGONS] = std::move(overhang_polygons_json);
         }
-        layer_json[JSON_LAYER_OVERHANG_POLYGONS] = std::move(overhang_polygons_json);
 
         //overhang_box
         layer_json[JSON_LAYER_OVERHANG_BBOX] = layer->loverhangs_bbox;
@@ -3896,6 +3918,8 @@ int Print::export_cached_data(const std::string& directory, bool with_space)
     int count = 0;
     std::vector<std::string> filename_vector;
     std::vector<json> json_vector;
+    std::vector<std::string> slices_filename_vector;
+    std::vector<SliceCacheWriter> slices_vector;
     for (PrintObject *obj : m_objects) {
         const ModelObject* model_obj = obj->model_object();
         if (obj->get_shared_object()) {
@@ -3907,6 +3931,7 @@ int Print::export_cached_data(const std::string& directory, bool with_space)
         const ModelInstance *model_instance = print_instance.model_instance;
         size_t identify_id = (model_instance->loaded_id > 0)?model_instance->loaded_id: model_instance->id().id;
         std::string file_name = directory +"/obj_"+std::to_string(identify_id)+".json";
+        std::string slices_file_name = directory +"/obj_"+std::to_string(identify_id)+".slices";
 
         BOOST_LOG_TRIVIAL(info) << boost::format("begin to dump object %1%, identify_id %2% to %3%")%model_obj->name %identify_id %file_name;
 
@@ -3915,16 +3940,19 @@ int Print::export_cached_data(const std::string& directory, bool with_space)
 
             root_json[JSON_OBJECT_NAME] = model_obj->name;
             root_json[JSON_IDENTIFY_ID] = identify_id;
+            root_json[JSON_SLICE_CACHE_VERSION] = SliceCacheWriter::VERSION;
 
-            //export the layers
+            //export the layers, the slices go to the binary slice cache
             std::vector<json> layers_json_vector(obj->layer_count());
+            SliceCacheWriter slices_writer(obj->layer_count());
             tbb::parallel_for(
                 tbb::blocked_range<size_t>(0, obj->layer_count()),
-                [&layers_json_vector, obj, convert_layer_to_json](const tbb::blocked_range<size_t>& layer_range) {
+                [&layers_json_vector, &slices_writer, obj, convert_layer_to_json](const tbb::blocked_range<size_t>& layer_range) {
                     for (size_t layer_index = layer_range.begin(); layer_index < layer_range.end(); ++ layer_index) {
                         const Layer *layer = obj->get_layer(layer_index);
                         json layer_json;
-                        convert_layer_to_json(layer_json, layer);
+                        convert_layer_to_json(layer_json, layer, false);
+                        slices_writer.set_layer(layer_index, layer->lslices, layer->lslices_bboxes, layer->loverhangs);
                         layers_json_vector[layer_index] = std::move(layer_json);
                     }
                 }
@@ -3953,7 +3981,7 @@ int Print::export_cached_data(const std::string& directory, bool with_space)
                         const SupportLayer *support_layer = obj->get_support_layer(s_layer_index);
                         json support_layer_json, support_islands_json = json::array(), support_fills_json, supportfills_entities_json = json::array();
 
-                        convert_layer_to_json(support_layer_json, support_layer);
+                        convert_layer_to_json(support_layer_json, support_layer, true);
 
                         support_layer_json[JSON_SUPPORT_LAYER_INTERFACE_ID] = support_layer->interface_id();
                         support_layer_json[JSON_SUPPORT_LAYER_TYPE] = support_layer->support_type;
@@ -4052,6 +4080,8 @@ int Print::export_cached_data(const std::string& directory, bool with_space)
 
             filename_vector.push_back(file_name);
             json_vector.push_back(std::move(root_json));
+            slices_filename_vector.push_back(slices_file_name);
+            slices_vector.push_back(std::move(slices_writer));
             /*boost::nowide::ofstream c;
             c.open(file_name, std::ios::out | std::ios::trunc);
             if (with_space)
@@ -4071,8 +4101,13 @@ int Print::export_cached_data(const std::string& directory, bool with_space)
     boost::mutex mutex;
     tbb::parallel_for(
         tbb::blocked_range<size_t>(0, filename_vector.size()),
-        [filename_vector, &json_vector, with_space, &ret, &mutex](const tbb::blocked_range<size_t>& output_range) {
+        [&filename_vector, &json_vector, &slices_filename_vector, &slices_vector, with_space, &ret, &mutex](const tbb::blocked_range<size_t>& output_range) {
             for (size_t object_index = output_range.begin(); object_index < output_range.end(); ++ object_index) {
+                if (!slices_vector[object_index].save(slices_filename_vector[object_index])) {
+                    boost::unique_lock l(mutex);
+                    ret = CLI_EXPORT_CACHE_WRITE_FAILED;
+                    continue;
+                }
                 try {
                     boost::nowide::ofstream c;
                     c.open(filename_vector[object_index], std::ios::out | std::ios::trunc);
@@ -4189,6 +4224,17 @@ int Print::load_cached_data(const std::string& directory)
             BOOST_LOG_TRIVIAL(info) << __FUNCTION__<<boost::format(":will load %1%, identify_id %2%, layer_count %3%, support_layer_count %4%, firstlayer_group_count %5%")
                 %name %identify_id %layer_count %support_layer_count %firstlayer_group_count;
 
+            //the slices of the object layers are memory mapped from the binary slice cache and decoded on the first access to the layers
+            std::shared_ptr<SliceCacheReader> slices_reader;
+            if (root_json.contains(JSON_SLICE_CACHE_VERSION)) {
+                std::string slices_file_name = directory +"/obj_"+std::to_string(identify_id)+".slices";
+                slices_reader = std::make_shared<SliceCacheReader>();
+                if (!slices_reader->open(slices_file_name) || slices_reader->layer_count() != layer_count) {
+                    BOOST_LOG_TRIVIAL(error) << __FUNCTION__<< boost::format(": can not load slice cache %1% with %2% layers")%slices_file_name %layer_count;
+                    return CLI_IMPORT_CACHE_LOAD_FAILED;
+                }
+            }
+
             Layer* previous_layer = NULL;
             //create layer and layer regions
             for (int index = 0; index < layer_count; index++)
@@ -4237,6 +4283,8 @@ int Print::load_cached_data(const std::string& directory)
                     }
                 }
             );
+            if (slices_reader)
+                obj->set_cached_slices(std::move(slices_reader));
 
             //support layers
             Layer* previous_support_layer = NULL;
@@ -34,9 +34,12 @@ class ModelObject;
 class Print;
 class PrintObject;
 class SupportLayer;
+class SliceCacheReader;
 // BBS
 class TreeSupportData;
 class TreeSupport;
+class PersistentSliceCache;
+namespace Geometry { class VoronoiDiagramCache; }
 
 #define MAX_OUTER_NOZZLE_DIAMETER   4
 // BBS: move from PrintObjectSlice.cpp
@@ -63,7 +66,7 @@ enum SupportNecessaryType {
 namespace FillAdaptive {
     struct Octree;
     struct OctreeDeleter;
-    using OctreePtr = std::unique_ptr<Octree, OctreeDeleter>;
+    using OctreePtr = std::shared_ptr<Octree>;
 };
 
 namespace FillLightning {
@@ -272,15 +275,38 @@ public:
         }
     };
 
+    // Slices of a ModelVolume produced by the last slicing of a PrintObject, see slice_volume() in PrintObjectSlice.cpp.
+    struct VolumeSlicesAtZs
+    {
+        ObjectID                             volume_id;
+        // Holding the mesh keeps its address unique, thus a replaced mesh is detected by comparing the pointers.
+        std::shared_ptr<const TriangleMesh>  mesh;
+        // Including the transformation of the volume into the PrintObject.
+        MeshSlicingParamsEx                  params;
+        // Sorted.
+        std::vector<float>                   zs;
+        std::vector<ExPolygons>              slices;
+    };
+
     std::vector<std::unique_ptr<PrintRegion>>   all_regions;
     std::vector<LayerRangeRegions>              layer_ranges;
     // Transformation of this ModelObject into one of the associated PrintObjects (all PrintObjects derived from a single modelObject differ by a Z rotation only).
     // This transformation is used to calculate VolumeExtents.
     Transform3d                                 trafo_bboxes;
     std::vector<ObjectID>                       cached_volume_ids;
+    // Slices of the volumes of the last slicing, least recently sliced first. Not released by clear(), so that editing
+    // the layer ranges, their layer heights or their configs reslices the meshes only at the slicing planes which moved.
+    // Only the slicing of the meshes is reused, the Layers and all the following steps are still regenerated.
+    // Kept only for the objects with height range modifiers, as it is a second copy of the slices of their volumes.
+    std::vector<VolumeSlicesAtZs>               sliced_volumes;
+    // The PrintObjects sharing these regions are sliced in parallel.
+    std::mutex                                  sliced_volumes_mutex;
+    // Number of the volume slices taken from sliced_volumes instead of slicing the meshes, guarded by sliced_volumes_mutex.
+    size_t                                      num_reused_slices { 0 };
 
     void ref_cnt_inc() { ++ m_ref_cnt; }
     void ref_cnt_dec() { if (-- m_ref_cnt == 0) delete this; }
+    size_t num_print_objects() const { return m_ref_cnt; }
     void clear() {
         all_regions.clear();
         layer_ranges.clear();
@@ -304,7 +330,7 @@ public:
     const Vec3crd&               size() const			{ return m_size; }
     const PrintObjectConfig&     config() const         { return m_config; }
     void                         configBrimWidth(double m)      {m_config.brim_width.value = m; }
-    ConstLayerPtrsAdaptor        layers() const         { return ConstLayerPtrsAdaptor(&m_layers); }
+    ConstLayerPtrsAdaptor        layers() const         { this->load_cached_slices(); return ConstLayerPtrsAdaptor(&m_layers); }
     ConstSupportLayerPtrsAdaptor support_layers() const { return ConstSupportLayerPtrsAdaptor(&m_support_layers); }
     const Transform3d&           trafo() const          { return m_trafo; }
     // Trafo with the center_offset() applied after the transformation, to center the object in XY before slicing.
@@ -314,7 +340,7 @@ public:
     PrintInstances &instances() { return m_instances; }
 
     // Whoever will get a non-const pointer to PrintObject will be able to modify its layers.
-    LayerPtrs&                   layers()               { return m_layers; }
+    LayerPtrs&                   layers()               { this->load_cached_slices(); return m_layers; }
     SupportLayerPtrs&            support_layers()       { return m_support_layers; }
 
     template<typename PolysType>
@@ -359,8 +385,8 @@ public:
     size_t 			total_layer_count() const { return this->layer_count() + this->support_layer_count(); }
     size_t 			layer_count() const { return m_layers.size(); }
     void 			clear_layers();
-    const Layer* 	get_layer(int idx) const { return m_layers[idx]; }
-    Layer* 			get_layer(int idx) 		 { return m_layers[idx]; }
+    const Layer* 	get_layer(int idx) const { this->load_cached_slices(); return m_layers[idx]; }
+    Layer* 			get_layer(int idx) 		 { this->load_cached_slices(); return m_layers[idx]; }
     // Get a layer exactly at print_z.
     const Layer*	get_layer_at_printz(coordf_t print_z) const;
     Layer*			get_layer_at_printz(coordf_t print_z);
@@ -382,6 +408,16 @@ public:
     SupportLayer* add_tree_support_layer(int id, coordf_t height, coordf_t print_z, coordf_t slice_z);
     std::shared_ptr<TreeSupportData> alloc_tree_support_preview_cache();
     void clear_tree_support_preview_cache() { m_tree_support_preview_cache.reset(); }
+    // Voronoi diagrams shared by the layers while generating perimeters, null outside of posPerimeters.
+    Geometry::VoronoiDiagramCache* voronoi_cache() const { return m_voronoi_cache.get(); }
+    // Number of layers, whose perimeters were copied from a layer with the same outlines by the last make_perimeters().
+    size_t num_layers_with_copied_perimeters() const { return m_num_layers_with_copied_perimeters; }
+    // Lightning trees of the tree support base generated by the last support generation. The caller has to check
+    // whether they were generated from the same inputs before reusing them, see FillLightning::Generator::Inputs.
+    const std::shared_ptr<FillLightning::Generator>& support_lightning_generator() const { return m_support_lightning_generator; }
+    // Keep the trees used by the running support generation, the trees of the previous one are released at its end otherwise.
+    void set_support_lightning_generator(std::shared_ptr<FillLightning::Generator> generator)
+        { m_support_lightning_generator = std::move(generator); m_support_lightning_generator_used = true; }
 
     size_t          support_layer_count() const { return m_support_layers.size(); }
     void            clear_support_layers();
@@ -472,6 +508,11 @@ public:
 
     static PrintObjectConfig object_config_from_model_object(const PrintObjectConfig &default_object_config, const ModelObject &object, size_t num_extruders);
 
+    // Hands the memory mapped slice cache to this object, its layers are decoded on the first access.
+    void                    set_cached_slices(std::shared_ptr<SliceCacheReader> reader);
+    void                    load_cached_slices() const { if (m_slice_cache_pending.load(std::memory_order_acquire)) this->decode_cached_slices(); }
+    void                    decode_cached_slices() const;
+
 private:
     void make_perimeters();
     void prepare_infill();
@@ -525,15 +566,27 @@ private:
     SlicingParameters                       m_slicing_params;
     LayerPtrs                               m_layers;
     SupportLayerPtrs                        m_support_layers;
+    // Slice cache memory mapped by Print::load_cached_data(). The lslices, lslices_bboxes and loverhangs of the layers
+    // are decoded from it on the first access to the layers, see load_cached_slices().
+    mutable std::shared_ptr<SliceCacheReader> m_slice_cache;
+    mutable std::atomic<bool>               m_slice_cache_pending { false };
+    mutable std::mutex                      m_slice_cache_mutex;
     // BBS
     std::shared_ptr<TreeSupportData>        m_tree_support_preview_cache;
+    std::shared_ptr<Geometry::VoronoiDiagramCache> m_voronoi_cache;
+    size_t                                  m_num_layers_with_copied_perimeters { 0 };
 
     // this is set to true when LayerRegion->slices is split in top/internal/bottom
     // so that next call to make_perimeters() performs a union() before computing loops
     bool                    				m_typed_slices = false;
 
     std::pair<FillAdaptive::OctreePtr, FillAdaptive::OctreePtr> m_adaptive_fill_octrees;
+    // Kept after posInfill, so that the next posPrepareInfill reuses the trees as long as their inputs did not change,
+    // for example if only the speeds or the temperatures were modified.
     FillLightning::GeneratorPtr m_lightning_generator;
+    std::shared_ptr<FillLightning::Generator> m_support_lightning_generator;
+    // Whether the running support generation set m_support_lightning_generator.
+    bool                        m_support_lightning_generator_used { false };
 
     std::vector < VolumeSlices >            firstLayerObjSliceByVolume;
     std::vector<groupedVolumeSlices>        firstLayerObjSliceByGroups;
@@ -556,6 +609,9 @@ private:
     // This was a per-object setting and now we default enable it.
     static bool clip_multipart_objects;
     static bool infill_only_where_needed;
+    // On disk cache of the sliced volumes shared between processes, used by slice_volumes() if set.
+    // Configured once per process by the command line interface.
+    static std::shared_ptr<PersistentSliceCache> persistent_slice_cache;
 };
 
 struct FakeWipeTower
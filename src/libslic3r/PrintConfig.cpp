@@ -7378,6 +7378,28 @@ CLIMiscConfigDef::CLIMiscConfigDef()
     def->cli_params = "option";
     def->set_default_value(new ConfigOptionBool(false));
 
+    def = this->add("slice_cache_dir", coString);
+    def->label = "Slice cache directory";
+    def->tooltip = "Reuse the sliced volumes across command line invocations by keeping them in this directory. "
+                   "The directory may be shared by several concurrently running processes.";
+    def->cli_params = "directory";
+    def->set_default_value(new ConfigOptionString());
+
+    def = this->add("slice_cache_size", coInt);
+    def->label = "Slice cache size";
+    def->tooltip = "Maximum size of the slice cache directory in megabytes, the least recently used entries are removed when exceeded. 0 means unlimited.";
+    def->cli_params = "size";
+    def->min = 0;
+    def->set_default_value(new ConfigOptionInt(4096));
+
+    def = this->add("tree_support_cache_size", coInt);
+    def->label = "Tree support cache size";
+    def->tooltip = "Memory budget in megabytes of each of the collision and avoidance caches of the tree supports of an object. "
+                   "Areas evicted from a full cache are recalculated when needed again. 0 means unlimited.";
+    def->cli_params = "size";
+    def->min = 0;
+    def->set_default_value(new ConfigOptionInt(0));
+
     def = this->add("makerlab_name", coString);
     def->label = "MakerLab name";
     def->tooltip = "MakerLab name to generate this 3mf";
@@ -4,6 +4,7 @@
 #include "ClipperUtils.hpp"
 #include "ElephantFootCompensation.hpp"
 #include "Geometry.hpp"
+#include "Geometry/Voronoi.hpp"
 #include "I18N.hpp"
 #include "Layer.hpp"
 #include "MutablePolygon.hpp"
@@ -18,6 +19,7 @@
 #include "Utils.hpp"
 #include "Fill/FillAdaptive.hpp"
 #include "Fill/FillLightning.hpp"
+#include "Format/SliceCache.hpp"
 #include "Format/STL.hpp"
 #include "format.hpp"
 
@@ -25,9 +27,12 @@
 #include <oneapi/tbb/blocked_range.h>
 #include <oneapi/tbb/concurrent_vector.h>
 #include <oneapi/tbb/parallel_for.h>
+#include <oneapi/tbb/task_arena.h>
 #include <string_view>
+#include <unordered_map>
 #include <utility>
 
+#include <boost/functional/hash.hpp>
 #include <boost/log/trivial.hpp>
 
 #include <tbb/parallel_for.h>
@@ -286,6 +291,91 @@ void PrintObject::_transform_hole_to_polyholes()
     }
 }
 
+static void hash_polygon(size_t &seed, const Polygon &polygon)
+{
+    boost::hash_combine(seed, polygon.size());
+    for (const Point &pt : polygon.points) {
+        boost::hash_combine(seed, pt.x());
+        boost::hash_combine(seed, pt.y());
+    }
+}
+
+static void hash_expolygon(size_t &seed, const ExPolygon &expolygon)
+{
+    hash_polygon(seed, expolygon.contour);
+    boost::hash_combine(seed, expolygon.holes.size());
+    for (const Polygon &hole : expolygon.holes)
+        hash_polygon(seed, hole);
+}
+
+// Fingerprint of the inputs of Layer::make_perimeters(), which are compared exactly by layers_share_perimeters().
+static size_t perimeter_inputs_hash(const Layer &layer)
+{
+    size_t seed = 0;
+    boost::hash_combine(seed, layer.height);
+    boost::hash_combine(seed, layer.id() % 2);
+    for (const LayerRegion *layerm : layer.regions()) {
+        // Layers of a height range modifier are assigned other regions, i.e. other perimeter settings, for the same outlines.
+        boost::hash_combine(seed, &layerm->region());
+        boost::hash_combine(seed, layerm->slices.surfaces.size());
+        for (const Surface &surface : layerm->slices.surfaces) {
+            boost::hash_combine(seed, int(surface.surface_type));
+            boost::hash_combine(seed, surface.extra_perimeters);
+            hash_expolygon(seed, surface.expolygon);
+        }
+    }
+    // The overhangs are detected against the layer below, the top surfaces against the layer above.
+    for (const Layer *other : { layer.lower_layer, layer.upper_layer }) {
+        boost::hash_combine(seed, other != nullptr);
+        if (other) {
+            boost::hash_combine(seed, other->lslices.size());
+            for (const ExPolygon &expolygon : other->lslices)
+                hash_expolygon(seed, expolygon);
+        }
+    }
+    return seed;
+}
+
+// Do the two layers of the same object produce the same perimeters, gap fills and fill surfaces?
+// Regions are shared by all the layers with the same region config, thus comparing the regions compares the perimeter settings.
+// The perimeter generator only looks at the layer id to tell the first layer and to alternate some features on odd layers,
+// the extrusions themselves are 2D with the layer height stored with the paths.
+static bool layers_share_perimeters(const Layer &l1, const Layer &l2)
+{
+    if (l1.height != l2.height || l1.id() % 2 != l2.id() % 2 || l1.regions().size() != l2.regions().size())
+        return false;
+    for (size_t region_id = 0; region_id < l1.regions().size(); ++ region_id) {
+        if (&l1.regions()[region_id]->region() != &l2.regions()[region_id]->region())
+            return false;
+        const Surfaces &s1 = l1.regions()[region_id]->slices.surfaces;
+        const Surfaces &s2 = l2.regions()[region_id]->slices.surfaces;
+        if (s1.size() != s2.size())
+            return false;
+        for (size_t i = 0; i < s1.size(); ++ i)
+            if (s1[i].surface_type != s2[i].surface_type || s1[i].extra_perimeters != s2[i].extra_perimeters || s1[i].expolygon != s2[i].expolygon)
+                return false;
+    }
+    auto same_slices = [](const Layer *l1, const Layer *l2) { return l1 == nullptr ? l2 == nullptr : l2 != nullptr && l1->lslices == l2->lslices; };
+    return same_slices(l1.lower_layer, l2.lower_layer) && same_slices(l1.upper_layer, l2.upper_layer);
+}
+
+// Copy the output of Layer::make_perimeters() from a layer passing layers_share_perimeters().
+static void copy_perimeters(const Layer &src, Layer &dst)
+{
+    for (size_t region_id = 0; region_id < src.regions().size(); ++ region_id) {
+        const LayerRegion &src_layerm = *src.regions()[region_id];
+        LayerRegion       &dst_layerm = *dst.regions()[region_id];
+        dst_layerm.perimeters = src_layerm.perimeters;
+        dst_layerm.thin_fills = src_layerm.thin_fills;
+        dst_layerm.fills.clear();
+        if (! dst_layerm.slices.empty()) {
+            dst_layerm.fill_surfaces              = src_layerm.fill_surfaces;
+            dst_layerm.fill_expolygons            = src_layerm.fill_expolygons;
+            dst_layerm.fill_no_overlap_expolygons = src_layerm.fill_no_overlap_expolygons;
+        }
+    }
+}
+
 // 1) Merges typed region slices into stInternal type.
 // 2) Increases an "extra perimeters" counter at region slices where needed.
 // 3) Generates perimeters, gap fills and fill regions (fill regions of type stInternal).
@@ -296,6 +386,7 @@ void PrintObject::make_perimeters()
 
     if (! this->set_started(posPerimeters))
         return;
+    this->load_cached_slices();
 
     m_print->set_status(15, L("Generating walls"));
     BOOST_LOG_TRIVIAL(info) << "Generating walls..." << log_memory_info();
@@ -380,17 +471,80 @@ void PrintObject::make_perimeters()
         BOOST_LOG_TRIVIAL(debug) << "Generating extra perimeters for region " << region_id << " in parallel - end";
     }
 
+    // Prismatic parts produce long runs of layers with the same outlines. The perimeters of such a run are generated
+    // for its first layer only and copied to the other layers of the run.
+    // Neither the spiral vase nor the fuzzy skin produce the same perimeters for the same outlines.
+    std::vector<size_t> perimeters_source(m_layers.size(), size_t(-1));
+    bool                share_perimeters = ! m_print->config().spiral_mode;
+    for (size_t region_id = 0; region_id < this->num_printing_regions(); ++ region_id)
+        if (this->printing_region(region_id).config().fuzzy_skin != FuzzySkinType::None)
+            share_perimeters = false;
+    if (share_perimeters) {
+        std::vector<size_t> hashes(m_layers.size(), 0);
+        tbb::parallel_for(
+            tbb::blocked_range<size_t>(0, m_layers.size()),
+            [this, &hashes](const tbb::blocked_range<size_t>& range) {
+                for (size_t layer_idx = range.begin(); layer_idx < range.end(); ++ layer_idx)
+                    hashes[layer_idx] = perimeter_inputs_hash(*m_layers[layer_idx]);
+            });
+        m_print->throw_if_canceled();
+        std::unordered_map<size_t, size_t> first_layer_with_hash;
+        for (size_t layer_idx = 0; layer_idx < m_layers.size(); ++ layer_idx)
+            // The first object layer is special to the perimeter generator.
+            if (m_layers[layer_idx]->id() > size_t(m_config.raft_layers.value)) {
+                auto [it, inserted] = first_layer_with_hash.emplace(hashes[layer_idx], layer_idx);
+                if (! inserted)
+                    perimeters_source[layer_idx] = it->second;
+            }
+        tbb::parallel_for(
+            tbb::blocked_range<size_t>(0, m_layers.size()),
+            [this, &perimeters_source](const tbb::blocked_range<size_t>& range) {
+                for (size_t layer_idx = range.begin(); layer_idx < range.end(); ++ layer_idx)
+                    if (size_t &src = perimeters_source[layer_idx]; src != size_t(-1) && ! layers_share_perimeters(*m_layers[src], *m_layers[layer_idx]))
+                        // Hash collision, generate the perimeters of this layer.
+                        src = size_t(-1);
+            });
+        m_print->throw_if_canceled();
+    }
+
     BOOST_LOG_TRIVIAL(debug) << "Generating perimeters in parallel - start";
+    // Layers with the same outlines, e.g. of prismatic parts, share their Voronoi diagrams.
+    m_voronoi_cache = std::make_shared<Geometry::VoronoiDiagramCache>();
     tbb::parallel_for(
         tbb::blocked_range<size_t>(0, m_layers.size()),
-        [this](const tbb::blocked_range<size_t>& range) {
-            for (size_t layer_idx = range.begin(); layer_idx < range.end(); ++ layer_idx) {
-                m_print->throw_if_canceled();
-                m_layers[layer_idx]->make_perimeters();
-            }
+        [this, &perimeters_source](const tbb::blocked_range<size_t>& range) {
+            for (size_t layer_idx = range.begin(); layer_idx < range.end(); ++ layer_idx)
+                if (perimeters_source[layer_idx] == size_t(-1)) {
+                    m_print->throw_if_canceled();
+                    m_layers[layer_idx]->make_perimeters();
+                }
         }
     );
     m_print->throw_if_canceled();
+    size_t num_shared = 0;
+    for (size_t src : perimeters_source)
+        if (src != size_t(-1))
+            ++ num_shared;
+    m_num_layers_with_copied_perimeters = num_shared;
+    if (num_shared > 0) {
+        tbb::parallel_for(
+            tbb::blocked_range<size_t>(0, m_layers.size()),
+            [this, &perimeters_source](const tbb::blocked_range<size_t>& range) {
+                for (size_t layer_idx = range.begin(); layer_idx < range.end(); ++ layer_idx)
+                    if (size_t src = perimeters_source[layer_idx]; src != size_t(-1)) {
+                        m_print->throw_if_canceled();
+                        copy_perimeters(*m_layers[src], *m_layers[layer_idx]);
+                    }
+            });
+        BOOST_LOG_TRIVIAL(info) << "Perimeters of " << num_shared << " out of " << m_layers.size() << " layers copied from layers with the same outlines";
+    }
+    {
+        Geometry::VoronoiDiagramCache::Stats stats = m_voronoi_cache->stats();
+        BOOST_LOG_TRIVIAL(info) << "Voronoi diagrams of the perimeters: " << stats.hits << " reused, " << stats.misses << " constructed in "
+                                << stats.construct_time << " s";
+        m_voronoi_cache.reset();
+    }
+    m_print->throw_if_canceled();
     BOOST_LOG_TRIVIAL(debug) << "Generating perimeters in parallel - end";
 
     this->set_done(posPerimeters);
@@ -400,6 +554,7 @@ void PrintObject::prepare_infill()
 {
     if (! this->set_started(posPrepareInfill))
         return;
+    this->load_cached_slices();
     m_print->set_status(25, L("Generating infill regions"));
     if (m_typed_slices) {
         // To improve robustness of detect_surfaces_type() when reslicing (working with typed slices), see GH issue #7442.
@@ -541,6 +696,7 @@ void PrintObject::infill()
     this->prepare_infill();
 
     if (this->set_started(posInfill)) {
+        this->load_cached_slices();
         m_print->set_status(35, L("Generating infill toolpath"));
         const auto& adaptive_fill_octree = this->m_adaptive_fill_octrees.first;
         const auto& support_fill_octree = this->m_adaptive_fill_octrees.second;
@@ -567,6 +723,7 @@ void PrintObject::infill()
 void PrintObject::ironing()
 {
     if (this->set_started(posIroning)) {
+        this->load_cached_slices();
         BOOST_LOG_TRIVIAL(debug) << "Ironing in parallel - start";
         tbb::parallel_for(
             // Ironing starting with layer 0 to support ironing all surfaces.
@@ -598,6 +755,7 @@ static const float g_min_overhang_percent_for_lift = 0.3f;
 void PrintObject::detect_overhangs_for_lift()
 {
     if (this->set_started(posDetectOverhangsForLift)) {
+        this->load_cached_slices();
         const double nozzle_diameter = m_print->config().nozzle_diameter.get_at(0);
         const coordf_t line_width = this->config().get_abs_value("line_width", nozzle_diameter);
 
@@ -630,7 +788,9 @@ void PrintObject::detect_overhangs_for_lift()
 void PrintObject::generate_support_material()
 {
     if (this->set_started(posSupportMaterial)) {
+        this->load_cached_slices();
         this->clear_support_layers();
+        m_support_lightning_generator_used = false;
 
         if ((this->has_support() && m_layers.size() > 1) || (this->has_raft() && ! m_layers.empty())) {
             m_print->set_status(50, L("Generating support"));
@@ -668,6 +828,9 @@ void PrintObject::generate_support_material()
 #endif
         }
 
+        // The trees of the previous support generation were not reused, e.g. the support was disabled or its base pattern changed.
+        if (! m_support_lightning_generator_used)
+            m_support_lightning_generator.reset();
         this->set_done(posSupportMaterial);
     }
 }
@@ -693,6 +856,7 @@ void PrintObject::estimate_curled_extrusions()
 
 void PrintObject::simplify_extrusion_path()
 {
+    this->load_cached_slices();
     if (this->set_started(posSimplifyPath)) {
         m_print->set_status(75, L("Optimizing toolpath"));
         BOOST_LOG_TRIVIAL(debug) << "Simplify extrusion path of object in parallel - start";
@@ -795,11 +959,20 @@ FillLightning::GeneratorPtr PrintObject::prepare_lightning_infill_data()
             break;
         }
 
-    return has_lightning_infill ? FillLightning::build_generator(std::as_const(*this), [this]() -> void { this->throw_if_canceled(); }) : FillLightning::GeneratorPtr();
+    if (! has_lightning_infill)
+        return FillLightning::GeneratorPtr();
+
+    // The trees only depend on the infill areas and on a few settings, reuse the ones generated by the previous run if those did not change.
+    return FillLightning::build_generator(std::as_const(*this), [this]() -> void { this->throw_if_canceled(); }, std::move(m_lightning_generator));
 }
 
 void PrintObject::clear_layers()
 {
+    {
+        std::lock_guard<std::mutex> lock(m_slice_cache_mutex);
+        m_slice_cache.reset();
+        m_slice_cache_pending.store(false, std::memory_order_release);
+    }
     if (!m_shared_object) {
         for (Layer *l : m_layers)
             delete l;
@@ -807,6 +980,43 @@ void PrintObject::clear_layers()
     }
 }
 
+void PrintObject::set_cached_slices(std::shared_ptr<SliceCacheReader> reader)
+{
+    std::lock_guard<std::mutex> lock(m_slice_cache_mutex);
+    m_slice_cache = std::move(reader);
+    m_slice_cache_pending.store(m_slice_cache != nullptr, std::memory_order_release);
+}
+
+void PrintObject::decode_cached_slices() const
+{
+    std::lock_guard<std::mutex> lock(m_slice_cache_mutex);
+    // Another thread may have decoded the layers while this one was waiting for the lock.
+    if (! m_slice_cache_pending.load(std::memory_order_relaxed))
+        return;
+
+    BOOST_LOG_TRIVIAL(debug) << "Decoding the cached slices of " << m_layers.size() << " layers - start";
+    std::atomic<bool> valid { true };
+    // Isolated, so that this thread does not pick up a task of the caller, which may try to access the layers as well
+    // and block on the mutex held here.
+    tbb::this_task_arena::isolate([this, &valid]() {
+        tbb::parallel_for(
+            tbb::blocked_range<size_t>(0, m_layers.size()),
+            [this, &valid](const tbb::blocked_range<size_t> &range) {
+                for (size_t layer_idx = range.begin(); layer_idx < range.end(); ++ layer_idx) {
+                    Layer *layer = m_layers[layer_idx];
+                    if (! m_slice_cache->load_layer(layer_idx, layer->lslices, layer->lslices_bboxes, layer->loverhangs))
+                        valid = false;
+                }
+            });
+    });
+    BOOST_LOG_TRIVIAL(debug) << "Decoding the cached slices - end";
+
+    m_slice_cache.reset();
+    m_slice_cache_pending.store(false, std::memory_order_release);
+    if (! valid)
+        throw Slic3r::RuntimeError("The slice cache of the object is corrupted");
+}
+
 Layer* PrintObject::add_layer(int id, coordf_t height, coordf_t print_z, coordf_t slice_z)
 {
     m_layers.emplace_back(new Layer(id, this, height, print_z, slice_z));
@@ -1214,6 +1424,9 @@ bool PrintObject::invalidate_step(PrintObjectStep step)
 		invalidated |= this->invalidate_steps({ posPerimeters, posPrepareInfill, posInfill, posIroning, posSupportMaterial, posSimplifyPath, posSimplifyInfill });
         invalidated |= m_print->invalidate_steps({ psSkirtBrim });
         m_slicing_params.valid = false;
+        // The areas the Lightning trees were generated for are sliced again.
+        m_lightning_generator.reset();
+        m_support_lightning_generator.reset();
     } else if (step == posSupportMaterial) {
         invalidated |= this->invalidate_steps({ posSimplifySupportPath });
         invalidated |= m_print->invalidate_steps({ psSkirtBrim });
@@ -3992,6 +4205,7 @@ void PrintObject::project_and_append_custom_facets(
 }
 
 const Layer* PrintObject::get_layer_at_printz(coordf_t print_z) const {
+    this->load_cached_slices();
     auto it = Slic3r::lower_bound_by_predicate(m_layers.begin(), m_layers.end(), [print_z](const Layer *layer) { return layer->print_z < print_z; });
     return (it == m_layers.end() || (*it)->print_z != print_z) ? nullptr : *it;
 }
@@ -4004,6 +4218,7 @@ Layer* PrintObject::get_layer_at_printz(coordf_t print_z) { return const_cast<La
 
 // Get a layer approximately at print_z.
 const Layer* PrintObject::get_layer_at_printz(coordf_t print_z, coordf_t epsilon) const {
+    this->load_cached_slices();
     coordf_t limit = print_z - epsilon;
     auto it = Slic3r::lower_bound_by_predicate(m_layers.begin(), m_layers.end(), [limit](const Layer *layer) { return layer->print_z < limit; });
     return (it == m_layers.end() || (*it)->print_z > print_z + epsilon) ? nullptr : *it;
@@ -4015,17 +4230,20 @@ Layer* PrintObject::get_layer_at_printz(coordf_t print_z, coordf_t epsilon) { re
 
 const Layer *PrintObject::get_first_layer_bellow_printz(coordf_t print_z, coordf_t epsilon) const
 {
+    this->load_cached_slices();
     coordf_t limit = print_z + epsilon;
     auto it = Slic3r::lower_bound_by_predicate(m_layers.begin(), m_layers.end(), [limit](const Layer *layer) { return layer->print_z < limit; });
     return (it == m_layers.begin()) ? nullptr : *(--it);
 }
 int PrintObject::get_layer_idx_get_printz(coordf_t print_z, coordf_t epsilon) {
+    this->load_cached_slices();
     coordf_t limit = print_z + epsilon;
     auto     it    = Slic3r::lower_bound_by_predicate(m_layers.begin(), m_layers.end(), [limit](const Layer *layer) { return layer->print_z < limit; });
     return (it == m_layers.begin()) ? -1 : std::distance(m_layers.begin(), it);
 }
 // BBS
 const Layer* PrintObject::get_layer_at_bottomz(coordf_t bottom_z, coordf_t epsilon) const {
+    this->load_cached_slices();
     coordf_t limit_upper = bottom_z + epsilon;
     coordf_t limit_lower = bottom_z - epsilon;
 
@@ -5,10 +5,13 @@
 #include "Print.hpp"
 #include "ClipperUtils.hpp"
 #include "Interlocking/InterlockingGenerator.hpp"
+#include "PersistentSliceCache.hpp"
 //BBS
 #include "ShortestPath.hpp"
 
+#include <boost/algorithm/hex.hpp>
 #include <boost/log/trivial.hpp>
+#include <boost/uuid/detail/md5.hpp>
 
 #include <tbb/parallel_for.h>
 
@@ -19,6 +22,7 @@ namespace Slic3r {
 
 bool PrintObject::clip_multipart_objects = true;
 bool PrintObject::infill_only_where_needed = false;
+std::shared_ptr<PersistentSliceCache> PrintObject::persistent_slice_cache;
 
 LayerPtrs new_layers(
     PrintObject                 *print_object,
@@ -45,23 +49,130 @@ LayerPtrs new_layers(
     return out;
 }
 
+// Key of PrintObject::persistent_slice_cache: Hash of everything slice_mesh_ex() depends on,
+// that is the mesh, its transformation, the slicing planes and the slicing parameters.
+// Bump the version whenever the slicing algorithm changes its output.
+static std::string persistent_slice_cache_key(const indexed_triangle_set &its, const std::vector<float> &zs, const MeshSlicingParamsEx &params)
+{
+    static constexpr const uint32_t version = 1;
+    using boost::uuids::detail::md5;
+    md5  md5_hash;
+    auto add = [&md5_hash](const auto &value) { md5_hash.process_bytes(&value, sizeof(value)); };
+    add(version);
+    add(its.vertices.size());
+    md5_hash.process_bytes(its.vertices.data(), its.vertices.size() * sizeof(stl_vertex));
+    add(its.indices.size());
+    md5_hash.process_bytes(its.indices.data(), its.indices.size() * sizeof(stl_triangle_vertex_indices));
+    add(zs.size());
+    md5_hash.process_bytes(zs.data(), zs.size() * sizeof(float));
+    md5_hash.process_bytes(params.trafo.matrix().data(), 16 * sizeof(double));
+    add(params.mode);
+    add(params.mode_below);
+    add(uint64_t(params.slicing_mode_normal_below_layer));
+    add(params.closing_radius);
+    add(params.extra_offset);
+    add(params.resolution);
+    // unsigned int[4], 128 bits
+    md5::digest_type md5_digest{};
+    std::string      key;
+    md5_hash.get_digest(md5_digest);
+    boost::algorithm::hex(md5_digest, md5_digest + std::size(md5_digest), std::back_inserter(key));
+    return key;
+}
+
+// Slice single triangle mesh, params.trafo already contains the volume transformation.
+static std::vector<ExPolygons> slice_volume_mesh(
+    const ModelVolume             &volume,
+    const std::vector<float>      &zs,
+    const MeshSlicingParamsEx     &params,
+    const std::function<void()>   &throw_on_cancel_callback)
+{
+    std::vector<ExPolygons> layers;
+    std::string cache_key;
+    if (PrintObject::persistent_slice_cache) {
+        cache_key = persistent_slice_cache_key(volume.mesh().its, zs, params);
+        if (PrintObject::persistent_slice_cache->load(cache_key, zs.size(), layers))
+            return layers;
+    }
+    indexed_triangle_set its = volume.mesh().its;
+    if (params.trafo.rotation().determinant() < 0.)
+        its_flip_triangles(its);
+    layers = slice_mesh_ex(its, zs, params, throw_on_cancel_callback);
+    throw_on_cancel_callback();
+    if (! cache_key.empty())
+        PrintObject::persistent_slice_cache->store(cache_key, layers);
+    return layers;
+}
+
+static bool sliced_volume_matches(const PrintObjectRegions::VolumeSlicesAtZs &sliced, const ModelVolume &volume, const MeshSlicingParamsEx &params)
+{
+    return sliced.volume_id == volume.id() && sliced.mesh == volume.get_mesh_shared_ptr() &&
+        sliced.params.trafo.matrix() == params.trafo.matrix() && sliced.params.mode == params.mode && sliced.params.mode_below == params.mode_below &&
+        sliced.params.slicing_mode_normal_below_layer == params.slicing_mode_normal_below_layer && sliced.params.closing_radius == params.closing_radius &&
+        sliced.params.extra_offset == params.extra_offset && sliced.params.resolution == params.resolution;
+}
+
 // Slice single triangle mesh.
+// If print_object_regions is provided, the slices of the last slicing of the same mesh with the same parameters are reused
+// at the slicing planes which did not move, only the other planes are sliced. The slices are then kept for the next slicing.
 static std::vector<ExPolygons> slice_volume(
     const ModelVolume             &volume,
     const std::vector<float>      &zs,
     const MeshSlicingParamsEx     &params,
+    PrintObjectRegions            *print_object_regions,
     const std::function<void()>   &throw_on_cancel_callback)
 {
     std::vector<ExPolygons> layers;
-    if (! zs.empty()) {
-        indexed_triangle_set its = volume.mesh().its;
-        if (its.indices.size() > 0) {
-            MeshSlicingParamsEx params2 { params };
-            params2.trafo = params2.trafo * volume.get_matrix();
-            if (params2.trafo.rotation().determinant() < 0.)
-                its_flip_triangles(its);
-            layers = slice_mesh_ex(its, zs, params2, throw_on_cancel_callback);
-            throw_on_cancel_callback();
+    if (! zs.empty() && ! volume.mesh().its.indices.empty()) {
+        MeshSlicingParamsEx params2 { params };
+        params2.trafo = params2.trafo * volume.get_matrix();
+        if (params2.slicing_mode_normal_below_layer > 0 && params2.mode_below != params2.mode)
+            // The slicing mode depends on the index of the slicing plane, the slices could not be reused after the planes moved.
+            print_object_regions = nullptr;
+        std::vector<size_t> ids_to_slice;
+        if (print_object_regions != nullptr) {
+            layers.assign(zs.size(), ExPolygons());
+            std::lock_guard<std::mutex> lock(print_object_regions->sliced_volumes_mutex);
+            const std::vector<PrintObjectRegions::VolumeSlicesAtZs> &sliced_volumes = print_object_regions->sliced_volumes;
+            auto it_sliced = std::find_if(sliced_volumes.begin(), sliced_volumes.end(),
+                [&volume, &params2](const PrintObjectRegions::VolumeSlicesAtZs &sliced) { return sliced_volume_matches(sliced, volume, params2); });
+            for (size_t i = 0, j = 0; i < zs.size(); ++ i) {
+                if (it_sliced != sliced_volumes.end()) {
+                    // Both zs are sorted. Tolerate the rounding errors of accumulating the layer heights.
+                    for (; j < it_sliced->zs.size() && it_sliced->zs[j] < zs[i] - float(EPSILON); ++ j) ;
+                    if (j < it_sliced->zs.size() && it_sliced->zs[j] <= zs[i] + float(EPSILON)) {
+                        layers[i] = it_sliced->slices[j];
+                        ++ print_object_regions->num_reused_slices;
+                        continue;
+                    }
+                }
+                ids_to_slice.emplace_back(i);
+            }
+        }
+        if (print_object_regions == nullptr)
+            layers = slice_volume_mesh(volume, zs, params2, throw_on_cancel_callback);
+        else if (ids_to_slice.size() == zs.size())
+            layers = slice_volume_mesh(volume, zs, params2, throw_on_cancel_callback);
+        else if (! ids_to_slice.empty()) {
+            std::vector<float> zs_to_slice;
+            zs_to_slice.reserve(ids_to_slice.size());
+            for (size_t i : ids_to_slice)
+                zs_to_slice.emplace_back(zs[i]);
+            std::vector<ExPolygons> sliced = slice_volume_mesh(volume, zs_to_slice, params2, throw_on_cancel_callback);
+            for (size_t i = 0; i < ids_to_slice.size(); ++ i)
+                layers[ids_to_slice[i]] = std::move(sliced[i]);
+        }
+        if (print_object_regions != nullptr) {
+            std::lock_guard<std::mutex> lock(print_object_regions->sliced_volumes_mutex);
+            std::vector<PrintObjectRegions::VolumeSlicesAtZs> &sliced_volumes = print_object_regions->sliced_volumes;
+            sliced_volumes.erase(std::remove_if(sliced_volumes.begin(), sliced_volumes.end(),
+                [&volume, &params2](const PrintObjectRegions::VolumeSlicesAtZs &sliced) { return sliced_volume_matches(sliced, volume, params2); }),
+                sliced_volumes.end());
+            // Keep the slices of the volume for each PrintObject sharing the regions (they differ by a rotation), drop the least recently sliced.
+            if (size_t(std::count_if(sliced_volumes.begin(), sliced_volumes.end(), [&volume](const PrintObjectRegions::VolumeSlicesAtZs &sliced) { return sliced.volume_id == volume.id(); })) >=
+                std::max<size_t>(1, print_object_regions->num_print_objects()))
+                sliced_volumes.erase(std::find_if(sliced_volumes.begin(), sliced_volumes.end(), [&volume](const PrintObjectRegions::VolumeSlicesAtZs &sliced) { return sliced.volume_id == volume.id(); }));
+            sliced_volumes.push_back({ volume.id(), volume.get_mesh_shared_ptr(), params2, zs, layers });
         }
     }
     return layers;
@@ -74,13 +185,14 @@ static std::vector<ExPolygons> slice_volume(
     const std::vector<float>                    &z,
     const std::vector<t_layer_height_range>     &ranges,
     const MeshSlicingParamsEx                   &params,
+    PrintObjectRegions                          *print_object_regions,
     const std::function<void()>                 &throw_on_cancel_callback)
 {
     std::vector<ExPolygons> out;
     if (! z.empty() && ! ranges.empty()) {
         if (ranges.size() == 1 && z.front() >= ranges.front().first && z.back() < ranges.front().second) {
             // All layers fit into a single range.
-            out = slice_volume(volume, z, params, throw_on_cancel_callback);
+            out = slice_volume(volume, z, params, print_object_regions, throw_on_cancel_callback);
         } else {
             std::vector<float>                     z_filtered;
             std::vector<std::pair<size_t, size_t>> n_filtered;
@@ -96,7 +208,7 @@ static std::vector<ExPolygons> slice_volume(
                     n_filtered.emplace_back(std::make_pair(first, i));
             }
             if (! n_filtered.empty()) {
-                std::vector<ExPolygons> layers = slice_volume(volume, z_filtered, params, throw_on_cancel_callback);
+                std::vector<ExPolygons> layers = slice_volume(volume, z_filtered, params, print_object_regions, throw_on_cancel_callback);
                 out.assign(z.size(), ExPolygons());
                 i = 0;
                 for (const std::pair<size_t, size_t> &span : n_filtered)
@@ -117,15 +229,25 @@ static inline bool model_volume_needs_slicing(const ModelVolume &mv)
 // Apply closing radius.
 // Apply positive XY compensation to ModelVolumeType::MODEL_PART and ModelVolumeType::PARAMETER_MODIFIER, not to ModelVolumeType::NEGATIVE_VOLUME.
 // Apply contour simplification.
+// If keep_volume_slices, reuse the slices of the last slicing kept by print_object_regions at the slicing planes which did not move
+// and keep the new slices for the next slicing. Otherwise release the kept slices.
 static std::vector<VolumeSlices> slice_volumes_inner(
     const PrintConfig                                        &print_config,
     const PrintObjectConfig                                  &print_object_config,
     const Transform3d                                        &object_trafo,
     ModelVolumePtrs                                           model_volumes,
-    const std::vector<PrintObjectRegions::LayerRangeRegions> &layer_ranges,
+    PrintObjectRegions                                       &print_object_regions,
+    bool                                                      keep_volume_slices,
     const std::vector<float>                                 &zs,
     const std::function<void()>                              &throw_on_cancel_callback)
 {
+    if (! keep_volume_slices) {
+        std::lock_guard<std::mutex> lock(print_object_regions.sliced_volumes_mutex);
+        print_object_regions.sliced_volumes.clear();
+        print_object_regions.sliced_volumes.shrink_to_fit();
+    }
+    PrintObjectRegions *sliced_volumes_cache = keep_volume_slices ? &print_object_regions : nullptr;
+    const std::vector<PrintObjectRegions::LayerRangeRegions> &layer_ranges = print_object_regions.layer_ranges;
     model_volumes_sort_by_id(model_volumes);
 
     std::vector<VolumeSlices> out;
@@ -178,7 +300,7 @@ static std::vector<VolumeSlices> slice_volumes_inner(
                     }
                     out.push_back({
                         model_volume->id(),
-                        slice_volume(*model_volume, zs, params, throw_on_cancel_callback)
+                        slice_volume(*model_volume, zs, params, sliced_volumes_cache, throw_on_cancel_callback)
                     });
                 }
             } else {
@@ -190,13 +312,23 @@ static std::vector<VolumeSlices> slice_volumes_inner(
                 if (! slicing_ranges.empty())
                     out.push_back({
                         model_volume->id(),
-                        slice_volume(*model_volume, zs, slicing_ranges, params, throw_on_cancel_callback)
+                        slice_volume(*model_volume, zs, slicing_ranges, params, sliced_volumes_cache, throw_on_cancel_callback)
                     });
             }
             if (! out.empty() && out.back().slices.empty())
                 out.pop_back();
         }
 
+    if (keep_volume_slices) {
+        // Drop the slices of the volumes which were deleted or whose mesh was replaced.
+        std::lock_guard<std::mutex> lock(print_object_regions.sliced_volumes_mutex);
+        std::vector<PrintObjectRegions::VolumeSlicesAtZs> &sliced_volumes = print_object_regions.sliced_volumes;
+        sliced_volumes.erase(std::remove_if(sliced_volumes.begin(), sliced_volumes.end(), [&model_volumes](const PrintObjectRegions::VolumeSlicesAtZs &sliced) {
+                auto it = lower_bound_by_predicate(model_volumes.begin(), model_volumes.end(), [&sliced](const ModelVolume *mv) { return mv->id() < sliced.volume_id; });
+                return it == model_volumes.end() || (*it)->id() != sliced.volume_id || (*it)->get_mesh_shared_ptr() != sliced.mesh;
+            }), sliced_volumes.end());
+    }
+
     return out;
 }
 
@@ -1000,9 +1132,11 @@ void PrintObject::slice_volumes()
     std::vector<float>                   slice_zs      = zs_from_layers(m_layers);
     std::vector<VolumeSlices> objSliceByVolume;
     if (!slice_zs.empty()) {
+        // Only the edits of the height range modifiers keep the slicing planes of the other ranges in place,
+        // thus the slices of the volumes are only kept for the objects having some.
         objSliceByVolume = slice_volumes_inner(
             print->config(), this->config(), this->trafo_centered(),
-            this->model_object()->volumes, m_shared_regions->layer_ranges, slice_zs, throw_on_cancel_callback);
+            this->model_object()->volumes, *m_shared_regions, ! this->model_object()->layer_config_ranges.empty(), slice_zs, throw_on_cancel_callback);
     }
 
     //BBS: "model_part" volumes are grouded according to their connections
@@ -1361,7 +1495,7 @@ std::vector<Polygons> PrintObject::slice_support_volumes(const ModelVolumeType m
         params.trafo = this->trafo_centered();
         for (; it_volume != it_volume_end; ++ it_volume)
             if ((*it_volume)->type() == model_volume_type) {
-                std::vector<ExPolygons> slices2 = slice_volume(*(*it_volume), zs, params, throw_on_cancel_callback);
+                std::vector<ExPolygons> slices2 = slice_volume(*(*it_volume), zs, params, nullptr, throw_on_cancel_callback);
                 if (slices.empty()) {
                     slices.reserve(slices2.size());
                     for (ExPolygons &src : slices2)
@@ -288,6 +288,26 @@ void TreeModelVolumes::precalculate(const PrintObject& print_object, const coord
 #endif
 }
 
+void TreeModelVolumes::log_cache_statistics() const
+{
+    auto log = [](const RadiusLayerPolygonCache &cache, std::string_view name) {
+        const RadiusLayerPolygonCache::Stats &stats = cache.stats();
+        BOOST_LOG_TRIVIAL(info) << name << ": hits " << stats.hits.load() << ", misses " << stats.misses.load() <<
+            ", calculating on demand " << 1e-6 * stats.compute_ns.load() << " ms";
+    };
+    log(m_collision_cache,                    "collision_cache");
+    log(m_collision_cache_holefree,           "collision_cache_holefree");
+    log(m_avoidance_cache,                    "avoidance_cache");
+    log(m_avoidance_cache_slow,               "avoidance_cache_slow");
+    log(m_avoidance_cache_to_model,           "avoidance_cache_to_model");
+    log(m_avoidance_cache_to_model_slow,      "avoidance_cache_to_model_slow");
+    log(m_placeable_areas_cache,              "placable_areas_cache");
+    log(m_avoidance_cache_holefree,           "avoidance_cache_holefree");
+    log(m_avoidance_cache_holefree_to_model,  "avoidance_cache_holefree_to_model");
+    log(m_wall_restrictions_cache,            "wall_restrictions_cache");
+    log(m_wall_restrictions_cache_min,        "wall_restrictions_cache_min");
+}
+
 const Polygons& TreeModelVolumes::getCollision(const coord_t orig_radius, LayerIndex layer_idx, bool min_xy_dist) const
 {
     const coord_t radius = this->ceilRadius(orig_radius, min_xy_dist);
@@ -297,7 +317,9 @@ const Polygons& TreeModelVolumes::getCollision(const coord_t orig_radius, LayerI
         BOOST_LOG_TRIVIAL(error_level_not_in_cache) << "Had to calculate collision at radius " << radius << " and layer " << layer_idx << ", but precalculate was called. Performance may suffer!";
         tree_supports_show_error("Not precalculated Collision requested."sv, false);
     }
+    auto t_start = std::chrono::steady_clock::now();
     const_cast<TreeModelVolumes*>(this)->calculateCollision(radius, layer_idx, []{});
+    m_collision_cache.add_compute_time(t_start);
     return getCollision(orig_radius, layer_idx, min_xy_dist);
 }
 
@@ -320,7 +342,9 @@ const Polygons& TreeModelVolumes::getCollisionHolefree(coord_t radius, LayerInde
         BOOST_LOG_TRIVIAL(error_level_not_in_cache) << "Had to calculate collision holefree at radius " << radius << " and layer " << layer_idx << ", but precalculate was called. Performance may suffer!";
         tree_supports_show_error("Not precalculated Holefree Collision requested."sv, false);
     }
+    auto t_start = std::chrono::steady_clock::now();
     const_cast<TreeModelVolumes*>(this)->calculateCollisionHolefree({ radius, layer_idx });
+    m_collision_cache_holefree.add_compute_time(t_start);
     return getCollisionHolefree(radius, layer_idx);
 }
 
@@ -348,7 +372,9 @@ const Polygons& TreeModelVolumes::getAvoidance(const coord_t orig_radius, LayerI
             tree_supports_show_error("Not precalculated Avoidance(to buildplate) requested."sv, false);
         }
     }
+    auto t_start = std::chrono::steady_clock::now();
     const_cast<TreeModelVolumes*>(this)->calculateAvoidance({ radius, layer_idx }, ! to_model, to_model);
+    this->avoidance_cache(type, to_model).add_compute_time(t_start);
     // Retrive failed and correct result was calculated. Now it has to be retrived.
     return getAvoidance(orig_radius, layer_idx, type, to_model, min_xy_dist);
 }
@@ -365,8 +391,9 @@ const Polygons& TreeModelVolumes::getPlaceableAreas(const coord_t orig_radius, L
     if (orig_radius == 0)
         // Placable areas for radius 0 are calculated in the general collision code.
         return this->getCollision(0, layer_idx, true);
-    else
-        const_cast<TreeModelVolumes*>(this)->calculatePlaceables(radius, layer_idx, throw_on_cancel);
+    auto t_start = std::chrono::steady_clock::now();
+    const_cast<TreeModelVolumes*>(this)->calculatePlaceables(radius, layer_idx, throw_on_cancel);
+    m_placeable_areas_cache.add_compute_time(t_start);
     return getPlaceableAreas(orig_radius, layer_idx, throw_on_cancel);
 }
 
@@ -393,7 +420,9 @@ const Polygons& TreeModelVolumes::getWallRestriction(const coord_t orig_radius,
                 "Not precalculated Wall restriction requested )."sv
             , false);
     }
+    auto t_start = std::chrono::steady_clock::now();
     const_cast<TreeModelVolumes*>(this)->calculateWallRestrictions({ radius, layer_idx });
+    (min_xy_dist ? m_wall_restrictions_cache_min : m_wall_restrictions_cache).add_compute_time(t_start);
     return getWallRestriction(orig_radius, layer_idx, min_xy_dist); // Retrieve failed and correct result was calculated. Now it has to be retrieved.
 }
 
@@ -849,24 +878,158 @@ coord_t TreeModelVolumes::ceilRadius(const coord_t radius) const
     return out;
 }
 
-void TreeModelVolumes::RadiusLayerPolygonCache::allocate_layers(size_t num_layers)
+TreeModelVolumes::RadiusLayerPolygonCache::RadiusColumn::~RadiusColumn()
+{
+    for (std::atomic<Slot*> &chunk : chunks)
+        if (Slot *slots = chunk.load(std::memory_order_relaxed); slots) {
+            for (size_t i = 0; i < CHUNK_SIZE; ++ i)
+                delete slots[i].load(std::memory_order_relaxed);
+            delete[] slots;
+        }
+}
+
+void TreeModelVolumes::RadiusLayerPolygonCache::RadiusColumn::set(LayerIndex layer_idx, Polygons &&polygons, std::atomic<LayerIndex> &num_layers)
+{
+    assert(layer_idx >= 0);
+    if (size_t(layer_idx) >= CHUNK_SIZE * MAX_CHUNKS) {
+        // Beyond the chunks, rare enough to be stored under a lock.
+        std::lock_guard<std::mutex> guard(overflow_mutex);
+        // An area already stored is kept as the references to it may be in use.
+        overflow.try_emplace(layer_idx, std::make_unique<const Polygons>(std::move(polygons)));
+    } else {
+        this->set_chunked(layer_idx, std::move(polygons));
+    }
+    for (LayerIndex n = num_layers.load(std::memory_order_relaxed); n <= layer_idx && ! num_layers.compare_exchange_weak(n, layer_idx + 1, std::memory_order_relaxed);) ;
+}
+
+void TreeModelVolumes::RadiusLayerPolygonCache::RadiusColumn::set_chunked(LayerIndex layer_idx, Polygons &&polygons)
+{
+    std::atomic<Slot*> &chunk = chunks[layer_idx / CHUNK_SIZE];
+    Slot *slots = chunk.load(std::memory_order_acquire);
+    if (slots == nullptr) {
+        // Zero initialized.
+        Slot *slots_new = new Slot[CHUNK_SIZE]();
+        if (chunk.compare_exchange_strong(slots, slots_new, std::memory_order_acq_rel))
+            slots = slots_new;
+        else
+            // Allocated by another thread in the meantime, slots was updated by compare_exchange_strong().
+            delete[] slots_new;
+    }
+    const Polygons *expected = nullptr;
+    auto           *value    = new Polygons(std::move(polygons));
+    if (! slots[layer_idx % CHUNK_SIZE].compare_exchange_strong(expected, value, std::memory_order_acq_rel))
+        // Already stored, keep the old value as the references to it may be in use.
+        delete value;
+}
+
+const Polygons* TreeModelVolumes::RadiusLayerPolygonCache::RadiusColumn::get_overflow(LayerIndex layer_idx) const
 {
-    if (num_layers > m_data.size()) {
-        if (num_layers > m_data.capacity())
-            reserve_power_of_2(m_data, num_layers);
-        m_data.resize(num_layers, {});
+    std::lock_guard<std::mutex> guard(overflow_mutex);
+    auto it = overflow.find(layer_idx);
+    return it == overflow.end() ? nullptr : it->second.get();
+}
+
+const Polygons* TreeModelVolumes::RadiusLayerPolygonCache::RadiusColumn::release(LayerIndex layer_idx)
+{
+    if (size_t(layer_idx) >= CHUNK_SIZE * MAX_CHUNKS) {
+        auto it = overflow.find(layer_idx);
+        if (it == overflow.end())
+            return nullptr;
+        const Polygons *out = it->second.release();
+        overflow.erase(it);
+        return out;
     }
+    Slot *slots = chunks[layer_idx / CHUNK_SIZE].load(std::memory_order_relaxed);
+    return slots ? slots[layer_idx % CHUNK_SIZE].exchange(nullptr, std::memory_order_relaxed) : nullptr;
+}
+
+TreeModelVolumes::RadiusLayerPolygonCache::RadiusColumn& TreeModelVolumes::RadiusLayerPolygonCache::column(coord_t radius)
+{
+    auto find = [radius](const Columns *columns) -> RadiusColumn* {
+        if (columns)
+            if (auto it = lower_bound_by_predicate(columns->begin(), columns->end(), [radius](const RadiusColumn *c) { return c->radius < radius; });
+                it != columns->end() && (*it)->radius == radius)
+                return *it;
+        return nullptr;
+    };
+    if (RadiusColumn *out = find(m_columns.load(std::memory_order_acquire)); out)
+        return *out;
+    std::lock_guard<std::mutex> guard(m_mutex);
+    const Columns *columns = m_columns.load(std::memory_order_acquire);
+    if (RadiusColumn *out = find(columns); out)
+        // Added by another thread in the meantime.
+        return *out;
+    // Publish a new snapshot, keep the old one alive as it may still be read.
+    m_column_storage.emplace_back(std::make_unique<RadiusColumn>(radius));
+    auto snapshot = std::make_unique<Columns>(columns ? *columns : Columns{});
+    snapshot->insert(std::upper_bound(snapshot->begin(), snapshot->end(), radius, [](coord_t r, const RadiusColumn *c) { return r < c->radius; }), m_column_storage.back().get());
+    m_snapshots.emplace_back(std::move(snapshot));
+    m_columns.store(m_snapshots.back().get(), std::memory_order_release);
+    return *m_column_storage.back();
+}
+
+TreeModelVolumes::RadiusLayerPolygonCache& TreeModelVolumes::RadiusLayerPolygonCache::operator=(RadiusLayerPolygonCache &&rhs)
+{
+    this->clear();
+    m_columns.store(rhs.m_columns.exchange(nullptr));
+    m_num_layers.store(rhs.m_num_layers.exchange(0));
+    m_column_storage = std::move(rhs.m_column_storage);
+    m_snapshots      = std::move(rhs.m_snapshots);
+    m_stats.hits.store(rhs.m_stats.hits.exchange(0));
+    m_stats.misses.store(rhs.m_stats.misses.exchange(0));
+    m_stats.compute_ns.store(rhs.m_stats.compute_ns.exchange(0));
+    return *this;
+}
+
+LayerIndex TreeModelVolumes::RadiusLayerPolygonCache::getMaxCalculatedLayer(coord_t radius) const
+{
+    auto layer_idx = m_num_layers.load(std::memory_order_acquire) - 1;
+    if (const Columns *columns = m_columns.load(std::memory_order_acquire); columns) {
+        auto it = lower_bound_by_predicate(columns->begin(), columns->end(), [radius](const RadiusColumn *c) { return c->radius < radius; });
+        if (it != columns->end() && (*it)->radius == radius) {
+            for (; layer_idx > 0; -- layer_idx)
+                if ((*it)->get(layer_idx) != nullptr)
+                    break;
+        } else
+            layer_idx = 0;
+    } else
+        layer_idx = 0;
+    // The placeable on model areas do not exist on layer 0, as there can not be model below it. As such it may be possible that layer 1 is available, but layer 0 does not exist.
+    return layer_idx <= 0 ? -1 : layer_idx;
+}
+
+void TreeModelVolumes::RadiusLayerPolygonCache::clear()
+{
+    m_columns.store(nullptr);
+    m_num_layers.store(0);
+    m_column_storage.clear();
+    m_snapshots.clear();
+}
+
+void TreeModelVolumes::RadiusLayerPolygonCache::clear_all_but_radius0()
+{
+    if (const Columns *columns = m_columns.load(); columns)
+        for (LayerIndex layer_idx = 0; layer_idx < m_num_layers.load(); ++ layer_idx) {
+            // Keep the smallest radius stored at this layer.
+            bool found = false;
+            for (RadiusColumn *column : *columns)
+                if (column->get(layer_idx) != nullptr) {
+                    if (found)
+                        delete column->release(layer_idx);
+                    found = true;
+                }
+        }
 }
 
 // For debugging purposes, sorted by layer index, then by radius.
 std::vector<std::pair<TreeModelVolumes::RadiusLayerPair, std::reference_wrapper<const Polygons>>> TreeModelVolumes::RadiusLayerPolygonCache::sorted() const
 {
     std::vector<std::pair<RadiusLayerPair, std::reference_wrapper<const Polygons>>> out;
-    for (auto &layer : m_data) {
-        auto layer_idx = LayerIndex(&layer - m_data.data());
-        for (auto &radius_polygons : layer)
-            out.emplace_back(std::make_pair(radius_polygons.first, layer_idx), radius_polygons.second);
-    }
+    if (const Columns *columns = m_columns.load(std::memory_order_acquire); columns)
+        for (LayerIndex layer_idx = 0; layer_idx < m_num_layers.load(std::memory_order_acquire); ++ layer_idx)
+            for (const RadiusColumn *column : *columns)
+                if (const Polygons *polygons = column->get(layer_idx); polygons)
+                    out.emplace_back(std::make_pair(column->radius, layer_idx), *polygons);
     assert(std::is_sorted(out.begin(), out.end(), [](auto &l, auto &r){ return l.first.second < r.first.second || (l.first.second == r.first.second) && l.first.first < r.first.first; }));
     return out;
 }
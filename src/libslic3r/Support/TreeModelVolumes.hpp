@@ -9,6 +9,12 @@
 #ifndef slic3r_TreeModelVolumes_hpp
 #define slic3r_TreeModelVolumes_hpp
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <memory>
 #include <mutex>
 #include <unordered_map>
 
@@ -86,6 +92,9 @@ public:
      */
     void precalculate(const PrintObject& print_object, const coord_t max_layer, std::function<void()> throw_on_cancel);
 
+    // Log the hits, misses and the time spent calculating on demand of the caches.
+    void log_cache_statistics() const;
+
     /*!
      * \brief Provides the areas that have to be avoided by the tree's branches to prevent collision with the model on this layer.
      *
@@ -191,47 +200,50 @@ private:
         LayerIndex            m_idx_end;
     };
 
+    // Gives the unit tests access to RadiusLayerPolygonCache.
+    friend struct RadiusLayerPolygonCacheTest;
+
     /*!
      * \brief Convenience typedef for the keys to the caches
      */
     using RadiusLayerPair             = std::pair<coord_t, LayerIndex>;
+    // Cache of areas per radius and layer. Once stored, an area is never modified until clear() or clear_all_but_radius0(),
+    // thus the references returned stay valid while other threads insert.
+    // Readers do not lock: The areas of a radius are stored in a RadiusColumn, whose slots are published by atomic pointers,
+    // and the sorted list of columns is replaced by a new immutable snapshot when a radius is added.
+    // Only adding a radius is serialized by a mutex.
     class RadiusLayerPolygonCache {
-        // Map from radius to Polygons. Cache of one layer collision regions.
-        using LayerData = std::map<coord_t, Polygons>;
-        // Vector of layers, at each layer map of radius to Polygons.
-        // Reference to Polygons returned shall be stable to insertion.
-        using Layers = std::vector<LayerData>;
     public:
         RadiusLayerPolygonCache() = default;
-        RadiusLayerPolygonCache(RadiusLayerPolygonCache &&rhs) : m_data(std::move(rhs.m_data)) {}
-        RadiusLayerPolygonCache& operator=(RadiusLayerPolygonCache &&rhs) { m_data = std::move(rhs.m_data); return *this; }
+        RadiusLayerPolygonCache(RadiusLayerPolygonCache &&rhs) { *this = std::move(rhs); }
+        // Not thread safe.
+        RadiusLayerPolygonCache& operator=(RadiusLayerPolygonCache &&rhs);
+        ~RadiusLayerPolygonCache() { this->clear(); }
 
         RadiusLayerPolygonCache(const RadiusLayerPolygonCache&) = delete;
         RadiusLayerPolygonCache& operator=(const RadiusLayerPolygonCache&) = delete;
 
+        // An area already stored for a radius and a layer is kept, the new one is dropped.
         void insert(std::vector<std::pair<RadiusLayerPair, Polygons>> &&in) {
-            std::lock_guard<std::mutex> guard(m_mutex);
             for (auto &d : in)
-                this->get_allocate_layer_data(d.first.second).emplace(d.first.first, std::move(d.second));
+                this->column(d.first.first).set(d.first.second, std::move(d.second), m_num_layers);
         }
         // by layer
         void insert(std::vector<std::pair<coord_t, Polygons>> &&in, coord_t radius) {
-            std::lock_guard<std::mutex> guard(m_mutex);
+            RadiusColumn &column = this->column(radius);
             for (auto &d : in)
-                this->get_allocate_layer_data(d.first).emplace(radius, std::move(d.second));
+                column.set(d.first, std::move(d.second), m_num_layers);
         }
         void insert(std::vector<Polygons> &&in, coord_t first_layer_idx, coord_t radius) {
-            std::lock_guard<std::mutex> guard(m_mutex);
-            allocate_layers(first_layer_idx + in.size());
+            RadiusColumn &column = this->column(radius);
             for (auto &d : in)
-                m_data[first_layer_idx ++].emplace(radius, std::move(d));
+                column.set(first_layer_idx ++, std::move(d), m_num_layers);
         }
         void insert(LayerPolygonCache &&in, coord_t radius) {
-            std::lock_guard<std::mutex> guard(m_mutex);
+            RadiusColumn &column = this->column(radius);
             LayerIndex i = in.begin();
-            allocate_layers(i + LayerIndex(in.size()));
             for (auto &d : in.polygons_mutable())
-                m_data[i ++].emplace(radius, std::move(d));
+                column.set(i ++, std::move(d), m_num_layers);
         }
         /*!
          * \brief Checks a cache for a given RadiusLayerPair and returns it if it is found
@@ -239,29 +251,25 @@ private:
          * \return A wrapped optional reference of the requested area (if it was found, an empty optional if nothing was found)
          */
         std::optional<std::reference_wrapper<const Polygons>> getArea(const TreeModelVolumes::RadiusLayerPair &key) const {
-            std::lock_guard<std::mutex> guard(m_mutex);
-            if (key.second >= LayerIndex(m_data.size()))
-                return std::optional<std::reference_wrapper<const Polygons>>{};
-            const auto &layer = m_data[key.second];
-            auto it = layer.find(key.first);
-            return it == layer.end() ? 
-                std::optional<std::reference_wrapper<const Polygons>>{} : std::optional<std::reference_wrapper<const Polygons>>{ it->second };
+            if (const Columns *columns = m_columns.load(std::memory_order_acquire); columns) {
+                auto it = lower_bound_by_predicate(columns->begin(), columns->end(), [&key](const RadiusColumn *c) { return c->radius < key.first; });
+                if (it != columns->end() && (*it)->radius == key.first)
+                    if (const Polygons *polygons = (*it)->get(key.second); polygons) {
+                        m_stats.hits.fetch_add(1, std::memory_order_relaxed);
+                        return std::optional<std::reference_wrapper<const Polygons>>{ *polygons };
+                    }
+            }
+            m_stats.misses.fetch_add(1, std::memory_order_relaxed);
+            return std::optional<std::reference_wrapper<const Polygons>>{};
         }
         // Get a collision area at a given layer for a radius that is a lower or equial to the key radius.
         std::optional<std::pair<coord_t, std::reference_wrapper<const Polygons>>> get_lower_bound_area(const TreeModelVolumes::RadiusLayerPair &key) const {
-            std::lock_guard<std::mutex> guard(m_mutex);
-            if (key.second >= LayerIndex(m_data.size()))
-                return {};
-            const auto &layer = m_data[key.second];
-            if (layer.empty())
-                return {};
-            auto it = layer.lower_bound(key.first);
-            if (it == layer.end() || it->first != key.first) {
-                if (it == layer.begin())
-                    return {};
-                -- it;
-            }
-            return std::make_pair(it->first, std::reference_wrapper<const Polygons>(it->second));
+            if (const Columns *columns = m_columns.load(std::memory_order_acquire); columns)
+                for (auto it = std::upper_bound(columns->begin(), columns->end(), key.first, [](coord_t radius, const RadiusColumn *c) { return radius < c->radius; });
+                     it != columns->begin();)
+                    if (const Polygons *polygons = (*(-- it))->get(key.second); polygons)
+                        return std::make_pair((*it)->radius, std::reference_wrapper<const Polygons>(*polygons));
+            return {};
         }
         /*!
          * \brief Get the highest already calculated layer in the cache.
@@ -270,40 +278,74 @@ private:
          *
          * \return A wrapped optional reference of the requested area (if it was found, an empty optional if nothing was found)
          */
-        LayerIndex getMaxCalculatedLayer(coord_t radius) const {
-            std::lock_guard<std::mutex> guard(m_mutex);
-            auto layer_idx = LayerIndex(m_data.size()) - 1;
-            for (; layer_idx > 0; -- layer_idx)
-                if (const auto &layer = m_data[layer_idx]; layer.find(radius) != layer.end())
-                    break;
-            // The placeable on model areas do not exist on layer 0, as there can not be model below it. As such it may be possible that layer 1 is available, but layer 0 does not exist.
-            return layer_idx == 0 ? -1 : layer_idx;
-        }
+        LayerIndex getMaxCalculatedLayer(coord_t radius) const;
 
         // For debugging purposes, sorted by layer index, then by radius.
         [[nodiscard]] std::vector<std::pair<RadiusLayerPair, std::reference_wrapper<const Polygons>>> sorted() const;
 
-        void clear() { m_data.clear(); }
-        void clear_all_but_radius0() { 
-            for (LayerData &l : m_data) {
-                auto begin = l.begin();
-                auto end = l.end();
-                if (begin != end && ++ begin != end)
-                    l.erase(begin, end);
-            }
+        // Not thread safe.
+        void clear();
+        void clear_all_but_radius0();
+
+        struct Stats {
+            std::atomic<size_t> hits { 0 };
+            std::atomic<size_t> misses { 0 };
+            // Time spent calculating the areas missing in the cache on demand.
+            std::atomic<int64_t> compute_ns { 0 };
+        };
+        const Stats& stats() const { return m_stats; }
+        void add_compute_time(std::chrono::steady_clock::time_point t_start) const {
+            m_stats.compute_ns.fetch_add(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - t_start).count(), std::memory_order_relaxed);
         }
 
     private:
-        LayerData&          get_allocate_layer_data(LayerIndex layer_idx) {
-            allocate_layers(layer_idx + 1);
-            return m_data[layer_idx];
-        }
-        void                allocate_layers(size_t num_layers);
-
-        Layers              m_data;
-        mutable std::mutex  m_mutex;
+        // Areas of all layers for a single radius. The layers are stored in chunks allocated on demand, which never move.
+        // The layers above CHUNK_SIZE * MAX_CHUNKS are stored in a map guarded by a mutex.
+        struct RadiusColumn {
+            static constexpr const size_t CHUNK_SIZE = 256;
+            static constexpr const size_t MAX_CHUNKS = 1024;
+            using Slot = std::atomic<const Polygons*>;
+
+            explicit RadiusColumn(coord_t radius) : radius(radius) {}
+            ~RadiusColumn();
+
+            const Polygons* get(LayerIndex layer_idx) const {
+                if (layer_idx < 0)
+                    return nullptr;
+                if (size_t(layer_idx) >= CHUNK_SIZE * MAX_CHUNKS)
+                    return this->get_overflow(layer_idx);
+                const Slot *chunk = chunks[layer_idx / CHUNK_SIZE].load(std::memory_order_acquire);
+                return chunk ? chunk[layer_idx % CHUNK_SIZE].load(std::memory_order_acquire) : nullptr;
+            }
+            void set(LayerIndex layer_idx, Polygons &&polygons, std::atomic<LayerIndex> &num_layers);
+            void set_chunked(LayerIndex layer_idx, Polygons &&polygons);
+            // Not thread safe, returns the released Polygons.
+            const Polygons* release(LayerIndex layer_idx);
+
+            const Polygons* get_overflow(LayerIndex layer_idx) const;
+
+            coord_t                           radius;
+            std::array<std::atomic<Slot*>, MAX_CHUNKS> chunks {};
+            mutable std::mutex                overflow_mutex;
+            std::map<LayerIndex, std::unique_ptr<const Polygons>> overflow;
+        };
+        // Sorted by radius.
+        using Columns = std::vector<RadiusColumn*>;
+
+        // Returns a column for the radius, adding it if it does not exist yet.
+        RadiusColumn&       column(coord_t radius);
+
+        std::atomic<const Columns*>                  m_columns { nullptr };
+        // One above the highest layer stored in any of the columns.
+        std::atomic<LayerIndex>                      m_num_layers { 0 };
+        // Owning the columns and the current and the retired snapshots of m_columns, guarded by m_mutex.
+        std::vector<std::unique_ptr<RadiusColumn>>   m_column_storage;
+        std::vector<std::unique_ptr<const Columns>>  m_snapshots;
+        std::mutex                                   m_mutex;
+        mutable Stats                                m_stats;
     };
 
+private:
 
     /*!
      * \brief Provides the areas that have to be avoided by the tree's branches to prevent collision with the model on this layer. Holes are removed.
@@ -1,4 +1,6 @@
 #include <math.h>
+#include <limits>
+#include <atomic>
 
 #include "MinimumSpanningTree.hpp"
 #include "TreeSupport.hpp"
@@ -89,17 +91,16 @@ enum TreeSupportStage {
     NUM_STAGES
 };
 
+// Thread safe: the stages timed by tic() / stage_add() are reached from the parallel loops, thus the start time
+// is kept by the caller and the durations are accumulated atomically.
 class TreeSupportProfiler
 {
 public:
-    uint32_t stage_durations[NUM_STAGES];
-    uint32_t stage_index = 0;
-    boost::posix_time::ptime tic_time;
-    boost::posix_time::ptime toc_time;
+    std::atomic<uint32_t> stage_durations[NUM_STAGES];
 
     TreeSupportProfiler()
     {
-        for (uint32_t& item : stage_durations) {
+        for (std::atomic<uint32_t>& item : stage_durations) {
             item = 0;
         }
     }
@@ -121,15 +122,13 @@ public:
         stage_durations[stage] = (time - m_stage_start_times[stage]).total_milliseconds();
     }
 
-    void tic() { tic_time = boost::posix_time::microsec_clock::local_time(); }
-    void toc() { toc_time = boost::posix_time::microsec_clock::local_time(); }
-    void stage_add(TreeSupportStage stage, bool do_toc = false)
+    boost::posix_time::ptime tic() const { return boost::posix_time::microsec_clock::local_time(); }
+    void stage_add(TreeSupportStage stage, const boost::posix_time::ptime &tic_time)
     {
         if (stage > NUM_STAGES)
             return;
-        if(do_toc)
-            toc_time = boost::posix_time::microsec_clock::local_time();
-        stage_durations[stage] += (toc_time - tic_time).total_milliseconds();
+        const boost::posix_time::ptime toc_time = boost::posix_time::microsec_clock::local_time();
+        stage_durations[stage].fetch_add(uint32_t((toc_time - tic_time).total_milliseconds()), std::memory_order_relaxed);
     }
 
     std::string report()
@@ -2299,7 +2298,7 @@ void TreeSupport::draw_circles(const std::vector<std::vector<Node*>>& contact_no
 
                 // let supports touch objects when brim is on
                 auto avoid_region = m_ts_data->get_collision((layer_nr == 0 && has_brim) ? config.brim_object_gap : m_ts_data->m_xy_distance, layer_nr);
-                base_areas = avoid_object_remove_extra_small_parts(base_areas, avoid_region);
+                base_areas = avoid_object_remove_extra_small_parts(base_areas, *avoid_region);
                 base_areas = std::move(diff_ex(base_areas, roof_areas));
                 base_areas = std::move(diff_ex(base_areas, roof_1st_layer));
                 base_areas = std::move(diff_ex(base_areas, roof_gap_areas));
@@ -2425,7 +2424,15 @@ void TreeSupport::draw_circles(const std::vector<std::vector<Node*>>& contact_no
             auto m_support_material_flow = support_material_flow(m_object, m_slicing_params.layer_height);
             coordf_t support_spacing = object_config.support_base_pattern_spacing.value + m_support_material_flow.spacing();
             coordf_t support_density = std::min(1., m_support_material_flow.spacing() / support_spacing * 2); // for lightning infill the density is defined differently, so need to double it
-            generator = std::make_unique<FillLightning::Generator>(m_object, contours, overhangs, []() {}, support_density);
+            // Reuse the trees of the previous support generation if they were generated from the same inputs.
+            FillLightning::Generator::Inputs inputs(*m_object, std::move(contours), std::move(overhangs), support_density);
+            generator = m_object->support_lightning_generator();
+            if (! generator || generator->inputs() != inputs) {
+                // Release the previous trees before generating the new ones.
+                m_object->set_support_lightning_generator(nullptr);
+                generator = std::make_shared<FillLightning::Generator>(std::move(inputs), []() {});
+            }
+            m_object->set_support_lightning_generator(generator);
         }
 
         else if (!with_infill) {
@@ -2530,7 +2537,7 @@ void TreeSupport::draw_circles(const std::vector<std::vector<Node*>>& contact_no
                                 // make sure 1) roof1 and object 2) roof1 and roof, won't intersect
                                 // Note: We can't replace roof1 directly, as we have recorded its address.
                                 //       So instead we need to replace its members one by one.
-                                auto tmp1 = diff_ex(roof1, m_ts_data->get_collision((layer_nr == 0 && has_brim) ? config.brim_object_gap : m_ts_data->m_xy_distance, layer_nr));
+                                auto tmp1 = diff_ex(roof1, *m_ts_data->get_collision((layer_nr == 0 && has_brim) ? config.brim_object_gap : m_ts_data->m_xy_distance, layer_nr));
                                 tmp1 = diff_ex(tmp1, ts_layer->roof_areas);
                                 if (!tmp1.empty()) {
                                     roof1.contour = std::move(tmp1[0].contour);
@@ -2682,33 +2689,54 @@ void TreeSupport::drop_nodes(std::vector<std::vector<Node*>>& contact_nodes)
         m_object->print()->set_status(60, (boost::format(_L("Support: propagate branches at layer %d")) % layer_nr).str());
 
         Polygons layer_contours = m_ts_data->get_contours_with_holes(layer_nr);
-        //std::unordered_map<Line, bool, LineHash>& mst_line_x_layer_contour_cache = m_mst_line_x_layer_contour_caches[layer_nr];
-        std::unordered_map<Line, bool, LineHash> mst_line_x_layer_contour_cache;
-        auto is_line_cut_by_contour = [&mst_line_x_layer_contour_cache,&layer_contours](Point a, Point b)
-        {
-            auto iter = mst_line_x_layer_contour_cache.find({ a, b });
-            if (iter != mst_line_x_layer_contour_cache.end()) {
-                if (iter->second)
-                    return true;
-            }
-            else {
-                profiler.tic();
-                Line ln(b, a);
-                Lines pls_intersect = intersection_ln(ln, layer_contours);
-                mst_line_x_layer_contour_cache.insert({ {a, b}, !pls_intersect.empty() });
-                mst_line_x_layer_contour_cache.insert({ ln, !pls_intersect.empty() });
-                profiler.stage_add(STAGE_intersection_ln, true);
-                if (!pls_intersect.empty())
-                    return true;
-            }
-            return false;
-        };
 
         //Group together all nodes for each part.
-        const ExPolygons& parts = m_ts_data->get_avoidance(0, layer_nr);
+        std::shared_ptr<const ExPolygons> parts_ptr = m_ts_data->get_avoidance(0, layer_nr);
+        const ExPolygons& parts = *parts_ptr;
+        /* Find which part each node is located in, in parallel. Since nodes have a radius and the
+         * avoidance areas are offset by that radius, the set of parts may
+         * be different per node. Here we consider a node to be inside the
+         * part that is closest. The node may be inside a bigger part that
+         * is actually two parts merged together due to an offset. In that
+         * case we may incorrectly keep two nodes separate, but at least
+         * every node falls into some group.
+         */
+        std::vector<size_t> closest_parts(layer_contact_nodes.size(), 0);
+        if (! parts.empty())
+            tbb::parallel_for(tbb::blocked_range<size_t>(0, layer_contact_nodes.size()), [&](const tbb::blocked_range<size_t> &range) {
+                for (size_t node_idx = range.begin(); node_idx < range.end(); ++ node_idx) {
+                    const Node &node = *layer_contact_nodes[node_idx];
+                    if (node.distance_to_top < 0 || (support_on_buildplate_only && !node.to_buildplate) || node.to_buildplate)
+                        continue;
+                    coordf_t closest_part_distance2 = std::numeric_limits<coordf_t>::max();
+                    size_t closest_part = -1;
+                    for (size_t part_index = 0; part_index < parts.size(); part_index++)
+                    {
+                        //constexpr bool border_result = true;
+                        if (is_inside_ex(parts[part_index], node.position)) //If it's inside, the distance is 0 and this part is considered the best.
+                        {
+                            closest_part = part_index;
+                            closest_part_distance2 = 0;
+                            break;
+                        }
+
+                        Point closest_point = *parts[part_index].contour.closest_point(node.position);
+                        const coordf_t distance2 = vsize2_with_unscale(node.position - closest_point);
+                        if (distance2 < closest_part_distance2)
+                        {
+                            closest_part_distance2 = distance2;
+                            closest_part = part_index;
+                        }
+                    }
+                    closest_parts[node_idx] = closest_part + 1; //Index + 1 because the 0th index is the outside part.
+                }
+            });
+
+        // Group the nodes serially in their original order, so that the groups are the same between runs.
         std::vector<std::unordered_map<Point, Node*, PointHash>> nodes_per_part(1 + parts.size()); //All nodes that aren't inside a part get grouped together in the 0th part.
-        for (Node* p_node : layer_contact_nodes)
+        for (size_t node_idx = 0; node_idx < layer_contact_nodes.size(); ++ node_idx)
         {
+            Node* p_node = layer_contact_nodes[node_idx];
             const Node& node = *p_node;
 
             if (node.distance_to_top < 0) {
@@ -2731,62 +2759,76 @@ void TreeSupport::drop_nodes(std::vector<std::vector<Node*>>& contact_nodes)
                 continue;
             }
 
-            /* Find which part this node is located in and group the nodes in
-             * the same part together. Since nodes have a radius and the
-             * avoidance areas are offset by that radius, the set of parts may
-             * be different per node. Here we consider a node to be inside the
-             * part that is closest. The node may be inside a bigger part that
-             * is actually two parts merged together due to an offset. In that
-             * case we may incorrectly keep two nodes separate, but at least
-             * every node falls into some group.
-             */
-            coordf_t closest_part_distance2 = std::numeric_limits<coordf_t>::max();
-            size_t closest_part = -1;
-            for (size_t part_index = 0; part_index < parts.size(); part_index++)
-            {
-                //constexpr bool border_result = true;
-                if (is_inside_ex(parts[part_index], node.position)) //If it's inside, the distance is 0 and this part is considered the best.
-                {
-                    closest_part = part_index;
-                    closest_part_distance2 = 0;
-                    break;
-                }
-
-                Point closest_point = *parts[part_index].contour.closest_point(node.position);
-                const coordf_t distance2 = vsize2_with_unscale(node.position - closest_point);
-                if (distance2 < closest_part_distance2)
-                {
-                    closest_part_distance2 = distance2;
-                    closest_part = part_index;
-                }
-            }
             //Put it in the best one.
-            nodes_per_part[closest_part + 1][node.position] = p_node; //Index + 1 because the 0th index is the outside part.
+            nodes_per_part[closest_parts[node_idx]][node.position] = p_node;
         }
 
         //Create a MST for every part.
-        profiler.tic();
+        auto tic_mst = profiler.tic();
         //std::vector<MinimumSpanningTree>& spanning_trees = m_spanning_trees[layer_nr];
-        std::vector<MinimumSpanningTree> spanning_trees;
-        for (const std::unordered_map<Point, Node*, PointHash>& group : nodes_per_part)
-        {
-            std::vector<Point> points_to_buildplate;
-            for (const std::pair<const Point, Node*>& entry : group)
-            {
-                points_to_buildplate.emplace_back(entry.first); //Just the position of the node.
+        std::vector<MinimumSpanningTree> spanning_trees(nodes_per_part.size());
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, nodes_per_part.size(), 1), [&nodes_per_part, &spanning_trees](const tbb::blocked_range<size_t> &range) {
+            for (size_t group_index = range.begin(); group_index < range.end(); ++ group_index) {
+                std::vector<Point> points_to_buildplate;
+                for (const std::pair<const Point, Node*>& entry : nodes_per_part[group_index])
+                {
+                    points_to_buildplate.emplace_back(entry.first); //Just the position of the node.
+                }
+                spanning_trees[group_index] = MinimumSpanningTree(points_to_buildplate);
             }
-            spanning_trees.emplace_back(points_to_buildplate);
+        });
+        profiler.stage_add(STAGE_MinimumSpanningTree, tic_mst);
+
+        // Calculate the avoidances of the next layer in parallel, one task per branch radius, as the avoidance of each radius
+        // is propagated from the layers below independently of the other radii.
+        {
+            std::vector<coordf_t> radii { m_ts_data->ceil_radius(0) };
+            for (const Node *p_node : layer_contact_nodes)
+                radii.emplace_back(m_ts_data->ceil_radius(calc_branch_radius(branch_radius, p_node->dist_mm_to_top, diameter_angle_scale_factor)));
+            sort_remove_duplicates(radii);
+            tbb::parallel_for(tbb::blocked_range<size_t>(0, radii.size(), 1), [this, &radii, layer_nr_next](const tbb::blocked_range<size_t> &range) {
+                for (size_t i = range.begin(); i < range.end(); ++ i)
+                    m_ts_data->get_avoidance(radii[i], layer_nr_next);
+            });
         }
-        profiler.stage_add(STAGE_MinimumSpanningTree,true);
 
 #ifdef SUPPORT_TREE_DEBUG_TO_SVG
         coordf_t branch_radius_temp = 0;
         coordf_t max_y = std::numeric_limits<coordf_t>::min();
         draw_layer_mst(std::to_string(ts_layer->print_z), spanning_trees, m_object->get_layer(layer_nr)->lslices);
 #endif
-        for (size_t group_index = 0; group_index < nodes_per_part.size(); group_index++)
+        // Process the groups in parallel. The new nodes and the unsupported leaves of each group are collected separately
+        // and merged in the order of the groups, thus the result is the same as if the groups were processed serially.
+        struct GroupResult {
+            std::vector<Node*>                    next_nodes;
+            std::vector<std::pair<size_t, Node*>> unsupported_branch_leaves;
+        };
+        std::vector<GroupResult> group_results(nodes_per_part.size());
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, nodes_per_part.size(), 1), [&](const tbb::blocked_range<size_t> &range) {
+        for (size_t group_index = range.begin(); group_index < range.end(); ++ group_index)
         {
             const MinimumSpanningTree& mst = spanning_trees[group_index];
+            GroupResult &result = group_results[group_index];
+            std::unordered_map<Line, bool, LineHash> mst_line_x_layer_contour_cache;
+            auto is_line_cut_by_contour = [&mst_line_x_layer_contour_cache,&layer_contours](Point a, Point b)
+            {
+                auto iter = mst_line_x_layer_contour_cache.find({ a, b });
+                if (iter != mst_line_x_layer_contour_cache.end()) {
+                    if (iter->second)
+                        return true;
+                }
+                else {
+                    auto tic = profiler.tic();
+                    Line ln(b, a);
+                    Lines pls_intersect = intersection_ln(ln, layer_contours);
+                    mst_line_x_layer_contour_cache.insert({ {a, b}, !pls_intersect.empty() });
+                    mst_line_x_layer_contour_cache.insert({ ln, !pls_intersect.empty() });
+                    profiler.stage_add(STAGE_intersection_ln, tic);
+                    if (!pls_intersect.empty())
+                        return true;
+                }
+                return false;
+            };
             //In the first pass, merge all nodes that are close together.
             std::unordered_set<Node*> to_delete;
             for (const std::pair<const Point, Node*>& entry : nodes_per_part[group_index])
@@ -2825,12 +2867,12 @@ void TreeSupport::drop_nodes(std::vector<std::vector<Node*>>& contact_nodes)
 
                     const coordf_t branch_radius_node = calc_branch_radius(branch_radius, node.dist_mm_to_top, diameter_angle_scale_factor);
 
-                    auto avoid_layer = m_ts_data->get_avoidance(branch_radius_node, layer_nr_next);
+                    std::shared_ptr<const ExPolygons> avoid_layer = m_ts_data->get_avoidance(branch_radius_node, layer_nr_next);
                     if (group_index == 0)
                     {
                         //Avoid collisions.
                         const coordf_t max_move_between_samples = max_move_distance + radius_sample_resolution + EPSILON; //100 micron extra for rounding errors.
-                        move_out_expolys(avoid_layer, next_position, radius_sample_resolution + EPSILON, max_move_between_samples);
+                        move_out_expolys(*avoid_layer, next_position, radius_sample_resolution + EPSILON, max_move_between_samples);
                     }
 
                     Node* neighbour = nodes_per_part[group_index][neighbours[0]];
@@ -2841,13 +2883,13 @@ void TreeSupport::drop_nodes(std::vector<std::vector<Node*>>& contact_nodes)
                         node_ = p_node->parent ? p_node : neighbour;
                     // Make sure the next pass doesn't drop down either of these (since that already happened).
                     node_->merged_neighbours.push_front(node_ == p_node ? neighbour : p_node);
-                    const bool to_buildplate = !is_inside_ex(m_ts_data->get_avoidance(0, layer_nr_next), next_position);
+                    const bool to_buildplate = !is_inside_ex(*m_ts_data->get_avoidance(0, layer_nr_next), next_position);
                     Node *     next_node     = new Node(next_position, node_->distance_to_top + 1, layer_nr_next, node_->support_roof_layers_below-1, to_buildplate, node_,
                                                print_z_next, height_next);
                     next_node->movement = next_position - node.position;
                     get_max_move_dist(next_node);
                     next_node->is_merged     = true;
-                    contact_nodes[layer_nr_next].push_back(next_node);
+                    result.next_nodes.emplace_back(next_node);
 
 
                     to_delete.insert(neighbour);
@@ -2891,21 +2933,21 @@ void TreeSupport::drop_nodes(std::vector<std::vector<Node*>>& contact_nodes)
                                                p_node, print_z_next, height_next);
                     next_node->max_move_dist = 0;
                     next_node->is_merged     = false;
-                    contact_nodes[layer_nr_next].emplace_back(next_node);
+                    result.next_nodes.emplace_back(next_node);
                     continue;
                 }
 
                 //If the branch falls completely inside a collision area (the entire branch would be removed by the X/Y offset), delete it.
-                if (group_index > 0 && is_inside_ex(m_ts_data->get_collision(m_ts_data->m_xy_distance, layer_nr), node.position))
+                if (group_index > 0 && is_inside_ex(*m_ts_data->get_collision(m_ts_data->m_xy_distance, layer_nr), node.position))
                 {
                     const coordf_t branch_radius_node = calc_branch_radius(branch_radius, node.dist_mm_to_top, diameter_angle_scale_factor);
-                    Point to_outside = projection_onto(m_ts_data->get_collision(m_ts_data->m_xy_distance, layer_nr), node.position);
+                    Point to_outside = projection_onto(*m_ts_data->get_collision(m_ts_data->m_xy_distance, layer_nr), node.position);
                     double dist2_to_outside = vsize2_with_unscale(node.position - to_outside);
                     if (dist2_to_outside >= branch_radius_node * branch_radius_node) //Too far inside.
                     {
                         if (support_on_buildplate_only)
                         {
-                            unsupported_branch_leaves.push_front({ layer_nr, p_node });
+                            result.unsupported_branch_leaves.emplace_back(layer_nr, p_node);
                         }
                         else {
                             Node* pn = p_node;
@@ -2978,7 +3020,8 @@ void TreeSupport::drop_nodes(std::vector<std::vector<Node*>>& contact_nodes)
                     branch_radius_temp = branch_radius_node;
                 }
 #endif
-                auto avoid_layer = m_ts_data->get_avoidance(branch_radius_node, layer_nr_next);
+                std::shared_ptr<const ExPolygons> avoid_layer_ptr = m_ts_data->get_avoidance(branch_radius_node, layer_nr_next);
+                const ExPolygons &avoid_layer = *avoid_layer_ptr;
 
                 Point  to_outside         = projection_onto(avoid_layer, node.position);
                 Point  direction_to_outer = to_outside - node.position;
@@ -3036,14 +3079,20 @@ void TreeSupport::drop_nodes(std::vector<std::vector<Node*>>& contact_nodes)
                 next_node->movement  = movement;
                 get_max_move_dist(next_node);
                 next_node->is_merged     = false;
-                contact_nodes[layer_nr_next].push_back(next_node);
+                result.next_nodes.emplace_back(next_node);
             }
         }
+        });
+        for (GroupResult &result : group_results) {
+            append(contact_nodes[layer_nr_next], std::move(result.next_nodes));
+            for (const std::pair<size_t, Node*> &leaf : result.unsupported_branch_leaves)
+                unsupported_branch_leaves.push_front(leaf);
+        }
 
 #ifdef SUPPORT_TREE_DEBUG_TO_SVG
         if (contact_nodes[layer_nr].empty() == false) {
-            draw_contours_and_nodes_to_svg((boost::format("%.2f") % contact_nodes[layer_nr][0]->print_z).str(), m_ts_data->get_avoidance(0, layer_nr),
-                                           m_ts_data->get_avoidance(branch_radius_temp, layer_nr),
+            draw_contours_and_nodes_to_svg((boost::format("%.2f") % contact_nodes[layer_nr][0]->print_z).str(), *m_ts_data->get_avoidance(0, layer_nr),
+                                           *m_ts_data->get_avoidance(branch_radius_temp, layer_nr),
                                            m_ts_data->m_layer_outlines_below[layer_nr],
             contact_nodes[layer_nr], contact_nodes[layer_nr_next], "contact_points", { "overhang","avoid","outline" }, { "blue","red","yellow" });
 
@@ -3084,6 +3133,9 @@ void TreeSupport::drop_nodes(std::vector<std::vector<Node*>>& contact_nodes)
     }
     
     BOOST_LOG_TRIVIAL(debug) << "after m_avoidance_cache.size()=" << m_ts_data->m_avoidance_cache.size();
+    for (const auto &[name, stats] : { std::make_pair("collision", m_ts_data->collision_cache_stats()), std::make_pair("avoidance", m_ts_data->avoidance_cache_stats()) })
+        BOOST_LOG_TRIVIAL(info) << "tree support " << name << " cache: hits " << stats.hits << ", misses " << stats.misses << ", evictions " << stats.evictions
+                                << ", entries " << stats.entries << ", " << (stats.bytes >> 20) << " MB";
 
     for (Node *node : to_free_node_set)
     {
@@ -3605,26 +3657,28 @@ TreeSupportData::TreeSupportData(const PrintObject &object, coordf_t xy_distance
     }
 }
 
-const ExPolygons& TreeSupportData::get_collision(coordf_t radius, size_t layer_nr) const
+std::shared_ptr<const ExPolygons> TreeSupportData::get_collision(coordf_t radius, size_t layer_nr) const
 {
-    profiler.tic();
+    auto tic = profiler.tic();
     radius = ceil_radius(radius);
     RadiusLayerPair key{radius, layer_nr};
-    const auto it = m_collision_cache.find(key);
-    const ExPolygons& collision = it != m_collision_cache.end() ? it->second : calculate_collision(key);
-    profiler.stage_add(STAGE_get_collision, true);
+    std::shared_ptr<const ExPolygons> collision = m_collision_cache.find(key);
+    if (! collision)
+        collision = calculate_collision(key);
+    profiler.stage_add(STAGE_get_collision, tic);
     return collision;
 }
 
-const ExPolygons& TreeSupportData::get_avoidance(coordf_t radius, size_t layer_nr, int recursions) const
+std::shared_ptr<const ExPolygons> TreeSupportData::get_avoidance(coordf_t radius, size_t layer_nr) const
 {
-    profiler.tic();
+    auto tic = profiler.tic();
     radius = ceil_radius(radius);
-    RadiusLayerPair key{radius, layer_nr, recursions };
-    const auto it = m_avoidance_cache.find(key);
-    const ExPolygons& avoidance = it != m_avoidance_cache.end() ? it->second : calculate_avoidance(key);
+    RadiusLayerPair key{radius, layer_nr};
+    std::shared_ptr<const ExPolygons> avoidance = m_avoidance_cache.find(key);
+    if (! avoidance)
+        avoidance = calculate_avoidance(key);
 
-    profiler.stage_add(STAGE_GET_AVOIDANCE, true);
+    profiler.stage_add(STAGE_GET_AVOIDANCE, tic);
     return avoidance;
 }
 
@@ -3665,55 +3719,145 @@ coordf_t TreeSupportData::ceil_radius(coordf_t radius) const
 #endif
 }
 
-const ExPolygons& TreeSupportData::calculate_collision(const RadiusLayerPair& key) const
+std::shared_ptr<const ExPolygons> TreeSupportData::calculate_collision(const RadiusLayerPair& key) const
 {
     assert(key.layer_nr < m_layer_outlines.size());
 
     ExPolygons collision_areas = offset_ex(m_layer_outlines[key.layer_nr], scale_(key.radius));
-    const auto ret = m_collision_cache.insert({ key, std::move(collision_areas) });
-    return ret.first->second;
+    return m_collision_cache.insert(key, std::move(collision_areas));
 }
 
-const ExPolygons& TreeSupportData::calculate_avoidance(const RadiusLayerPair& key) const
+std::shared_ptr<const ExPolygons> TreeSupportData::calculate_avoidance(const RadiusLayerPair& key) const
 {
     const auto& radius = key.radius;
-    const auto& layer_nr = key.layer_nr;
-    BOOST_LOG_TRIVIAL(debug) << "calculate_avoidance on radius=" << radius << ", layer=" << layer_nr<<", recursion="<<key.recursions;
-    constexpr auto max_recursion_depth = 100;
-    if (key.recursions <= max_recursion_depth*2) {
-        if (layer_nr == 0) {
-            m_avoidance_cache[key] = get_collision(radius, 0);
-            return m_avoidance_cache[key];
-        }
-
-        // Avoidance for a given layer depends on all layers beneath it so could have very deep recursion depths if
-        // called at high layer heights. We can limit the reqursion depth to N by checking if the layer N
-        // below the current one exists and if not, forcing the calculation of that layer. This may cause another recursion
-        // if the layer at 2N below the current one but we won't exceed our limit unless there are N*N uncalculated layers
-        // below our current one.
-        size_t         layer_nr_next       = layer_nr;
-        int            layers_below;
-        for (layers_below = 0; layers_below < max_recursion_depth && layer_nr_next > 0; layers_below++) { layer_nr_next = layer_heights[layer_nr_next].next_layer_nr; }
-        // Check if we would exceed the recursion limit by trying to process this layer
-        if (layers_below >= max_recursion_depth && m_avoidance_cache.find({radius, layer_nr_next}) == m_avoidance_cache.end()) {
-            // Force the calculation of the layer `max_recursion_depth` below our current one, ignoring the result.
-            get_avoidance(radius, layer_nr_next, key.recursions + 1);
-        }
-
-        layer_nr_next   = layer_heights[layer_nr].next_layer_nr;
-        ExPolygons        avoidance_areas = offset_ex(get_avoidance(radius, layer_nr_next, key.recursions+1), scale_(-m_max_move));
-        const ExPolygons &collision       = get_collision(radius, layer_nr);
-        avoidance_areas.insert(avoidance_areas.end(), collision.begin(), collision.end());
-        avoidance_areas = std::move(union_ex(avoidance_areas));
-        auto ret = m_avoidance_cache.insert({ key, std::move(avoidance_areas) });
-        //assert(ret.second);
-        return ret.first->second;
-    } else {
-        ExPolygons avoidance_areas = offset_ex(m_layer_outlines_below[layer_nr], scale_(m_xy_distance + radius));
-        auto ret = m_avoidance_cache.insert({ key, std::move(avoidance_areas) });
-        assert(ret.second);
-        return ret.first->second;
+    BOOST_LOG_TRIVIAL(debug) << "calculate_avoidance on radius=" << radius << ", layer=" << key.layer_nr;
+    // Avoidance for a given layer depends on all layers beneath it. Instead of recursing, walk down to the first layer
+    // still cached and calculate the layers above it bottom up. Thus a miss is always calculated the same way,
+    // no matter whether the layers below were never calculated or were evicted from the cache.
+    std::vector<size_t>               layers_to_calculate { key.layer_nr };
+    std::shared_ptr<const ExPolygons> avoidance_below;
+    while (layers_to_calculate.back() > 0) {
+        const size_t layer_nr_next = layer_heights[layers_to_calculate.back()].next_layer_nr;
+        if (avoidance_below = m_avoidance_cache.find({ radius, layer_nr_next }); avoidance_below)
+            break;
+        layers_to_calculate.emplace_back(layer_nr_next);
     }
+
+    std::shared_ptr<const ExPolygons> avoidance;
+    for (auto it = layers_to_calculate.rbegin(); it != layers_to_calculate.rend(); ++ it) {
+        const size_t layer_nr = *it;
+        std::shared_ptr<const ExPolygons> collision = get_collision(radius, layer_nr);
+        if (avoidance_below) {
+            ExPolygons avoidance_areas = offset_ex(*avoidance_below, scale_(-m_max_move));
+            avoidance_areas.insert(avoidance_areas.end(), collision->begin(), collision->end());
+            avoidance = m_avoidance_cache.insert({ radius, layer_nr }, union_ex(avoidance_areas));
+        } else {
+            assert(layer_nr == 0);
+            avoidance = m_avoidance_cache.insert({ radius, layer_nr }, ExPolygons(*collision));
+        }
+        // Held here, thus the layer below does not need to stay cached.
+        avoidance_below = avoidance;
+    }
+    return avoidance;
+}
+
+size_t TreeSupportData::cache_size_limit = 0;
+
+// Estimate of the heap memory held by the polygons.
+static size_t expolygons_memory_size(const ExPolygons &expolys)
+{
+    size_t bytes = sizeof(ExPolygons) + expolys.capacity() * sizeof(ExPolygon);
+    for (const ExPolygon &expoly : expolys) {
+        bytes += expoly.contour.points.capacity() * sizeof(Point) + expoly.holes.capacity() * sizeof(Polygon);
+        for (const Polygon &hole : expoly.holes)
+            bytes += hole.points.capacity() * sizeof(Point);
+    }
+    return bytes;
+}
+
+TreeSupportData::RadiusLayerCache::RadiusLayerCache(size_t size_limit) :
+    m_shard_size_limit(size_limit == 0 ? std::numeric_limits<size_t>::max() : std::max<size_t>(1, size_limit / NUM_SHARDS)),
+    m_shards(new Shard[NUM_SHARDS])
+{}
+
+std::shared_ptr<const ExPolygons> TreeSupportData::RadiusLayerCache::find(const RadiusLayerPair &key) const
+{
+    Shard &shard = this->shard(key);
+    std::scoped_lock<std::mutex> lock(shard.mutex);
+    if (auto it = shard.index.find(key); it != shard.index.end()) {
+        Entry &entry = shard.entries[it->second];
+        entry.referenced = true;
+        ++ shard.stats.hits;
+        return entry.value;
+    }
+    ++ shard.stats.misses;
+    return nullptr;
+}
+
+bool TreeSupportData::RadiusLayerCache::contains(const RadiusLayerPair &key) const
+{
+    Shard &shard = this->shard(key);
+    std::scoped_lock<std::mutex> lock(shard.mutex);
+    return shard.index.find(key) != shard.index.end();
+}
+
+std::shared_ptr<const ExPolygons> TreeSupportData::RadiusLayerCache::insert(const RadiusLayerPair &key, ExPolygons &&value)
+{
+    size_t bytes = expolygons_memory_size(value);
+    auto   ptr   = std::make_shared<const ExPolygons>(std::move(value));
+    Shard &shard = this->shard(key);
+    std::scoped_lock<std::mutex> lock(shard.mutex);
+    if (auto it = shard.index.find(key); it != shard.index.end()) {
+        // Calculated by another thread in the meantime.
+        Entry &entry = shard.entries[it->second];
+        entry.referenced = true;
+        return entry.value;
+    }
+    shard.index.emplace(key, shard.entries.size());
+    shard.entries.push_back({ key, ptr, bytes, true });
+    shard.bytes += bytes;
+    this->evict(shard);
+    return ptr;
+}
+
+void TreeSupportData::RadiusLayerCache::evict(Shard &shard) const
+{
+    // Keep at least the entry just inserted, it is referenced by the caller anyway.
+    while (shard.bytes > m_shard_size_limit && shard.entries.size() > 1) {
+        if (shard.clock_hand >= shard.entries.size())
+            shard.clock_hand = 0;
+        Entry &entry = shard.entries[shard.clock_hand];
+        if (entry.referenced) {
+            // Second chance.
+            entry.referenced = false;
+            ++ shard.clock_hand;
+        } else {
+            // Replace the evicted entry with the last one to keep the entries compact.
+            shard.bytes -= entry.bytes;
+            shard.index.erase(entry.key);
+            if (shard.clock_hand + 1 < shard.entries.size()) {
+                entry = std::move(shard.entries.back());
+                shard.index[entry.key] = shard.clock_hand;
+            }
+            shard.entries.pop_back();
+            ++ shard.stats.evictions;
+        }
+    }
+}
+
+TreeSupportData::CacheStats TreeSupportData::RadiusLayerCache::stats() const
+{
+    CacheStats out;
+    for (size_t i = 0; i < NUM_SHARDS; ++ i) {
+        Shard &shard = m_shards[i];
+        std::scoped_lock<std::mutex> lock(shard.mutex);
+        out.hits      += shard.stats.hits;
+        out.misses    += shard.stats.misses;
+        out.evictions += shard.stats.evictions;
+        out.entries   += shard.entries.size();
+        out.bytes     += shard.bytes;
+    }
+    return out;
 }
 
 } //namespace Slic3r
@@ -2,6 +2,9 @@
 #define TREESUPPORT_H
 
 #include <forward_list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
 #include <unordered_set>
 #include "ExPolygon.hpp"
 #include "Point.hpp"
@@ -75,9 +78,9 @@ public:
      *
      * \param radius The radius of the node of interest
      * \param layer The layer of interest
-     * \return Polygons object
+     * \return Polygons object, kept alive by the returned pointer even if evicted from the cache meanwhile
      */
-    const ExPolygons& get_collision(coordf_t radius, size_t layer_idx) const;
+    std::shared_ptr<const ExPolygons> get_collision(coordf_t radius, size_t layer_idx) const;
 
     /*!
      * \brief Creates the areas that have to be avoided by the tree's branches
@@ -91,9 +94,24 @@ public:
      *
      * \param radius The radius of the node of interest
      * \param layer The layer of interest
-     * \return Polygons object
+     * \return Polygons object, kept alive by the returned pointer even if evicted from the cache meanwhile
      */
-    const ExPolygons& get_avoidance(coordf_t radius, size_t layer_idx, int recursions=0) const;
+    std::shared_ptr<const ExPolygons> get_avoidance(coordf_t radius, size_t layer_idx) const;
+
+    struct CacheStats {
+        size_t hits      = 0;
+        size_t misses    = 0;
+        size_t evictions = 0;
+        size_t entries   = 0;
+        // Estimated memory held by the cached polygons.
+        size_t bytes     = 0;
+    };
+    CacheStats collision_cache_stats() const { return m_collision_cache.stats(); }
+    CacheStats avoidance_cache_stats() const { return m_avoidance_cache.stats(); }
+
+    // Memory budget of each of the collision and avoidance caches of a TreeSupportData, in bytes. 0 means unlimited.
+    // Configured once per process by the command line interface.
+    static size_t cache_size_limit;
 
     Polygons get_contours(size_t layer_nr) const;
     Polygons get_contours_with_holes(size_t layer_nr) const;
@@ -109,8 +127,6 @@ private:
     struct RadiusLayerPair {
         coordf_t radius;
         size_t layer_nr;
-        int recursions;
-        
     };
     struct RadiusLayerPairEquality {
         constexpr bool operator()(const RadiusLayerPair& _Left, const RadiusLayerPair& _Right) const {
@@ -123,6 +139,53 @@ private:
         }
     };
 
+    /*!
+     * \brief Thread safe cache of the areas at given radius and layer indices with a memory budget.
+     *
+     * The entries are distributed over shards, each guarded by its own mutex. Once the memory held by a shard
+     * exceeds its part of the budget, the entries are evicted by the clock (second chance) algorithm.
+     * An evicted entry is recalculated on the next request, see calculate_avoidance() for why the result does not depend on the evictions.
+     */
+    class RadiusLayerCache {
+    public:
+        explicit RadiusLayerCache(size_t size_limit = 0);
+
+        // Returns nullptr if not cached, counts a hit or a miss.
+        std::shared_ptr<const ExPolygons> find(const RadiusLayerPair &key) const;
+        // Does not count into the statistics.
+        bool                              contains(const RadiusLayerPair &key) const;
+        // Stores the value unless another thread stored it in the meantime, returns the cached value.
+        std::shared_ptr<const ExPolygons> insert(const RadiusLayerPair &key, ExPolygons &&value);
+        size_t                            size() const { return this->stats().entries; }
+        CacheStats                        stats() const;
+
+    private:
+        static constexpr const size_t NUM_SHARDS = 16;
+
+        struct Entry {
+            RadiusLayerPair                   key;
+            std::shared_ptr<const ExPolygons> value;
+            size_t                            bytes;
+            // Set on access, cleared by the clock hand passing by.
+            bool                              referenced;
+        };
+        struct Shard {
+            std::mutex                                                                   mutex;
+            std::vector<Entry>                                                           entries;
+            // Index into entries.
+            std::unordered_map<RadiusLayerPair, size_t, RadiusLayerPairHash, RadiusLayerPairEquality> index;
+            size_t                                                                       clock_hand { 0 };
+            size_t                                                                       bytes { 0 };
+            CacheStats                                                                   stats;
+        };
+
+        Shard& shard(const RadiusLayerPair &key) const { return m_shards[RadiusLayerPairHash()(key) % NUM_SHARDS]; }
+        void   evict(Shard &shard) const;
+
+        size_t                   m_shard_size_limit;
+        std::unique_ptr<Shard[]> m_shards;
+    };
+
     /*!
      * \brief Round \p radius upwards to a multiple of m_radius_sample_resolution
      *
@@ -136,7 +199,7 @@ private:
      *
      * \param key The radius and layer of the node of interest
      */
-    const ExPolygons& calculate_collision(const RadiusLayerPair& key) const;
+    std::shared_ptr<const ExPolygons> calculate_collision(const RadiusLayerPair& key) const;
 
     /*!
      * \brief Calculate the avoidance areas at the radius and layer indicated
@@ -144,7 +207,7 @@ private:
      *
      * \param key The radius and layer of the node of interest
      */
-    const ExPolygons& calculate_avoidance(const RadiusLayerPair& key) const;
+    std::shared_ptr<const ExPolygons> calculate_avoidance(const RadiusLayerPair& key) const;
 
 
 public:
@@ -188,9 +251,10 @@ public:
      * 
      * coconut: previously stl::unordered_map is used which seems problematic with tbb::parallel_for.
      * So we change to tbb::concurrent_unordered_map
+     * The caches are now bounded by cache_size_limit, see RadiusLayerCache.
      */
-    mutable tbb::concurrent_unordered_map<RadiusLayerPair, ExPolygons, RadiusLayerPairHash, RadiusLayerPairEquality> m_collision_cache;
-    mutable tbb::concurrent_unordered_map<RadiusLayerPair, ExPolygons, RadiusLayerPairHash, RadiusLayerPairEquality> m_avoidance_cache;
+    mutable RadiusLayerCache m_collision_cache { cache_size_limit };
+    mutable RadiusLayerCache m_avoidance_cache { cache_size_limit };
 
     friend TreeSupport;
 };
@@ -399,7 +463,7 @@ public:
     SupportType support_type;
     SupportMaterialStyle support_style;
 
-    std::unique_ptr<FillLightning::Generator> generator;
+    std::shared_ptr<FillLightning::Generator> generator;
     std::unordered_map<double, size_t> printZ_to_lightninglayer;
 
     std::function<void()> throw_on_cancel;
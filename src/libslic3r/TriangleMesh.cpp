@@ -16,6 +16,7 @@
 #include <libqhullcpp/QhullVertexSet.h>
 
 #include <cmath>
+#include <cstring>
 #include <deque>
 #include <queue>
 #include <vector>
@@ -23,6 +24,7 @@
 #include <algorithm>
 #include <type_traits>
 
+#include <boost/functional/hash.hpp>
 #include <boost/log/trivial.hpp>
 #include <boost/nowide/cstdio.hpp>
 #include <boost/predef/other/endian.h>
@@ -180,6 +182,7 @@ static void trianglemesh_repair_on_import(stl_file &stl)
 
 bool TriangleMesh::from_stl(stl_file& stl, bool repair)
 {
+    m_content_hash = 0;
     if (repair)
         trianglemesh_repair_on_import(stl);
 
@@ -246,6 +249,7 @@ void TriangleMesh::scale(float factor)
 
 void TriangleMesh::scale(const Vec3f &versor)
 {
+    m_content_hash = 0;
     // Scale extents.
     auto s = versor.array();
     m_stats.min.array() *= s;
@@ -270,6 +274,7 @@ void TriangleMesh::scale(const Vec3f &versor)
 
 void TriangleMesh::translate(const Vec3f &displacement)
 {
+    m_content_hash = 0;
     if (displacement.x() != 0.f || displacement.y() != 0.f || displacement.z() != 0.f) {
         for (stl_vertex& v : this->its.vertices)
             v += displacement;
@@ -285,6 +290,7 @@ void TriangleMesh::translate(float x, float y, float z)
 
 void TriangleMesh::rotate(float angle, const Axis &axis)
 {
+    m_content_hash = 0;
     if (angle != 0.f) {
         angle = Slic3r::Geometry::rad2deg(angle);
         switch (axis) {
@@ -299,6 +305,7 @@ void TriangleMesh::rotate(float angle, const Axis &axis)
 
 void TriangleMesh::rotate(float angle, const Vec3d& axis)
 {
+    m_content_hash = 0;
     if (angle != 0.f) {
         Vec3d axis_norm = axis.normalized();
         Transform3d m = Transform3d::Identity();
@@ -310,6 +317,7 @@ void TriangleMesh::rotate(float angle, const Vec3d& axis)
 
 void TriangleMesh::mirror(const Axis axis)
 {
+    m_content_hash = 0;
     switch (axis) {
     case X:
         for (stl_vertex &v : its.vertices)
@@ -336,6 +344,7 @@ void TriangleMesh::mirror(const Axis axis)
 
 void TriangleMesh::transform(const Transform3d& t, bool fix_left_handed)
 {
+    m_content_hash = 0;
     its_transform(its, t);
     double det = t.matrix().block(0, 0, 3, 3).determinant();
     if (fix_left_handed && det < 0.) {
@@ -348,6 +357,7 @@ void TriangleMesh::transform(const Transform3d& t, bool fix_left_handed)
 
 void TriangleMesh::transform(const Matrix3d& m, bool fix_left_handed)
 {
+    m_content_hash = 0;
     its_transform(its, m);
     double det = m.block(0, 0, 3, 3).determinant();
     if (fix_left_handed && det < 0.) {
@@ -360,6 +370,7 @@ void TriangleMesh::transform(const Matrix3d& m, bool fix_left_handed)
 
 void TriangleMesh::flip_triangles()
 {
+    m_content_hash = 0;
     its_flip_triangles(its);
     m_stats.volume = - m_stats.volume;
 }
@@ -405,10 +416,40 @@ std::vector<TriangleMesh> TriangleMesh::split() const
 
 void TriangleMesh::merge(const TriangleMesh &mesh)
 {
+    m_content_hash = 0;
     its_merge(this->its, mesh.its);
     m_stats = m_stats.merge(mesh.m_stats);
 }
 
+size_t TriangleMesh::content_hash() const
+{
+    size_t hash = m_content_hash.load();
+    if (hash == 0) {
+        static_assert(sizeof(stl_vertex) == 3 * sizeof(uint32_t) && sizeof(stl_triangle_vertex_indices) == 3 * sizeof(uint32_t), "Unexpected padding");
+        // Hash the bit patterns, the same floats produce the same hash.
+        auto   vertices = reinterpret_cast<const uint32_t*>(this->its.vertices.data());
+        auto   indices  = reinterpret_cast<const uint32_t*>(this->its.indices.data());
+        size_t seed     = 0;
+        boost::hash_combine(seed, this->its.vertices.size());
+        boost::hash_combine(seed, this->its.indices.size());
+        boost::hash_range(seed, vertices, vertices + 3 * this->its.vertices.size());
+        boost::hash_range(seed, indices, indices + 3 * this->its.indices.size());
+        // Zero is reserved for "not calculated".
+        hash = std::max<size_t>(seed, 1);
+        m_content_hash.store(hash);
+    }
+    return hash;
+}
+
+bool TriangleMesh::content_equal(const TriangleMesh &rhs) const
+{
+    return this == &rhs ||
+        (this->its.vertices.size() == rhs.its.vertices.size() && this->its.indices.size() == rhs.its.indices.size() &&
+         this->content_hash() == rhs.content_hash() &&
+         std::memcmp(this->its.vertices.data(), rhs.its.vertices.data(), this->its.vertices.size() * sizeof(stl_vertex)) == 0 &&
+         std::memcmp(this->its.indices.data(), rhs.its.indices.data(), this->its.indices.size() * sizeof(stl_triangle_vertex_indices)) == 0);
+}
+
 // Calculate projection of the mesh into the XY plane, in scaled coordinates.
 //FIXME This could be extremely slow! Use it for tiny meshes only!
 ExPolygons TriangleMesh::horizontal_projection() const
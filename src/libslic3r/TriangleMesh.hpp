@@ -3,6 +3,7 @@
 
 #include "libslic3r.h"
 #include <admesh/stl.h>
+#include <atomic>
 #include <functional>
 #include <vector>
 #include "BoundingBox.hpp"
@@ -92,7 +93,7 @@ public:
     TriangleMesh(std::vector<Vec3f> &&vertices, const std::vector<Vec3i32> &&faces);
     explicit TriangleMesh(const indexed_triangle_set &M);
     explicit TriangleMesh(indexed_triangle_set &&M, const RepairedMeshErrors& repaired_errors = RepairedMeshErrors());
-    void clear() { this->its.clear(); this->m_stats.clear(); }
+    void clear() { this->its.clear(); this->m_stats.clear(); m_content_hash = 0; }
     bool from_stl(stl_file& stl, bool repair = true);
     bool  ReadSTLFile(const char *input_file, bool repair = true, ImportstlProgressFn stlFn = nullptr, int custom_header_length = 80);
     bool write_ascii(const char* output_file);
@@ -152,6 +153,12 @@ public:
 
     const TriangleMeshStats& stats() const { return m_stats; }
 
+    // Hash of the vertices and indices, calculated on the first call and cached until the mesh is modified by one of its methods.
+    // Not thread safe for the first call. Modifying this->its directly does not invalidate the cached value.
+    size_t content_hash() const;
+    // Exact comparison of the vertices and indices, rejecting most of the different meshes by content_hash().
+    bool   content_equal(const TriangleMesh &rhs) const;
+
     void set_init_shift(const Vec3d &offset) { m_init_shift = offset; }
     Vec3d get_init_shift() const { return m_init_shift; }
 
@@ -160,6 +167,21 @@ public:
 private:
     TriangleMeshStats m_stats;
     Vec3d m_init_shift {0.0, 0.0, 0.0};
+    // Cached content_hash(), zero if not calculated yet.
+    // Atomic, as content_hash() may be called by multiple threads on a shared mesh. Relaxed ordering is sufficient,
+    // racing threads calculate the same value from a mesh, which is not modified while it is shared.
+    struct ContentHash {
+        ContentHash() = default;
+        ContentHash(const ContentHash &rhs) : value(rhs.load()) {}
+        ContentHash(ContentHash &&rhs) : value(rhs.value.exchange(0, std::memory_order_relaxed)) {}
+        ContentHash& operator=(const ContentHash &rhs) { this->store(rhs.load()); return *this; }
+        ContentHash& operator=(ContentHash &&rhs) { this->store(rhs.value.exchange(0, std::memory_order_relaxed)); return *this; }
+        ContentHash& operator=(size_t hash) { this->store(hash); return *this; }
+        size_t load() const { return value.load(std::memory_order_relaxed); }
+        void   store(size_t hash) { value.store(hash, std::memory_order_relaxed); }
+        std::atomic<size_t> value { 0 };
+    };
+    mutable ContentHash m_content_hash;
 };
 
 // Index of face indices incident with a vertex index.
@@ -0,0 +1,309 @@
+#include <catch2/catch.hpp>
+
+#include <cfloat>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <random>
+
+#include <boost/filesystem.hpp>
+#include <boost/nowide/cstdio.hpp>
+#include <boost/nowide/fstream.hpp>
+
+#include "libslic3r/GCode/GCodeProcessor.hpp"
+#include "libslic3r/Print.hpp"
+
+using namespace Slic3r;
+
+// Synthetic G-code with enough moves to trigger several planner windows, mixing feedrates, retractions, dwells and layer changes.
+static std::string generate_gcode(size_t num_layers, size_t moves_per_layer)
+{
+    std::mt19937 rng(7);
+    std::string  gcode = "G21\nG90\nM83\n";
+    const std::string layer_change = ";" + GCodeProcessor::reserved_tag(GCodeProcessor::ETags::Layer_Change) + "\n";
+    char         line[128];
+    for (size_t layer = 0; layer < num_layers; ++ layer) {
+        gcode += layer_change;
+        snprintf(line, sizeof(line), "G1 Z%.2f F600\n", 0.2 * double(layer + 1));
+        gcode += line;
+        for (size_t i = 0; i < moves_per_layer; ++ i) {
+            if (i % 50 == 49) {
+                gcode += "G1 E-0.8 F2400\nG0 X100 Y100 F12000\nG1 E0.8 F2400\n";
+            } else if (i % 333 == 332) {
+                gcode += "G4 P150\n";
+            } else {
+                snprintf(line, sizeof(line), "G1 X%.3f Y%.3f E%.5f F%d\n",
+                    double(rng() % 20000) * 0.01, double(rng() % 20000) * 0.01, double(rng() % 1000) * 0.0001, 600 + int(rng() % 12) * 600);
+                gcode += line;
+            }
+        }
+    }
+    return gcode;
+}
+
+struct TimeEstimate
+{
+    float                                    time;
+    std::vector<float>                       layers_time;
+    std::vector<std::pair<EMoveType, float>> moves_time;
+};
+
+static std::vector<TimeEstimate> estimate_time(const std::string &gcode, bool parallel)
+{
+    PrintConfig    config;
+    GCodeProcessor processor;
+    processor.enable_parallel_time_estimation(parallel);
+    processor.apply_config(config);
+    processor.enable_stealth_time_estimator(true);
+    processor.initialize("test.gcode");
+    processor.process_buffer(gcode);
+    processor.finalize(false);
+    std::vector<TimeEstimate> out;
+    for (PrintEstimatedStatistics::ETimeMode mode : { PrintEstimatedStatistics::ETimeMode::Normal, PrintEstimatedStatistics::ETimeMode::Stealth })
+        out.push_back({ processor.get_time(mode), processor.get_layers_time(mode), processor.get_moves_time(mode) });
+    return out;
+}
+
+SCENARIO("Time estimate planned in background tasks", "[GCodeProcessor]") {
+    GIVEN("A G-code spanning many planner windows") {
+        const std::string gcode = generate_gcode(20, 2000);
+        std::vector<TimeEstimate> serial   = estimate_time(gcode, false);
+        std::vector<TimeEstimate> parallel = estimate_time(gcode, true);
+        THEN("The estimate is the same as when planning on the calling thread") {
+            REQUIRE(serial.size() == parallel.size());
+            for (size_t i = 0; i < serial.size(); ++ i) {
+                REQUIRE(serial[i].time > 0.f);
+                REQUIRE(serial[i].time == parallel[i].time);
+                REQUIRE(serial[i].layers_time == parallel[i].layers_time);
+                REQUIRE(serial[i].moves_time.size() == parallel[i].moves_time.size());
+                for (size_t j = 0; j < serial[i].moves_time.size(); ++ j) {
+                    REQUIRE(serial[i].moves_time[j].first == parallel[i].moves_time[j].first);
+                    REQUIRE(serial[i].moves_time[j].second == parallel[i].moves_time[j].second);
+                }
+            }
+        }
+        THEN("The layer times are reported for each layer") {
+            REQUIRE(serial.front().layers_time.size() == 20);
+        }
+    }
+}
+
+SCENARIO("Post-processing patches the reserved slots in place", "[GCodeProcessor]") {
+    GIVEN("An exported G-code with the placeholders and the used filament statistics in reserved slots") {
+        PrintConfig config;
+        config.disable_m73.value = true;
+        GCodeProcessor processor;
+        processor.apply_config(config);
+        processor.enable_stealth_time_estimator(true);
+        REQUIRE(processor.can_post_process_in_place());
+        const std::string gcode =
+            processor.reserve_post_process_slot(";" + GCodeProcessor::reserved_tag(GCodeProcessor::ETags::Estimated_Printing_Time_Placeholder)) +
+            processor.reserve_post_process_slot(";" + GCodeProcessor::reserved_tag(GCodeProcessor::ETags::Total_Layer_Number_Placeholder)) +
+            generate_gcode(5, 500) +
+            processor.reserve_post_process_slot(PrintStatistics::FilamentUsedMmMask + " 0.00") +
+            processor.reserve_post_process_slot(PrintStatistics::FilamentUsedCm3Mask + " 0.00");
+        const std::string path = boost::filesystem::unique_path().string();
+        {
+            FILE *f = boost::nowide::fopen(path.c_str(), "wb");
+            REQUIRE(f != nullptr);
+            fwrite(gcode.data(), 1, gcode.size(), f);
+            fclose(f);
+        }
+        processor.initialize(path);
+        // The G-code export passes the G-code to the processor in chunks.
+        for (size_t begin = 0, end; begin < gcode.size(); begin = end) {
+            end = gcode.find('\n', std::min(gcode.size() - 1, begin + 4096)) + 1;
+            processor.process_buffer(gcode.substr(begin, end - begin));
+        }
+        processor.finalize(true);
+        const GCodeProcessorResult &result = processor.get_result();
+
+        std::string patched;
+        {
+            boost::nowide::ifstream in(path, std::ios::binary);
+            patched.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+        }
+        boost::nowide::remove(path.c_str());
+        std::vector<std::string> lines;
+        std::vector<size_t>      lines_ends;
+        for (size_t begin = 0, end; begin < patched.size(); begin = end + 1) {
+            end = patched.find('\n', begin);
+            lines.emplace_back(patched.substr(begin, end - begin));
+            lines_ends.emplace_back(end + 1);
+        }
+
+        THEN("The slots are overwritten in place and the G-code between them is not moved") {
+            REQUIRE(patched.size() == gcode.size());
+            const size_t body_begin = 2 * GCodeProcessor::Post_Process_Slot_Width;
+            const size_t body_end   = gcode.find(PrintStatistics::FilamentUsedMmMask);
+            REQUIRE(patched.substr(body_begin, body_end - body_begin) == gcode.substr(body_begin, body_end - body_begin));
+        }
+        THEN("The placeholders are replaced by the estimated times of both modes and the number of layers") {
+            REQUIRE(boost::starts_with(lines[0], "; model printing time: "));
+            REQUIRE(boost::starts_with(lines[1], "; model printing time: "));
+            REQUIRE(boost::starts_with(lines[2], "; total layer number: 5"));
+        }
+        THEN("The used filament is recalculated") {
+            REQUIRE(boost::starts_with(lines[lines.size() - 2], PrintStatistics::FilamentUsedMmMask));
+            REQUIRE(lines[lines.size() - 2].find(" 0.00") == std::string::npos);
+        }
+        THEN("The line ends and the moves refer to the patched file") {
+            REQUIRE(result.lines_ends == lines_ends);
+            bool moves_valid = true;
+            for (const GCodeProcessorResult::MoveVertex &move : result.moves)
+                if (move.type == EMoveType::Extrude)
+                    moves_valid &= boost::starts_with(lines[move.gcode_id - 1], "G1 X");
+            REQUIRE(moves_valid);
+        }
+    }
+}
+
+TEST_CASE("Post-processing slots fit the replaced lines", "[GCodeProcessor]") {
+    const std::string tag = ";" + GCodeProcessor::reserved_tag(GCodeProcessor::ETags::Estimated_Printing_Time_Placeholder);
+    PrintConfig       config;
+    GCodeProcessor    processor;
+    processor.apply_config(config);
+    // Lines M73 are inserted by the post-processing, the G-code is rewritten and the lines are not padded.
+    REQUIRE(! processor.can_post_process_in_place());
+    REQUIRE(processor.reserve_post_process_slot(tag) == tag + "\n");
+
+    config.disable_m73.value = true;
+    processor.apply_config(config);
+    REQUIRE(processor.can_post_process_in_place());
+    const std::string slot = processor.reserve_post_process_slot(tag);
+    REQUIRE(slot.size() == GCodeProcessor::Post_Process_Slot_Width);
+    REQUIRE(boost::starts_with(slot, tag + " "));
+    REQUIRE(slot.back() == '\n');
+    const std::string long_line(300, 'x');
+    REQUIRE(processor.reserve_post_process_slot(long_line).size() == 2 * long_line.size());
+}
+
+static GCodeProcessorResult::MoveVertex random_move(std::mt19937 &rng, unsigned int gcode_id)
+{
+    GCodeProcessorResult::MoveVertex move;
+    move.gcode_id       = gcode_id;
+    move.type           = EMoveType(rng() % size_t(EMoveType::Count));
+    move.extrusion_role = ExtrusionRole(rng() % erCount);
+    move.extruder_id    = rng() % 4;
+    move.cp_color_id    = rng() % 4;
+    move.position       = Vec3f(float(rng() % 25600) * 0.01f, float(rng() % 25600) * 0.01f, float(gcode_id / 100) * 0.2f);
+    move.delta_extruder = float(rng() % 1000) * 0.0001f;
+    move.feedrate       = float(rng() % 300);
+    move.width          = 0.3f + float(rng() % 30) * 0.01f;
+    move.height         = 0.2f;
+    move.mm3_per_mm     = float(rng() % 100) * 0.001f;
+    // Fan speed and temperature change rarely.
+    move.fan_speed      = float(gcode_id / 37 % 3) * 50.f;
+    move.temperature    = gcode_id < 500 ? 215.f : 210.f;
+    move.time           = float(gcode_id);
+    move.layer_duration = float(gcode_id / 100);
+    if (rng() % 10 == 0) {
+        move.move_path_type      = EMovePathType::Arc_move_ccw;
+        move.arc_center_position = Vec3f(100.f, 100.f, move.position.z());
+        for (size_t i = rng() % 5; i > 0; -- i)
+            move.interpolation_points.emplace_back(Vec3f(float(i), 2.f * float(i), move.position.z()));
+    } else
+        move.move_path_type = EMovePathType::Linear_move;
+    return move;
+}
+
+static bool same_move(const GCodeProcessorResult::MoveVertex &lhs, const GCodeProcessorResult::MoveVertex &rhs)
+{
+    // Widths and heights are stored in half precision.
+    auto same_half = [](float l, float r) { return std::abs(l - r) <= std::abs(l) * 0.0005f; };
+    return lhs.gcode_id == rhs.gcode_id && lhs.type == rhs.type && lhs.extrusion_role == rhs.extrusion_role && lhs.extruder_id == rhs.extruder_id &&
+        lhs.cp_color_id == rhs.cp_color_id && lhs.position == rhs.position && lhs.delta_extruder == rhs.delta_extruder && lhs.feedrate == rhs.feedrate &&
+        same_half(lhs.width, rhs.width) && same_half(lhs.height, rhs.height) && lhs.mm3_per_mm == rhs.mm3_per_mm && lhs.fan_speed == rhs.fan_speed &&
+        lhs.temperature == rhs.temperature && lhs.time == rhs.time && lhs.layer_duration == rhs.layer_duration && lhs.move_path_type == rhs.move_path_type &&
+        (! rhs.is_arc_move() || (lhs.arc_center_position == rhs.arc_center_position && lhs.interpolation_points == rhs.interpolation_points));
+}
+
+SCENARIO("Moves are stored column by column", "[GCodeProcessor]") {
+    GIVEN("Random moves stored into the columns") {
+        std::mt19937 rng(11);
+        std::vector<GCodeProcessorResult::MoveVertex> expected;
+        GCodeProcessorResult::MoveVertices            moves;
+        for (unsigned int i = 0; i < 1000; ++ i) {
+            expected.emplace_back(random_move(rng, i));
+            moves.push_back(expected.back());
+        }
+        auto all_same = [&expected, &moves]() {
+            bool same = expected.size() == moves.size();
+            for (size_t i = 0; same && i < expected.size(); ++ i)
+                same = same_move(moves[i], expected[i]) && moves.position(i) == expected[i].position &&
+                    moves.interpolation_points(i).size() == (expected[i].is_arc_move() ? expected[i].interpolation_points.size() : 0);
+            return same;
+        };
+        THEN("The moves are decoded back") {
+            REQUIRE(all_same());
+            size_t cnt = 0;
+            for (const GCodeProcessorResult::MoveVertex &move : moves)
+                cnt += same_move(move, expected[cnt]);
+            REQUIRE(cnt == expected.size());
+        }
+        THEN("They use less memory than the moves") {
+            moves.shrink_to_fit();
+            REQUIRE(moves.memsize() < expected.size() * sizeof(GCodeProcessorResult::MoveVertex) * 6 / 10);
+        }
+        WHEN("Moves are replaced and erased") {
+            for (size_t i : { 0, 36, 37, 499, 500, 501, 998, 999 }) {
+                GCodeProcessorResult::MoveVertex move = random_move(rng, (unsigned int)i);
+                move.fan_speed   = 25.f;
+                move.temperature = float(i);
+                moves.set(i, move);
+                expected[i] = move;
+            }
+            for (size_t i : { 999, 500, 37, 36, 0, 0, 120, 500 }) {
+                moves.erase(i);
+                expected.erase(expected.begin() + i);
+            }
+            THEN("The remaining moves are decoded back") {
+                REQUIRE(all_same());
+            }
+        }
+        WHEN("The layer durations are transformed") {
+            moves.transform_layer_durations([](float layer_id) { return layer_id < 5.f ? 1.f : 2.f * layer_id; });
+            for (GCodeProcessorResult::MoveVertex &move : expected)
+                move.layer_duration = move.layer_duration < 5.f ? 1.f : 2.f * move.layer_duration;
+            THEN("The moves are decoded back") {
+                REQUIRE(all_same());
+            }
+        }
+    }
+}
+
+TEST_CASE("Half precision conversion", "[GCodeProcessor]") {
+    using MoveVertices = GCodeProcessorResult::MoveVertices;
+    for (float value : { 0.f, 1.f, -2.f, 0.5f, 1024.f, 65504.f, 6.103515625e-05f, 5.9604645e-08f })
+        REQUIRE(MoveVertices::half_to_float(MoveVertices::float_to_half(value)) == value);
+    REQUIRE(std::isinf(MoveVertices::half_to_float(MoveVertices::float_to_half(1e6f))));
+    REQUIRE(std::isnan(MoveVertices::half_to_float(MoveVertices::float_to_half(std::numeric_limits<float>::quiet_NaN()))));
+    for (float value = 0.01f; value < 10.f; value += 0.01f)
+        REQUIRE(MoveVertices::half_to_float(MoveVertices::float_to_half(value)) == Approx(value).epsilon(0.0005));
+}
+
+TEST_CASE("Memory used by the moves of a large G-code", "[GCodeProcessor][!hide]") {
+    const std::string gcode = generate_gcode(100, 50000);
+    PrintConfig    config;
+    GCodeProcessor processor;
+    processor.apply_config(config);
+    processor.initialize("test.gcode");
+    processor.process_buffer(gcode);
+    processor.finalize(false);
+    const GCodeProcessorResult::MoveVertices &moves = processor.get_result().moves;
+    REQUIRE(moves.size() > 5000000);
+    auto t0 = std::chrono::high_resolution_clock::now();
+    Vec3f  min = Vec3f::Constant(FLT_MAX);
+    Vec3f  max = Vec3f::Constant(- FLT_MAX);
+    for (size_t i = 0; i < moves.size(); ++ i)
+        if (moves.type(i) == EMoveType::Extrude && moves.width(i) != 0.f) {
+            min = min.cwiseMin(moves.position(i));
+            max = max.cwiseMax(moves.position(i));
+        }
+    auto t1 = std::chrono::high_resolution_clock::now();
+    REQUIRE(min.x() <= max.x());
+    std::cout << moves.size() << " moves: " << (moves.memsize() >> 20) << " MB stored by columns, " <<
+        ((moves.size() * sizeof(GCodeProcessorResult::MoveVertex)) >> 20) << " MB as an array of moves, bounding box scan " <<
+        std::chrono::duration<double>(t1 - t0).count() << " s" << std::endl;
+}
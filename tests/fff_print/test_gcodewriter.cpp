@@ -94,3 +94,34 @@ SCENARIO("set_speed emits values with fixed-point output.", "[GCodeWriter]") {
         }
     }
 }
+
+SCENARIO("The appending variants emit the same G-code as the returning ones.", "[GCodeWriter]") {
+
+    GIVEN("Two GCodeWriter instances with a single extruder") {
+        GCodeWriter writer_returning;
+        GCodeWriter writer_appending;
+        for (GCodeWriter *writer : { &writer_returning, &writer_appending }) {
+            writer->set_extruders({ 0 });
+            writer->set_extruder(0);
+        }
+        WHEN("the same moves are emitted by both writers") {
+            std::string returned;
+            returned += writer_returning.set_speed(1800., "", ";_EXTRUDE_SET_SPEED");
+            returned += writer_returning.travel_to_xy(Vec2d(10., 10.), "travel");
+            returned += writer_returning.extrude_to_xy(Vec2d(20., 10.), 0.5, "perimeter");
+            returned += writer_returning.extrude_arc_to_xy(Vec2d(20., 20.), Vec2d(0., 5.), 0.8, true);
+            returned += writer_returning.extrude_to_xyz(Vec3d(10., 20., 0.3), 0.5);
+            std::string appended = "; header\n";
+            writer_appending.set_speed(appended, 1800., "", ";_EXTRUDE_SET_SPEED");
+            writer_appending.travel_to_xy(appended, Vec2d(10., 10.), "travel");
+            writer_appending.extrude_to_xy(appended, Vec2d(20., 10.), 0.5, "perimeter");
+            writer_appending.extrude_arc_to_xy(appended, Vec2d(20., 20.), Vec2d(0., 5.), 0.8, true);
+            writer_appending.extrude_to_xyz(appended, Vec3d(10., 20., 0.3), 0.5);
+            THEN("the appended G-code follows the existing content and matches the returned G-code") {
+                REQUIRE_THAT(appended, Catch::Equals("; header\n" + returned));
+                REQUIRE(writer_appending.get_position() == writer_returning.get_position());
+                REQUIRE(writer_appending.extruder()->E() == Approx(writer_returning.extruder()->E()));
+            }
+        }
+    }
+}
@@ -87,3 +87,183 @@ SCENARIO("PrintObject: object layer heights", "[PrintObject]") {
 #endif
     }
 }
+
+SCENARIO("PrintObject: perimeters of layers with the same outlines", "[PrintObject]") {
+    GIVEN("20mm cube sliced at 0.5mm layers") {
+        Slic3r::Print print;
+        Slic3r::Test::init_and_process_print({TestMesh::cube_20x20x20}, print, {
+            { "first_layer_height", 0.5 },
+            { "layer_height",       0.5 },
+            { "sparse_infill_density", 0.2 }
+        });
+        const PrintObject    &object = *print.objects().front();
+        ConstLayerPtrsAdaptor layers = object.layers();
+        REQUIRE(layers.size() == 40);
+        THEN("The perimeters of the middle layers are copied instead of generated") {
+            REQUIRE(object.num_layers_with_copied_perimeters() >= 19);
+            REQUIRE(object.num_layers_with_copied_perimeters() < layers.size());
+        }
+        THEN("The middle layers have the same perimeters and fill surfaces") {
+            const LayerRegion &first = *layers[10]->regions().front();
+            REQUIRE(! first.perimeters.empty());
+            for (size_t i = 11; i < 30; ++ i) {
+                const LayerRegion &layerm = *layers[i]->regions().front();
+                REQUIRE(layerm.perimeters.items_count() == first.perimeters.items_count());
+                REQUIRE(layerm.perimeters.length() == Approx(first.perimeters.length()));
+                REQUIRE(layerm.fill_expolygons == first.fill_expolygons);
+            }
+        }
+    }
+}
+
+SCENARIO("PrintObject: editing a height range modifier", "[PrintObject]") {
+    GIVEN("20mm cube with two height ranges of 0.2mm layers") {
+        DynamicPrintConfig config = DynamicPrintConfig::full_print_config();
+        config.set_deserialize_strict({
+            { "first_layer_height", 0.2 },
+            { "layer_height",       0.2 }
+        });
+        Slic3r::Model model;
+        Slic3r::Print print;
+        Slic3r::Test::init_print({TestMesh::cube_20x20x20}, print, model, config);
+        ModelObject &model_object = *model.objects.front();
+        model_object.layer_config_ranges[{ 0., 10. }].set("layer_height", 0.2);
+        model_object.layer_config_ranges[{ 10., 20. }].set("layer_height", 0.2);
+        print.apply(model, config);
+        print.process();
+        auto layer_slices = [](const Print &print) {
+            std::vector<std::pair<coordf_t, ExPolygons>> out;
+            for (const Layer *layer : print.objects().front()->layers())
+                out.emplace_back(layer->print_z, layer->lslices);
+            return out;
+        };
+        const std::vector<std::pair<coordf_t, ExPolygons>> slices_before = layer_slices(print);
+        REQUIRE(! print.objects().front()->shared_regions()->sliced_volumes.empty());
+        const size_t num_reused_before = print.objects().front()->shared_regions()->num_reused_slices;
+        WHEN("the layer height of the upper range is changed to 0.1mm") {
+            model_object.layer_config_ranges[{ 10., 20. }].set("layer_height", 0.1);
+            print.apply(model, config);
+            print.process();
+            const std::vector<std::pair<coordf_t, ExPolygons>> slices_after = layer_slices(print);
+            THEN("The layers of the lower range are unchanged and their slices are reused") {
+                size_t num_lower = std::count_if(slices_before.begin(), slices_before.end(), [](const auto &l) { return l.first < 10. - EPSILON; });
+                REQUIRE(num_lower >= 45);
+                REQUIRE(print.objects().front()->shared_regions()->num_reused_slices >= num_reused_before + num_lower);
+                REQUIRE(slices_after.size() > slices_before.size());
+                for (size_t i = 0; i < num_lower; ++ i) {
+                    REQUIRE(slices_after[i].first == Approx(slices_before[i].first));
+                    REQUIRE(slices_after[i].second == slices_before[i].second);
+                }
+            }
+            THEN("All the layers match a print sliced from scratch") {
+                Slic3r::Print print_fresh;
+                print_fresh.apply(model, config);
+                print_fresh.process();
+                const std::vector<std::pair<coordf_t, ExPolygons>> slices_fresh = layer_slices(print_fresh);
+                REQUIRE(slices_after.size() == slices_fresh.size());
+                for (size_t i = 0; i < slices_fresh.size(); ++ i) {
+                    REQUIRE(slices_after[i].first == Approx(slices_fresh[i].first));
+                    REQUIRE(slices_after[i].second == slices_fresh[i].second);
+                }
+            }
+        }
+    }
+    GIVEN("20mm cube without height ranges") {
+        Slic3r::Print print;
+        Slic3r::Test::init_and_process_print({TestMesh::cube_20x20x20}, print, {
+            { "first_layer_height", 0.2 },
+            { "layer_height",       0.2 }
+        });
+        THEN("The slices of its volumes are not kept") {
+            REQUIRE(print.objects().front()->shared_regions()->sliced_volumes.empty());
+        }
+    }
+}
+
+SCENARIO("PrintObject: reusing the Lightning infill trees", "[PrintObject]") {
+    GIVEN("20mm cube with Lightning infill") {
+        DynamicPrintConfig config = DynamicPrintConfig::full_print_config();
+        config.set_deserialize_strict({
+            { "first_layer_height",    0.2 },
+            { "layer_height",          0.2 },
+            { "sparse_infill_pattern", "lightning" },
+            { "sparse_infill_density", "20%" },
+            { "infill_direction",      45 }
+        });
+        Slic3r::Model model;
+        Slic3r::Print print;
+        Slic3r::Test::init_print({TestMesh::cube_20x20x20}, print, model, config);
+        print.process();
+        auto infill_polylines = [](const Print &print) {
+            std::vector<Polylines> out;
+            for (const Layer *layer : print.objects().front()->layers()) {
+                Polylines polylines;
+                for (const LayerRegion *layerm : layer->regions())
+                    layerm->fills.collect_polylines(polylines);
+                out.emplace_back(std::move(polylines));
+            }
+            return out;
+        };
+        auto fresh_infill_polylines = [&model, &config, &infill_polylines]() {
+            Slic3r::Print print_fresh;
+            print_fresh.apply(model, config);
+            print_fresh.process();
+            return infill_polylines(print_fresh);
+        };
+        WHEN("the infill is prepared again from the same areas") {
+            // The Lightning trees do not depend on the infill direction, they are reused.
+            config.set_deserialize_strict({ { "infill_direction", 90 } });
+            print.apply(model, config);
+            print.process();
+            THEN("The infill matches a print with newly generated trees") {
+                const std::vector<Polylines> infill = infill_polylines(print);
+                REQUIRE(std::any_of(infill.begin(), infill.end(), [](const Polylines &polylines) { return ! polylines.empty(); }));
+                REQUIRE(infill == fresh_infill_polylines());
+            }
+        }
+        WHEN("the infill density is changed") {
+            config.set_deserialize_strict({ { "sparse_infill_density", "40%" } });
+            print.apply(model, config);
+            print.process();
+            THEN("The trees are generated again and the infill matches a fresh print") {
+                REQUIRE(infill_polylines(print) == fresh_infill_polylines());
+            }
+        }
+    }
+}
+
+SCENARIO("PrintObject: perimeters of layers with the same outlines in a height range modifier", "[PrintObject]") {
+    GIVEN("20mm cube with 4 walls in its upper half") {
+        DynamicPrintConfig config = DynamicPrintConfig::full_print_config();
+        config.set_deserialize_strict({
+            { "first_layer_height",    0.5 },
+            { "layer_height",          0.5 },
+            { "wall_loops",            2 },
+            { "sparse_infill_density", 0.2 }
+        });
+        Slic3r::Model model;
+        Slic3r::Print print;
+        Slic3r::Test::init_print({TestMesh::cube_20x20x20}, print, model, config);
+        model.objects.front()->layer_config_ranges[{ 10., 20. }].set("wall_loops", 4);
+        print.apply(model, config);
+        print.process();
+        ConstLayerPtrsAdaptor layers = print.objects().front()->layers();
+        REQUIRE(layers.size() == 40);
+        THEN("The layers of the height range get the perimeters of their own settings") {
+            auto num_loops = [](const Layer &layer) {
+                size_t n = 0;
+                for (const LayerRegion *layerm : layer.regions())
+                    n += layerm->perimeters.flatten().entities.size();
+                return n;
+            };
+            const size_t loops_below = num_loops(*layers[10]);
+            const size_t loops_above = num_loops(*layers[30]);
+            REQUIRE(loops_below > 0);
+            REQUIRE(loops_above > loops_below);
+            for (size_t i = 11; i < 19; ++ i)
+                REQUIRE(num_loops(*layers[i]) == loops_below);
+            for (size_t i = 21; i < 38; ++ i)
+                REQUIRE(num_loops(*layers[i]) == loops_above);
+        }
+    }
+}
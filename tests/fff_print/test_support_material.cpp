@@ -2,6 +2,11 @@
 
 #include "libslic3r/GCodeReader.hpp"
 #include "libslic3r/Layer.hpp"
+#include "libslic3r/Support/TreeSupport.hpp"
+
+#include <thread>
+
+#include <tbb/global_control.h>
 
 #include "test_data.hpp" // get access to init_print, etc
 
@@ -18,6 +23,42 @@ TEST_CASE("SupportMaterial: Three raft layers created", "[SupportMaterial]")
     REQUIRE(print.objects().front()->support_layers().size() == 3);
 }
 
+// Support islands of the slim tree supports of the overhang test mesh.
+static std::vector<ExPolygons> tree_support_islands(size_t cache_size_limit, size_t max_threads)
+{
+    tbb::global_control parallelism(tbb::global_control::max_allowed_parallelism, max_threads);
+    TreeSupportData::cache_size_limit = cache_size_limit;
+    Slic3r::Print print;
+    Slic3r::Test::init_and_process_print({ TestMesh::overhang }, print, {
+        { "enable_support", 1 },
+        { "support_type",   "tree(auto)" },
+        { "support_style",  "tree_slim" },
+        { "layer_height",   0.2 }
+    });
+    TreeSupportData::cache_size_limit = 0;
+    std::vector<ExPolygons> out;
+    for (const SupportLayer *layer : print.objects().front()->support_layers())
+        out.emplace_back(layer->support_islands);
+    return out;
+}
+
+TEST_CASE("SupportMaterial: tree supports do not depend on the avoidance cache size", "[SupportMaterial]")
+{
+    const std::vector<ExPolygons> unbounded = tree_support_islands(0, 1);
+    // Each shard of the caches keeps just the last area inserted, the others are evicted.
+    const std::vector<ExPolygons> tiny      = tree_support_islands(1, 1);
+    REQUIRE(! unbounded.empty());
+    REQUIRE(tiny == unbounded);
+}
+
+TEST_CASE("SupportMaterial: tree supports generated in parallel match the serial ones", "[SupportMaterial]")
+{
+    const std::vector<ExPolygons> serial   = tree_support_islands(0, 1);
+    const std::vector<ExPolygons> parallel = tree_support_islands(0, std::max(4u, std::thread::hardware_concurrency()));
+    REQUIRE(! serial.empty());
+    REQUIRE(parallel == serial);
+}
+
 SCENARIO("SupportMaterial: support_layers_z and contact_distance", "[SupportMaterial]")
 {
     // Box h = 20mm, hole bottom at 5mm, hole height 10mm (top edge at 15mm).
@@ -134,6 +134,31 @@ SCENARIO( "TriangleMesh: Transformation functions affect mesh as expected.") {
     }
 }
 
+SCENARIO( "TriangleMesh: content hash identifies identical meshes.") {
+    GIVEN( "Two separately created 20mm cubes") {
+        TriangleMesh cube1 = make_cube();
+        TriangleMesh cube2 = make_cube();
+        THEN( "Their content is the same") {
+            REQUIRE(cube1.content_hash() == cube2.content_hash());
+            REQUIRE(cube1.content_equal(cube2));
+        }
+        WHEN( "One of them is translated") {
+            size_t hash = cube2.content_hash();
+            cube2.translate(1.0, 0.0, 0.0);
+            THEN( "The cached hash is updated and the content differs") {
+                REQUIRE(cube2.content_hash() != hash);
+                REQUIRE(! cube1.content_equal(cube2));
+            }
+        }
+        WHEN( "One of them is copied") {
+            TriangleMesh cube3 = cube1;
+            THEN( "The copy has the same content") {
+                REQUIRE(cube3.content_equal(cube1));
+            }
+        }
+    }
+}
+
 SCENARIO( "TriangleMesh: slice behavior.") {
     GIVEN( "A 20mm cube with one corner on the origin") {
         auto cube = make_cube();
@@ -177,6 +202,26 @@ SCENARIO( "TriangleMesh: slice behavior.") {
     }
 }
 
+SCENARIO( "TriangleMesh: slicing at many planes matches slicing at each plane separately.") {
+    GIVEN( "A finely tesselated sphere") {
+        indexed_triangle_set sphere = its_make_sphere(10., 2. * PI / 200.);
+        std::vector<float> zs;
+        for (float z = -9.9f; z < 10.f; z += 0.2f)
+            zs.emplace_back(z);
+        WHEN("The sphere is sliced at all the planes at once") {
+            std::vector<Polygons> layers = slice_mesh(sphere, zs, MeshSlicingParams{});
+            THEN( "Each layer has the same area as the sphere sliced at the single plane") {
+                REQUIRE(layers.size() == zs.size());
+                for (size_t i = 0; i < zs.size(); ++ i) {
+                    Polygons single = slice_mesh(sphere, zs[i], MeshSlicingParams{});
+                    REQUIRE(layers[i].size() == single.size());
+                    REQUIRE(area(layers[i]) == Approx(area(single)));
+                }
+            }
+        }
+    }
+}
+
 SCENARIO( "make_xxx functions produce meshes.") {
     GIVEN("make_cube() function") {
         WHEN("make_cube() is called with arguments 20,20,20") {
@@ -58,3 +58,43 @@ TEST_CASE("Building a tree over a box, ray caster and closest query", "[AABBIndi
     REQUIRE(closest_point.y() == Approx(0.5));
     REQUIRE(closest_point.z() == Approx(1.));
 }
+
+TEST_CASE("Float ray caster over a float tree", "[AABBIndirect]")
+{
+    TriangleMesh tmesh = make_cube(1., 1., 1.);
+
+    auto tree = AABBTreeIndirect::build_aabb_tree_over_indexed_triangle_set(tmesh.its.vertices, tmesh.its.indices);
+    REQUIRE(! tree.empty());
+
+    igl::Hit hit;
+	bool intersected = AABBTreeIndirect::intersect_ray_first_hit(
+		tmesh.its.vertices, tmesh.its.indices,
+		tree,
+		Vec3f(0.5f, 0.5f, -5.f),
+		Vec3f(0.f, 0.f, 1.f),
+		hit);
+
+    REQUIRE(intersected);
+    REQUIRE(hit.t == Approx(5.));
+
+    std::vector<igl::Hit> hits;
+	bool intersected2 = AABBTreeIndirect::intersect_ray_all_hits(
+		tmesh.its.vertices, tmesh.its.indices,
+		tree,
+        Vec3f(0.3f, 0.5f, -5.f),
+		Vec3f(0.f, 0.f, 1.f),
+		hits);
+    REQUIRE(intersected2);
+    REQUIRE(hits.size() == 2);
+    REQUIRE(hits.front().t == Approx(5.));
+    REQUIRE(hits.back().t == Approx(6.));
+
+    // The float query hits the same triangles as the double query.
+    for (float x : { 0.1f, 0.35f, 0.8f }) {
+        igl::Hit hitf, hitd;
+        REQUIRE(AABBTreeIndirect::intersect_ray_first_hit(tmesh.its.vertices, tmesh.its.indices, tree, Vec3f(x, 5.f, 0.4f), Vec3f(0.f, -1.f, 0.f), hitf));
+        REQUIRE(AABBTreeIndirect::intersect_ray_first_hit(tmesh.its.vertices, tmesh.its.indices, tree, Vec3d(x, 5., 0.4), Vec3d(0., -1., 0.), hitd));
+        REQUIRE(hitf.id == hitd.id);
+        REQUIRE(hitf.t == Approx(hitd.t));
+    }
+}
@@ -0,0 +1,107 @@
+#include <catch2/catch.hpp>
+
+#include <cstdint>
+#include <list>
+#include <set>
+
+#include "libslic3r/Arachne/utils/ArenaAllocator.hpp"
+
+using namespace Slic3r::Arachne;
+
+static bool is_aligned(const void *p, size_t alignment) { return reinterpret_cast<std::uintptr_t>(p) % alignment == 0; }
+
+TEST_CASE("Arena: consecutive allocations share a block", "[ArenaAllocator]") {
+    Arena arena(1024);
+    std::set<char*> allocated;
+    // 32 objects of 32 bytes fill the block exactly.
+    for (size_t i = 0; i < 32; ++ i) {
+        char *p = static_cast<char*>(arena.allocate(32, 8));
+        REQUIRE(p != nullptr);
+        // No two allocations overlap.
+        auto it = allocated.lower_bound(p);
+        if (it != allocated.end())
+            REQUIRE(p + 32 <= *it);
+        if (it != allocated.begin())
+            REQUIRE(*std::prev(it) + 32 <= p);
+        allocated.insert(p);
+    }
+    REQUIRE(arena.num_allocations() == 32);
+    REQUIRE(arena.num_blocks() == 1);
+    // The block is full, the next allocation takes a new one.
+    arena.allocate(32, 8);
+    REQUIRE(arena.num_blocks() == 2);
+}
+
+TEST_CASE("Arena: released objects are reused by objects of the same size", "[ArenaAllocator]") {
+    Arena arena(1024);
+    void *a = arena.allocate(48, 8);
+    void *b = arena.allocate(64, 8);
+    arena.deallocate(a, 48);
+    arena.deallocate(b, 64);
+    REQUIRE(arena.allocate(64, 8) == b);
+    REQUIRE(arena.allocate(48, 8) == a);
+    // The free lists are empty again, new objects are cut from the block.
+    void *c = arena.allocate(48, 8);
+    REQUIRE(c != a);
+    REQUIRE(c != b);
+    REQUIRE(arena.num_blocks() == 1);
+}
+
+TEST_CASE("Arena: objects of more sizes than there are free lists", "[ArenaAllocator]") {
+    Arena arena(64 * 1024);
+    std::vector<std::pair<void*, size_t>> objects;
+    for (size_t size = 16; size <= 16 * 64; size += 16)
+        objects.emplace_back(arena.allocate(size, 8), size);
+    for (const auto &[p, size] : objects)
+        arena.deallocate(p, size);
+    // The objects of the first sizes are reused, the other ones stay in their block until the arena is released.
+    REQUIRE(arena.allocate(16, 8) == objects.front().first);
+    REQUIRE(arena.allocate(16 * 64, 8) != objects.back().first);
+}
+
+TEST_CASE("Arena: allocations are aligned", "[ArenaAllocator]") {
+    Arena arena(1024);
+    for (size_t alignment : { 1, 2, 4, 8, 16, 32, 64 }) {
+        // Misalign the free space first.
+        arena.allocate(9, 1);
+        void *p = arena.allocate(24, alignment);
+        REQUIRE(is_aligned(p, alignment));
+    }
+}
+
+TEST_CASE("Arena: allocations larger than a block", "[ArenaAllocator]") {
+    Arena arena(256);
+    void *small = arena.allocate(32, 8);
+    char *large = static_cast<char*>(arena.allocate(1000, 64));
+    REQUIRE(is_aligned(large, 64));
+    REQUIRE(arena.num_blocks() == 2);
+    // The whole object is writable.
+    std::fill(large, large + 1000, char(0x5a));
+    REQUIRE(std::all_of(large, large + 1000, [](char c) { return c == char(0x5a); }));
+    REQUIRE(small != large);
+    // Less than 128 bytes are left in the large block, the next object takes a new block.
+    arena.allocate(128, 8);
+    REQUIRE(arena.num_blocks() == 3);
+}
+
+TEST_CASE("ArenaAllocator: std::list sharing an arena", "[ArenaAllocator]") {
+    auto arena = std::make_shared<Arena>();
+    std::list<int, ArenaAllocator<int>> list { ArenaAllocator<int>(arena) };
+    for (int i = 0; i < 1000; ++ i)
+        list.push_back(i);
+    const size_t num_allocations = arena->num_allocations();
+    REQUIRE(num_allocations >= 1000);
+    // Erasing and inserting the same number of nodes reuses the released nodes.
+    for (int i = 0; i < 500; ++ i)
+        list.pop_front();
+    for (int i = 0; i < 500; ++ i)
+        list.push_back(i);
+    REQUIRE(arena->num_allocations() == num_allocations + 500);
+    REQUIRE(arena->num_blocks() == 1);
+    REQUIRE(list.size() == 1000);
+    REQUIRE(list.front() == 500);
+    REQUIRE(list.back() == 499);
+    // Copies of the allocator, including the rebound ones, share the arena.
+    REQUIRE(ArenaAllocator<double>(list.get_allocator()) == list.get_allocator());
+    REQUIRE(ArenaAllocator<int>(std::make_shared<Arena>()) != list.get_allocator());
+}
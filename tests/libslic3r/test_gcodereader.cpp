@@ -0,0 +1,182 @@
+#include <catch2/catch.hpp>
+
+#include "libslic3r/GCodeReader.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include <random>
+
+#include <boost/filesystem.hpp>
+#include <boost/nowide/cstdio.hpp>
+
+#include <fast_float/fast_float.h>
+
+using namespace Slic3r;
+
+static std::string write_temp_file(const std::string &content)
+{
+    std::string path = boost::filesystem::unique_path().string();
+    FILE *f = boost::nowide::fopen(path.c_str(), "wb");
+    REQUIRE(f != nullptr);
+    fwrite(content.data(), 1, content.size(), f);
+    fclose(f);
+    return path;
+}
+
+struct ParsedLine
+{
+    std::string raw;
+    std::string cmd;
+    std::string comment;
+    float       x;
+    float       y;
+    float       e;
+    bool        has_x;
+    bool        has_e;
+};
+
+static std::vector<ParsedLine> parse(GCodeReader &reader, const std::string &path, std::vector<size_t> *lines_ends = nullptr)
+{
+    std::vector<ParsedLine> out;
+    auto callback = [&out](GCodeReader&, const GCodeReader::GCodeLine &line) {
+        out.push_back({ line.raw(), std::string(line.cmd()), std::string(line.comment()), line.x(), line.y(), line.e(), line.has_x(), line.has_e() });
+    };
+    if (lines_ends)
+        REQUIRE(reader.parse_file(path, callback, *lines_ends));
+    else
+        REQUIRE(reader.parse_file(path, callback));
+    return out;
+}
+
+SCENARIO("GCodeReader parses a memory mapped file in place", "[GCodeReader]") {
+    GIVEN("A G-code with CRLF line ends, an empty line and an unterminated last line") {
+        const std::string gcode = "G1 X1.5 Y2 E0.1 ; first\r\n\nG1 X3\nM107\r\n;TYPE:Perimeter\nG1 X4 Y5 E.25";
+        std::string       path  = write_temp_file(gcode);
+        GCodeReader       reader;
+        std::vector<size_t> lines_ends;
+        std::vector<ParsedLine> lines = parse(reader, path, &lines_ends);
+        boost::nowide::remove(path.c_str());
+        THEN("All lines are reported without the newlines") {
+            REQUIRE(lines.size() == 6);
+            REQUIRE(lines[0].raw == "G1 X1.5 Y2 E0.1 ; first");
+            REQUIRE(lines[0].cmd == "G1");
+            REQUIRE(lines[0].comment == " first");
+            REQUIRE(lines[1].raw.empty());
+            REQUIRE(lines[3].raw == "M107");
+            REQUIRE(lines[4].comment == "TYPE:Perimeter");
+            REQUIRE(lines[5].raw == "G1 X4 Y5 E.25");
+        }
+        THEN("Axes are parsed") {
+            REQUIRE(lines[0].has_x);
+            REQUIRE(lines[0].x == Approx(1.5f));
+            REQUIRE(lines[0].y == Approx(2.f));
+            REQUIRE(lines[0].e == Approx(0.1f));
+            REQUIRE(lines[2].has_x);
+            REQUIRE(! lines[2].has_e);
+            REQUIRE(lines[5].e == Approx(0.25f));
+        }
+        THEN("Line ends are the offsets past each LF") {
+            REQUIRE(lines_ends == std::vector<size_t>{ 25, 26, 32, 38, 54 });
+        }
+        THEN("The reader position follows the moves") {
+            REQUIRE(reader.x() == Approx(4.f));
+            REQUIRE(reader.y() == Approx(5.f));
+        }
+    }
+    GIVEN("A G-code with CR line ends") {
+        std::string path = write_temp_file("G1 X1\rG1 X2\rG1 X3\r");
+        GCodeReader reader;
+        std::vector<ParsedLine> lines = parse(reader, path);
+        boost::nowide::remove(path.c_str());
+        THEN("Each CR terminates a line") {
+            REQUIRE(lines.size() == 3);
+            REQUIRE(lines[2].x == Approx(3.f));
+        }
+    }
+    GIVEN("A file and the same G-code in a buffer") {
+        std::string gcode;
+        for (int i = 0; i < 1000; ++ i)
+            gcode += "G1 X" + std::to_string(i) + " Y" + std::to_string(i * 2) + " E0.05\nG0 Z" + std::to_string(i) + ".2 ; travel\n";
+        std::string path = write_temp_file(gcode);
+        GCodeReader file_reader;
+        std::vector<ParsedLine> from_file = parse(file_reader, path);
+        boost::nowide::remove(path.c_str());
+        std::vector<ParsedLine> from_buffer;
+        GCodeReader buffer_reader;
+        buffer_reader.parse_buffer(gcode, [&from_buffer](GCodeReader&, const GCodeReader::GCodeLine &line) {
+            from_buffer.push_back({ line.raw(), std::string(line.cmd()), std::string(line.comment()), line.x(), line.y(), line.e(), line.has_x(), line.has_e() });
+        });
+        THEN("Both are parsed the same") {
+            REQUIRE(from_file.size() == from_buffer.size());
+            bool same = true;
+            for (size_t i = 0; i < from_file.size(); ++ i)
+                same &= from_file[i].raw == from_buffer[i].raw && from_file[i].x == from_buffer[i].x && from_file[i].e == from_buffer[i].e;
+            REQUIRE(same);
+        }
+    }
+}
+
+SCENARIO("GCodeLine copies own their raw string", "[GCodeReader]") {
+    std::string buffer = "G1 X10 Y20\n";
+    GCodeReader::GCodeLine copy;
+    GCodeReader reader;
+    reader.parse_buffer(buffer, [&copy](GCodeReader&, const GCodeReader::GCodeLine &line) { copy = line; });
+    buffer.assign(buffer.size(), ' ');
+    REQUIRE(copy.raw() == "G1 X10 Y20");
+    REQUIRE(copy.cmd_is("G1"));
+    copy.set(X, 5.f);
+    REQUIRE(copy.raw() == "G1 X5.000 Y20");
+    REQUIRE(copy.raw_view() == copy.raw());
+}
+
+TEST_CASE("GCodeReader parses axis values the same as fast_float", "[GCodeReader]") {
+    std::mt19937 rng(42);
+    std::vector<std::string> values { "0", "-0", "1.", ".5", "-.5", "+1", "1e3", "1.5E-2", "123456789012345678", "0.1234567890123456", "-", ".", "abc" };
+    for (int i = 0; i < 100000; ++ i) {
+        char buf[64];
+        snprintf(buf, sizeof(buf), "%.*f", int(rng() % 9), double(int(rng() % 2000001) - 1000000) * pow(10., - int(rng() % 6)));
+        values.emplace_back(buf);
+    }
+    GCodeReader reader;
+    size_t      mismatches = 0;
+    for (const std::string &value : values) {
+        std::string line = "G1 X" + value + " Y1";
+        double      expected;
+        auto [pend, ec] = fast_float::from_chars(value.data(), value.data() + value.size(), expected);
+        bool        valid = ec == std::errc() && pend == value.data() + value.size();
+        reader.parse_line(line, [&](GCodeReader&, const GCodeReader::GCodeLine &gline) {
+            if (gline.has_x() != valid || (valid && gline.x() != float(expected)))
+                ++ mismatches;
+        });
+    }
+    REQUIRE(mismatches == 0);
+}
+
+TEST_CASE("GCodeReader lines per second benchmark", "[GCodeReader][!hide]") {
+    const size_t num_lines = 10000000;
+    std::string path = boost::filesystem::unique_path().string();
+    {
+        FILE *f = boost::nowide::fopen(path.c_str(), "wb");
+        REQUIRE(f != nullptr);
+        char line[128];
+        for (size_t i = 0; i < num_lines; ++ i) {
+            int len = (i % 10 == 9) ?
+                snprintf(line, sizeof(line), ";TYPE:Outer wall\n") :
+                snprintf(line, sizeof(line), "G%d X%.3f Y%.3f E%.5f\n", int(i % 4), double(i % 2560) * 0.1, double(i % 1280) * 0.2, double(i % 100) * 0.001);
+            fwrite(line, 1, len, f);
+        }
+        fclose(f);
+    }
+    GCodeReader reader;
+    size_t      cnt = 0;
+    double      sum = 0.;
+    auto t0 = std::chrono::high_resolution_clock::now();
+    REQUIRE(reader.parse_file(path, [&cnt, &sum](GCodeReader&, const GCodeReader::GCodeLine &line) { ++ cnt; sum += line.x(); }));
+    auto t1 = std::chrono::high_resolution_clock::now();
+    boost::nowide::remove(path.c_str());
+    REQUIRE(cnt == num_lines);
+    double seconds = std::chrono::duration<double>(t1 - t0).count();
+    std::cout << "GCodeReader::parse_file: " << num_lines << " lines in " << seconds << " s, " << size_t(double(num_lines) / seconds) << " lines/s" << std::endl;
+}
@@ -0,0 +1,256 @@
+#include <catch2/catch.hpp>
+
+#include "libslic3r/Format/SliceCache.hpp"
+#include "libslic3r/PersistentSliceCache.hpp"
+
+#include <chrono>
+#include <iostream>
+
+#include <boost/filesystem.hpp>
+#include <boost/nowide/cstdio.hpp>
+#include <boost/nowide/fstream.hpp>
+
+#include <nlohmann/json.hpp>
+
+using namespace Slic3r;
+
+static ExPolygon make_ring(const Point &center, coord_t outer, coord_t inner, size_t num_points)
+{
+    ExPolygon expoly;
+    for (size_t i = 0; i < num_points; ++ i) {
+        double angle = 2. * PI * double(i) / double(num_points);
+        expoly.contour.points.emplace_back(center + Point(coord_t(outer * cos(angle)), coord_t(outer * sin(angle))));
+    }
+    Polygon hole;
+    for (size_t i = num_points; i > 0; -- i) {
+        double angle = 2. * PI * double(i) / double(num_points);
+        hole.points.emplace_back(center + Point(coord_t(inner * cos(angle)), coord_t(inner * sin(angle))));
+    }
+    expoly.holes.emplace_back(std::move(hole));
+    return expoly;
+}
+
+struct CachedLayer
+{
+    ExPolygons               lslices;
+    std::vector<BoundingBox> lslices_bboxes;
+    ExPolygons               loverhangs;
+};
+
+static std::vector<CachedLayer> make_layers(size_t num_layers, size_t num_islands, size_t num_points)
+{
+    std::vector<CachedLayer> layers(num_layers);
+    for (size_t layer_id = 0; layer_id < num_layers; ++ layer_id) {
+        CachedLayer &layer = layers[layer_id];
+        for (size_t i = 0; i < num_islands; ++ i) {
+            layer.lslices.emplace_back(make_ring(Point(scaled(30. * i), scaled(-10. * i)), scaled(10. + 0.01 * layer_id), scaled(5.), num_points));
+            layer.lslices_bboxes.emplace_back(get_extents(layer.lslices.back()));
+        }
+        if (layer_id % 3 == 0)
+            layer.loverhangs.emplace_back(make_ring(Point(scaled(-100.), scaled(100.)), scaled(2.), scaled(1.), 16));
+    }
+    // An undefined bounding box has to survive the round trip as well.
+    layers.front().lslices_bboxes.emplace_back();
+    // So does a bounding box with a different width and height.
+    layers.back().lslices_bboxes.emplace_back(Point(scaled(-20.), scaled(5.)), Point(scaled(80.), scaled(12.)));
+    return layers;
+}
+
+static bool save_layers(const std::string &path, const std::vector<CachedLayer> &layers)
+{
+    SliceCacheWriter writer(layers.size());
+    for (size_t i = 0; i < layers.size(); ++ i)
+        writer.set_layer(i, layers[i].lslices, layers[i].lslices_bboxes, layers[i].loverhangs);
+    return writer.save(path);
+}
+
+TEST_CASE("Slice cache round trip", "[SliceCache]") {
+    std::vector<CachedLayer> layers = make_layers(20, 3, 64);
+    std::string              path   = boost::filesystem::unique_path().string();
+    REQUIRE(save_layers(path, layers));
+
+    SliceCacheReader reader;
+    REQUIRE(reader.open(path));
+    REQUIRE(reader.layer_count() == layers.size());
+    // Layers may be decoded in any order.
+    for (size_t i = layers.size(); i > 0; -- i) {
+        CachedLayer loaded;
+        REQUIRE(reader.load_layer(i - 1, loaded.lslices, loaded.lslices_bboxes, loaded.loverhangs));
+        const CachedLayer &expected = layers[i - 1];
+        REQUIRE(loaded.lslices == expected.lslices);
+        REQUIRE(loaded.loverhangs == expected.loverhangs);
+        REQUIRE(loaded.lslices_bboxes.size() == expected.lslices_bboxes.size());
+        for (size_t j = 0; j < expected.lslices_bboxes.size(); ++ j) {
+            REQUIRE(loaded.lslices_bboxes[j].defined == expected.lslices_bboxes[j].defined);
+            REQUIRE(loaded.lslices_bboxes[j].min == expected.lslices_bboxes[j].min);
+            REQUIRE(loaded.lslices_bboxes[j].max == expected.lslices_bboxes[j].max);
+        }
+    }
+    CachedLayer out_of_range;
+    REQUIRE(! reader.load_layer(layers.size(), out_of_range.lslices, out_of_range.lslices_bboxes, out_of_range.loverhangs));
+    reader.close();
+    boost::nowide::remove(path.c_str());
+}
+
+TEST_CASE("Slice cache rejects foreign or truncated files", "[SliceCache]") {
+    std::string path = boost::filesystem::unique_path().string();
+    {
+        boost::nowide::ofstream out(path, std::ios::binary);
+        out << "{\"name\": \"not a slice cache\", \"layers\": []}";
+    }
+    SliceCacheReader reader;
+    REQUIRE(! reader.open(path));
+
+    REQUIRE(save_layers(path, make_layers(5, 2, 32)));
+    boost::filesystem::resize_file(path, boost::filesystem::file_size(path) - 7);
+    REQUIRE(! reader.open(path));
+    boost::nowide::remove(path.c_str());
+}
+
+TEST_CASE("Persistent slice cache hits, misses and eviction", "[SliceCache]") {
+    std::string directory = (boost::filesystem::temp_directory_path() / boost::filesystem::unique_path()).string();
+    std::vector<ExPolygons> layers;
+    for (const CachedLayer &layer : make_layers(10, 2, 64))
+        layers.emplace_back(layer.lslices);
+
+    {
+        PersistentSliceCache cache(directory, 0);
+        std::vector<ExPolygons> loaded;
+        REQUIRE(! cache.load("A", layers.size(), loaded));
+        cache.store("A", layers);
+        REQUIRE(cache.load("A", layers.size(), loaded));
+        REQUIRE(loaded == layers);
+        PersistentSliceCache::Stats stats = cache.stats();
+        REQUIRE(stats.hits == 1);
+        REQUIRE(stats.misses == 1);
+        REQUIRE(stats.stores == 1);
+        REQUIRE(stats.bytes > 0);
+    }
+
+    // Another process sees the entry stored by the first one.
+    uint64_t entry_size = boost::filesystem::file_size(boost::filesystem::path(directory) / "A.slices");
+    PersistentSliceCache cache(directory, 2 * entry_size + entry_size / 2);
+    REQUIRE(cache.stats().bytes == entry_size);
+    std::vector<ExPolygons> loaded;
+    REQUIRE(cache.load("A", layers.size(), loaded));
+    cache.store("B", layers);
+    // "A" was used before "B" was stored, thus it is the least recently used entry.
+    cache.store("C", layers);
+    REQUIRE(cache.stats().evictions == 1);
+    REQUIRE(cache.stats().bytes == 2 * entry_size);
+    REQUIRE(! cache.load("A", layers.size(), loaded));
+    REQUIRE(cache.load("B", layers.size(), loaded));
+    REQUIRE(cache.load("C", layers.size(), loaded));
+
+    // An entry with a different number of layers is a miss.
+    PersistentSliceCache::Stats stats = cache.stats();
+    REQUIRE(! cache.load("C", layers.size() + 1, loaded));
+    REQUIRE(loaded.empty());
+    REQUIRE(cache.stats().hits == stats.hits);
+    REQUIRE(cache.stats().misses == stats.misses + 1);
+    boost::filesystem::remove_all(directory);
+}
+
+// The same schema as the layer slices of the json cache written by Print::export_cached_data().
+static nlohmann::json points_to_json(const Points &points)
+{
+    nlohmann::json j = nlohmann::json::array();
+    for (const Point &pt : points) {
+        j.push_back(pt.x());
+        j.push_back(pt.y());
+    }
+    return j;
+}
+
+static Points points_from_json(const nlohmann::json &j)
+{
+    Points points;
+    points.reserve(j.size() / 2);
+    for (size_t i = 0; i + 1 < j.size(); i += 2)
+        points.emplace_back(j[i].get<coord_t>(), j[i + 1].get<coord_t>());
+    return points;
+}
+
+static nlohmann::json expolygons_to_json(const ExPolygons &expolys)
+{
+    nlohmann::json j = nlohmann::json::array();
+    for (const ExPolygon &expoly : expolys) {
+        nlohmann::json holes = nlohmann::json::array();
+        for (const Polygon &hole : expoly.holes)
+            holes.push_back(points_to_json(hole.points));
+        j.push_back({ { "contour", points_to_json(expoly.contour.points) }, { "holes", std::move(holes) } });
+    }
+    return j;
+}
+
+static ExPolygons expolygons_from_json(const nlohmann::json &j)
+{
+    ExPolygons expolys;
+    expolys.reserve(j.size());
+    for (const nlohmann::json &expoly_json : j) {
+        ExPolygon expoly;
+        expoly.contour.points = points_from_json(expoly_json["contour"]);
+        for (const nlohmann::json &hole_json : expoly_json["holes"])
+            expoly.holes.emplace_back(points_from_json(hole_json));
+        expolys.emplace_back(std::move(expoly));
+    }
+    return expolys;
+}
+
+TEST_CASE("Slice cache vs. json benchmark", "[SliceCache][!hide]") {
+    // Both formats store and load the same payload: the slices with their holes, their bounding boxes and the overhangs.
+    std::vector<CachedLayer> layers = make_layers(2000, 50, 200);
+    std::string              path   = boost::filesystem::unique_path().string();
+
+    auto t0 = std::chrono::high_resolution_clock::now();
+    {
+        nlohmann::json root = nlohmann::json::array();
+        for (const CachedLayer &layer : layers) {
+            nlohmann::json bboxes = nlohmann::json::array();
+            for (const BoundingBox &bbox : layer.lslices_bboxes)
+                bboxes.push_back({ bbox.min.x(), bbox.min.y(), bbox.max.x(), bbox.max.y() });
+            root.push_back({ { "sliced_polygons", expolygons_to_json(layer.lslices) }, { "sliced_bboxes", std::move(bboxes) },
+                             { "overhang_polygons", expolygons_to_json(layer.loverhangs) } });
+        }
+        boost::nowide::ofstream out(path);
+        out << root.dump(0);
+    }
+    size_t json_size = boost::filesystem::file_size(path);
+    std::vector<CachedLayer> json_loaded;
+    {
+        boost::nowide::ifstream in(path);
+        nlohmann::json root;
+        in >> root;
+        for (const nlohmann::json &layer_json : root) {
+            CachedLayer layer;
+            layer.lslices = expolygons_from_json(layer_json["sliced_polygons"]);
+            for (const nlohmann::json &bbox : layer_json["sliced_bboxes"])
+                layer.lslices_bboxes.emplace_back(Point(bbox[0].get<coord_t>(), bbox[1].get<coord_t>()), Point(bbox[2].get<coord_t>(), bbox[3].get<coord_t>()));
+            layer.loverhangs = expolygons_from_json(layer_json["overhang_polygons"]);
+            json_loaded.emplace_back(std::move(layer));
+        }
+    }
+    auto t1 = std::chrono::high_resolution_clock::now();
+
+    REQUIRE(save_layers(path, layers));
+    size_t binary_size = boost::filesystem::file_size(path);
+    std::vector<CachedLayer> binary_loaded(layers.size());
+    {
+        SliceCacheReader reader;
+        REQUIRE(reader.open(path));
+        for (size_t i = 0; i < reader.layer_count(); ++ i)
+            REQUIRE(reader.load_layer(i, binary_loaded[i].lslices, binary_loaded[i].lslices_bboxes, binary_loaded[i].loverhangs));
+    }
+    auto t2 = std::chrono::high_resolution_clock::now();
+    boost::nowide::remove(path.c_str());
+
+    std::cout << "json:               " << json_size << " bytes, " << std::chrono::duration_cast<std::chrono::milliseconds>(t1 - t0).count() << " ms" << std::endl;
+    std::cout << "binary slice cache: " << binary_size << " bytes, " << std::chrono::duration_cast<std::chrono::milliseconds>(t2 - t1).count() << " ms" << std::endl;
+    REQUIRE(json_loaded.size() == binary_loaded.size());
+    for (size_t i = 0; i < layers.size(); ++ i) {
+        REQUIRE(json_loaded[i].lslices == binary_loaded[i].lslices);
+        REQUIRE(json_loaded[i].loverhangs == binary_loaded[i].loverhangs);
+        REQUIRE(json_loaded[i].lslices_bboxes.size() == binary_loaded[i].lslices_bboxes.size());
+    }
+    REQUIRE(binary_size < json_size);
+}
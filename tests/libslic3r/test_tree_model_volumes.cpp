@@ -0,0 +1,99 @@
+#include <catch2/catch.hpp>
+
+#include <atomic>
+#include <thread>
+
+#include "libslic3r/Support/TreeModelVolumes.hpp"
+
+namespace Slic3r::TreeSupport3D {
+// Friend of TreeModelVolumes, exposing its private cache.
+struct RadiusLayerPolygonCacheTest {
+    using Cache = TreeModelVolumes::RadiusLayerPolygonCache;
+    using Key   = TreeModelVolumes::RadiusLayerPair;
+};
+} // namespace Slic3r::TreeSupport3D
+
+using namespace Slic3r;
+using namespace Slic3r::TreeSupport3D;
+
+using RadiusLayerPolygonCache = RadiusLayerPolygonCacheTest::Cache;
+using RadiusLayerPair         = RadiusLayerPolygonCacheTest::Key;
+
+static Polygons test_area(coord_t radius, LayerIndex layer_idx)
+{
+    return { Polygon({ { 0, 0 }, { radius + 1, 0 }, { radius + 1, coord_t(layer_idx) + 1 } }) };
+}
+
+static bool test_area_matches(const Polygons &polygons, coord_t radius, LayerIndex layer_idx)
+{
+    return polygons == test_area(radius, layer_idx);
+}
+
+TEST_CASE("RadiusLayerPolygonCache filled from multiple threads", "[TreeSupport]") {
+    static constexpr const size_t     num_threads = 8;
+    static constexpr const coord_t    num_radii   = 10;
+    // Spanning several chunks.
+    static constexpr const LayerIndex num_layers  = 1000;
+
+    RadiusLayerPolygonCache cache;
+    // The Catch2 assertions are not thread safe.
+    std::atomic<size_t>     num_failed { 0 };
+    std::vector<std::thread> threads;
+    for (size_t thread_idx = 0; thread_idx < num_threads; ++ thread_idx)
+        threads.emplace_back([&cache, &num_failed, thread_idx]() {
+            // Each thread stores all the areas in its own order, racing the others on the radii, the chunks and the slots.
+            for (LayerIndex i = 0; i < num_layers; ++ i) {
+                const LayerIndex layer_idx = thread_idx % 2 ? num_layers - 1 - i : i;
+                for (coord_t j = 0; j < num_radii; ++ j) {
+                    const coord_t radius = ((j + coord_t(thread_idx)) % num_radii) * 100;
+                    cache.insert(std::vector<std::pair<RadiusLayerPair, Polygons>>{ { { radius, layer_idx }, test_area(radius, layer_idx) } });
+                    auto area = cache.getArea({ radius, layer_idx });
+                    if (! area || ! test_area_matches(area->get(), radius, layer_idx))
+                        ++ num_failed;
+                }
+            }
+        });
+    for (std::thread &thread : threads)
+        thread.join();
+
+    REQUIRE(num_failed == 0);
+    REQUIRE(cache.sorted().size() == size_t(num_radii * num_layers));
+    for (coord_t j = 0; j < num_radii; ++ j) {
+        const coord_t radius = j * 100;
+        REQUIRE(cache.getMaxCalculatedLayer(radius) == num_layers - 1);
+        for (LayerIndex layer_idx = 0; layer_idx < num_layers; ++ layer_idx) {
+            auto area = cache.getArea({ radius, layer_idx });
+            REQUIRE(area);
+            REQUIRE(test_area_matches(area->get(), radius, layer_idx));
+        }
+    }
+    REQUIRE(! cache.getArea({ 50, 0 }));
+    REQUIRE(cache.stats().compute_ns == 0);
+
+    SECTION("Moving the cache keeps the areas and the statistics") {
+        cache.add_compute_time(std::chrono::steady_clock::now() - std::chrono::milliseconds(1));
+        const size_t hits = cache.stats().hits;
+        RadiusLayerPolygonCache moved(std::move(cache));
+        REQUIRE(moved.sorted().size() == size_t(num_radii * num_layers));
+        REQUIRE(moved.stats().hits == hits);
+        REQUIRE(moved.stats().compute_ns > 0);
+        REQUIRE(cache.stats().compute_ns == 0);
+    }
+}
+
+TEST_CASE("RadiusLayerPolygonCache stores layers above the chunks", "[TreeSupport]") {
+    // Above the 256 * 1024 layers stored in the chunks.
+    static constexpr const LayerIndex layer_idx = 300000;
+
+    RadiusLayerPolygonCache cache;
+    cache.insert(std::vector<std::pair<RadiusLayerPair, Polygons>>{ { { 100, layer_idx }, test_area(100, layer_idx) }, { { 100, 5 }, test_area(100, 5) } });
+    auto area = cache.getArea({ 100, layer_idx });
+    REQUIRE(area);
+    REQUIRE(test_area_matches(area->get(), 100, layer_idx));
+    // The area stored first is kept.
+    cache.insert(std::vector<std::pair<RadiusLayerPair, Polygons>>{ { { 100, layer_idx }, test_area(100, 7) } });
+    REQUIRE(&cache.getArea({ 100, layer_idx })->get() == &area->get());
+    REQUIRE(! cache.getArea({ 100, layer_idx + 1 }));
+    REQUIRE(cache.getMaxCalculatedLayer(100) == layer_idx);
+    REQUIRE(cache.sorted().size() == 2);
+}
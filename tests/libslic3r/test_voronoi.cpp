@@ -2158,3 +2158,38 @@ TEST_CASE("Intersecting Voronoi edges", "[Voronoi]")
 
 //    REQUIRE(!has_intersecting_edges(poly, vd));
 }
+
+TEST_CASE("Voronoi diagram cache", "[Voronoi]")
+{
+    Polygons square { Polygon{ { 0, 0 }, { 10000000, 0 }, { 10000000, 10000000 }, { 0, 10000000 } } };
+    Polygons hole   = square;
+    hole.emplace_back(Polygon{ { 2000000, 2000000 }, { 2000000, 8000000 }, { 8000000, 8000000 }, { 8000000, 2000000 } });
+
+    Geometry::VoronoiDiagramCache cache(2);
+    std::shared_ptr<const VD> vd1 = cache.get(square);
+    REQUIRE(cache.get(square) == vd1);
+    REQUIRE(vd1->is_valid());
+
+    VD    vd;
+    Lines lines = to_lines(square);
+    vd.construct_voronoi(lines.begin(), lines.end());
+    REQUIRE(vd1->num_edges() == vd.num_edges());
+    REQUIRE(vd1->num_vertices() == vd.num_vertices());
+
+    // The annotated diagram is cached separately, the annotation does not touch the plain diagram handed out before.
+    std::shared_ptr<const VD> vd2 = cache.get(square, true);
+    REQUIRE(vd2 != vd1);
+    REQUIRE(cache.get(square, true) == vd2);
+    REQUIRE(std::all_of(vd1->vertices().begin(), vd1->vertices().end(), [](const VD::vertex_type &v) { return v.color() == 0; }));
+    REQUIRE(std::any_of(vd2->vertices().begin(), vd2->vertices().end(), [](const VD::vertex_type &v) { return v.color() != 0; }));
+
+    // The plain square is evicted by the square with a hole, but the diagram stays valid for its users.
+    std::shared_ptr<const VD> vd3 = cache.get(hole);
+    REQUIRE(vd3 != vd1);
+    REQUIRE(cache.get(square) != vd1);
+    REQUIRE(vd1->num_edges() == vd.num_edges());
+
+    Geometry::VoronoiDiagramCache::Stats stats = cache.stats();
+    REQUIRE(stats.hits == 2);
+    REQUIRE(stats.misses == 4);
+}